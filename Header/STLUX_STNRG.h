@@ -148,6 +148,8 @@ input mo
   #define TRIGGER_TRAP           __trap()                             ///< trigger a trap (=soft interrupt) e.g. for EMC robustness (see AN1015)
   #define WAIT_FOR_INTERRUPT()   __wait_for_interrupt()               ///< stop code execution and wait for interrupt
   #define ENTER_HALT()           __halt()                             ///< put controller to HALT mode
+  #define SAVE_AND_DISABLE_INTERRUPTS(cc) do { cc = __get_interrupt_state(); __disable_interrupt(); } while (0)   ///< save interrupt state to uint8_t variable cc, then disable interrupts
+  #define RESTORE_INTERRUPTS(cc) __set_interrupt_state(cc)           ///< restore interrupt state from variable cc
   #define SW_RESET()             (_WWDG_CR = _WWDG_CR_WDGA)           ///< reset controller via WWDG module
 
   // data type in bit fields
@@ -171,6 +173,8 @@ input mo
   #define TRIGGER_TRAP           __asm__("trap")                      ///< trigger a trap (=soft interrupt) e.g. for EMC robustness (see AN1015)
   #define WAIT_FOR_INTERRUPT()   __asm__("wfi")                       ///< stop code execution and wait for interrupt
   #define ENTER_HALT()           __asm__("halt")                      ///< put controller to HALT mode
+  #define SAVE_AND_DISABLE_INTERRUPTS(cc) __asm__("push a\n push cc\n pop a\n sim\n ld _" #cc ", a\n pop a")   ///< save interrupt state to global/static uint8_t variable cc, then disable interrupts
+  #define RESTORE_INTERRUPTS(cc) __asm__("push a\n ld a, _" #cc "\n push a\n pop cc\n pop a")   ///< restore interrupt state from variable cc
   #define SW_RESET()             (_WWDG_CR = _WWDG_CR_WDGA)           ///< reset controller via WWDG module
 
   // data type in bit fields
@@ -1314,18 +1318,36 @@ input mo
     #define _MSC_FTM0CKSEL_CLK_SEL01 ((uint8_t) (0x01 << 1))   ///< Basic Timer 0 clock source configuration [1]
     #define _MSC_FTM0CKSEL_CLK_SEL02 ((uint8_t) (0x01 << 2))   ///< Basic Timer 0 clock source configuration [2]
     #define _MSC_FTM0CKSEL_EN0       ((uint8_t) (0x01 << 3))   ///< Basic Timer 0 enable [0]
-    #define _MSC_FTM0CKSEL_CLK_SEL1  ((uint8_t) (0x07 << 0))   ///< Basic Timer 1 clock source configuration [2:0]
-    #define _MSC_FTM0CKSEL_CLK_SEL10 ((uint8_t) (0x01 << 0))   ///< Basic Timer 1 clock source configuration [0]
-    #define _MSC_FTM0CKSEL_CLK_SEL11 ((uint8_t) (0x01 << 1))   ///< Basic Timer 1 clock source configuration [1]
-    #define _MSC_FTM0CKSEL_CLK_SEL12 ((uint8_t) (0x01 << 2))   ///< Basic Timer 1 clock source configuration [2]
-    #define _MSC_FTM0CKSEL_EN1       ((uint8_t) (0x01 << 3))   ///< Basic Timer 1 enable [0]
+    #define _MSC_FTM0CKSEL_CLK_SEL1  ((uint8_t) (0x07 << 4))   ///< Basic Timer 1 clock source configuration [2:0]
+    #define _MSC_FTM0CKSEL_CLK_SEL10 ((uint8_t) (0x01 << 4))   ///< Basic Timer 1 clock source configuration [0]
+    #define _MSC_FTM0CKSEL_CLK_SEL11 ((uint8_t) (0x01 << 5))   ///< Basic Timer 1 clock source configuration [1]
+    #define _MSC_FTM0CKSEL_CLK_SEL12 ((uint8_t) (0x01 << 6))   ///< Basic Timer 1 clock source configuration [2]
+    #define _MSC_FTM0CKSEL_EN1       ((uint8_t) (0x01 << 7))   ///< Basic Timer 1 enable [0]
 
     /* MSC basic timer 1 counter value (_MSC_FTM1CONF, indirect access via _MSC_IDXADD=0x04) */
-    #define _MSC_FTM1CONF_ADC_AFLUSH  ((uint8_t) (0x01 << 3)) ///< ADC FIFO auto-flush for single conversion mode [0]
-    #define _MSC_FTM1CONF_ADC_ARELOAD ((uint8_t) (0x01 << 3)) ///< ADC FIFO auto-reload enable (requires ADC_CFG.CIRCULAR=1) [0]
+    #define _MSC_FTM1CONF_ADC_AFLUSH  ((uint8_t) (0x01 << 6)) ///< ADC FIFO auto-flush for single conversion mode [0]
+    #define _MSC_FTM1CONF_ADC_ARELOAD ((uint8_t) (0x01 << 7)) ///< ADC FIFO auto-reload enable (requires ADC_CFG.CIRCULAR=1) [0]
 
   #endif // STNRG
 
+  /* MSC DALI clock selection (_MSC_DALICKSEL, indirect access via _MSC_IDXADD=0x05) */
+  #define _MSC_DALICKSEL_CLK_SEL   ((uint8_t) (0x07 << 0))   ///< DALI filter clock source configuration [2:0]
+  #define _MSC_DALICKSEL_CLK_SEL0  ((uint8_t) (0x01 << 0))   ///< DALI filter clock source configuration [0]
+  #define _MSC_DALICKSEL_CLK_SEL1  ((uint8_t) (0x01 << 1))   ///< DALI filter clock source configuration [1]
+  #define _MSC_DALICKSEL_CLK_SEL2  ((uint8_t) (0x01 << 2))   ///< DALI filter clock source configuration [2]
+  #define _MSC_DALICKSEL_EN        ((uint8_t) (0x01 << 3))   ///< DALI filter logic enable [0]
+  #define _MSC_DALICKSEL_ADC_TRGSEL ((uint8_t) (0x0F << 4))   ///< DALI configure ADC trigger sources [3:0]
+  #define _MSC_DALICKSEL_ADC_TRGSEL0 ((uint8_t) (0x01 << 4))   ///< DALI configure ADC trigger sources [0]
+  #define _MSC_DALICKSEL_ADC_TRGSEL1 ((uint8_t) (0x01 << 5))   ///< DALI configure ADC trigger sources [1]
+  #define _MSC_DALICKSEL_ADC_TRGSEL2 ((uint8_t) (0x01 << 6))   ///< DALI configure ADC trigger sources [2]
+  #define _MSC_DALICKSEL_ADC_TRGSEL3 ((uint8_t) (0x01 << 7))   ///< DALI configure ADC trigger sources [3]
+
+  /* MSC DALI filter mode configuration (_MSC_DALICONF, indirect access via _MSC_IDXADD=0x07) */
+  #define _MSC_DALICONF_COUNT      ((uint8_t) (0x3F << 0))   ///< DALI filter counter timer value [5:0]
+  #define _MSC_DALICONF_MODE       ((uint8_t) (0x03 << 6))   ///< DALI filter mode selection [1:0]
+  #define _MSC_DALICONF_MODE0      ((uint8_t) (0x01 << 6))   ///< DALI filter mode selection [0]
+  #define _MSC_DALICONF_MODE1      ((uint8_t) (0x01 << 7))   ///< DALI filter mode selection [1]
+
   /* MSC INPP2 aux. register 1 (_MSC_INPP2AUX1, indirect access via _MSC_IDXADD=0x08) */
   #define _MSC_INPP2AUX1_PULLUP0   ((uint8_t) (0x01 << 0))   ///< INPP2[0] pull-up enable [0]
   #define _MSC_INPP2AUX1_PULLUP1   ((uint8_t) (0x01 << 1))   ///< INPP2[1] pull-up enable [0]
@@ -1350,6 +1372,102 @@ input mo
   #define _MSC_INPP2AUX2_INPP0_IMSK  ((uint8_t) (0x01 << 6)) ///< INPP0 interrupt mask enable [0]
   // reserved [7]
 
+  // DAC hysteresis only for STNRG
+  #if defined(STNRG)
+
+    /* MSC DAC0 hysteresis selection (_MSC_DAC0_HYST, indirect access via _MSC_IDXADD=0x0A) */
+    #define _MSC_DAC0_HYST_HYSTDN    ((uint8_t) (0x07 << 0))   ///< comparator hysteresis on falling signals [2:0]
+    #define _MSC_DAC0_HYST_HYSTDN0   ((uint8_t) (0x01 << 0))   ///< comparator hysteresis on falling signals [0]
+    #define _MSC_DAC0_HYST_HYSTDN1   ((uint8_t) (0x01 << 1))   ///< comparator hysteresis on falling signals [1]
+    #define _MSC_DAC0_HYST_HYSTDN2   ((uint8_t) (0x01 << 2))   ///< comparator hysteresis on falling signals [2]
+    // reserved [3]
+    #define _MSC_DAC0_HYST_HYSTUP    ((uint8_t) (0x07 << 4))   ///< comparator hysteresis on rising signals [2:0]
+    #define _MSC_DAC0_HYST_HYSTUP0   ((uint8_t) (0x01 << 4))   ///< comparator hysteresis on rising signals [0]
+    #define _MSC_DAC0_HYST_HYSTUP1   ((uint8_t) (0x01 << 5))   ///< comparator hysteresis on rising signals [1]
+    #define _MSC_DAC0_HYST_HYSTUP2   ((uint8_t) (0x01 << 6))   ///< comparator hysteresis on rising signals [2]
+    // reserved [7]
+
+    /* MSC DAC1 hysteresis selection (_MSC_DAC1_HYST, indirect access via _MSC_IDXADD=0x0B) */
+    #define _MSC_DAC1_HYST_HYSTDN    ((uint8_t) (0x07 << 0))   ///< comparator hysteresis on falling signals [2:0]
+    #define _MSC_DAC1_HYST_HYSTDN0   ((uint8_t) (0x01 << 0))   ///< comparator hysteresis on falling signals [0]
+    #define _MSC_DAC1_HYST_HYSTDN1   ((uint8_t) (0x01 << 1))   ///< comparator hysteresis on falling signals [1]
+    #define _MSC_DAC1_HYST_HYSTDN2   ((uint8_t) (0x01 << 2))   ///< comparator hysteresis on falling signals [2]
+    // reserved [3]
+    #define _MSC_DAC1_HYST_HYSTUP    ((uint8_t) (0x07 << 4))   ///< comparator hysteresis on rising signals [2:0]
+    #define _MSC_DAC1_HYST_HYSTUP0   ((uint8_t) (0x01 << 4))   ///< comparator hysteresis on rising signals [0]
+    #define _MSC_DAC1_HYST_HYSTUP1   ((uint8_t) (0x01 << 5))   ///< comparator hysteresis on rising signals [1]
+    #define _MSC_DAC1_HYST_HYSTUP2   ((uint8_t) (0x01 << 6))   ///< comparator hysteresis on rising signals [2]
+    // reserved [7]
+
+    /* MSC DAC2 hysteresis selection (_MSC_DAC2_HYST, indirect access via _MSC_IDXADD=0x0C) */
+    #define _MSC_DAC2_HYST_HYSTDN    ((uint8_t) (0x07 << 0))   ///< comparator hysteresis on falling signals [2:0]
+    #define _MSC_DAC2_HYST_HYSTDN0   ((uint8_t) (0x01 << 0))   ///< comparator hysteresis on falling signals [0]
+    #define _MSC_DAC2_HYST_HYSTDN1   ((uint8_t) (0x01 << 1))   ///< comparator hysteresis on falling signals [1]
+    #define _MSC_DAC2_HYST_HYSTDN2   ((uint8_t) (0x01 << 2))   ///< comparator hysteresis on falling signals [2]
+    // reserved [3]
+    #define _MSC_DAC2_HYST_HYSTUP    ((uint8_t) (0x07 << 4))   ///< comparator hysteresis on rising signals [2:0]
+    #define _MSC_DAC2_HYST_HYSTUP0   ((uint8_t) (0x01 << 4))   ///< comparator hysteresis on rising signals [0]
+    #define _MSC_DAC2_HYST_HYSTUP1   ((uint8_t) (0x01 << 5))   ///< comparator hysteresis on rising signals [1]
+    #define _MSC_DAC2_HYST_HYSTUP2   ((uint8_t) (0x01 << 6))   ///< comparator hysteresis on rising signals [2]
+    // reserved [7]
+
+    /* MSC DAC3 hysteresis selection (_MSC_DAC3_HYST, indirect access via _MSC_IDXADD=0x0D) */
+    #define _MSC_DAC3_HYST_HYSTDN    ((uint8_t) (0x07 << 0))   ///< comparator hysteresis on falling signals [2:0]
+    #define _MSC_DAC3_HYST_HYSTDN0   ((uint8_t) (0x01 << 0))   ///< comparator hysteresis on falling signals [0]
+    #define _MSC_DAC3_HYST_HYSTDN1   ((uint8_t) (0x01 << 1))   ///< comparator hysteresis on falling signals [1]
+    #define _MSC_DAC3_HYST_HYSTDN2   ((uint8_t) (0x01 << 2))   ///< comparator hysteresis on falling signals [2]
+    // reserved [3]
+    #define _MSC_DAC3_HYST_HYSTUP    ((uint8_t) (0x07 << 4))   ///< comparator hysteresis on rising signals [2:0]
+    #define _MSC_DAC3_HYST_HYSTUP0   ((uint8_t) (0x01 << 4))   ///< comparator hysteresis on rising signals [0]
+    #define _MSC_DAC3_HYST_HYSTUP1   ((uint8_t) (0x01 << 5))   ///< comparator hysteresis on rising signals [1]
+    #define _MSC_DAC3_HYST_HYSTUP2   ((uint8_t) (0x01 << 6))   ///< comparator hysteresis on rising signals [2]
+    // reserved [7]
+
+  #endif // STNRG
+
+  /* MSC P3-0 control register input line (CMP0) (_MSC_CFGP30, indirect access via _MSC_IDXADD=0x0E) */
+  #define _MSC_CFGP30_INT_LEV      ((uint8_t) (0x01 << 0))   ///< interrupt request active level [0]
+  #define _MSC_CFGP30_INT_SEL      ((uint8_t) (0x03 << 1))   ///< interrupt source configuration [1:0]
+  #define _MSC_CFGP30_INT_SEL0     ((uint8_t) (0x01 << 1))   ///< interrupt source configuration [0]
+  #define _MSC_CFGP30_INT_SEL1     ((uint8_t) (0x01 << 2))   ///< interrupt source configuration [1]
+  #define _MSC_CFGP30_INT_ENB      ((uint8_t) (0x01 << 3))   ///< interrupt enable [0]
+  #define _MSC_CFGP30_INT_MSK      ((uint8_t) (0x01 << 4))   ///< interrupt mask enable for polling [0]
+  // reserved [7:5]
+
+  /* MSC P3-1 control register input line (CMP1) (_MSC_CFGP31, indirect access via _MSC_IDXADD=0x0F) */
+  #define _MSC_CFGP31_INT_LEV      ((uint8_t) (0x01 << 0))   ///< interrupt request active level [0]
+  #define _MSC_CFGP31_INT_SEL      ((uint8_t) (0x03 << 1))   ///< interrupt source configuration [1:0]
+  #define _MSC_CFGP31_INT_SEL0     ((uint8_t) (0x01 << 1))   ///< interrupt source configuration [0]
+  #define _MSC_CFGP31_INT_SEL1     ((uint8_t) (0x01 << 2))   ///< interrupt source configuration [1]
+  #define _MSC_CFGP31_INT_ENB      ((uint8_t) (0x01 << 3))   ///< interrupt enable [0]
+  #define _MSC_CFGP31_INT_MSK      ((uint8_t) (0x01 << 4))   ///< interrupt mask enable for polling [0]
+  // reserved [7:5]
+
+  /* MSC P3-2 control register input line (CMP2) (_MSC_CFGP32, indirect access via _MSC_IDXADD=0x10) */
+  #define _MSC_CFGP32_INT_LEV      ((uint8_t) (0x01 << 0))   ///< interrupt request active level [0]
+  #define _MSC_CFGP32_INT_SEL      ((uint8_t) (0x03 << 1))   ///< interrupt source configuration [1:0]
+  #define _MSC_CFGP32_INT_SEL0     ((uint8_t) (0x01 << 1))   ///< interrupt source configuration [0]
+  #define _MSC_CFGP32_INT_SEL1     ((uint8_t) (0x01 << 2))   ///< interrupt source configuration [1]
+  #define _MSC_CFGP32_INT_ENB      ((uint8_t) (0x01 << 3))   ///< interrupt enable [0]
+  #define _MSC_CFGP32_INT_MSK      ((uint8_t) (0x01 << 4))   ///< interrupt mask enable for polling [0]
+  // reserved [7:5]
+
+  /* MSC P3-3 control register input line (CMP3) (_MSC_CFGP33, indirect access via _MSC_IDXADD=0x11) */
+  #define _MSC_CFGP33_INT_LEV      ((uint8_t) (0x01 << 0))   ///< interrupt request active level [0]
+  #define _MSC_CFGP33_INT_SEL      ((uint8_t) (0x03 << 1))   ///< interrupt source configuration [1:0]
+  #define _MSC_CFGP33_INT_SEL0     ((uint8_t) (0x01 << 1))   ///< interrupt source configuration [0]
+  #define _MSC_CFGP33_INT_SEL1     ((uint8_t) (0x01 << 2))   ///< interrupt source configuration [1]
+  #define _MSC_CFGP33_INT_ENB      ((uint8_t) (0x01 << 3))   ///< interrupt enable [0]
+  #define _MSC_CFGP33_INT_MSK      ((uint8_t) (0x01 << 4))   ///< interrupt mask enable for polling [0]
+  // reserved [7:5]
+
+  /* MSC Port 3 status register (CMP) (_MSC_STSP3, indirect access via _MSC_IDXADD=0x12) */
+  #define _MSC_STSP3_INT_0         ((uint8_t) (0x01 << 0))   ///< interrupt pending for port3[0] [0]
+  #define _MSC_STSP3_INT_1         ((uint8_t) (0x01 << 1))   ///< interrupt pending for port3[1] [0]
+  #define _MSC_STSP3_INT_2         ((uint8_t) (0x01 << 2))   ///< interrupt pending for port3[2] [0]
+  #define _MSC_STSP3_INT_3         ((uint8_t) (0x01 << 3))   ///< interrupt pending for port3[3] [0]
+  // reserved [7:4]
+
 #endif // MSC_AddressBase
 
 
@@ -2829,12 +2947,12 @@ input mo
 
   /* DALI Status and control register (_DALI_CSR) */
   // reserved [1:0]
-  #define _DALI_CSR_WDGF               ((uint8_t) (0x01 << 0))   ///< DALI watchdog receiver line interrupt status flag [0]
-  #define _DALI_CSR_WDGE               ((uint8_t) (0x01 << 0))   ///< DALI watchdog receiver line interrupt enable [0]
-  #define _DALI_CSR_RTF                ((uint8_t) (0x01 << 0))   ///< DALI receive/transmit flag [0]
-  #define _DALI_CSR_EF                 ((uint8_t) (0x01 << 0))   ///< DALI error flag [0]
-  #define _DALI_CSR_ITF                ((uint8_t) (0x01 << 0))   ///< DALI interrupt flag [0]
-  #define _DALI_CSR_IEN                ((uint8_t) (0x01 << 0))   ///< DALI interrupt enable [0]
+  #define _DALI_CSR_WDGF               ((uint8_t) (0x01 << 2))   ///< DALI watchdog receiver line interrupt status flag [0]
+  #define _DALI_CSR_WDGE               ((uint8_t) (0x01 << 3))   ///< DALI watchdog receiver line interrupt enable [0]
+  #define _DALI_CSR_RTF                ((uint8_t) (0x01 << 4))   ///< DALI receive/transmit flag [0]
+  #define _DALI_CSR_EF                 ((uint8_t) (0x01 << 5))   ///< DALI error flag [0]
+  #define _DALI_CSR_ITF                ((uint8_t) (0x01 << 6))   ///< DALI interrupt flag [0]
+  #define _DALI_CSR_IEN                ((uint8_t) (0x01 << 7))   ///< DALI interrupt enable [0]
 
   /* DALI Status register 1 (_DALI_CSR1) */
   #define _DALI_CSR1_WDG_PRSC          ((uint8_t) (0x07 << 0))   ///< DALI watchdog DALI prescaler timer [2:0]
@@ -45,6 +45,8 @@
   #define SDCC_VERSION (__SDCC_VERSION_MAJOR * 10000 \
                       + __SDCC_VERSION_MINOR * 100 \
                       + __SDCC_VERSION_PATCH)
+#elif defined(STM8_HOST)
+  #define _HOST_
 #else
   #error in 'STM8AF_STM8S.h': compiler not supported
 #endif
@@ -148,6 +150,8 @@
   #define TRIGGER_TRAP           __trap()                             ///< trigger a trap (=soft interrupt) e.g. for EMC robustness (see AN1015)
   #define WAIT_FOR_INTERRUPT()   __wait_for_interrupt()               ///< stop code execution and wait for interrupt
   #define ENTER_HALT()           __halt()                             ///< put controller to HALT mode
+  #define SAVE_AND_DISABLE_INTERRUPTS(cc) do { cc = __get_interrupt_state(); __disable_interrupt(); } while (0)   ///< save interrupt state to uint8_t variable cc, then disable interrupts
+  #define RESTORE_INTERRUPTS(cc) __set_interrupt_state(cc)           ///< restore interrupt state from variable cc
   #define SW_RESET()             (_WWDG_CR = _WWDG_CR_WDGA)           ///< reset controller via WWDG module
 
   // data type in bit fields
@@ -171,11 +175,49 @@
   #define TRIGGER_TRAP           __asm__("trap")                      ///< trigger a trap (=soft interrupt) e.g. for EMC robustness (see AN1015)
   #define WAIT_FOR_INTERRUPT()   __asm__("wfi")                       ///< stop code execution and wait for interrupt
   #define ENTER_HALT()           __asm__("halt")                      ///< put controller to HALT mode
+  #define SAVE_AND_DISABLE_INTERRUPTS(cc) __asm__("push a\n push cc\n pop a\n sim\n ld _" #cc ", a\n pop a")   ///< save interrupt state to global/static uint8_t variable cc, then disable interrupts
+  #define RESTORE_INTERRUPTS(cc) __asm__("push a\n ld a, _" #cc "\n push a\n pop cc\n pop a")   ///< restore interrupt state from variable cc
   #define SW_RESET()             (_WWDG_CR = _WWDG_CR_WDGA)           ///< reset controller via WWDG module
 
   // data type in bit fields
   #define _BITS                  unsigned int                         ///< data type in bit structs (follow C90 standard)
 
+// host compiler (gcc/clang) with register simulator for unit tests (see host/host.h)
+#elif defined(_HOST_)
+
+  // simulator functions, see host/host.c
+  extern unsigned char  *stm8_host_mem;
+  void stm8_host_isr(unsigned char irq, void (*func)(void));
+  void stm8_host_nop(void);
+  void stm8_host_sim(void);
+  void stm8_host_rim(void);
+  unsigned char stm8_host_save_sim(void);
+  void stm8_host_restore(unsigned char state);
+  void stm8_host_wfi(void);
+  void stm8_host_trap(void);
+
+  // macros to unify ISR declaration and implementation. ISRs are registered in simulator before main()
+  #define _HOST_CAT2(a,b)        a##b
+  #define _HOST_CAT(a,b)         _HOST_CAT2(a,b)
+  #define ISR_HANDLER(func,irq)  void func(void) __attribute__((weak)); \
+                                 static void __attribute__((constructor)) _HOST_CAT(func##_reg, __LINE__)(void) { stm8_host_isr(irq, func); } \
+                                 void func(void)                      ///< handler for interrupt service routine
+  #define ISR_HANDLER_TRAP(func) void func(void)                      ///< handler for trap service routine
+
+  // common assembler instructions are simulated
+  #define NOP()                  stm8_host_nop()                      ///< perform a nop() operation (=minimum delay)
+  #define DISABLE_INTERRUPTS()   stm8_host_sim()                      ///< disable interrupt handling
+  #define ENABLE_INTERRUPTS()    stm8_host_rim()                      ///< enable interrupt handling
+  #define TRIGGER_TRAP           stm8_host_trap()                     ///< trigger a trap (=soft interrupt) e.g. for EMC robustness (see AN1015)
+  #define WAIT_FOR_INTERRUPT()   stm8_host_wfi()                      ///< stop code execution and wait for interrupt
+  #define ENTER_HALT()           stm8_host_wfi()                      ///< put controller to HALT mode
+  #define SAVE_AND_DISABLE_INTERRUPTS(cc) ((cc) = stm8_host_save_sim())   ///< save interrupt state to variable cc, then disable interrupts
+  #define RESTORE_INTERRUPTS(cc) stm8_host_restore(cc)                ///< restore interrupt state from variable cc
+  #define SW_RESET()             (_WWDG_CR = _WWDG_CR_WDGA)           ///< reset controller via WWDG module
+
+  // data type in bit fields
+  #define _BITS                  unsigned char                        ///< data type in bit structs (1B per register)
+
 #endif
 
 
@@ -184,7 +226,11 @@
 -----------------------------------------------------------------------------*/
 
 // general macros
-#define _SFR(type, addr)       (*((volatile type*) (addr)))           ///< peripheral register
+#if defined(_HOST_)
+  #define _SFR(type, addr)     (*((volatile type*) (stm8_host_mem + (addr))))   ///< peripheral register in simulated address space
+#else
+  #define _SFR(type, addr)     (*((volatile type*) (addr)))           ///< peripheral register
+#endif
 #if defined(_DOXYGEN) || defined(UID_AddressBase)
   #define _UID(N)              _SFR(uint8_t,  UID_AddressBase+N)      ///< read unique identifier byte N
 #endif
@@ -232,7 +278,7 @@
 
   #endif // INT8_MAX
 
-#elif defined(_SDCC_)
+#elif defined(_SDCC_) || defined(_HOST_)
 
   // use compiler header
   #include <stdint.h>
@@ -240,6 +286,27 @@
 #endif
 
 
+/*-----------------------------------------------------------------------------
+    OPTIONAL TRACED REGISTER ACCESS
+    Define STM8_TRACE and link a recorder, e.g. examples/stm8af_stm8s/Register_Trace
+-----------------------------------------------------------------------------*/
+#if defined(STM8_TRACE)
+
+  // recorder functions, see Register_Trace/trace.c
+  uint8_t   stm8_trace_read(volatile uint8_t *reg);
+  void      stm8_trace_write(volatile uint8_t *reg, uint8_t value);
+
+  #define SFR_READ(reg)          stm8_trace_read(&(reg))              ///< read 8-bit register and record access
+  #define SFR_WRITE(reg, val)    stm8_trace_write(&(reg), (val))      ///< write 8-bit register and record access
+
+#else
+
+  #define SFR_READ(reg)          (reg)                                ///< read 8-bit register (recorded if STM8_TRACE is defined)
+  #define SFR_WRITE(reg, val)    ((reg) = (val))                      ///< write 8-bit register (recorded if STM8_TRACE is defined)
+
+#endif
+
+
 /*-----------------------------------------------------------------------------
     ISR Vector Table (SDCC, Raisonance, IAR)
     Note: IAR has an IRQ offset of +2 compared to STM8 datasheet (see below)
@@ -3148,7 +3215,7 @@
 
     /** @brief Reserved registers on selected devices (2B) */
     #if defined(STM8S103) || defined(STM8S003) || defined(STM8S001)
-      uint8_t      [2];
+      uint8_t res     [2];
     #endif
 
 
@@ -3874,7 +3941,7 @@
 
     /** @brief Reserved registers on selected devices (2B) */
     #if defined(STM8S103) || defined(STM8S003) || defined(STM8S001)
-      uint8_t      [2];
+      uint8_t res     [2];
     #endif
 
 
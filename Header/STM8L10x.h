@@ -103,6 +103,7 @@
   #define ENABLE_INTERRUPTS()    _asm("rim")                          ///< enable interrupt handling
   #define TRIGGER_TRAP           _asm("trap")                         ///< trigger a trap (=soft interrupt) e.g. for EMC robustness (see AN1015)
   #define WAIT_FOR_INTERRUPT()   _asm("wfi")                          ///< stop code execution and wait for interrupt
+  #define WAIT_FOR_EVENT()       _asm("wfe")                          ///< stop code execution and wait for event (no ISR call)
   #define ENTER_HALT()           _asm("halt")                         ///< put controller to HALT mode
   #define SW_RESET()             (_IWDG_KR = _IWDG_KR_KEY_ENABLE)     ///< reset controller via IWDG module (WWDG not implemented)
 
@@ -125,6 +126,7 @@
   #define ENABLE_INTERRUPTS()    _rim_()                              ///< enable interrupt handling
   #define TRIGGER_TRAP           _trap_()                             ///< trigger a trap (=soft interrupt) e.g. for EMC robustness (see AN1015)
   #define WAIT_FOR_INTERRUPT()   _wfi_()                              ///< stop code execution and wait for interrupt
+  #define WAIT_FOR_EVENT()       _wfe_()                              ///< stop code execution and wait for event (no ISR call)
   #define ENTER_HALT()           _halt_()                             ///< put controller to HALT mode
   #define SW_RESET()             (_IWDG_KR = _IWDG_KR_KEY_ENABLE)     ///< reset controller via IWDG module (WWDG not implemented)
 
@@ -147,7 +149,10 @@
   #define ENABLE_INTERRUPTS()    __enable_interrupt()                 ///< enable interrupt handling
   #define TRIGGER_TRAP           __trap()                             ///< trigger a trap (=soft interrupt) e.g. for EMC robustness (see AN1015)
   #define WAIT_FOR_INTERRUPT()   __wait_for_interrupt()               ///< stop code execution and wait for interrupt
+  #define WAIT_FOR_EVENT()       __wait_for_event()                   ///< stop code execution and wait for event (no ISR call)
   #define ENTER_HALT()           __halt()                             ///< put controller to HALT mode
+  #define SAVE_AND_DISABLE_INTERRUPTS(cc) do { cc = __get_interrupt_state(); __disable_interrupt(); } while (0)   ///< save interrupt state to uint8_t variable cc, then disable interrupts
+  #define RESTORE_INTERRUPTS(cc) __set_interrupt_state(cc)           ///< restore interrupt state from variable cc
   #define SW_RESET()             (_IWDG_KR = _IWDG_KR_KEY_ENABLE)     ///< reset controller via IWDG module (WWDG not implemented)
 
   // data type in bit fields
@@ -170,7 +175,10 @@
   #define ENABLE_INTERRUPTS()    __asm__("rim")                       ///< enable interrupt handling
   #define TRIGGER_TRAP           __asm__("trap")                      ///< trigger a trap (=soft interrupt) e.g. for EMC robustness (see AN1015)
   #define WAIT_FOR_INTERRUPT()   __asm__("wfi")                       ///< stop code execution and wait for interrupt
+  #define WAIT_FOR_EVENT()       __asm__("wfe")                       ///< stop code execution and wait for event (no ISR call)
   #define ENTER_HALT()           __asm__("halt")                      ///< put controller to HALT mode
+  #define SAVE_AND_DISABLE_INTERRUPTS(cc) __asm__("push a\n push cc\n pop a\n sim\n ld _" #cc ", a\n pop a")   ///< save interrupt state to global/static uint8_t variable cc, then disable interrupts
+  #define RESTORE_INTERRUPTS(cc) __asm__("push a\n ld a, _" #cc "\n push a\n pop cc\n pop a")   ///< restore interrupt state from variable cc
   #define SW_RESET()             (_IWDG_KR = _IWDG_KR_KEY_ENABLE)     ///< reset controller via IWDG module (WWDG not implemented)
 
   // data type in bit fields
@@ -2463,8 +2471,8 @@
   #define _COMP_CR_COMPREF             ((uint8_t) (0x01 << 3))   ///< COMP Comparator reference [0]
   #define _COMP_CR_POL                 ((uint8_t) (0x01 << 4))   ///< COMP Comparator polarity [0]
   #define _COMP_CR_CNF_TIM             ((uint8_t) (0x03 << 5))   ///< COMP Comparator 1/2 output connected to TIM2/3 capture or break [1:0]
-  #define _COMP_CR_CNF_TIM0            ((uint8_t) (0x03 << 5))   ///< COMP Comparator 1/2 output connected to TIM2/3 capture or break [0]
-  #define _COMP_CR_CNF_TIM1            ((uint8_t) (0x03 << 6))   ///< COMP Comparator 1/2 output connected to TIM2/3 capture or break [1]
+  #define _COMP_CR_CNF_TIM0            ((uint8_t) (0x01 << 5))   ///< COMP Comparator 1/2 output connected to TIM2/3 capture or break [0]
+  #define _COMP_CR_CNF_TIM1            ((uint8_t) (0x01 << 6))   ///< COMP Comparator 1/2 output connected to TIM2/3 capture or break [1]
   #define _COMP_CR_IC1_BK              ((uint8_t) (0x01 << 7))   ///< COMP Input capture 1 / break selection [0]
 
   /* Comparator control status register (_COMP_CSR) */
@@ -148,6 +148,8 @@
   #define TRIGGER_TRAP           __trap()                             ///< trigger a trap (=soft interrupt) e.g. for EMC robustness (see AN1015)
   #define WAIT_FOR_INTERRUPT()   __wait_for_interrupt()               ///< stop code execution and wait for interrupt
   #define ENTER_HALT()           __halt()                             ///< put controller to HALT mode
+  #define SAVE_AND_DISABLE_INTERRUPTS(cc) do { cc = __get_interrupt_state(); __disable_interrupt(); } while (0)   ///< save interrupt state to uint8_t variable cc, then disable interrupts
+  #define RESTORE_INTERRUPTS(cc) __set_interrupt_state(cc)           ///< restore interrupt state from variable cc
   #define SW_RESET()             (_WWDG_CR = _WWDG_CR_WDGA)           ///< reset controller via WWDG module
 
   // data type in bit fields
@@ -171,6 +173,8 @@
   #define TRIGGER_TRAP           __asm__("trap")                      ///< trigger a trap (=soft interrupt) e.g. for EMC robustness (see AN1015)
   #define WAIT_FOR_INTERRUPT()   __asm__("wfi")                       ///< stop code execution and wait for interrupt
   #define ENTER_HALT()           __asm__("halt")                      ///< put controller to HALT mode
+  #define SAVE_AND_DISABLE_INTERRUPTS(cc) __asm__("push a\n push cc\n pop a\n sim\n ld _" #cc ", a\n pop a")   ///< save interrupt state to global/static uint8_t variable cc, then disable interrupts
+  #define RESTORE_INTERRUPTS(cc) __asm__("push a\n ld a, _" #cc "\n push a\n pop cc\n pop a")   ///< restore interrupt state from variable cc
   #define SW_RESET()             (_WWDG_CR = _WWDG_CR_WDGA)           ///< reset controller via WWDG module
 
   // data type in bit fields
@@ -3064,9 +3068,9 @@
   /* ProxSense Control Register 3 (_PXS_CR3) */
   #define _PXS_CR3_VTHR                ((uint8_t) (0x0F << 0))   ///< ProxSense Threshold voltage (Vthr) selection [3:0]
   #define _PXS_CR3_VTHR0               ((uint8_t) (0x01 << 0))   ///< ProxSense Threshold voltage (Vthr) selection [0]
-  #define _PXS_CR3_VTHR1               ((uint8_t) (0x01 << 0))   ///< ProxSense Threshold voltage (Vthr) selection [1]
-  #define _PXS_CR3_VTHR2               ((uint8_t) (0x01 << 0))   ///< ProxSense Threshold voltage (Vthr) selection [2]
-  #define _PXS_CR3_VTHR3               ((uint8_t) (0x01 << 0))   ///< ProxSense Threshold voltage (Vthr) selection [3]
+  #define _PXS_CR3_VTHR1               ((uint8_t) (0x01 << 1))   ///< ProxSense Threshold voltage (Vthr) selection [1]
+  #define _PXS_CR3_VTHR2               ((uint8_t) (0x01 << 2))   ///< ProxSense Threshold voltage (Vthr) selection [2]
+  #define _PXS_CR3_VTHR3               ((uint8_t) (0x01 << 3))   ///< ProxSense Threshold voltage (Vthr) selection [3]
   #define _PXS_CR3_BIAS                ((uint8_t) (0x03 << 4))   ///< ProxSense Sample and hold strength selection [1:0]
   #define _PXS_CR3_BIAS0               ((uint8_t) (0x01 << 4))   ///< ProxSense Sample and hold strength selection [0]
   #define _PXS_CR3_BIAS1               ((uint8_t) (0x01 << 5))   ///< ProxSense Sample and hold strength selection [1]
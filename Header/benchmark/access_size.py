@@ -0,0 +1,199 @@
+#!/usr/bin/python3
+# -*- coding: utf-8 -*-
+'''
+  Code size and cycle table of the register access styles used in the STM8 examples,
+  i.e. byte access with bit masks, bitfield access and STM8 bit instructions. The
+  micro-benchmark in folder 'access_styles' is built with each compiler and flag set,
+  and bytes and cycles per function are read from the SDCC listings. Results are
+  compared against a reference file to detect regressions after header changes.
+
+  Copyright (C) 2019 Georg Icking-Konert
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+  **notes**
+
+    - cycles are the sum over all instructions of a function as listed by the assembler.
+      This is exact for the benchmark functions, which contain no branches or loops
+    - bytes and cycles include the return instruction, but not the call
+    - function names are <operation>_<style>, e.g. 'toggle_bitfield'
+
+'''
+
+# import required modules
+import os, sys, csv
+import argparse
+import sdcc_build
+
+
+# print disclaimer
+print('')
+print(sys.argv[0] + ', a small utility to compare code size and cycles')
+print('of STM8 register access styles.')
+print('')
+print('Copyright (C) 2019  Georg Icking-Konert')
+print('')
+print('This program comes with ABSOLUTELY NO WARRANTY!')
+print('This is free software, and you are welcome to redistribute it')
+print('under certain conditions; see source code for details.')
+print('')
+
+
+#-------------------------------------------------------------------
+# global settings
+#-------------------------------------------------------------------
+
+# directories relative to this script
+BASEDIR     = os.path.dirname(os.path.abspath(__file__))
+PROJECT     = os.path.join(BASEDIR, 'access_styles')
+
+# access styles in order of table columns
+STYLES      = ['byte', 'mask', 'bitfield', 'bitinstr']
+
+
+
+#-------------------------------------------------------------------
+# print table of one compiler and flag set
+#-------------------------------------------------------------------
+def printTable(functions):
+  """ Print table with operations as rows and access styles as columns.
+
+  :param functions:   dict {function: {'bytes', 'cycles'}} from listings
+
+  """
+
+  # sort functions into operation/style
+  table = {}
+  for name, data in functions.items():
+    op, _, style = name.rpartition('_')
+    if style in STYLES:
+      table.setdefault(op, {})[style] = data
+
+  # print table, entries are 'bytes/cycles'
+  print('    %-10s' % 'operation' + ''.join(['%12s' % style for style in STYLES]))
+  for op in sorted(table):
+    row = ''
+    for style in STYLES:
+      data = table[op].get(style)
+      row += '%12s' % ('%dB/%dcy' % (data['bytes'], data['cycles']) if data is not None else '-')
+    print('    %-10s' % op + row)
+  if 'empty' in functions:
+    print('    (empty function: %dB/%dcy)' % (functions['empty']['bytes'], functions['empty']['cycles']))
+  print('')
+
+
+
+#-------------------------------------------------------------------
+# compare with reference
+#-------------------------------------------------------------------
+def compareReference(results, refFile):
+  """ Compare results with reference file.
+
+  :param results:     list of rows [compiler, flagset, function, bytes, cycles]
+  :param refFile:     name of reference CSV file
+
+  :return:            number of functions which became larger or slower
+
+  """
+
+  # read reference, key is (compiler, flagset, function)
+  reference = {}
+  with open(refFile, newline='') as f:
+    for row in csv.DictReader(f):
+      reference[(row['compiler'], row['flagset'], row['function'])] = (int(row['bytes']), int(row['cycles']))
+
+  # compare and list changes
+  numWorse = 0
+  numCompared = 0
+  for compiler, flagset, func, size, cycles in results:
+    ref = reference.get((compiler, flagset, func))
+    if ref is None:
+      continue
+    numCompared += 1
+    if ref == (size, cycles):
+      continue
+    if (size > ref[0]) or (cycles > ref[1]):
+      status = 'REGRESSION'
+      numWorse += 1
+    else:
+      status = 'improved'
+    print('  %-10s %-12s %-16s %3dB/%3dcy -> %3dB/%3dcy  %s' % (compiler, flagset, func, ref[0], ref[1], size, cycles, status))
+
+  # e.g. other SDCC version than reference
+  if (numCompared == 0) and (len(results) > 0):
+    print('  warning: no reference data for these compilers and flag sets, nothing compared')
+
+  return numWorse
+
+
+
+#-------------------------------------------------------------------
+# main program
+#-------------------------------------------------------------------
+
+# commandline parameters with defaults
+parser = argparse.ArgumentParser(description="STM8 register access code size table")
+parser.add_argument('-c', '--cc',       type=str,   help='comma separated SDCC executables, e.g. for different versions', required=False, default=sdcc_build.SDCC)
+parser.add_argument('-f', '--flagsets', type=str,   help='comma separated flag sets (%s)' % ','.join(sdcc_build.FLAGSETS), required=False, default=','.join(sdcc_build.FLAGSETS))
+parser.add_argument('-r', '--ref',      type=str,   help='reference CSV file',       required=False, default=os.path.join(BASEDIR, 'access_size_ref.csv'))
+parser.add_argument('-u', '--update',   action='store_true', help='store results as new reference')
+parser.add_argument('-o', '--out',      type=str,   help='output directory',         required=False, default=os.path.join(BASEDIR, 'results'))
+args = parser.parse_args()
+
+# loop over compilers and flag sets
+project = sdcc_build.Project(PROJECT)
+results = []
+numFail = 0
+for cc in args.cc.split(','):
+  compiler = sdcc_build.getCompilerVersion(cc)
+  for flagset in args.flagsets.split(','):
+    print('  %s, flags \'%s\' (%s):' % (compiler, flagset, ' '.join(sdcc_build.FLAGSETS[flagset])))
+
+    # build benchmark and read listings
+    buildDir = os.path.join(BASEDIR, 'build', 'size', compiler, flagset)
+    if sdcc_build.buildProject(project, sdcc_build.FLAGSETS[flagset], buildDir, cc) is None:
+      print('    build failed, see %s\n' % os.path.join(buildDir, 'build.log'))
+      numFail += 1
+      continue
+    functions = {name: data for name, data in sdcc_build.readListings(buildDir).items() if name != 'main'}
+    printTable(functions)
+
+    for name in sorted(functions):
+      results.append([compiler, flagset, name, functions[name]['bytes'], functions[name]['cycles']])
+
+# export results
+os.makedirs(args.out, exist_ok=True)
+outFile = os.path.join(args.out, 'access_size.csv')
+for fileName in [outFile] + ([args.ref] if args.update else []):
+  with open(fileName, 'w', newline='') as f:
+    writer = csv.writer(f)
+    writer.writerow(['compiler', 'flagset', 'function', 'bytes', 'cycles'])
+    writer.writerows(results)
+print('  results stored in %s' % outFile)
+if args.update:
+  print('  reference updated in %s' % args.ref)
+
+# compare with reference. Return error on regression or build failure
+numWorse = 0
+if (not args.update) and os.path.exists(args.ref):
+  print('  changes vs. reference %s:' % args.ref)
+  numWorse = compareReference(results, args.ref)
+  print('  %d regression(s)' % numWorse)
+elif not args.update:
+  print('  warning: reference %s not found, regression check skipped. Create it with -u' % args.ref)
+print('')
+sys.exit(1 if (numWorse > 0) or (numFail > 0) else 0)
+
+# end of program
@@ -0,0 +1,144 @@
+/**********************
+  Micro-benchmark for register access styles of the STM8 headers.
+  Each access is wrapped in a separate, non-inlined function, which is
+  timed on the ucsim simulator by ../ucsim_benchmark.py.
+
+  Compared access styles:
+  - byte access with bit mask, e.g. _PORTC_ODR |= _PORT_PIN5
+  - bitfield access via struct, e.g. _PORTC.ODR.PIN5 = 1
+  - explicit STM8 bit instruction via inline assembler (SDCC only)
+
+  Functionality:
+  - init FCPU to 16MHz
+  - call all benchmark functions in an endless loop
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// convert address to string for inline assembler
+#define _STR(x)     #x
+#define STR(x)      _STR(x)
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// store read values to prevent optimization
+volatile uint8_t  g_sink;
+
+
+/*----------------------------------------------------------
+    BENCHMARK FUNCTIONS
+----------------------------------------------------------*/
+
+// reference: call overhead only
+void empty(void) {
+}
+
+// set pin
+void set_byte(void) {
+  _PORTC_ODR |= _PORT_PIN5;
+}
+void set_bitfield(void) {
+  _PORTC.ODR.PIN5 = 1;
+}
+void set_bitinstr(void) {
+  #if defined(_SDCC_)
+    __asm__("bset " STR(PORTC_AddressBase) ", #5");
+  #else
+    _PORTC_ODR |= _PORT_PIN5;
+  #endif
+}
+
+// clear pin
+void clr_byte(void) {
+  _PORTC_ODR &= ~_PORT_PIN5;
+}
+void clr_bitfield(void) {
+  _PORTC.ODR.PIN5 = 0;
+}
+void clr_bitinstr(void) {
+  #if defined(_SDCC_)
+    __asm__("bres " STR(PORTC_AddressBase) ", #5");
+  #else
+    _PORTC_ODR &= ~_PORT_PIN5;
+  #endif
+}
+
+// toggle pin
+void toggle_byte(void) {
+  _PORTC_ODR ^= _PORT_PIN5;
+}
+void toggle_bitfield(void) {
+  _PORTC.ODR.PIN5 ^= 1;
+}
+void toggle_bitinstr(void) {
+  #if defined(_SDCC_)
+    __asm__("bcpl " STR(PORTC_AddressBase) ", #5");
+  #else
+    _PORTC_ODR ^= _PORT_PIN5;
+  #endif
+}
+
+// read pin
+void read_byte(void) {
+  g_sink = (_PORTC_IDR & _PORT_PIN5) ? 1 : 0;
+}
+void read_bitfield(void) {
+  g_sink = _PORTC.IDR.PIN5;
+}
+
+// clear clock dividers (multi-bit fields)
+void ckdiv_byte(void) {
+  _CLK_CKDIVR = 0x00;
+}
+void ckdiv_mask(void) {
+  _CLK_CKDIVR &= ~(_CLK_CKDIVR_CPUDIV | _CLK_CKDIVR_HSIDIV);
+}
+void ckdiv_bitfield(void) {
+  _CLK.CKDIVR.CPUDIV = 0;
+  _CLK.CKDIVR.HSIDIV = 0;
+}
+
+
+/*----------------------------------------------------------
+    MAIN FUNCTION
+----------------------------------------------------------*/
+void main (void) {
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // configure PC5 as push-pull output
+  _PORTC_DDR |= _PORT_PIN5;
+  _PORTC_CR1 |= _PORT_PIN5;
+
+  // main loop
+  while(1) {
+    empty();
+    set_byte();
+    set_bitfield();
+    set_bitinstr();
+    clr_byte();
+    clr_bitfield();
+    clr_bitinstr();
+    toggle_byte();
+    toggle_bitfield();
+    toggle_bitinstr();
+    read_byte();
+    read_bitfield();
+    ckdiv_byte();
+    ckdiv_mask();
+    ckdiv_bitfield();
+  } // main loop
+
+} // main
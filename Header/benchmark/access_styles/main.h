@@ -0,0 +1,24 @@
+/**
+  \file main.h
+
+  \brief device selection for register access benchmark
+
+  Device only affects addresses, i.e. timing is identical for all STM8S/STM8AF.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _MAIN_H_
+#define _MAIN_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "STM8S105K6.h"
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _MAIN_H_
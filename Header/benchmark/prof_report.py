@@ -0,0 +1,230 @@
+#!/usr/bin/python3
+# -*- coding: utf-8 -*-
+'''
+  Evaluate a profiler dump recorded on target via PROF_ENTER()/PROF_EXIT() (see
+  example project 'Profiler'). Nested sections are reconstructed from the event
+  stream, and inclusive and exclusive CPU cycles per section ID are reported as
+  table, optionally with a histogram of the inclusive cycles.
+
+  Copyright (C) 2019 Georg Icking-Konert
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+  **notes**
+
+    - dump format (little endian):
+        header:  'SPRF', timer [kHz] (2B), CPU [kHz] (2B), overhead [ticks] (2B), number of events (2B)
+        event:   timestamp (2B), tag (bit 7 = exit)
+    - inclusive cycles are corrected by the measured overhead of an empty section. Exclusive
+      cycles additionally exclude nested sections incl. their instrumentation, e.g. ISRs
+    - the ring buffer may start or end inside a section. Events without partner are skipped
+    - timestamps wrap after 65536 timer ticks, i.e. the time between two events must be shorter
+
+'''
+
+# import required modules
+import os, sys, re
+import struct
+import argparse
+
+
+# print disclaimer
+print('')
+print(sys.argv[0] + ', a small utility to evaluate STM8 profiler dumps.')
+print('')
+print('Copyright (C) 2019  Georg Icking-Konert')
+print('')
+print('This program comes with ABSOLUTELY NO WARRANTY!')
+print('This is free software, and you are welcome to redistribute it')
+print('under certain conditions; see source code for details.')
+print('')
+
+
+#-------------------------------------------------------------------
+# global settings
+#-------------------------------------------------------------------
+
+# dump file identifier and exit flag in tag
+MAGIC       = b'SPRF'
+EXIT_FLAG   = 0x80
+
+# width of histogram bars
+BAR_WIDTH   = 40
+
+
+
+#-------------------------------------------------------------------
+# read section names from header
+#-------------------------------------------------------------------
+def readNames(files):
+  """ Get section names from '#define PROF_ID_<name> <id>' lines.
+
+  :param files:   list of C headers
+
+  :return: dict {id: name}
+
+  """
+
+  names = {}
+  for name in files:
+    with open(name, 'r') as fp:
+      for line in fp:
+        match = re.match(r'\s*#define\s+PROF_ID_(\w+)\s+(\d+)', line)
+        if match and (match.group(1) != 'MAX'):
+          names[int(match.group(2))] = match.group(1)
+  return names
+
+
+
+#-------------------------------------------------------------------
+# read dump file
+#-------------------------------------------------------------------
+def readDump(filename):
+  """ Read dump and unwrap timestamps.
+
+  :param filename:   name of binary dump
+
+  :return: (timer frequency [kHz], CPU frequency [kHz], overhead [ticks], list of (time, id, isExit))
+
+  """
+
+  with open(filename, 'rb') as fp:
+    data = fp.read()
+  if (len(data) < 12) or (data[0:4] != MAGIC):
+    sys.exit('error: ' + filename + ' is no profiler dump')
+  freqTim, freqCpu, overhead, count = struct.unpack('<HHHH', data[4:12])
+  if (freqTim == 0) or (freqCpu == 0):
+    sys.exit('error: invalid dump header')
+  if len(data) < 12 + 3*count:
+    print('warning: dump truncated after ' + str((len(data) - 12) // 3) + ' events')
+    count = (len(data) - 12) // 3
+
+  events = []
+  time, last = 0, None
+  for i in range(count):
+    stamp, tag = struct.unpack('<HB', data[12 + 3*i : 15 + 3*i])
+    if last is not None:
+      time += (stamp - last) & 0xFFFF
+    last = stamp
+    events.append((time, tag & ~EXIT_FLAG, bool(tag & EXIT_FLAG)))
+
+  return freqTim, freqCpu, overhead, events
+
+
+
+#-------------------------------------------------------------------
+# reconstruct sections
+#-------------------------------------------------------------------
+def evalSections(events, overhead):
+  """ Match enter and exit events and calculate cycles per section.
+
+  :param events:     list of (time, id, isExit)
+  :param overhead:   ticks of an empty section
+
+  :return: (dict {id: list of (inclusive, exclusive) ticks}, number of skipped events)
+
+  """
+
+  stack   = []        # open sections: [id, start time, ticks of nested sections]
+  result  = {}
+  skipped = 0
+
+  for time, id, isExit in events:
+
+    # enter: open section
+    if not isExit:
+      stack.append([id, time, 0])
+      continue
+
+    # exit without enter (lost in ring buffer) -> skip
+    if id not in [s[0] for s in stack]:
+      skipped += 1
+      continue
+
+    # close section. Drop open sections without exit (lost due to wrong nesting)
+    while stack[-1][0] != id:
+      stack.pop()
+      skipped += 1
+    sid, start, nested = stack.pop()
+    incl = max(time - start - overhead, 0)
+    excl = max(incl - nested, 0)
+    result.setdefault(id, []).append((incl, excl))
+
+    # parent also spends the instrumentation of the nested section, i.e. 2 events
+    if stack:
+      stack[-1][2] += incl + 2*overhead
+
+  skipped += len(stack)
+  return result, skipped
+
+
+
+#-------------------------------------------------------------------
+# print histogram
+#-------------------------------------------------------------------
+def printHistogram(values):
+  """ Print histogram of cycles with power of 2 bins.
+
+  :param values:   list of cycles
+
+  """
+
+  bins = {}
+  for value in values:
+    bin = max(int(value), 1).bit_length() - 1
+    bins[bin] = bins.get(bin, 0) + 1
+  peak = max(bins.values())
+  for bin in range(min(bins), max(bins) + 1):
+    num = bins.get(bin, 0)
+    print('    %7d..%-7d %6d  %s' % (1 << bin, (2 << bin) - 1, num, '#' * ((num * BAR_WIDTH + peak - 1) // peak)))
+
+
+
+#-------------------------------------------------------------------
+# main program
+#-------------------------------------------------------------------
+if __name__ == '__main__':
+
+  # commandline parameters
+  parser = argparse.ArgumentParser(description='evaluate STM8 profiler dump')
+  parser.add_argument('dump', help='binary dump from prof_dump()')
+  parser.add_argument('-i', '--include', action='append', default=[], help='header with PROF_ID_<name> definitions (multiple allowed)')
+  parser.add_argument('-H', '--hist', action='store_true', help='print histogram of inclusive cycles')
+  args = parser.parse_args()
+
+  # read input
+  names = readNames(args.include)
+  freqTim, freqCpu, overhead, events = readDump(args.dump)
+  sections, skipped = evalSections(events, overhead)
+  scale = freqCpu / freqTim
+  if not sections:
+    sys.exit('error: no complete section in dump')
+
+  # total time of dump for load calculation
+  total = events[-1][0] - events[0][0]
+  print('events: ' + str(len(events)) + ', skipped: ' + str(skipped) + ', duration: ' + str(int(total * scale)) + ' cycles, overhead: ' + str(int(overhead * scale)) + ' cycles')
+  print('')
+
+  # table, sorted by exclusive time
+  print('  id  name                 calls   incl min   incl avg   incl max   excl avg   excl sum   load')
+  for id in sorted(sections, key=lambda i: -sum(e for _, e in sections[i])):
+    incl = [i * scale for i, _ in sections[id]]
+    excl = [e * scale for _, e in sections[id]]
+    load = (100.0 * sum(excl) / (total * scale)) if total else 0.0
+    print('%4d  %-18s %7d %10d %10d %10d %10d %10d %5.1f%%' % (id, names.get(id, '-'), len(incl), min(incl), sum(incl) / len(incl),
+      max(incl), sum(excl) / len(excl), sum(excl), load))
+    if args.hist:
+      printHistogram(incl)
+      print('')
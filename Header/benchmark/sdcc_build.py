@@ -0,0 +1,304 @@
+#!/usr/bin/python3
+# -*- coding: utf-8 -*-
+'''
+  Helper module to build STM8 example projects with SDCC using variable compiler
+  flags, and to extract symbol addresses and per-function code size and cycles
+  from the SDCC linker map (.map) and relocated listings (.rst).
+
+  Copyright (C) 2019 Georg Icking-Konert
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+  **references**
+
+    - `SDCC compiler <http://sdcc.sourceforge.net/>`_
+    - `PM0044 STM8 CPU programming manual <https://www.st.com/resource/en/programming_manual/cd00161709.pdf>`_
+
+'''
+
+# import required modules
+import os, re, glob
+import subprocess
+
+
+#-------------------------------------------------------------------
+# global settings
+#-------------------------------------------------------------------
+
+# compiler and fixed flags (as in example Makefiles)
+SDCC        = 'sdcc'
+CFLAGS      = ['--std-sdcc99', '-mstm8']
+LDFLAGS     = ['-lstm8', '-mstm8', '--out-fmt-ihx']
+
+# additional compiler flag sets for comparison
+FLAGSETS    = {
+  'default':  [],
+  'size':     ['--opt-code-size'],
+  'speed':    ['--opt-code-speed'],
+  'speed_ra': ['--opt-code-speed', '--max-allocs-per-node', '50000'],
+}
+
+# cycles of return instructions (PM0044), if not listed in .rst
+RET_CYCLES  = {'ret': 4, 'retf': 5, 'iret': 11}
+
+# .rst instruction line, e.g. '      008092 52 04            [ 2]  176 	sub	sp, #4'
+reRstInstr  = re.compile(r'^\s*([0-9A-Fa-f]{6})\s+((?:[0-9A-Fa-f]{2}\s)+)\s*\[\s*(\d+)\]\s+\d+\s+(\w+)')
+
+# .rst continuation line of long instruction, e.g. '      008096 00'
+reRstCont   = re.compile(r'^\s*([0-9A-Fa-f]{6})((?:\s[0-9A-Fa-f]{2})+)\s*$')
+
+# .rst function start, e.g. '                                    173 ;	 function main'
+reRstFunc   = re.compile(r'^\s+\d+\s+;\s+function\s+(\w+)')
+
+# .rst label, e.g. '      008092                        175 _main:'
+reRstLabel  = re.compile(r'^\s*([0-9A-Fa-f]{6})\s+\d+\s+(\w+):')
+
+# .map symbol, e.g. '     00008092  _main                              main'
+reMapSym    = re.compile(r'^\s+([0-9A-Fa-f]{8})\s+(_\w+)\s')
+
+
+#-------------------------------------------------------------------
+# STM8 project container
+#-------------------------------------------------------------------
+class Project:
+  """ Class describing an SDCC project, i.e. a directory with *.c files and a Makefile.
+
+  Include directory, shared driver directory (COMMONDIR) and defines are taken from
+  the project Makefile. Shared drivers are compiled with the project. The simulator
+  CPU type is derived from the device header included in main.h.
+
+  :param path:       directory of project
+
+  :return:           project object
+
+  """
+
+  #########
+  # constructor
+  #########
+  def __init__(self, path):
+
+    self.path     = os.path.abspath(path)
+    self.name     = os.path.basename(self.path)
+    self.sources  = sorted(glob.glob(os.path.join(self.path, '*.c')))
+    self.incDir   = os.path.join(self.path, '../../../stm8/stm8af_stm8s')
+    self.comDir   = None
+    self.defines  = []
+    self.device   = None
+
+    # get include directory and defines from Makefile
+    makefile = os.path.join(self.path, 'Makefile')
+    if os.path.exists(makefile):
+      for line in open(makefile):
+        match = re.match(r'^\s*INCLUDEDIR\s*=\s*(\S+)', line)
+        if match:
+          self.incDir = os.path.normpath(os.path.join(self.path, match.group(1)))
+        match = re.match(r'^\s*COMMONDIR\s*=\s*(\S+)', line)
+        if match:
+          self.comDir = os.path.normpath(os.path.join(self.path, match.group(1)))
+        match = re.match(r'^\s*DEFINES\s*=(.*)$', line)
+        if match:
+          self.defines = match.group(1).split()
+
+    # add shared drivers, which are compiled per project
+    if self.comDir is not None:
+      self.sources += sorted(glob.glob(os.path.join(self.comDir, '*.c')))
+
+    # get device from first device header included in main.h
+    mainh = os.path.join(self.path, 'main.h')
+    if os.path.exists(mainh):
+      match = re.search(r'#include\s+"(STM8\w+)\.h"', open(mainh).read())
+      if match:
+        self.device = match.group(1)
+
+
+  #########
+  # get ucsim CPU type
+  #########
+  def getSimType(self):
+    """ Get CPU type for ucsim (sstm8 -t) from device name.
+
+    :return:   ucsim CPU type, e.g. 'STM8S105'
+
+    """
+
+    if self.device is None:
+      return 'STM8S'
+    for prefix, simType in [('STM8S10[35]', None), ('STM8S00[13]', 'STM8S103'), ('STM8S903', 'STM8S103'),
+                            ('STM8S20[78]', 'STM8S208'), ('STM8S007', 'STM8S208'), ('STM8S005', 'STM8S105'),
+                            ('STM8AF', 'STM8AF'), ('STM8L10', 'STM8L101')]:
+      match = re.match(prefix, self.device)
+      if match:
+        return simType if simType is not None else match.group(0)
+    return 'STM8S'
+
+
+
+#-------------------------------------------------------------------
+# build project
+#-------------------------------------------------------------------
+def buildProject(project, flags, buildDir, cc=SDCC):
+  """ Compile and link project into build directory.
+
+  :param project:    Project object to build
+  :param flags:      list of additional compiler flags, e.g. ['--opt-code-size']
+  :param buildDir:   output directory for objects, listings and map file
+  :param cc:         SDCC executable, e.g. to compare compiler versions
+
+  :return:           name of .ihx file, or None on error. Compiler output is stored in buildDir/build.log
+
+  """
+
+  os.makedirs(buildDir, exist_ok=True)
+  log = open(os.path.join(buildDir, 'build.log'), 'w')
+  ihx = os.path.join(buildDir, project.name + '.ihx')
+  rels = []
+
+  # compile all sources
+  for src in project.sources:
+    rel = os.path.join(buildDir, os.path.splitext(os.path.basename(src))[0] + '.rel')
+    incs = ['-I' + project.incDir, '-I' + project.path] + ([] if project.comDir is None else ['-I' + project.comDir])
+    cmd = [cc] + CFLAGS + flags + project.defines + incs + ['-c', '-o', rel, src]
+    log.write(' '.join(cmd) + '\n')
+    try:
+      result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    except OSError as exc:
+      log.write('cannot execute compiler: ' + str(exc) + '\n')
+      log.close()
+      return None
+    log.write(result.stdout)
+    if result.returncode != 0:
+      log.close()
+      return None
+    rels.append(rel)
+
+  # link objects
+  cmd = [cc] + LDFLAGS + flags + rels + ['-o', ihx]
+  log.write(' '.join(cmd) + '\n')
+  result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+  log.write(result.stdout)
+  log.close()
+  if (result.returncode != 0) or (not os.path.exists(ihx)):
+    return None
+
+  return ihx
+
+
+
+#-------------------------------------------------------------------
+# get compiler version
+#-------------------------------------------------------------------
+def getCompilerVersion(cc=SDCC):
+  """ Get version of SDCC executable as label for results.
+
+  :param cc:         SDCC executable
+
+  :return:           label, e.g. 'sdcc-4.0.0', or name of executable if version is unknown
+
+  """
+
+  try:
+    result = subprocess.run([cc, '-v'], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    match = re.search(r'(\d+\.\d+\.\d+)', result.stdout)
+    if match:
+      return 'sdcc-' + match.group(1)
+  except OSError:
+    pass
+  return os.path.basename(cc)
+
+
+
+#-------------------------------------------------------------------
+# read symbol addresses from linker map
+#-------------------------------------------------------------------
+def readMap(mapFile):
+  """ Read global symbol addresses from SDCC linker map.
+
+  :param mapFile:    name of .map file
+
+  :return:           dict {symbol: address}, e.g. {'_main': 0x8092}
+
+  """
+
+  symbols = {}
+  for line in open(mapFile):
+    match = reMapSym.match(line)
+    if match:
+      symbols[match.group(2)] = int(match.group(1), 16)
+  return symbols
+
+
+
+#-------------------------------------------------------------------
+# read function sizes and cycles from relocated listings
+#-------------------------------------------------------------------
+def readListings(buildDir):
+  """ Read all relocated listings (.rst) in build directory and extract per-function data.
+
+  Cycles are the sum over all instructions as listed by the assembler, i.e. the
+  length of the straight-line path without loops and branches taken.
+
+  :param buildDir:   build directory containing .rst files
+
+  :return:           dict {function: {'module', 'start', 'bytes', 'cycles', 'rets'}} with
+                     'rets' a list of (address, cycles) of return instructions
+
+  """
+
+  functions = {}
+  for rst in sorted(glob.glob(os.path.join(buildDir, '*.rst'))):
+    module = os.path.splitext(os.path.basename(rst))[0]
+    func = None
+    for line in open(rst, errors='replace'):
+
+      # new memory area, e.g. constants after code
+      if re.search(r'\.area\s', line):
+        func = None
+        continue
+
+      # start of new function
+      match = reRstFunc.match(line)
+      if match:
+        func = {'module': module, 'start': None, 'bytes': 0, 'cycles': 0, 'rets': []}
+        functions[match.group(1)] = func
+        continue
+      if func is None:
+        continue
+
+      # function entry address
+      match = reRstLabel.match(line)
+      if match:
+        if func['start'] is None:
+          func['start'] = int(match.group(1), 16)
+        continue
+
+      # instruction
+      match = reRstInstr.match(line)
+      if match:
+        func['bytes']  += len(match.group(2).split())
+        func['cycles'] += int(match.group(3))
+        instr = match.group(4).lower()
+        if instr in RET_CYCLES:
+          func['rets'].append((int(match.group(1), 16), int(match.group(3)) or RET_CYCLES[instr]))
+        continue
+
+      # continuation of long instruction
+      match = reRstCont.match(line)
+      if match:
+        func['bytes'] += len(match.group(2).split())
+
+  return functions
+
+# end of module
@@ -0,0 +1,235 @@
+#!/usr/bin/python3
+# -*- coding: utf-8 -*-
+'''
+  Cycle benchmark of the STM8 example projects and register access micro-benchmarks
+  on the SDCC simulator ucsim (sstm8). For each set of compiler flags all projects
+  are built, selected functions are timed via simulator breakpoints, and the results
+  are exported as CSV file.
+
+  Copyright (C) 2019 Georg Icking-Konert
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+  **measurement**
+
+    - probe mode 'call': breakpoints on function entry and on all its return instructions.
+      Cycles = simulator clock at return - clock at entry + cycles of return instruction.
+      For ISRs the context save by hardware (interrupt latency) is not included.
+    - probe mode 'period': breakpoint on function entry only. Cycles = difference between
+      consecutive calls, e.g. the duration of one main loop iteration.
+    - the simulator clock is read via the ucsim 'state' command after each breakpoint
+
+
+  **references**
+
+    - `ucsim simulator <http://mazsola.iit.uni-miskolc.hu/ucsim/>`_
+
+'''
+
+# import required modules
+import os, sys, re, csv
+import argparse
+import subprocess
+import sdcc_build
+
+
+# print disclaimer
+print('')
+print(sys.argv[0] + ', a small utility to measure CPU cycles of STM8 example')
+print('projects and register access styles on the ucsim simulator.')
+print('')
+print('Copyright (C) 2019  Georg Icking-Konert')
+print('')
+print('This program comes with ABSOLUTELY NO WARRANTY!')
+print('This is free software, and you are welcome to redistribute it')
+print('under certain conditions; see source code for details.')
+print('')
+
+
+#-------------------------------------------------------------------
+# benchmark configuration
+#-------------------------------------------------------------------
+
+# directories relative to this script
+BASEDIR     = os.path.dirname(os.path.abspath(__file__))
+PROJECTDIRS = [os.path.join(BASEDIR, '../examples/stm8af_stm8s'), BASEDIR]
+
+# compiler flag sets. One CSV file is created per set
+FLAGSETS    = sdcc_build.FLAGSETS
+
+# timed functions per project: (function, mode). Projects without probes are only built
+PROBES = {
+  'ADC1_Measure':         [('putchar', 'call'), ('printf', 'period')],
+  'ADC2_Measure':         [('putchar', 'call'), ('printf', 'period')],
+  'UART1_Gets_Printf':    [('putchar', 'call')],
+  'UART2_Gets_Printf':    [('putchar', 'call')],
+  'Flash_EEPROM':         [('putchar', 'call')],
+  'blink_TIM4_ISR':       [('TIM4_UPD_ISR', 'call')],
+  'blink_TIM4_Timebase':  [('TIM4_UPD_ISR', 'call'), ('tb_poll', 'call'), ('tb_micros', 'call')],
+  'LowPower_Scheduler':   [('TIM4_UPD_ISR', 'call')],
+  'access_styles':        [('set_byte', 'call'),      ('set_bitfield', 'call'),      ('set_bitinstr', 'call'),
+                           ('clr_byte', 'call'),      ('clr_bitfield', 'call'),      ('clr_bitinstr', 'call'),
+                           ('toggle_byte', 'call'),   ('toggle_bitfield', 'call'),   ('toggle_bitinstr', 'call'),
+                           ('read_byte', 'call'),     ('read_bitfield', 'call'),
+                           ('ckdiv_byte', 'call'),    ('ckdiv_mask', 'call'),        ('ckdiv_bitfield', 'call'),
+                           ('empty', 'call')],
+}
+
+# simulator clock after breakpoint, e.g. 'Total time since last reset= 0.0001 sec (1600 clks)'
+reSimClock = re.compile(r'\((\d+)\s+clks\)')
+
+
+
+#-------------------------------------------------------------------
+# run simulator
+#-------------------------------------------------------------------
+def runSimulator(sim, simType, ihx, breakpoints, numStops, timeout):
+  """ Run ucsim with breakpoints and read simulator clock at each stop.
+
+  Commands are passed via stdin. After each 'run' the simulator stops at the next
+  breakpoint, and 'state' prints the simulator clock.
+
+  :param sim:          simulator executable (sstm8)
+  :param simType:      ucsim CPU type
+  :param ihx:          firmware in Intel hex format
+  :param breakpoints:  list of breakpoint addresses
+  :param numStops:     number of stops to record
+  :param timeout:      max. simulation time [s]. On timeout the clocks recorded so far are returned
+
+  :return:             list of simulator clocks at breakpoints
+
+  """
+
+  cmds  = ['break 0x%04x' % addr for addr in breakpoints]
+  cmds += ['run', 'state'] * numStops
+  cmds += ['quit']
+  try:
+    result = subprocess.run([sim, '-t', simType, '-X', '16M', ihx], input='\n'.join(cmds) + '\n',
+      stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True, timeout=timeout)
+    output = result.stdout
+  except subprocess.TimeoutExpired as exc:
+    output = exc.output if exc.output is not None else ''
+    if isinstance(output, bytes):
+      output = output.decode(errors='replace')
+
+  return [int(clk) for clk in reSimClock.findall(output)]
+
+
+
+#-------------------------------------------------------------------
+# measure one probe
+#-------------------------------------------------------------------
+def measureProbe(args, project, ihx, symbols, functions, func, mode):
+  """ Measure cycles of one function in simulator.
+
+  :param args:         command line arguments
+  :param project:      Project object
+  :param ihx:          firmware in Intel hex format
+  :param symbols:      symbol addresses from linker map
+  :param functions:    function data from listings
+  :param func:         name of C function
+  :param mode:         'call' or 'period'
+
+  :return:             (status, list of cycles)
+
+  """
+
+  # get function entry from map, and return instructions from listing
+  entry = symbols.get('_' + func)
+  if entry is None:
+    return ('no symbol', [])
+  rets = functions.get(func, {}).get('rets', [])
+
+  # time from entry to end of return instruction
+  if mode == 'call':
+    if len(rets) == 0:
+      return ('no return', [])
+    retCycles = {addr: cycles for addr, cycles in rets}
+    clocks = runSimulator(args.sim, project.getSimType(), ihx, [entry] + list(retCycles.keys()), 2*args.samples, args.timeout)
+    cycles = [clocks[i+1] - clocks[i] for i in range(0, len(clocks)-1, 2)]
+    # add duration of return instruction (unknown which one was hit -> use max)
+    cycles = [c + max(retCycles.values()) for c in cycles]
+
+  # time between consecutive calls
+  else:
+    clocks = runSimulator(args.sim, project.getSimType(), ihx, [entry], args.samples+1, args.timeout)
+    cycles = [clocks[i+1] - clocks[i] for i in range(len(clocks)-1)]
+
+  status = 'ok' if len(cycles) == args.samples else ('timeout' if len(cycles) > 0 else 'not reached')
+  return (status, cycles)
+
+
+
+#-------------------------------------------------------------------
+# main program
+#-------------------------------------------------------------------
+
+# commandline parameters with defaults
+parser = argparse.ArgumentParser(description="STM8 cycle benchmark on ucsim")
+parser.add_argument('-f', '--flagsets', type=str,   help='comma separated flag sets (%s)' % ','.join(FLAGSETS), required=False, default=','.join(FLAGSETS))
+parser.add_argument('-p', '--projects', type=str,   help='comma separated projects (default: all)', required=False, default=None)
+parser.add_argument('-n', '--samples',  type=int,   help='samples per probe',         required=False, default=10)
+parser.add_argument('-t', '--timeout',  type=float, help='simulation timeout [s]',    required=False, default=20.0)
+parser.add_argument('-s', '--sim',      type=str,   help='ucsim STM8 simulator',      required=False, default='sstm8')
+parser.add_argument('-o', '--out',      type=str,   help='output directory',          required=False, default=os.path.join(BASEDIR, 'results'))
+args = parser.parse_args()
+
+# collect projects, i.e. subdirectories with main.c
+projects = []
+for projectDir in PROJECTDIRS:
+  for name in sorted(os.listdir(projectDir)):
+    if os.path.exists(os.path.join(projectDir, name, 'main.c')):
+      projects.append(sdcc_build.Project(os.path.join(projectDir, name)))
+if args.projects is not None:
+  projects = [p for p in projects if p.name in args.projects.split(',')]
+
+# loop over flag sets
+os.makedirs(args.out, exist_ok=True)
+for flagset in args.flagsets.split(','):
+  flags = FLAGSETS[flagset]
+  csvName = os.path.join(args.out, 'cycles_%s.csv' % flagset)
+  print('flags \'%s\' (%s) -> %s' % (flagset, ' '.join(flags), csvName))
+
+  with open(csvName, 'w', newline='') as csvFile:
+    writer = csv.writer(csvFile)
+    writer.writerow(['project', 'function', 'mode', 'status', 'samples', 'min', 'avg', 'max'])
+
+    for project in projects:
+
+      # build project with current flags
+      buildDir = os.path.join(BASEDIR, 'build', flagset, project.name)
+      ihx = sdcc_build.buildProject(project, flags, buildDir)
+      if ihx is None:
+        print('  %-22s build failed, see %s' % (project.name, os.path.join(buildDir, 'build.log')))
+        writer.writerow([project.name, '', '', 'build failed', 0, '', '', ''])
+        continue
+      if project.name not in PROBES:
+        print('  %-22s built' % project.name)
+        writer.writerow([project.name, '', '', 'built', 0, '', '', ''])
+        continue
+
+      # measure all probes of project
+      symbols   = sdcc_build.readMap(os.path.splitext(ihx)[0] + '.map')
+      functions = sdcc_build.readListings(buildDir)
+      for func, mode in PROBES[project.name]:
+        status, cycles = measureProbe(args, project, ihx, symbols, functions, func, mode)
+        if len(cycles) > 0:
+          row = [min(cycles), '%.1f' % (sum(cycles) / len(cycles)), max(cycles)]
+        else:
+          row = ['', '', '']
+        print('  %-22s %-18s %-7s %-12s %s' % (project.name, func, mode, status, row))
+        writer.writerow([project.name, func, mode, status, len(cycles)] + row)
+
+# end of program
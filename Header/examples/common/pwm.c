@@ -0,0 +1,107 @@
+/**
+  \file pwm.c
+
+  \brief implementation of TIM2 PWM driver (STM8AF/S, STM8L10x, STM8TL5x)
+
+  TIM2 runs in PWM mode 1 with preload of ARR and CCRx, i.e. duty changes
+  take effect at the next update event without glitches. On STM8L10x and
+  STM8TL5x TIM2 has a break register, and outputs are only active with
+  BKR.MOE set. The TIM2 clock is gated after reset on these families.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "pwm.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if (F_CPU/(PWM_FREQ << PWM_PSC)) > 65535L
+  #error PWM_FREQ too low for F_CPU
+#endif
+#if (F_CPU/(PWM_FREQ << PWM_PSC)) < 100L
+  #error PWM_FREQ too high for F_CPU (resolution <1%)
+#endif
+
+// PWM mode 1 with compare preload
+#define PWM_MODE1           ((uint8_t) (0x06 << 4))
+
+// enable peripheral clock. STM8L10x/STM8TL5x: clocks are gated after reset. STM8AF/S: enabled after reset
+#if defined(_CLK_PCKENR1_TIM2) && defined(_CLK_PCKENR1)
+  #define PWM_CLK_ENABLE()  (_CLK_PCKENR1 |= _CLK_PCKENR1_TIM2)
+#elif defined(_CLK_PCKENR1_TIM2)
+  #define PWM_CLK_ENABLE()  (_CLK_PCKENR |= _CLK_PCKENR1_TIM2)
+#else
+  #define PWM_CLK_ENABLE()
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void pwm_init(void)
+
+  \brief init TIM2 for PWM
+
+  Configure TIM2 for PWM_FREQ on channels 1 and 2 with 0% duty
+  and start timer.
+*/
+void pwm_init(void) {
+
+  // enable clock, stop timer and set period
+  PWM_CLK_ENABLE();
+  _TIM2_CR1   = 0x00;
+  _TIM2_PSCR  = PWM_PSC;
+  _TIM2_ARRH  = (uint8_t) ((PWM_PERIOD - 1) >> 8);
+  _TIM2_ARRL  = (uint8_t) (PWM_PERIOD - 1);
+
+  // channels 1+2: PWM mode 1 with preload, 0% duty, outputs active high
+  _TIM2_CCMR1 = PWM_MODE1 | _TIM2_CCMR1_OC1PE;
+  _TIM2_CCMR2 = PWM_MODE1 | _TIM2_CCMR2_OC2PE;
+  PWM_SET1(0);
+  PWM_SET2(0);
+  _TIM2_CCER1 = _TIM2_CCER1_CC1E | _TIM2_CCER1_CC2E;
+
+  // STM8L10x/STM8TL5x: enable outputs
+#if defined(_TIM2_BKR_MOE)
+  _TIM2_BKR   = _TIM2_BKR_MOE;
+#endif
+
+  // load prescaler and preload registers, then start timer
+  _TIM2_EGR   = _TIM2_EGR_UG;
+  _TIM2_CR1   = _TIM2_CR1_ARPE | _TIM2_CR1_CEN;
+
+} // pwm_init
+
+
+
+/**
+  \fn void pwm_set(uint8_t channel, uint16_t duty)
+
+  \brief set duty of PWM channel
+
+  \param[in]  channel   TIM2 channel (1 or 2)
+  \param[in]  duty      high time [ticks] (0..PWM_PERIOD)
+
+  Value is applied at the next update event.
+*/
+void pwm_set(uint8_t channel, uint16_t duty) {
+
+  if (duty > PWM_PERIOD)
+    duty = PWM_PERIOD;
+  if (channel == 1)
+    PWM_SET1(duty);
+  else if (channel == 2)
+    PWM_SET2(duty);
+
+} // pwm_set
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,81 @@
+/**
+  \file pwm.h
+
+  \brief declaration of TIM2 PWM driver (STM8AF/S, STM8L10x, STM8TL5x)
+
+  Edge-aligned PWM on TIM2 channels 1 and 2, which exist on all supported
+  families. Prescaler and period are calculated at compile time from F_CPU
+  and PWM_FREQ. The duty cycle is given in timer ticks (0..PWM_PERIOD).
+  PWM_SET1()/PWM_SET2() write the compare registers directly, pwm_set()
+  selects the channel at runtime.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _PWM_H_
+#define _PWM_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// CPU clock [Hz]. Is set via CLK_CKDIVR in main()
+#if !defined(F_CPU)
+  #define F_CPU             16000000L     ///< CPU frequency [Hz]
+#endif
+
+// PWM frequency [Hz]
+#if !defined(PWM_FREQ)
+  #define PWM_FREQ          1000L         ///< PWM frequency [Hz]
+#endif
+
+// TIM2 prescaler: select smallest one with <=65535 ticks per period (TIM2_PSCR is 3 bit on STM8L10x)
+#if (F_CPU/PWM_FREQ) <= 65535L
+  #define PWM_PSC           0             ///< TIM2 prescaler 2^0
+#elif (F_CPU/(2L*PWM_FREQ)) <= 65535L
+  #define PWM_PSC           1             ///< TIM2 prescaler 2^1
+#elif (F_CPU/(4L*PWM_FREQ)) <= 65535L
+  #define PWM_PSC           2             ///< TIM2 prescaler 2^2
+#elif (F_CPU/(8L*PWM_FREQ)) <= 65535L
+  #define PWM_PSC           3             ///< TIM2 prescaler 2^3
+#elif (F_CPU/(16L*PWM_FREQ)) <= 65535L
+  #define PWM_PSC           4             ///< TIM2 prescaler 2^4
+#elif (F_CPU/(32L*PWM_FREQ)) <= 65535L
+  #define PWM_PSC           5             ///< TIM2 prescaler 2^5
+#elif (F_CPU/(64L*PWM_FREQ)) <= 65535L
+  #define PWM_PSC           6             ///< TIM2 prescaler 2^6
+#else
+  #define PWM_PSC           7             ///< TIM2 prescaler 2^7
+#endif
+
+/// TIM2 ticks per PWM period (=ARR+1), i.e. 100% duty
+#define PWM_PERIOD          ((uint16_t) (F_CPU/(PWM_FREQ << PWM_PSC)))
+
+/// set duty of channel 1 [ticks]. High byte must be written first
+#define PWM_SET1(duty)      do { _TIM2_CCR1H = (uint8_t) ((duty) >> 8); _TIM2_CCR1L = (uint8_t) (duty); } while (0)
+
+/// set duty of channel 2 [ticks]. High byte must be written first
+#define PWM_SET2(duty)      do { _TIM2_CCR2H = (uint8_t) ((duty) >> 8); _TIM2_CCR2L = (uint8_t) (duty); } while (0)
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// init TIM2 for PWM on channels 1 and 2 with 0% duty
+void      pwm_init(void);
+
+/// set duty of channel (1 or 2) [ticks]. Takes effect at next period
+void      pwm_set(uint8_t channel, uint16_t duty);
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _PWM_H_
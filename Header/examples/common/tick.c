@@ -0,0 +1,139 @@
+/**
+  \file tick.c
+
+  \brief implementation of 1ms TIM4 timebase (STM8AF/S, STM8L10x, STM8TL5x)
+
+  TIM4 generates a 1ms update interrupt, which increases the millisecond
+  counter. On STM8L10x/STM8TL5x the TIM4 clock is enabled first, as all
+  peripheral clocks are gated after reset.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "tick.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if (TICK_PER_MS > 256) || ((F_CPU % (1000L << TICK_PSC)) != 0)
+  #error F_CPU not supported by TIM4 timebase
+#endif
+
+// enable peripheral clock. STM8L10x/STM8TL5x: clocks are gated after reset. STM8AF/S: enabled after reset
+#if defined(_CLK_PCKENR1_TIM4) && defined(_CLK_PCKENR1)
+  #define TICK_CLK_ENABLE() (_CLK_PCKENR1 |= _CLK_PCKENR1_TIM4)
+#elif defined(_CLK_PCKENR1_TIM4)
+  #define TICK_CLK_ENABLE() (_CLK_PCKENR |= _CLK_PCKENR1_TIM4)
+#else
+  #define TICK_CLK_ENABLE()
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+static volatile uint32_t   s_millis;                    ///< ms counter, increased in TIM4 ISR
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void TICK_ISR(void)
+
+  \brief ISR for TIM4 update interrupt
+
+  Clear update flag and increase ms counter.
+*/
+ISR_HANDLER(TICK_ISR, TICK_VECTOR) {
+
+  TICK_SR = 0x00;
+  s_millis++;
+
+} // TICK_ISR
+
+
+
+/**
+  \fn void tick_init(void)
+
+  \brief init TIM4 for 1ms interrupt
+
+  Configure TIM4 for 1ms update interrupt and reset counter.
+  Interrupts must be enabled by application.
+*/
+void tick_init(void) {
+
+  s_millis = 0;
+
+  // enable clock, stop timer and set period to 1ms
+  TICK_CLK_ENABLE();
+  TICK_CR    = 0x00;
+  _TIM4_PSCR = TICK_PSC;
+  _TIM4_ARR  = (uint8_t) (TICK_PER_MS - 1);
+  _TIM4_CNTR = 0x00;
+
+  // load prescaler immediately, then clear resulting update flag
+  _TIM4_EGR  = _TIM4_EGR_UG;
+  TICK_SR    = 0x00;
+
+  // enable interrupt and start timer
+  _TIM4_IER  = _TIM4_IER_UIE;
+  TICK_CR    = (TICK_CR_ARPE | TICK_CR_CEN);
+
+} // tick_init
+
+
+
+/**
+  \fn uint32_t tick_millis(void)
+
+  \brief get milliseconds since tick_init()
+
+  \return milliseconds since tick_init()
+
+  Read ms counter without disabling interrupts. 32bit access is not
+  atomic on STM8, so repeat read until the ISR didn't change the counter.
+*/
+uint32_t tick_millis(void) {
+
+  uint32_t  ms;
+
+  do {
+    ms = s_millis;
+  } while (ms != s_millis);
+
+  return(ms);
+
+} // tick_millis
+
+
+
+/**
+  \fn void tick_delay_ms(uint16_t ms)
+
+  \brief sleep for some milliseconds
+
+  \param[in]  ms   duration [ms]
+
+  Wait in WAIT mode until time has passed. CPU wakes up at least every
+  1ms via TIM4 interrupt. Interrupts must be enabled.
+*/
+void tick_delay_ms(uint16_t ms) {
+
+  uint32_t  start = tick_millis();
+
+  while ((tick_millis() - start) < ms)
+    WAIT_FOR_INTERRUPT();
+
+} // tick_delay_ms
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,90 @@
+/**
+  \file tick.h
+
+  \brief declaration of 1ms TIM4 timebase (STM8AF/S, STM8L10x, STM8TL5x)
+
+  Family independent millisecond timebase with TIM4 update interrupt. The
+  TIM4 register names (CR/SR on STM8AF/S, CR1/SR1 on STM8L10x/STM8TL5x) and
+  the interrupt vector are selected at compile time from the device header.
+  Prescaler and period are calculated by the preprocessor from F_CPU.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _TICK_H_
+#define _TICK_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// CPU clock [Hz]. Is set via CLK_CKDIVR in main()
+#if !defined(F_CPU)
+  #define F_CPU             16000000L     ///< CPU frequency [Hz]
+#endif
+
+// select TIM4 registers and interrupt vector of family
+#if defined(_TIM4_CR1)
+  #define TICK_CR           _TIM4_CR1                       ///< STM8L10x, STM8TL5x: control register
+  #define TICK_CR_CEN       _TIM4_CR1_CEN                   ///< counter enable
+  #define TICK_CR_ARPE      _TIM4_CR1_ARPE                  ///< auto-reload preload
+  #define TICK_SR           _TIM4_SR1                       ///< status register
+  #define TICK_VECTOR       __TIM4_UPD_VECTOR__             ///< update interrupt
+#elif defined(_TIM4_CR)
+  #define TICK_CR           _TIM4_CR                        ///< STM8AF/S: control register
+  #define TICK_CR_CEN       _TIM4_CR_CEN                    ///< counter enable
+  #define TICK_CR_ARPE      _TIM4_CR_ARPE                   ///< auto-reload preload
+  #define TICK_SR           _TIM4_SR                        ///< status register
+  #define TICK_VECTOR       __TIM4_UPD_OVF_VECTOR__         ///< update interrupt
+#else
+  #error device has no TIM4
+#endif
+
+// TIM4 prescaler: select smallest one with <=256 ticks per ms
+#if (F_CPU/1000L) <= 256
+  #define TICK_PSC          0             ///< TIM4 prescaler 2^0
+#elif (F_CPU/2000L) <= 256
+  #define TICK_PSC          1             ///< TIM4 prescaler 2^1
+#elif (F_CPU/4000L) <= 256
+  #define TICK_PSC          2             ///< TIM4 prescaler 2^2
+#elif (F_CPU/8000L) <= 256
+  #define TICK_PSC          3             ///< TIM4 prescaler 2^3
+#elif (F_CPU/16000L) <= 256
+  #define TICK_PSC          4             ///< TIM4 prescaler 2^4
+#elif (F_CPU/32000L) <= 256
+  #define TICK_PSC          5             ///< TIM4 prescaler 2^5
+#elif (F_CPU/64000L) <= 256
+  #define TICK_PSC          6             ///< TIM4 prescaler 2^6
+#else
+  #define TICK_PSC          7             ///< TIM4 prescaler 2^7
+#endif
+#define TICK_PER_MS         (F_CPU/(1000L << TICK_PSC))     ///< TIM4 ticks per ms (=ARR+1)
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+ISR_HANDLER(TICK_ISR, TICK_VECTOR);
+
+/// init TIM4 for 1ms interrupt. Interrupts must be enabled by application
+void      tick_init(void);
+
+/// get milliseconds since tick_init() (atomic)
+uint32_t  tick_millis(void);
+
+/// sleep for some milliseconds (CPU in WAIT mode)
+void      tick_delay_ms(uint16_t ms);
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _TICK_H_
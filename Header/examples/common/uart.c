@@ -0,0 +1,223 @@
+/**
+  \file uart.c
+
+  \brief implementation of interrupt-driven UART driver (STM8AF/S, STM8L10x, STM8TL5x)
+
+  Bytes are sent and received via ring buffers. Each buffer has a single
+  writer, i.e. the indices need no locking: the TX buffer is written by the
+  application and read by the TXE ISR, the RX buffer vice versa. The TXE
+  interrupt is only enabled while the TX buffer contains data. If the RX
+  buffer is full, new bytes are discarded. A buffer holds up to size-1 bytes.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "uart.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if (UART_TX_SIZE < 2) || (UART_TX_SIZE > 256) || (UART_TX_SIZE & (UART_TX_SIZE - 1))
+  #error UART_TX_SIZE must be a power of 2 (2..256)
+#endif
+#if (UART_RX_SIZE < 2) || (UART_RX_SIZE > 256) || (UART_RX_SIZE & (UART_RX_SIZE - 1))
+  #error UART_RX_SIZE must be a power of 2 (2..256)
+#endif
+#if (UART_DIV < 16) || (UART_DIV > 0xFFFF)
+  #error UART_BAUD not supported for F_CPU
+#endif
+
+// index masks of ring buffers
+#define UART_TX_MASK        ((uint8_t) (UART_TX_SIZE - 1))
+#define UART_RX_MASK        ((uint8_t) (UART_RX_SIZE - 1))
+
+// enable peripheral clock. STM8L10x/STM8TL5x: clocks are gated after reset. STM8AF/S: enabled after reset
+#if defined(_CLK_PCKENR1_USART) && defined(_CLK_PCKENR1)
+  #define UART_CLK_ENABLE() (_CLK_PCKENR1 |= _CLK_PCKENR1_USART)
+#elif defined(_CLK_PCKENR1_USART)
+  #define UART_CLK_ENABLE() (_CLK_PCKENR |= _CLK_PCKENR1_USART)
+#else
+  #define UART_CLK_ENABLE()
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// TX ring buffer. Head is written by application, tail by ISR
+static uint8_t            s_txBuf[UART_TX_SIZE];
+static volatile uint8_t   s_txHead;
+static volatile uint8_t   s_txTail;
+
+// RX ring buffer. Head is written by ISR, tail by application
+static uint8_t            s_rxBuf[UART_RX_SIZE];
+static volatile uint8_t   s_rxHead;
+static volatile uint8_t   s_rxTail;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void UART_TXE_ISR(void)
+
+  \brief ISR for UART TX empty interrupt
+
+  Send next byte from TX buffer. Disable interrupt if buffer is empty.
+*/
+ISR_HANDLER(UART_TXE_ISR, UART_TXE_VECTOR) {
+
+  uint8_t   tail = s_txTail;
+
+  if (tail != s_txHead) {
+    _UART(DR) = s_txBuf[tail];
+    s_txTail = (tail + 1) & UART_TX_MASK;
+  }
+  else
+    _UART(CR2) &= ~_UART(CR2_TIEN);
+
+} // UART_TXE_ISR
+
+
+
+/**
+  \fn void UART_RXF_ISR(void)
+
+  \brief ISR for UART RX full interrupt
+
+  Store received byte in RX buffer. Reading SR, then DR also clears error flags.
+*/
+ISR_HANDLER(UART_RXF_ISR, UART_RXF_VECTOR) {
+
+  uint8_t   head = s_rxHead;
+  uint8_t   next = (head + 1) & UART_RX_MASK;
+  uint8_t   data;
+
+  data = _UART(SR);
+  data = _UART(DR);
+  if (next != s_rxTail) {
+    s_rxBuf[head] = data;
+    s_rxHead = next;
+  }
+
+} // UART_RXF_ISR
+
+
+
+/**
+  \fn void uart_init(void)
+
+  \brief init UART
+
+  Set baudrate, 8N1 and enable sender, receiver and RX interrupt.
+  Interrupts must be enabled by application.
+*/
+void uart_init(void) {
+
+  // reset buffers
+  s_txHead = s_txTail = 0;
+  s_rxHead = s_rxTail = 0;
+
+  // enable clock, then set baudrate (note: BRR2 must be written before BRR1!)
+  UART_CLK_ENABLE();
+  _UART(CR2)  = 0x00;
+  _UART(BRR2) = (uint8_t) (((UART_DIV & 0xF000) >> 8) | (UART_DIV & 0x000F));
+  _UART(BRR1) = (uint8_t) ((UART_DIV & 0x0FF0) >> 4);
+
+  // 8N1, enable sender, receiver and RX interrupt
+  _UART(CR1)  = 0x00;
+  _UART(CR3)  = 0x00;
+  _UART(CR2)  = _UART(CR2_TEN) | _UART(CR2_REN) | _UART(CR2_RIEN);
+
+} // uart_init
+
+
+
+/**
+  \fn void uart_write(uint8_t data)
+
+  \brief send byte
+
+  \param[in]  data   byte to send
+
+  Store byte in TX buffer and enable TXE interrupt. If the buffer is full,
+  wait until the ISR has sent a byte. Don't call from ISRs with higher
+  priority than the UART ISR.
+*/
+void uart_write(uint8_t data) {
+
+  uint8_t   head = s_txHead;
+  uint8_t   next = (head + 1) & UART_TX_MASK;
+
+  while (next == s_txTail);
+  s_txBuf[head] = data;
+  s_txHead = next;
+  _UART(CR2) |= _UART(CR2_TIEN);
+
+} // uart_write
+
+
+
+/**
+  \fn uint8_t uart_available(void)
+
+  \brief get number of received bytes
+
+  \return number of bytes in RX buffer
+*/
+uint8_t uart_available(void) {
+
+  return((s_rxHead - s_rxTail) & UART_RX_MASK);
+
+} // uart_available
+
+
+
+/**
+  \fn uint8_t uart_read(uint8_t *data)
+
+  \brief get received byte
+
+  \param[out] data   received byte
+
+  \return 1 if byte was read, 0 if RX buffer is empty
+*/
+uint8_t uart_read(uint8_t *data) {
+
+  uint8_t   tail = s_rxTail;
+
+  if (tail == s_rxHead)
+    return(0);
+  *data = s_rxBuf[tail];
+  s_rxTail = (tail + 1) & UART_RX_MASK;
+
+  return(1);
+
+} // uart_read
+
+
+
+/**
+  \fn void uart_flush(void)
+
+  \brief wait until all bytes are sent
+
+  Wait until TX buffer is empty and last byte has left the shift register,
+  e.g. before entering HALT mode.
+*/
+void uart_flush(void) {
+
+  while (s_txTail != s_txHead);
+  while (!(_UART(SR) & _UART(SR_TC)));
+
+} // uart_flush
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
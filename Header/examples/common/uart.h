@@ -0,0 +1,96 @@
+/**
+  \file uart.h
+
+  \brief declaration of interrupt-driven UART driver (STM8AF/S, STM8L10x, STM8TL5x)
+
+  Family independent UART driver with TX and RX ring buffers. The UART is
+  selected at compile time from the register definitions of the device header:
+  USART on STM8L10x/STM8TL5x, else UART2 or UART1 on STM8AF/S. Register
+  access is resolved by the preprocessor, i.e. the generated code is the
+  same as with hand-written register access for the respective family.
+  The baudrate is calculated at compile time from F_CPU and UART_BAUD.
+  Pins (e.g. push-pull TX on STM8L10x) are configured by the application.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _UART_H_
+#define _UART_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// CPU clock [Hz]. Is set via CLK_CKDIVR in main()
+#if !defined(F_CPU)
+  #define F_CPU             16000000L     ///< CPU frequency [Hz]
+#endif
+
+// baudrate [Baud]
+#if !defined(UART_BAUD)
+  #define UART_BAUD         115200L       ///< UART baudrate
+#endif
+
+// size of TX and RX buffers [B]. Must be a power of 2 (2..256)
+#if !defined(UART_TX_SIZE)
+  #define UART_TX_SIZE      32            ///< size of TX ring buffer
+#endif
+#if !defined(UART_RX_SIZE)
+  #define UART_RX_SIZE      16            ///< size of RX ring buffer
+#endif
+
+// select UART and interrupt vectors of family. _UART(reg) maps register and bit names
+#if defined(_USART_SR)
+  #define _UART(reg)        _USART_##reg                    ///< STM8L10x, STM8TL5x: USART
+  #define UART_TXE_VECTOR   __USART_TXE_VECTOR__            ///< TX empty interrupt
+  #define UART_RXF_VECTOR   __USART_RXF_VECTOR__            ///< RX full interrupt
+#elif defined(_UART2_SR)
+  #define _UART(reg)        _UART2_##reg                    ///< STM8AF/S with UART2
+  #define UART_TXE_VECTOR   __UART2_TXE_VECTOR__            ///< TX empty interrupt
+  #define UART_RXF_VECTOR   __UART2_RXF_VECTOR__            ///< RX full interrupt
+#elif defined(_UART1_SR)
+  #define _UART(reg)        _UART1_##reg                    ///< STM8AF/S with UART1
+  #define UART_TXE_VECTOR   __UART1_TXE_VECTOR__            ///< TX empty interrupt
+  #define UART_RXF_VECTOR   __UART1_RXF_VECTOR__            ///< RX full interrupt
+#else
+  #error device has no supported UART
+#endif
+
+/// baudrate divider
+#define UART_DIV            ((F_CPU + UART_BAUD/2) / UART_BAUD)
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+ISR_HANDLER(UART_TXE_ISR, UART_TXE_VECTOR);
+ISR_HANDLER(UART_RXF_ISR, UART_RXF_VECTOR);
+
+/// init UART for 8N1 with interrupts. Interrupts must be enabled by application
+void      uart_init(void);
+
+/// send byte. Waits if TX buffer is full
+void      uart_write(uint8_t data);
+
+/// get number of received bytes in RX buffer
+uint8_t   uart_available(void);
+
+/// get received byte. Return 1 on success, 0 if RX buffer is empty
+uint8_t   uart_read(uint8_t *data);
+
+/// wait until all bytes are sent
+void      uart_flush(void);
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _UART_H_
@@ -0,0 +1,794 @@
+/**
+  \file dali.c
+
+  \brief implementation of interrupt-driven DALI control gear stack for STLUX/STNRG
+
+  Timing-critical parts run in interrupts: the DALI ISR only copies received
+  frames to the forward queue, and the 1ms SYSTIM ISR sends queued answers in
+  the backward frame window and steps the fade engine. Decoding and command
+  execution in dali_process() may therefore be delayed by the application by
+  up to DALI_BD_MIN_MS without losing answers.
+  The fade position is stored as level with 16 fractional bits. Fade time X
+  (0..15) fades in 0.5s * sqrt(2^X), fade rate X (1..15) with 506/sqrt(2^X)
+  steps/s, both independent of the number of steps.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "dali.h"
+#include "lamp.h"
+#include "msc.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// SYSTIM prescaler for 1ms tick (fTIM = F_CPU / 2^DALI_TICK_PSC)
+#define DALI_TICK_PSC       4
+#define DALI_TICK_PER_MS    (F_CPU / (1000L << DALI_TICK_PSC))
+
+// check configuration
+#if (DALI_CLK_DIV < 1) || (DALI_CLK_DIV > 1023)
+  #error DALI_BAUD not supported for F_CPU
+#endif
+#if ((F_CPU % (1000L << DALI_TICK_PSC)) != 0) || (DALI_TICK_PER_MS > 65536L)
+  #error F_CPU not supported by 1ms SYSTIM tick
+#endif
+#if ((DALI_RX_QUEUE & (DALI_RX_QUEUE - 1)) != 0) || ((DALI_TX_QUEUE & (DALI_TX_QUEUE - 1)) != 0)
+  #error DALI_RX_QUEUE and DALI_TX_QUEUE must be powers of 2
+#endif
+
+// special command DATA TRANSFER REGISTER (address byte)
+#define DALI_SPC_DTR        0xA3
+
+// default settings after power-up and RESET
+#define DALI_DEF_MAX        254
+#define DALI_DEF_MIN        1
+#define DALI_DEF_POWER_ON   254
+#define DALI_DEF_FAIL       254
+#define DALI_DEF_FADE_TIME  0
+#define DALI_DEF_FADE_RATE  7
+
+// build command dispatch table
+#define _DALI_FIRST(f,l,h)  (uint8_t) (f),
+#define _DALI_LAST(f,l,h)   (uint8_t) (l),
+#define _DALI_HANDLER(f,l,h) h,
+#define _DALI_COUNT(f,l,h)  + 1
+#define DALI_NUM_CMD        (0 DALI_CMD_TABLE(_DALI_COUNT))
+
+/// command handler. Return answer (0..255) or DALI_NO_ANSWER
+typedef uint16_t (*dali_handler_t)(uint8_t cmd);
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// command dispatch table
+static const uint8_t          s_cmdFirst[DALI_NUM_CMD]   = { DALI_CMD_TABLE(_DALI_FIRST) };
+static const uint8_t          s_cmdLast[DALI_NUM_CMD]    = { DALI_CMD_TABLE(_DALI_LAST) };
+static const dali_handler_t   s_cmdHandler[DALI_NUM_CMD] = { DALI_CMD_TABLE(_DALI_HANDLER) };
+
+// receive filter: values of _MSC_DALICKSEL, _MSC_DALICKDIV, _MSC_DALICONF
+static const uint8_t          s_daliFilter[3] = { DALI_FLT_CKSEL, DALI_FLT_DIV, DALI_FLT_CONF };
+
+// fade time [ms] for X=1..15, and fade rate [levels/ms * 2^16] for X=1..15
+static const uint32_t   s_fadeTimeMs[15] = { 707L, 1000L, 1414L, 2000L, 2828L, 4000L, 5657L, 8000L,
+                                             11314L, 16000L, 22627L, 32000L, 45255L, 64000L, 90510L };
+static const uint16_t   s_fadeRateStep[15] = { 23449, 16581, 11724, 8290, 5862, 4145, 2931, 2073,
+                                               1466, 1036, 733, 518, 366, 259, 183 };
+
+// forward frame queue (written by DALI ISR) with time [ms] of reception
+static volatile uint16_t  s_rxFrame[DALI_RX_QUEUE];
+static volatile uint16_t  s_rxTime[DALI_RX_QUEUE];
+static volatile uint8_t   s_rxHead, s_rxTail;
+
+// backward frame queue (read by tick ISR) with time [ms] of forward frame
+static volatile uint8_t   s_txData[DALI_TX_QUEUE];
+static volatile uint16_t  s_txTime[DALI_TX_QUEUE];
+static volatile uint8_t   s_txHead, s_txTail;
+static volatile uint8_t   s_txBusy;
+
+// ms counter and error counter
+static volatile uint32_t  s_millis;
+static volatile uint16_t  s_errors;
+
+// fade engine: position and step [levels * 2^16], target level, actual level
+static volatile uint32_t  s_fadePos;
+static volatile uint32_t  s_fadeStep;
+static volatile uint8_t   s_fadeTarget;
+static volatile uint8_t   s_actual;
+
+// settings and DTR
+static uint8_t            s_shortAddr;
+static uint16_t           s_groups;
+static uint8_t            s_maxLevel, s_minLevel, s_powerOnLevel, s_failLevel;
+static uint8_t            s_fadeTime, s_fadeRate;
+static uint8_t            s_scene[16];
+static uint8_t            s_dtr;
+
+// last configuration command for repetition check
+static uint16_t           s_lastFrame;
+static uint16_t           s_lastTime;
+static uint8_t            s_lastValid;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void dali_fade_to(uint8_t level, uint32_t step)
+
+  \brief start fade to arc power level
+
+  \param[in]  level   target level (0..254)
+  \param[in]  step    step per ms [levels * 2^16], or 0 for immediate change
+
+  A lamp which is off starts at the min. level. Called from main loop only.
+*/
+static void dali_fade_to(uint8_t level, uint32_t step) {
+
+  DISABLE_INTERRUPTS();
+  if (step == 0) {
+    s_fadePos = (uint32_t) level << 16;
+    s_actual  = level;
+    lamp_set(level);
+  }
+  else if (s_actual == 0) {
+    s_fadePos = (uint32_t) s_minLevel << 16;
+    s_actual  = s_minLevel;
+    lamp_set(s_minLevel);
+  }
+  s_fadeTarget = level;
+  s_fadeStep   = step;
+  ENABLE_INTERRUPTS();
+
+} // dali_fade_to
+
+
+
+/**
+  \fn void dali_fade_time_to(uint8_t level)
+
+  \brief fade to arc power level with fade time
+
+  \param[in]  level   target level (0..254)
+*/
+static void dali_fade_time_to(uint8_t level) {
+
+  uint8_t   delta;
+  uint32_t  step = 0;
+
+  if (s_fadeTime != 0) {
+    delta = (level > s_actual) ? (level - s_actual) : (s_actual - level);
+    step  = ((uint32_t) delta << 16) / s_fadeTimeMs[s_fadeTime - 1];
+    if (step == 0)
+      step = 1;
+  }
+  dali_fade_to(level, step);
+
+} // dali_fade_time_to
+
+
+
+/**
+  \fn uint8_t dali_limit(uint8_t level)
+
+  \brief limit arc power level to min..max. Level 0 (off) is kept
+
+  \param[in]  level   arc power level
+
+  \return limited level
+*/
+static uint8_t dali_limit(uint8_t level) {
+
+  if (level == 0)
+    return(0);
+  if (level < s_minLevel)
+    return(s_minLevel);
+  if (level > s_maxLevel)
+    return(s_maxLevel);
+  return(level);
+
+} // dali_limit
+
+
+
+/**
+  \fn void dali_reset(void)
+
+  \brief restore default settings
+
+  Short address and DTR are kept, as for the DALI RESET command.
+*/
+static void dali_reset(void) {
+
+  uint8_t   i;
+
+  s_groups     = 0x0000;
+  s_maxLevel   = DALI_DEF_MAX;
+  s_minLevel   = DALI_DEF_MIN;
+  s_powerOnLevel = DALI_DEF_POWER_ON;
+  s_failLevel  = DALI_DEF_FAIL;
+  s_fadeTime   = DALI_DEF_FADE_TIME;
+  s_fadeRate   = DALI_DEF_FADE_RATE;
+  for (i = 0; i < 16; i++)
+    s_scene[i] = DALI_MASK;
+
+} // dali_reset
+
+
+
+/**
+  \fn uint16_t dali_dispatch(uint8_t cmd)
+
+  \brief execute command via dispatch table
+
+  \param[in]  cmd   DALI command (2nd byte of forward frame)
+
+  \return answer (0..255) or DALI_NO_ANSWER
+*/
+static uint16_t dali_dispatch(uint8_t cmd) {
+
+  uint8_t   i;
+
+  for (i = 0; i < DALI_NUM_CMD; i++) {
+    if ((cmd >= s_cmdFirst[i]) && (cmd <= s_cmdLast[i]))
+      return(s_cmdHandler[i](cmd));
+  }
+  return(DALI_NO_ANSWER);
+
+} // dali_dispatch
+
+
+
+/**
+  \fn uint16_t dali_decode(uint16_t frame, uint16_t time)
+
+  \brief decode and execute forward frame
+
+  \param[in]  frame   forward frame (address byte, data byte)
+  \param[in]  time    time of reception [ms]
+
+  \return answer (0..255) or DALI_NO_ANSWER
+*/
+static uint16_t dali_decode(uint16_t frame, uint16_t time) {
+
+  uint8_t   addr = (uint8_t) (frame >> 8);
+  uint8_t   data = (uint8_t) frame;
+
+  // special commands 101CCCC1 and 110CCCC1. Only DTR is supported
+  if (((addr & 0xE1) == 0xA1) || ((addr & 0xE1) == 0xC1)) {
+    if (addr == DALI_SPC_DTR)
+      s_dtr = data;
+    return(DALI_NO_ANSWER);
+  }
+
+  // address match: broadcast, broadcast unaddressed, group 100GGGGS, short address 0AAAAAAS
+  if ((addr & 0xFE) == 0xFE)
+    ;
+  else if ((addr & 0xFE) == 0xFC) {
+    if (s_shortAddr != 0xFF)
+      return(DALI_NO_ANSWER);
+  }
+  else if ((addr & 0xE0) == 0x80) {
+    if (!(s_groups & ((uint16_t) 1 << ((addr >> 1) & 0x0F))))
+      return(DALI_NO_ANSWER);
+  }
+  else if ((addr & 0x80) || ((addr >> 1) != s_shortAddr))
+    return(DALI_NO_ANSWER);
+
+  // direct arc power control
+  if (!(addr & 0x01)) {
+    if (data == DALI_MASK)
+      dali_fade_to(s_actual, 0);
+    else
+      dali_fade_time_to(dali_limit(data));
+    return(DALI_NO_ANSWER);
+  }
+
+  // configuration commands are executed on second reception within DALI_REPEAT_MS
+  if ((data >= 32) && (data <= 128)) {
+    if ((!s_lastValid) || (frame != s_lastFrame) || ((uint16_t) (time - s_lastTime) > DALI_REPEAT_MS)) {
+      s_lastFrame = frame;
+      s_lastTime  = time;
+      s_lastValid = 1;
+      return(DALI_NO_ANSWER);
+    }
+  }
+  s_lastValid = 0;
+
+  return(dali_dispatch(data));
+
+} // dali_decode
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void DALI_ISR(void)
+
+  \brief ISR for DALI frame received/sent and errors
+
+  Store received forward frame in queue. After a sent backward frame return
+  to receive state. Frames are dropped and counted on error or full queue.
+*/
+ISR_HANDLER(DALI_ISR, __DALI_VECTOR__) {
+
+  uint8_t   csr = _DALI_CSR;
+  uint8_t   next;
+
+  // clear flags, keep interrupt enabled
+  _DALI_CSR = _DALI_CSR_IEN;
+
+  // receive error
+  if (csr & _DALI_CSR_EF)
+    s_errors++;
+
+  // frame complete
+  else if (csr & _DALI_CSR_RTF) {
+
+    // backward frame sent -> receive state
+    if (s_txBusy) {
+      _DALI_CR &= (uint8_t) ~_DALI_CR_RTS;
+      s_txBusy = 0;
+    }
+
+    // forward frame received -> queue
+    else {
+      next = (s_rxHead + 1) & (DALI_RX_QUEUE - 1);
+      if (next != s_rxTail) {
+        s_rxFrame[s_rxHead] = ((uint16_t) _DALI_FB1 << 8) | _DALI_FB0;
+        s_rxTime[s_rxHead]  = (uint16_t) s_millis;
+        s_rxHead = next;
+      }
+      else
+        s_errors++;
+    }
+  }
+
+} // DALI_ISR
+
+
+
+/**
+  \fn void DALI_TICK_ISR(void)
+
+  \brief ISR for 1ms SYSTIM update
+
+  Increase ms counter, send queued backward frame in window after forward
+  frame and step fade engine.
+*/
+ISR_HANDLER(DALI_TICK_ISR, __SYSTIM_UPD_OVF_VECTOR__) {
+
+  uint16_t  age;
+  uint32_t  target;
+  uint8_t   level;
+
+  _SYSTIM_SR1 = 0x00;
+  s_millis++;
+
+  // backward frame: drop if too late, send in window. Frame was received in the ms before
+  // its timestamp, i.e. age n means n-1..n ms since reception -> age > min for settling time > min
+  if ((!s_txBusy) && (s_txHead != s_txTail)) {
+    age = (uint16_t) s_millis - s_txTime[s_txTail];
+    if (age > DALI_BD_MAX_MS) {
+      s_txTail = (s_txTail + 1) & (DALI_TX_QUEUE - 1);
+      s_errors++;
+    }
+    else if (age > DALI_BD_MIN_MS) {
+      _DALI_BD = s_txData[s_txTail];
+      _DALI_CR |= _DALI_CR_RTS;
+      s_txBusy = 1;
+      s_txTail = (s_txTail + 1) & (DALI_TX_QUEUE - 1);
+    }
+  }
+
+  // fade step. Update lamp on change of integer level
+  if (s_fadeStep) {
+    target = (uint32_t) s_fadeTarget << 16;
+    if (s_fadePos < target) {
+      s_fadePos += s_fadeStep;
+      if (s_fadePos >= target)
+        s_fadeStep = 0;
+    }
+    else if ((s_fadePos - target) > s_fadeStep)
+      s_fadePos -= s_fadeStep;
+    else
+      s_fadeStep = 0;
+    if (s_fadeStep == 0)
+      s_fadePos = target;
+    level = (uint8_t) (s_fadePos >> 16);
+    if (level != s_actual) {
+      s_actual = level;
+      lamp_set(level);
+    }
+  }
+
+} // DALI_TICK_ISR
+
+
+
+/**
+  \fn void dali_init(void)
+
+  \brief init DALI stack
+
+  Configure DALI data rate and receive filter, 1ms SYSTIM interrupt and lamp
+  output, and switch lamp to power-on level. Interrupts must be enabled by
+  application.
+*/
+void dali_init(void) {
+
+  // reset state and settings
+  s_rxHead = s_rxTail = 0;
+  s_txHead = s_txTail = 0;
+  s_txBusy    = 0;
+  s_millis    = 0;
+  s_errors    = 0;
+  s_fadeStep  = 0;
+  s_lastValid = 0;
+  s_dtr       = 0;
+  s_shortAddr = DALI_SHORT_ADDR;
+  dali_reset();
+
+  // enable clocks of DALI and SYSTIM
+  _CLK_PCKENR1 |= (_CLK_PCKENR1_DALI | _CLK_PCKENR1_STMR);
+
+  // 1ms SYSTIM update interrupt. Load prescaler immediately, then clear resulting update flag
+  _SYSTIM_CR1  = 0x00;
+  _SYSTIM_PSCR = DALI_TICK_PSC;
+  _SYSTIM_ARRH = (uint8_t) ((DALI_TICK_PER_MS - 1) >> 8);
+  _SYSTIM_ARRL = (uint8_t) (DALI_TICK_PER_MS - 1);
+  _SYSTIM_EGR  = _SYSTIM_EGR_UG;
+  _SYSTIM_SR1  = 0x00;
+  _SYSTIM_IER  = _SYSTIM_IER_UIE;
+  _SYSTIM_CR1  = (_SYSTIM_CR1_ARPE | _SYSTIM_CR1_CEN);
+
+  // receive filter via indirect MSC registers
+  msc_write_block(MSC_IDX_DALICKSEL, s_daliFilter, sizeof(s_daliFilter));
+
+  // data rate, interrupt, enable in receive state with 16-bit forward frames (MLN=0)
+  _DALI_CR    = 0x00;
+  _DALI_CLK_L = (uint8_t) DALI_CLK_DIV;
+  _DALI_CLK_H = (uint8_t) (DALI_CLK_DIV >> 8);
+  _DALI_CSR   = _DALI_CSR_IEN;
+  _DALI_CR    = _DALI_CR_DCME;
+
+  // lamp on with power-on level
+  lamp_init();
+  s_fadeTarget = s_powerOnLevel;
+  s_fadePos    = (uint32_t) s_powerOnLevel << 16;
+  s_actual     = s_powerOnLevel;
+  lamp_set(s_powerOnLevel);
+
+} // dali_init
+
+
+
+/**
+  \fn void dali_process(void)
+
+  \brief decode and execute queued forward frames
+
+  Answers are queued with the time of the forward frame, and are sent or
+  dropped by the tick ISR.
+*/
+void dali_process(void) {
+
+  uint16_t  frame, time, answer;
+  uint8_t   next;
+
+  while (s_rxTail != s_rxHead) {
+
+    // get frame from queue
+    frame = s_rxFrame[s_rxTail];
+    time  = s_rxTime[s_rxTail];
+    s_rxTail = (s_rxTail + 1) & (DALI_RX_QUEUE - 1);
+
+    // execute and queue answer. Queue is only written here
+    answer = dali_decode(frame, time);
+    if (answer != DALI_NO_ANSWER) {
+      next = (s_txHead + 1) & (DALI_TX_QUEUE - 1);
+      if (next != s_txTail) {
+        s_txData[s_txHead] = (uint8_t) answer;
+        s_txTime[s_txHead] = time;
+        s_txHead = next;
+      }
+      else
+        s_errors++;
+    }
+
+  } // loop frames
+
+} // dali_process
+
+
+
+/**
+  \fn uint32_t dali_millis(void)
+
+  \brief get milliseconds since dali_init()
+
+  \return milliseconds since dali_init()
+
+  Repeat read until the ISR didn't change the counter, as 32bit access is not atomic.
+*/
+uint32_t dali_millis(void) {
+
+  uint32_t  ms;
+
+  do {
+    ms = s_millis;
+  } while (ms != s_millis);
+
+  return(ms);
+
+} // dali_millis
+
+
+
+/**
+  \fn uint8_t dali_level(void)
+
+  \brief get actual arc power level
+
+  \return actual level (0 = off, 1..254)
+*/
+uint8_t dali_level(void) {
+
+  return(s_actual);
+
+} // dali_level
+
+
+
+/**
+  \fn uint16_t dali_errors(void)
+
+  \brief get number of errors
+
+  \return number of receive errors, queue overflows and dropped late answers
+*/
+uint16_t dali_errors(void) {
+
+  uint16_t  n;
+
+  DISABLE_INTERRUPTS();
+  n = s_errors;
+  ENABLE_INTERRUPTS();
+
+  return(n);
+
+} // dali_errors
+
+
+
+/**
+  \fn uint8_t dali_dtr(void)
+
+  \brief get data transfer register
+
+  \return content of DTR
+*/
+uint8_t dali_dtr(void) {
+
+  return(s_dtr);
+
+} // dali_dtr
+
+
+
+/**
+  \fn uint16_t dali_cmd_arc(uint8_t cmd)
+
+  \brief built-in handler for arc power commands
+
+  \param[in]  cmd   0=OFF, 1=UP, 2=DOWN, 3=STEP UP, 4=STEP DOWN, 5=RECALL MAX,
+                    6=RECALL MIN, 7=STEP DOWN AND OFF, 8=ON AND STEP UP
+
+  \return DALI_NO_ANSWER
+
+  UP/DOWN fade for 200ms with the fade rate, all others change immediately.
+*/
+uint16_t dali_cmd_arc(uint8_t cmd) {
+
+  uint8_t   actual = s_actual;
+  uint32_t  step   = s_fadeRateStep[((s_fadeRate == 0) ? 1 : s_fadeRate) - 1];
+  uint16_t  delta  = (uint16_t) ((step * 200) >> 16);
+
+  switch (cmd) {
+    case 0:
+      dali_fade_to(0, 0);
+      break;
+    case 1:
+      if (actual)
+        dali_fade_to(((uint16_t) actual + delta >= s_maxLevel) ? s_maxLevel : actual + delta, step);
+      break;
+    case 2:
+      if (actual)
+        dali_fade_to(((uint16_t) actual <= s_minLevel + delta) ? s_minLevel : actual - delta, step);
+      break;
+    case 3:
+      if ((actual) && (actual < s_maxLevel))
+        dali_fade_to(actual + 1, 0);
+      break;
+    case 4:
+      if (actual > s_minLevel)
+        dali_fade_to(actual - 1, 0);
+      break;
+    case 5:
+      dali_fade_to(s_maxLevel, 0);
+      break;
+    case 6:
+      dali_fade_to(s_minLevel, 0);
+      break;
+    case 7:
+      if (actual)
+        dali_fade_to((actual <= s_minLevel) ? 0 : actual - 1, 0);
+      break;
+    case 8:
+      if (actual == 0)
+        dali_fade_to(s_minLevel, 0);
+      else if (actual < s_maxLevel)
+        dali_fade_to(actual + 1, 0);
+      break;
+  }
+
+  return(DALI_NO_ANSWER);
+
+} // dali_cmd_arc
+
+
+
+/**
+  \fn uint16_t dali_cmd_scene(uint8_t cmd)
+
+  \brief built-in handler for GO TO SCENE
+
+  \param[in]  cmd   16..31 for scene 0..15
+
+  \return DALI_NO_ANSWER
+*/
+uint16_t dali_cmd_scene(uint8_t cmd) {
+
+  uint8_t   level = s_scene[cmd & 0x0F];
+
+  if (level != DALI_MASK)
+    dali_fade_time_to(dali_limit(level));
+
+  return(DALI_NO_ANSWER);
+
+} // dali_cmd_scene
+
+
+
+/**
+  \fn uint16_t dali_cmd_config(uint8_t cmd)
+
+  \brief built-in handler for configuration commands
+
+  \param[in]  cmd   32..128
+
+  \return DALI_NO_ANSWER
+
+  Supported: RESET, STORE ACTUAL LEVEL IN DTR, STORE DTR AS MAX/MIN/FAILURE/
+  POWER ON LEVEL, FADE TIME/RATE, SCENE, REMOVE FROM SCENE, ADD TO/REMOVE FROM
+  GROUP, STORE DTR AS SHORT ADDRESS. Repetition is checked by the caller.
+*/
+uint16_t dali_cmd_config(uint8_t cmd) {
+
+  uint8_t   dtr = s_dtr;
+
+  if (cmd == 32)
+    dali_reset();
+  else if (cmd == 33)
+    s_dtr = s_actual;
+  else if (cmd == 42)
+    s_maxLevel = (dtr < s_minLevel) ? s_minLevel : ((dtr > 254) ? 254 : dtr);
+  else if (cmd == 43)
+    s_minLevel = (dtr > s_maxLevel) ? s_maxLevel : ((dtr < 1) ? 1 : dtr);
+  else if (cmd == 44)
+    s_failLevel = dtr;
+  else if (cmd == 45)
+    s_powerOnLevel = dtr;
+  else if (cmd == 46)
+    s_fadeTime = (dtr > 15) ? 15 : dtr;
+  else if (cmd == 47)
+    s_fadeRate = (dtr > 15) ? 15 : ((dtr < 1) ? 1 : dtr);
+  else if ((cmd >= 64) && (cmd <= 79))
+    s_scene[cmd & 0x0F] = dtr;
+  else if ((cmd >= 80) && (cmd <= 95))
+    s_scene[cmd & 0x0F] = DALI_MASK;
+  else if ((cmd >= 96) && (cmd <= 111))
+    s_groups |= (uint16_t) 1 << (cmd & 0x0F);
+  else if ((cmd >= 112) && (cmd <= 127))
+    s_groups &= (uint16_t) ~((uint16_t) 1 << (cmd & 0x0F));
+  else if (cmd == 128)
+    s_shortAddr = ((dtr & 0x81) == 0x01) ? (dtr >> 1) : 0xFF;
+
+  // keep actual level within new limits
+  if ((s_actual) && (dali_limit(s_actual) != s_actual))
+    dali_fade_to(dali_limit(s_actual), 0);
+
+  return(DALI_NO_ANSWER);
+
+} // dali_cmd_config
+
+
+
+/**
+  \fn uint16_t dali_cmd_query(uint8_t cmd)
+
+  \brief built-in handler for queries
+
+  \param[in]  cmd   144..199
+
+  \return answer, or DALI_NO_ANSWER for 'no' and unsupported queries
+*/
+uint16_t dali_cmd_query(uint8_t cmd) {
+
+  uint8_t   status;
+
+  switch (cmd) {
+
+    // QUERY STATUS: lamp on, fade running, missing short address
+    case 144:
+      status = 0x00;
+      if (s_actual)
+        status |= 0x04;
+      if (s_fadeStep)
+        status |= 0x10;
+      if (s_shortAddr == 0xFF)
+        status |= 0x40;
+      return(status);
+
+    // QUERY CONTROL GEAR, QUERY LAMP POWER ON
+    case 145:
+      return(0xFF);
+    case 147:
+      return((s_actual) ? 0xFF : DALI_NO_ANSWER);
+
+    // QUERY CONTENT DTR, QUERY DEVICE TYPE (6 = LED)
+    case 152:
+      return(s_dtr);
+    case 153:
+      return(6);
+
+    // QUERY ACTUAL/MAX/MIN/POWER ON/SYSTEM FAILURE LEVEL, FADE TIME/RATE
+    case 160:
+      return(s_actual);
+    case 161:
+      return(s_maxLevel);
+    case 162:
+      return(s_minLevel);
+    case 163:
+      return(s_powerOnLevel);
+    case 164:
+      return(s_failLevel);
+    case 165:
+      return((uint8_t) ((s_fadeTime << 4) | s_fadeRate));
+
+    // QUERY GROUPS 0-7, 8-15
+    case 192:
+      return((uint8_t) s_groups);
+    case 193:
+      return((uint8_t) (s_groups >> 8));
+  }
+
+  // QUERY SCENE LEVEL
+  if ((cmd >= 176) && (cmd <= 191))
+    return(s_scene[cmd & 0x0F]);
+
+  return(DALI_NO_ANSWER);
+
+} // dali_cmd_query
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,149 @@
+/**
+  \file dali.h
+
+  \brief declaration of interrupt-driven DALI control gear stack for STLUX/STNRG
+
+  DALI slave (control gear) on the _DALI peripheral, which receives 16-bit
+  forward frames and transmits 8-bit backward frames in hardware:
+    - the DALI ISR stores received forward frames with timestamp in a queue
+    - dali_process() decodes the queued frames in the main loop: address match
+      (short address, groups, broadcast), direct arc power, special commands and
+      dispatch of commands via table DALI_CMD_TABLE(X) with X(first, last, handler)
+    - answers are queued as backward frames and sent by the 1ms SYSTIM ISR in the
+      window (DALI_BD_MIN_MS, DALI_BD_MAX_MS] after the forward frame. Late answers are dropped
+    - the fade engine runs in the 1ms SYSTIM ISR with 16 fractional bits and
+      sets the lamp level via lamp_set()
+  Configuration commands (32..128) are executed only if repeated within DALI_REPEAT_MS.
+  Settings are kept in RAM, i.e. they are not stored to EEPROM.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _DALI_H_
+#define _DALI_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// master clock [Hz]. Is set via CLK_CKDIVR in main()
+#if !defined(F_CPU)
+  #define F_CPU             16000000L     ///< master frequency [Hz]
+#endif
+
+// DALI bit rate [Baud]
+#if !defined(DALI_BAUD)
+  #define DALI_BAUD         1200L         ///< DALI bit rate
+#endif
+
+// short address after reset (0..63), or 0xFF for none
+#if !defined(DALI_SHORT_ADDR)
+  #define DALI_SHORT_ADDR   0xFF          ///< initial short address
+#endif
+
+// size of forward frame queue (power of 2)
+#if !defined(DALI_RX_QUEUE)
+  #define DALI_RX_QUEUE     8             ///< queued forward frames
+#endif
+
+// size of backward frame queue (power of 2)
+#if !defined(DALI_TX_QUEUE)
+  #define DALI_TX_QUEUE     4             ///< queued backward frames
+#endif
+
+// time window (min, max] for backward frame after end of forward frame [ms]. The
+// forward frame is stamped with 1ms resolution, i.e. answers leave after more than min
+#if !defined(DALI_BD_MIN_MS)
+  #define DALI_BD_MIN_MS    3             ///< min. settling time before backward frame (exclusive)
+#endif
+#if !defined(DALI_BD_MAX_MS)
+  #define DALI_BD_MAX_MS    9             ///< max. settling time (inclusive), later answers are dropped
+#endif
+
+// configuration commands must be repeated within this time [ms]
+#if !defined(DALI_REPEAT_MS)
+  #define DALI_REPEAT_MS    100           ///< max. time for repeated command
+#endif
+
+// receive filter, indirect MSC registers _MSC_DALICKSEL, _MSC_DALICKDIV and _MSC_DALICONF. Default: filter off (reset values)
+#if !defined(DALI_FLT_CKSEL)
+  #define DALI_FLT_CKSEL    0x00          ///< filter clock source and enable
+#endif
+#if !defined(DALI_FLT_DIV)
+  #define DALI_FLT_DIV      0x00          ///< filter clock = CLK(CLK_SEL) / (DIV + 1)
+#endif
+#if !defined(DALI_FLT_CONF)
+  #define DALI_FLT_CONF     0x00          ///< filter mode and counter
+#endif
+
+/// DALI data rate prescaler (fdata = fmaster / ((N+1)*16))
+#define DALI_CLK_DIV        ((F_CPU + 8 * DALI_BAUD) / (16 * DALI_BAUD) - 1)
+
+/// return value of command handlers without answer
+#define DALI_NO_ANSWER      0xFFFF
+
+/// arc power level 'MASK', i.e. no change
+#define DALI_MASK           255
+
+/// built-in command handlers X(first command, last command, handler). Extend in main.h via DALI_CMD_TABLE(X)
+#define DALI_CMD_TABLE_STD(X) \
+  X(  0,   8, dali_cmd_arc)      /* OFF .. ON AND STEP UP */ \
+  X( 16,  31, dali_cmd_scene)    /* GO TO SCENE 0..15 */ \
+  X( 32, 128, dali_cmd_config)   /* RESET .. STORE DTR AS SHORT ADDRESS */ \
+  X(144, 199, dali_cmd_query)    /* QUERY STATUS .. QUERY GROUPS 8-15 */
+
+// command table. First matching entry is used
+#if !defined(DALI_CMD_TABLE)
+  #define DALI_CMD_TABLE(X) DALI_CMD_TABLE_STD(X)
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+ISR_HANDLER(DALI_ISR, __DALI_VECTOR__);
+ISR_HANDLER(DALI_TICK_ISR, __SYSTIM_UPD_OVF_VECTOR__);
+
+/// init DALI peripheral, receive filter, 1ms SYSTIM and lamp. Interrupts must be enabled by application
+void      dali_init(void);
+
+/// decode and execute queued forward frames. Call periodically from main loop
+void      dali_process(void);
+
+/// get milliseconds since dali_init()
+uint32_t  dali_millis(void);
+
+/// get actual arc power level (0..254)
+uint8_t   dali_level(void);
+
+/// get number of receive errors and dropped (late or overflowed) frames
+uint16_t  dali_errors(void);
+
+/// get data transfer register (DTR), e.g. in application command handlers
+uint8_t   dali_dtr(void);
+
+/// built-in handler for arc power commands 0..8
+uint16_t  dali_cmd_arc(uint8_t cmd);
+
+/// built-in handler for GO TO SCENE 16..31
+uint16_t  dali_cmd_scene(uint8_t cmd);
+
+/// built-in handler for configuration commands 32..128
+uint16_t  dali_cmd_config(uint8_t cmd);
+
+/// built-in handler for queries 144..199
+uint16_t  dali_cmd_query(uint8_t cmd);
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _DALI_H_
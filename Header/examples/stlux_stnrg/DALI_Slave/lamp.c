@@ -0,0 +1,143 @@
+/**
+  \file lamp.c
+
+  \brief implementation of DALI lamp output via SMED PWM for STLUX/STNRG
+
+  DALI dimming curve: P(n) = 10^((n-1)*3/253 - 1) %, i.e. one level step is
+  1/25.387 octave. The duty is calculated as period * 2^(-q/32) with
+  q = (254-n) * 32/25.387 in 1/32 octaves, using a 32 entry table and a
+  shift instead of a 254 entry table.
+  The FSM cycle contains 2 PWM periods (S0/S2 high, S1/S3 low).
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "lamp.h"
+#include "smed.h"
+#include "smed_cfg.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+/// PWM period [SMED ticks]
+#define LAMP_PERIOD         (SMED_CLOCK_LAMP / LAMP_PWM_HZ)
+
+// check configuration
+#if (LAMP_PERIOD < 1000) || (LAMP_PERIOD > 65535L)
+  #error LAMP_PWM_HZ must give 1000..65535 SMED ticks per period
+#endif
+
+/// SMED registers of lamp unit
+#define LAMP_REG(offs)      (*((volatile uint8_t*) (SMED0_AddressBase + SMED_UNIT_LAMP * SMED_UNIT_SIZE + (offs))))
+
+// offset of time register T0L
+#define LAMP_OFFS_T0L       0x04
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// 2^16 * 2^(-i/32) for i=0..31
+static const uint16_t   s_exp2[32] = {
+  65535, 64132, 62757, 61413, 60097, 58809, 57549, 56316, 55109, 53928, 52773, 51642, 50535, 49452, 48393, 47356,
+  46341, 45348, 44376, 43425, 42495, 41584, 40693, 39821, 38968, 38133, 37316, 36516, 35734, 34968, 34219, 33486 };
+
+// SMED state
+static uint8_t          s_running;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void lamp_init(void)
+
+  \brief init lamp output
+
+  Load lamp state machine to SMED. The unit is started by lamp_set().
+*/
+void lamp_init(void) {
+
+  smed_load(SMED_UNIT_LAMP, g_smed_lamp);
+  s_running = 0;
+
+} // lamp_init
+
+
+
+/**
+  \fn uint16_t lamp_duty(uint8_t level)
+
+  \brief get PWM duty for arc power level
+
+  \param[in]  level   arc power level (1..254)
+
+  \return high time [SMED ticks], 1..LAMP_PERIOD-1
+*/
+uint16_t lamp_duty(uint8_t level) {
+
+  uint16_t  q;
+  uint16_t  duty;
+
+  // attenuation in 1/32 octaves (1291/1024 = 32/25.387)
+  q = (uint16_t) (((uint32_t) (254 - level) * 1291 + 512) >> 10);
+  duty = (uint16_t) (((uint32_t) LAMP_PERIOD * s_exp2[q & 31]) >> (16 + (q >> 5)));
+
+  if (duty == 0)
+    duty = 1;
+  return(duty);
+
+} // lamp_duty
+
+
+
+/**
+  \fn void lamp_set(uint8_t level)
+
+  \brief set lamp to arc power level
+
+  \param[in]  level   0 = off, 1..254
+
+  Write high and low time to S0/S2 and S1/S3, then validate them. The SMED
+  takes them over at the next timer transition, i.e. without glitch.
+*/
+void lamp_set(uint8_t level) {
+
+  uint16_t  high, low;
+
+  // off: stop SMED
+  if (level == 0) {
+    smed_stop(SMED_MASK(SMED_UNIT_LAMP));
+    s_running = 0;
+    return;
+  }
+
+  // high and low time
+  high = lamp_duty(level);
+  low  = LAMP_PERIOD - high;
+  LAMP_REG(LAMP_OFFS_T0L + 0) = (uint8_t) high;
+  LAMP_REG(LAMP_OFFS_T0L + 1) = (uint8_t) (high >> 8);
+  LAMP_REG(LAMP_OFFS_T0L + 2) = (uint8_t) low;
+  LAMP_REG(LAMP_OFFS_T0L + 3) = (uint8_t) (low >> 8);
+  LAMP_REG(LAMP_OFFS_T0L + 4) = (uint8_t) high;
+  LAMP_REG(LAMP_OFFS_T0L + 5) = (uint8_t) (high >> 8);
+  LAMP_REG(LAMP_OFFS_T0L + 6) = (uint8_t) low;
+  LAMP_REG(LAMP_OFFS_T0L + 7) = (uint8_t) (low >> 8);
+  LAMP_REG(SMED_OFFS_CTR_TMR) = (_SMED_CTR_TMR_TIME_T0_VAL | _SMED_CTR_TMR_TIME_T1_VAL | _SMED_CTR_TMR_TIME_T2_VAL | _SMED_CTR_TMR_TIME_T3_VAL);
+
+  // start SMED
+  if (!s_running) {
+    smed_start(SMED_MASK(SMED_UNIT_LAMP));
+    s_running = 1;
+  }
+
+} // lamp_set
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
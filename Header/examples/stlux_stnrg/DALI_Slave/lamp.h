@@ -0,0 +1,50 @@
+/**
+  \file lamp.h
+
+  \brief declaration of DALI lamp output via SMED PWM for STLUX/STNRG
+
+  The SMED state machine is compiled from lamp.ini by generate_smed.py. The
+  DALI arc power level is converted to PWM duty with the logarithmic DALI
+  dimming curve, and the SMED time registers are updated and validated at
+  runtime.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _LAMP_H_
+#define _LAMP_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// lamp PWM frequency [Hz]
+#if !defined(LAMP_PWM_HZ)
+  #define LAMP_PWM_HZ       1000L         ///< PWM frequency
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// load lamp state machine to SMED. Lamp is off
+void      lamp_init(void);
+
+/// set lamp to DALI arc power level (0 = off, 1..254 = 0.1%..100%)
+void      lamp_set(uint8_t level);
+
+/// get PWM duty [SMED ticks] for arc power level
+uint16_t  lamp_duty(uint8_t level);
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _LAMP_H_
@@ -0,0 +1,75 @@
+/**********************
+  DALI control gear for STLUX/STNRG
+  Interrupt-driven DALI slave on the DALI peripheral with SMED lamp PWM
+
+  Functionality:
+  - init FCPU to 16MHz
+  - init DALI stack: DALI peripheral with receive filter, 1ms SYSTIM, lamp PWM on SMED0
+  - forward frames are queued by the DALI ISR and executed in the main loop
+    via the command table in main.h
+  - answers are sent as backward frames by the 1ms ISR in the backward frame window
+  - fades to arc power levels are stepped in the 1ms ISR
+  - sleep in WAIT mode between interrupts
+
+  Boards:
+  - STLUX385A board with DALI transceiver and LED driver on PWM0
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "dali.h"
+
+
+/**
+  \fn uint16_t app_query_version(uint8_t cmd)
+
+  \brief application handler for QUERY VERSION NUMBER
+
+  \param[in]  cmd   DALI command (unused)
+
+  \return version number
+*/
+uint16_t app_query_version(uint8_t cmd) {
+
+  (void) cmd;
+  return(1);
+
+} // app_query_version
+
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  ////
+  // initialization
+  ////
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // init DALI stack and lamp
+  dali_init();
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // execute received DALI frames
+    dali_process();
+
+    // sleep until next interrupt
+    WAIT_FOR_INTERRUPT();
+
+  } // main loop
+
+} // main()
@@ -0,0 +1,31 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STLUX385A.h"	// generic STLUX385A board
+
+
+/*----------------------------------------------------------
+    DRIVER CONFIGURATION
+----------------------------------------------------------*/
+
+// master clock
+#define F_CPU           16000000L
+
+// DALI short address after reset (0..63, 0xFF = none)
+#define DALI_SHORT_ADDR 0x05
+
+// lamp PWM frequency [Hz]
+#define LAMP_PWM_HZ     1000L
+
+
+/*----------------------------------------------------------
+    DALI COMMAND TABLE
+----------------------------------------------------------*/
+
+// application command handlers
+uint16_t app_query_version(uint8_t cmd);
+
+// command table X(first, last, handler). First match is used, i.e. application handlers override built-in ones
+#define DALI_CMD_TABLE(X) \
+  X(151, 151, app_query_version)    /* QUERY VERSION NUMBER */ \
+  DALI_CMD_TABLE_STD(X)
@@ -0,0 +1,31 @@
+/**
+  \file smed_cfg.h
+
+  \brief SMED register tables for smed_load()
+
+  Generated by generate_smed.py from lamp.ini. Do not edit!
+*/
+
+#ifndef _SMED_CFG_H_
+#define _SMED_CFG_H_
+
+#include "smed.h"
+
+#if (SMED_CFG_SIZE != 32)
+  #error table layout differs from smed.h, please regenerate
+#endif
+
+
+// SMED0 'lamp' from lamp.ini, clock 16MHz, resolution 62.5ns
+#define SMED_UNIT_LAMP                    0    ///< SMED unit of 'lamp'
+#define SMED_CLOCK_LAMP                   16000000L    ///< SMED clock [Hz] of 'lamp'
+
+/// register table of 'lamp'
+static const uint8_t g_smed_lamp[SMED_CFG_SIZE] = {
+  0x00, 0x00, 0x40, 0x1F, 0x40, 0x1F, 0x40, 0x1F,
+  0x40, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+  0x00, 0x30, 0x00, 0x00, 0x10, 0x00, 0x00, 0x30,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00,
+};
+
+#endif // _SMED_CFG_H_
@@ -0,0 +1,13 @@
+REM SDCC output
+rm -fr *.asm
+DEL /Q *.lst
+DEL /Q *.rel
+DEL /Q *.rst
+DEL /Q *.sym
+DEL /Q *.cdb
+DEL /Q *.ihx
+DEL /Q *.lk
+DEL /Q *.map
+DEL /Q *.SRC
+
+REM PAUSE
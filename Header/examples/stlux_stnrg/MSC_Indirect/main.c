@@ -0,0 +1,158 @@
+/**********************
+  Indirect MSC register access for STLUX/STNRG
+  Index-shadowed, interrupt-safe access to the indexed MSC registers via msc.c
+
+  Functionality:
+  - init FCPU to 16MHz
+  - 1ms SYSTIM interrupt polls comparator status _MSC_STSP3 via msc_read() and
+    toggles GPIO0[0] on each new pending comparator event
+  - every 500ms switch between two comparator configurations
+    - mode A: CMP0/1 masked for polling, input pull-ups via msc_write_list()
+    - mode B: CMP2/3 masked for polling via msc_write_block()
+  - main and ISR access the indirect registers concurrently without
+    corrupting _MSC_IDXADD
+  - sleep in WAIT mode between interrupts
+
+  Boards:
+  - comparator inputs CMP0..3 and GPIO0[0] of any STLUX385A board
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "msc.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// SYSTIM prescaler for 1ms tick (fTIM = F_CPU / 2^TICK_PSC)
+#define TICK_PSC        4
+#define TICK_PER_MS     (F_CPU / (1000L << TICK_PSC))
+
+// GPIO0 pin for event indication
+#define EVENT_PIN       0x01
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// mode A: {index, value} pairs, sorted by index
+const uint8_t           g_modeA[] = {
+  MSC_IDX_INPP2AUX1, (_MSC_INPP2AUX1_PULLUP0 | _MSC_INPP2AUX1_PULLUP1),
+  #if defined(STNRG)
+    MSC_IDX_DAC0_HYST, (_MSC_DAC0_HYST_HYSTDN0 | _MSC_DAC0_HYST_HYSTUP0),
+    MSC_IDX_DAC1_HYST, (_MSC_DAC1_HYST_HYSTDN0 | _MSC_DAC1_HYST_HYSTUP0),
+  #endif
+  MSC_IDX_CFGP30,    (_MSC_CFGP30_INT_MSK | _MSC_CFGP30_INT_SEL0),
+  MSC_IDX_CFGP31,    (_MSC_CFGP31_INT_MSK | _MSC_CFGP31_INT_SEL0),
+  MSC_IDX_CFGP32,    0x00,
+  MSC_IDX_CFGP33,    0x00
+};
+
+// mode B: values of CFGP30..CFGP33
+const uint8_t           g_modeB[] = {
+  0x00,
+  0x00,
+  (_MSC_CFGP32_INT_MSK | _MSC_CFGP32_INT_SEL0),
+  (_MSC_CFGP33_INT_MSK | _MSC_CFGP33_INT_SEL0)
+};
+
+// milliseconds since start, written by ISR
+volatile uint16_t       g_millis;
+
+
+/**
+  \fn void TICK_ISR(void)
+
+  \brief ISR for 1ms SYSTIM update
+
+  Poll comparator status via index layer. This may interrupt an indirect
+  register access in main without corrupting it.
+*/
+ISR_HANDLER(TICK_ISR, __SYSTIM_UPD_OVF_VECTOR__) {
+
+  static uint8_t  stsOld = 0;
+  uint8_t         sts;
+
+  // clear update flag
+  _SYSTIM_SR1 = 0x00;
+  g_millis++;
+
+  // toggle pin on new pending comparator event
+  sts = msc_read(MSC_IDX_STSP3) & (_MSC_STSP3_INT_0 | _MSC_STSP3_INT_1 | _MSC_STSP3_INT_2 | _MSC_STSP3_INT_3);
+  if (sts & (uint8_t) ~stsOld)
+    _PORT0_ODR ^= EVENT_PIN;
+  stsOld = sts;
+
+} // TICK_ISR
+
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint16_t  now, last = 0;
+  uint8_t   mode = 0;
+
+
+  ////
+  // initialization
+  ////
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // event pin as push-pull output
+  _PORT0_DDR |= EVENT_PIN;
+  _PORT0_CR1 |= EVENT_PIN;
+
+  // comparator mode A
+  msc_write_list(g_modeA, sizeof(g_modeA)/2);
+
+  // 1ms SYSTIM update interrupt. Load prescaler immediately, then clear resulting update flag
+  _CLK_PCKENR1 |= _CLK_PCKENR1_STMR;
+  _SYSTIM_CR1  = 0x00;
+  _SYSTIM_PSCR = TICK_PSC;
+  _SYSTIM_ARRH = (uint8_t) ((TICK_PER_MS - 1) >> 8);
+  _SYSTIM_ARRL = (uint8_t) (TICK_PER_MS - 1);
+  _SYSTIM_EGR  = _SYSTIM_EGR_UG;
+  _SYSTIM_SR1  = 0x00;
+  _SYSTIM_IER  = _SYSTIM_IER_UIE;
+  _SYSTIM_CR1  = (_SYSTIM_CR1_ARPE | _SYSTIM_CR1_CEN);
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // read 16-bit millis atomically
+    DISABLE_INTERRUPTS();
+    now = g_millis;
+    ENABLE_INTERRUPTS();
+
+    // switch comparator configuration. ISR may poll status concurrently
+    if ((uint16_t) (now - last) >= MODE_MS) {
+      last = now;
+      mode ^= 1;
+      if (mode)
+        msc_write_block(MSC_IDX_CFGP30, g_modeB, sizeof(g_modeB));
+      else
+        msc_write_list(g_modeA, sizeof(g_modeA)/2);
+    }
+
+    // sleep until next interrupt
+    WAIT_FOR_INTERRUPT();
+
+  } // main loop
+
+} // main()
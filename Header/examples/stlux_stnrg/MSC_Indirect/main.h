@@ -0,0 +1,15 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STLUX385A.h"	// generic STLUX385A board
+
+
+/*----------------------------------------------------------
+    CONFIGURATION
+----------------------------------------------------------*/
+
+// master clock
+#define F_CPU           16000000L
+
+// period of comparator mode switch [ms]
+#define MODE_MS         500
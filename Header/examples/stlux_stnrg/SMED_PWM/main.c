@@ -0,0 +1,52 @@
+/**********************
+  SMED PWM for STLUX/STNRG
+  SMED state machines compiled from declarative descriptions by generate_smed.py
+
+  Functionality:
+  - SMED clock and CPU clock keep their reset values
+  - load register tables of SMED0 (pwm_main.ini) and SMED1 (pwm_aux.ini)
+  - start both units back-to-back
+    - SMED0: 100kHz PWM with 30% duty
+    - SMED1: 20kHz PWM with 25% duty
+  - after changing an .ini file, 'make' regenerates smed_cfg.h
+
+  Boards:
+  - PWM0 and PWM1 outputs of any STLUX385A board
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "smed.h"
+#include "smed_cfg.h"
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  ////
+  // initialization
+  ////
+
+  // load state machines. Units remain stopped
+  smed_load(SMED_UNIT_PWM_MAIN, g_smed_pwm_main);
+  smed_load(SMED_UNIT_PWM_AUX, g_smed_pwm_aux);
+
+  // start both units
+  smed_start(SMED_MASK(SMED_UNIT_PWM_MAIN) | SMED_MASK(SMED_UNIT_PWM_AUX));
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // PWM is generated by SMEDs without CPU load
+    NOP();
+
+  } // main loop
+
+} // main()
@@ -0,0 +1,4 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STLUX385A.h"	// generic STLUX385A board
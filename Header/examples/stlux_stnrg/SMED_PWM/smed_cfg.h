@@ -0,0 +1,44 @@
+/**
+  \file smed_cfg.h
+
+  \brief SMED register tables for smed_load()
+
+  Generated by generate_smed.py from pwm_main.ini, pwm_aux.ini. Do not edit!
+*/
+
+#ifndef _SMED_CFG_H_
+#define _SMED_CFG_H_
+
+#include "smed.h"
+
+#if (SMED_CFG_SIZE != 32)
+  #error table layout differs from smed.h, please regenerate
+#endif
+
+
+// SMED0 'pwm_main' from pwm_main.ini, clock 16MHz, resolution 62.5ns
+#define SMED_UNIT_PWM_MAIN                0    ///< SMED unit of 'pwm_main'
+#define SMED_CLOCK_PWM_MAIN               16000000L    ///< SMED clock [Hz] of 'pwm_main'
+
+/// register table of 'pwm_main'
+static const uint8_t g_smed_pwm_main[SMED_CFG_SIZE] = {
+  0x00, 0x00, 0x30, 0x00, 0x70, 0x00, 0x30, 0x00,
+  0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+  0x00, 0x30, 0x00, 0x00, 0x10, 0x00, 0x00, 0x30,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00,
+};
+
+
+// SMED1 'pwm_aux' from pwm_aux.ini, clock 16MHz, resolution 62.5ns
+#define SMED_UNIT_PWM_AUX                 1    ///< SMED unit of 'pwm_aux'
+#define SMED_CLOCK_PWM_AUX                16000000L    ///< SMED clock [Hz] of 'pwm_aux'
+
+/// register table of 'pwm_aux'
+static const uint8_t g_smed_pwm_aux[SMED_CFG_SIZE] = {
+  0x00, 0x00, 0xC8, 0x00, 0xA0, 0x00, 0xE0, 0x01,
+  0x58, 0x02, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00,
+};
+
+#endif // _SMED_CFG_H_
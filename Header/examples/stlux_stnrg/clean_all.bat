@@ -0,0 +1,7 @@
+REM clean all sub-projects
+
+cd DALI_Slave             & cmd /c ".\clean.bat" & cd ..
+cd MSC_Indirect           & cmd /c ".\clean.bat" & cd ..
+cd SMED_PWM               & cmd /c ".\clean.bat" & cd ..
+
+REM PAUSE test
@@ -0,0 +1,12 @@
+#!/bin/bash
+
+# change to current working directory
+cd `dirname $0`
+
+# clean all sub-projects
+
+cd DALI_Slave         ; ./clean.sh; cd ..
+cd MSC_Indirect       ; ./clean.sh; cd ..
+cd SMED_PWM           ; ./clean.sh; cd ..
+
+#PAUSE test
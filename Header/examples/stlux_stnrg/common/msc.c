@@ -0,0 +1,188 @@
+/**
+  \file msc.c
+
+  \brief implementation of access layer for indirect MSC registers of STLUX/STNRG
+
+  The current index is kept in a shadow variable, so consecutive accesses to
+  the same register or runs of registers set up in one list only write
+  _MSC_IDXADD when the index changes. Index and data accesses are done with
+  interrupts disabled. The interrupt state is saved before and restored after
+  each access, i.e. functions may be called with interrupts already disabled
+  and from ISRs. Then an ISR cannot
+  change the index between index and data access, and the shadow always
+  matches the hardware.
+  Lists and blocks are written in a single critical section, i.e. the
+  interrupt latency grows with the list length (approx. 10 CPU cycles per entry).
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "msc.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// critical sections via SAVE_AND_DISABLE_INTERRUPTS() of family header
+#if !defined(SAVE_AND_DISABLE_INTERRUPTS)
+  #error compiler not supported
+#endif
+
+// set index if it differs from shadow. Call only with interrupts disabled
+#define MSC_SET_IDX(idx)    do { if ((idx) != s_mscIdx) { s_mscIdx = (idx); _MSC_IDXADD = (idx); } } while (0)
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// interrupt state during indirect access. Only accessed with interrupts disabled
+volatile uint8_t    g_mscCC;
+
+// shadow of _MSC_IDXADD. Only accessed with interrupts disabled
+static uint8_t      s_mscIdx = MSC_IDX_NONE;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void msc_invalidate(void)
+
+  \brief mark shadow index as unknown
+
+  Call after _MSC_IDXADD was written without this layer, e.g. by legacy code.
+  The next access then writes the index register.
+*/
+void msc_invalidate(void) {
+
+  s_mscIdx = MSC_IDX_NONE;
+
+} // msc_invalidate
+
+
+
+/**
+  \fn uint8_t msc_read(uint8_t idx)
+
+  \brief read indirect MSC register
+
+  \param[in]  idx   register index, see MSC_IDX_*
+
+  \return register value
+*/
+uint8_t msc_read(uint8_t idx) {
+
+  uint8_t   value;
+
+  SAVE_AND_DISABLE_INTERRUPTS(g_mscCC);
+  MSC_SET_IDX(idx);
+  value = _MSC_IDXDAT;
+  RESTORE_INTERRUPTS(g_mscCC);
+
+  return(value);
+
+} // msc_read
+
+
+
+/**
+  \fn void msc_write(uint8_t idx, uint8_t value)
+
+  \brief write indirect MSC register
+
+  \param[in]  idx     register index, see MSC_IDX_*
+  \param[in]  value   new register value
+*/
+void msc_write(uint8_t idx, uint8_t value) {
+
+  SAVE_AND_DISABLE_INTERRUPTS(g_mscCC);
+  MSC_SET_IDX(idx);
+  _MSC_IDXDAT = value;
+  RESTORE_INTERRUPTS(g_mscCC);
+
+} // msc_write
+
+
+
+/**
+  \fn void msc_modify(uint8_t idx, uint8_t clear, uint8_t set)
+
+  \brief clear and set bits of indirect MSC register
+
+  \param[in]  idx     register index, see MSC_IDX_*
+  \param[in]  clear   bit mask to clear
+  \param[in]  set     bit mask to set (after clear)
+
+  Read-modify-write is done in one critical section, i.e. it is atomic
+  with respect to ISRs using this layer.
+*/
+void msc_modify(uint8_t idx, uint8_t clear, uint8_t set) {
+
+  SAVE_AND_DISABLE_INTERRUPTS(g_mscCC);
+  MSC_SET_IDX(idx);
+  _MSC_IDXDAT = (uint8_t) ((_MSC_IDXDAT & (uint8_t) ~clear) | set);
+  RESTORE_INTERRUPTS(g_mscCC);
+
+} // msc_modify
+
+
+
+/**
+  \fn void msc_write_list(const uint8_t *list, uint8_t num)
+
+  \brief write list of indirect MSC registers
+
+  \param[in]  list   array of num {index, value} pairs
+  \param[in]  num    number of pairs
+
+  Registers are written in list order with one critical section. Order the
+  list by index to profit from the index shadow, e.g. repeated writes to the
+  same register only write the index once.
+*/
+void msc_write_list(const uint8_t *list, uint8_t num) {
+
+  uint8_t   idx;
+
+  SAVE_AND_DISABLE_INTERRUPTS(g_mscCC);
+  while (num--) {
+    idx = *list++;
+    MSC_SET_IDX(idx);
+    _MSC_IDXDAT = *list++;
+  }
+  RESTORE_INTERRUPTS(g_mscCC);
+
+} // msc_write_list
+
+
+
+/**
+  \fn void msc_write_block(uint8_t idx, const uint8_t *values, uint8_t num)
+
+  \brief write consecutive indirect MSC registers
+
+  \param[in]  idx      index of first register, see MSC_IDX_*
+  \param[in]  values   array of num register values
+  \param[in]  num      number of registers
+
+  Write registers idx..idx+num-1 with one critical section, e.g. all
+  comparator input lines CFGP30..CFGP33 or DAC hysteresis registers.
+*/
+void msc_write_block(uint8_t idx, const uint8_t *values, uint8_t num) {
+
+  SAVE_AND_DISABLE_INTERRUPTS(g_mscCC);
+  while (num--) {
+    MSC_SET_IDX(idx);
+    _MSC_IDXDAT = *values++;
+    idx++;
+  }
+  RESTORE_INTERRUPTS(g_mscCC);
+
+} // msc_write_block
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,84 @@
+/**
+  \file msc.h
+
+  \brief declaration of access layer for indirect MSC registers of STLUX/STNRG
+
+  The indirect MSC registers (timer, DALI filter, DAC hysteresis, comparator
+  configuration etc.) are accessed via index register _MSC_IDXADD and data
+  register _MSC_IDXDAT. This layer
+    - keeps a shadow of the current index and skips redundant index writes
+    - performs each access with interrupts disabled, i.e. it may be used from
+      main and ISRs without corrupting the index. The interrupt state is
+      restored afterwards, i.e. nested use is safe
+    - writes lists of registers in a single critical section
+  All accesses to _MSC_IDXADD must use this layer, else call msc_invalidate().
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _MSC_H_
+#define _MSC_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// index of indirect MSC registers in _MSC_IDXADD
+#define MSC_IDX_FTM0CKSEL   0x00          ///< basic timer 1/0 source clock selection (STNRG)
+#define MSC_IDX_FTM0CKDIV   0x01          ///< basic timer 0 clock prescale (STNRG)
+#define MSC_IDX_FTM0CONF    0x02          ///< basic timer 0 counter value (STNRG)
+#define MSC_IDX_FTM1CKDIV   0x03          ///< basic timer 1 clock prescale (STNRG)
+#define MSC_IDX_FTM1CONF    0x04          ///< basic timer 1 counter value (STNRG)
+#define MSC_IDX_DALICKSEL   0x05          ///< DALI clock selection
+#define MSC_IDX_DALICKDIV   0x06          ///< DALI filter clock division factor
+#define MSC_IDX_DALICONF    0x07          ///< DALI filter mode configuration
+#define MSC_IDX_INPP2AUX1   0x08          ///< INPP2 aux. register 1
+#define MSC_IDX_INPP2AUX2   0x09          ///< INPP2 aux. register 2
+#define MSC_IDX_DAC0_HYST   0x0A          ///< DAC0 hysteresis selection (STNRG)
+#define MSC_IDX_DAC1_HYST   0x0B          ///< DAC1 hysteresis selection (STNRG)
+#define MSC_IDX_DAC2_HYST   0x0C          ///< DAC2 hysteresis selection (STNRG)
+#define MSC_IDX_DAC3_HYST   0x0D          ///< DAC3 hysteresis selection (STNRG)
+#define MSC_IDX_CFGP30      0x0E          ///< P3-0 control register input line (CMP0)
+#define MSC_IDX_CFGP31      0x0F          ///< P3-1 control register input line (CMP1)
+#define MSC_IDX_CFGP32      0x10          ///< P3-2 control register input line (CMP2)
+#define MSC_IDX_CFGP33      0x11          ///< P3-3 control register input line (CMP3)
+#define MSC_IDX_STSP3       0x12          ///< port 3 status register (CMP)
+#define MSC_IDX_IOMXP2      0x13          ///< port P2 alternate function MUX control register
+
+/// shadow value for unknown index
+#define MSC_IDX_NONE        0xFF
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// mark shadow index as unknown, e.g. after direct write to _MSC_IDXADD
+void      msc_invalidate(void);
+
+/// read indirect MSC register
+uint8_t   msc_read(uint8_t idx);
+
+/// write indirect MSC register
+void      msc_write(uint8_t idx, uint8_t value);
+
+/// clear and set bits of indirect MSC register (atomic read-modify-write)
+void      msc_modify(uint8_t idx, uint8_t clear, uint8_t set);
+
+/// write list of {index, value} pairs in one critical section
+void      msc_write_list(const uint8_t *list, uint8_t num);
+
+/// write consecutive indirect MSC registers, starting at index, in one critical section
+void      msc_write_block(uint8_t idx, const uint8_t *values, uint8_t num);
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _MSC_H_
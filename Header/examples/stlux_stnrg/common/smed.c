@@ -0,0 +1,115 @@
+/**
+  \file smed.c
+
+  \brief implementation of SMED register table loader for STLUX/STNRG
+
+  All timing and state parameters are precomputed and validated on the host
+  by generate_smed.py, so the loader only copies bytes. The registers of a
+  unit are addressed via the unit base address, i.e. one loop serves all
+  units without per-unit register names.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "smed.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// SMED units are required
+#if !defined(SMED0_AddressBase)
+  #error device has no SMED units
+#endif
+
+/// start address of SMED unit
+#define SMED_BASE(unit)     ((volatile uint8_t*) (SMED0_AddressBase + (uint16_t) (unit) * SMED_UNIT_SIZE))
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void smed_load(uint8_t unit, const uint8_t *cfg)
+
+  \brief load register table to SMED unit
+
+  \param[in]  unit   SMED unit (0..5)
+  \param[in]  cfg    register table (SMED_CFG_SIZE bytes), see smed_cfg.h
+
+  Stop the unit, enable its clock and copy the table. The time registers are
+  validated after the burst. The unit remains stopped until smed_start().
+*/
+void smed_load(uint8_t unit, const uint8_t *cfg) {
+
+  volatile uint8_t  *reg = SMED_BASE(unit);
+  uint8_t           i;
+
+  // stop FSM and counter
+  reg[SMED_OFFS_CTR] = 0x00;
+
+  // SMED clock and connection matrix. Registers of units are consecutive
+  _CLK_PCKENR2 |= SMED_MASK(unit);
+  (&_CLK_SMD0)[unit]   = cfg[SMED_CFG_CLK];
+  (&_MSC_CBOXS0)[unit] = cfg[SMED_CFG_CBOX];
+
+  // burst CTR_INP..CFG, then IER, ISEL, DMP
+  for (i = 0; i < SMED_CFG_BURST; i++)
+    reg[SMED_OFFS_FIRST + i] = cfg[i];
+  for (i = 0; i < 3; i++)
+    reg[SMED_OFFS_IER + i] = cfg[SMED_CFG_IER + i];
+
+  // validate time and dithering registers
+  reg[SMED_OFFS_CTR_TMR] = cfg[SMED_CFG_VALID];
+
+} // smed_load
+
+
+
+/**
+  \fn void smed_start(uint8_t mask)
+
+  \brief start SMED units
+
+  \param[in]  mask   units to start (bit n = SMEDn)
+
+  Units are started by consecutive writes to their CTR register, i.e. with a
+  constant offset of a few CPU cycles.
+*/
+void smed_start(uint8_t mask) {
+
+  uint8_t   unit;
+
+  for (unit = 0; unit < 6; unit++) {
+    if (mask & SMED_MASK(unit))
+      SMED_BASE(unit)[SMED_OFFS_CTR] = _SMED_CTR_FSM_ENA | _SMED_CTR_START_CNT;
+  }
+
+} // smed_start
+
+
+
+/**
+  \fn void smed_stop(uint8_t mask)
+
+  \brief stop SMED units
+
+  \param[in]  mask   units to stop (bit n = SMEDn)
+*/
+void smed_stop(uint8_t mask) {
+
+  uint8_t   unit;
+
+  for (unit = 0; unit < 6; unit++) {
+    if (mask & SMED_MASK(unit))
+      SMED_BASE(unit)[SMED_OFFS_CTR] = 0x00;
+  }
+
+} // smed_stop
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
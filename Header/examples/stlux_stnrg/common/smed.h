@@ -0,0 +1,68 @@
+/**
+  \file smed.h
+
+  \brief declaration of SMED register table loader for STLUX/STNRG
+
+  The SMED units are configured via register tables, which are compiled from
+  declarative state machine descriptions by generate_smed.py (see
+  smed_cfg.h). smed_load() writes a table to a unit in one burst, and
+  smed_start() starts several units with back-to-back register writes.
+  Table layout (SMED_CFG_SIZE bytes):
+    - 0..25: registers CTR_INP..CFG (offset 0x02..0x1B), written in one burst
+    - IER, ISEL and DMP registers
+    - validation mask for CTR_TMR, written after the time registers
+    - clock configuration _CLK_SMDn and connection matrix _MSC_CBOXSn
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _SMED_H_
+#define _SMED_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// register offsets in SMED unit. Units are 0x40 apart
+#define SMED_OFFS_CTR       0x00          ///< offset of CTR
+#define SMED_OFFS_CTR_TMR   0x01          ///< offset of CTR_TMR
+#define SMED_OFFS_FIRST     0x02          ///< offset of first burst register (CTR_INP)
+#define SMED_OFFS_IER       0x20          ///< offset of IER, followed by ISEL and DMP
+#define SMED_UNIT_SIZE      0x40          ///< address distance of SMED units
+
+// table layout
+#define SMED_CFG_BURST      26            ///< number of burst registers CTR_INP..CFG
+#define SMED_CFG_IER        26            ///< index of IER, ISEL and DMP
+#define SMED_CFG_VALID      29            ///< index of CTR_TMR validation mask
+#define SMED_CFG_CLK        30            ///< index of _CLK_SMDn
+#define SMED_CFG_CBOX       31            ///< index of _MSC_CBOXSn
+#define SMED_CFG_SIZE       32            ///< size of register table
+
+/// bit mask of SMED unit for smed_start() and smed_stop()
+#define SMED_MASK(unit)     ((uint8_t) (1 << (unit)))
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// stop SMED unit, enable its clock and load register table from generate_smed.py
+void      smed_load(uint8_t unit, const uint8_t *cfg);
+
+/// start SMED units in mask (bit n = SMEDn) back-to-back
+void      smed_start(uint8_t mask);
+
+/// stop SMED units in mask (bit n = SMEDn)
+void      smed_stop(uint8_t mask);
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _SMED_H_
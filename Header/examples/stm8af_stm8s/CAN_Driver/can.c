@@ -0,0 +1,542 @@
+/**
+  \file can.c
+
+  \brief implementation of interrupt-driven beCAN driver
+
+  Mailbox, filter and configuration registers share one address window,
+  selected via CAN_PSR. The selected page is cached in RAM, and PSR is only
+  written on a page change. ISRs restore the page on exit, so the cache
+  stays valid for code they interrupt.
+
+  TX frames are kept in a queue sorted by arbitration priority (lower ID
+  first). Free mailboxes are always loaded from the queue head, and the
+  hardware sends pending mailboxes by identifier (TXFP=0). If all mailboxes
+  are pending and a more urgent frame is queued, the least urgent mailbox is
+  aborted and its frame is re-queued, which avoids priority inversion.
+
+  The RX ISR drains the complete FIFO (3 frames) into a ring buffer, which
+  avoids FIFO overruns during long main loop iterations.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "can.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// bit timing: 1 sync + BS1 + BS2 time quanta, sample point at ~87.5%
+#define CAN_BS2         (CAN_TQ / 8)
+#define CAN_BS1         (CAN_TQ - 1 - CAN_BS2)
+#define CAN_BRP         (F_CPU / (CAN_BAUDRATE * CAN_TQ))
+#define CAN_SJW         1
+
+// check configuration
+#if (CAN_TQ < 8) || (CAN_TQ > 19)
+  #error CAN_TQ must be 8..19
+#endif
+#if (CAN_BS1 > 16) || (CAN_BS2 > 8)
+  #error CAN_BS1 (max. 16) or CAN_BS2 (max. 8) exceeds BTR2 field
+#endif
+#if ((F_CPU % (CAN_BAUDRATE * CAN_TQ)) != 0) || (CAN_BRP < 1) || (CAN_BRP > 64)
+  #error CAN_BAUDRATE not possible with F_CPU and CAN_TQ
+#endif
+#if (CAN_RX_BUFFER & (CAN_RX_BUFFER-1)) != 0
+  #error CAN_RX_BUFFER must be a power of 2
+#endif
+
+// register pages
+#define CAN_PAGE_TX0    0               ///< TX mailbox 0
+#define CAN_PAGE_TX1    1               ///< TX mailbox 1
+#define CAN_PAGE_F01    2               ///< filters 0:1
+#define CAN_PAGE_TX2    5               ///< TX mailbox 2
+#define CAN_PAGE_CFG    6               ///< configuration and diagnostics
+#define CAN_PAGE_RX     7               ///< RX FIFO output mailbox
+
+// number of TX mailboxes and filter banks
+#define CAN_MAILBOXES   3
+#define CAN_BANKS       6
+
+// select register page if not yet selected
+#define CAN_PAGE(p)     do { if (s_page != (p)) { s_page = (p); _CAN_PSR = (p); } } while (0)
+
+// block TX ISR during modification of TX queue
+#define CAN_TX_LOCK()   (_CAN_IER &= ~_CAN_IER_TMEIE)
+#define CAN_TX_UNLOCK() (_CAN_IER |= _CAN_IER_TMEIE)
+
+// max. polls for init/normal mode acknowledge
+#define CAN_INAK_WAIT   0xFFFF
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// filter table from main.h
+#if defined(CAN_FILTERS)
+  static const can_filter_t  s_filter[] = CAN_FILTERS;
+#endif
+
+// register page of mailboxes
+static const uint8_t    s_mboxPage[CAN_MAILBOXES] = {CAN_PAGE_TX0, CAN_PAGE_TX1, CAN_PAGE_TX2};
+
+// cached CAN_PSR
+static volatile uint8_t s_page;
+
+// TX state
+static can_msg_t        s_txQueue[CAN_TX_QUEUE];     ///< sorted by priority, [0]=most urgent
+static uint8_t          s_txNum;                     ///< frames in queue
+static can_msg_t        s_mbox[CAN_MAILBOXES];       ///< copy of pending mailbox frames (for re-queue)
+static uint8_t          s_mboxBusy;                  ///< bit n: mailbox n pending
+static uint8_t          s_mboxAbort;                 ///< bit n: abort requested for mailbox n
+
+// RX ring buffer
+static can_msg_t        s_rxBuf[CAN_RX_BUFFER];
+static volatile uint8_t s_rxHead;                    ///< written by ISR
+static volatile uint8_t s_rxTail;                    ///< written by can_receive()
+static volatile uint8_t s_rxLost;                    ///< frames lost due to full buffer or FIFO overrun
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn uint32_t can_priority(const can_msg_t *msg)
+
+  \brief get arbitration priority of frame
+
+  \param[in]  msg   CAN frame
+
+  \return priority (lower = more urgent). Standard IDs are aligned to the base ID of extended IDs
+*/
+static uint32_t can_priority(const can_msg_t *msg) {
+
+  if (msg->flags & CAN_EXT)
+    return(msg->id);
+  return(msg->id << 18);
+
+} // can_priority
+
+
+
+/**
+  \fn uint8_t can_queue_insert(const can_msg_t *msg)
+
+  \brief insert frame into sorted TX queue (TX ISR must be locked)
+
+  \param[in]  msg   CAN frame
+
+  \return CAN_OK or CAN_ERR_FULL
+
+  Frames of equal priority keep their order.
+*/
+static uint8_t can_queue_insert(const can_msg_t *msg) {
+
+  uint32_t  prio = can_priority(msg);
+  uint8_t   i;
+
+  if (s_txNum >= CAN_TX_QUEUE)
+    return(CAN_ERR_FULL);
+
+  // shift less urgent frames back
+  for (i = s_txNum; (i > 0) && (can_priority(&(s_txQueue[i-1])) > prio); i--)
+    s_txQueue[i] = s_txQueue[i-1];
+  s_txQueue[i] = *msg;
+  s_txNum++;
+
+  return(CAN_OK);
+
+} // can_queue_insert
+
+
+
+/**
+  \fn void can_mbox_load(uint8_t mb)
+
+  \brief load queue head into mailbox and request transmission (TX ISR must be locked)
+
+  \param[in]  mb    mailbox index (0..2)
+*/
+static void can_mbox_load(uint8_t mb) {
+
+  can_msg_t  *msg = &(s_mbox[mb]);
+  uint8_t    i, idr1;
+
+  // move queue head to mailbox copy
+  *msg = s_txQueue[0];
+  s_txNum--;
+  for (i=0; i<s_txNum; i++)
+    s_txQueue[i] = s_txQueue[i+1];
+
+  // write identifier
+  CAN_PAGE(s_mboxPage[mb]);
+  idr1 = (msg->flags & CAN_RTR) ? _CAN_MIDR1_RTR : 0x00;
+  if (msg->flags & CAN_EXT) {
+    _CAN_MIDR1 = idr1 | _CAN_MIDR1_IDE | (uint8_t) ((msg->id >> 24) & 0x1F);
+    _CAN_MIDR2 = (uint8_t) (msg->id >> 16);
+    _CAN_MIDR3 = (uint8_t) (msg->id >> 8);
+    _CAN_MIDR4 = (uint8_t) (msg->id);
+  }
+  else {
+    _CAN_MIDR1 = idr1 | (uint8_t) ((msg->id >> 6) & 0x1F);
+    _CAN_MIDR2 = (uint8_t) (msg->id << 2);
+  }
+
+  // write data and request transmission
+  _CAN_MDLCR = msg->dlc;
+  for (i=0; i<msg->dlc; i++)
+    (&_CAN_MDAR1)[i] = msg->data[i];
+  _CAN_MCSR |= _CAN_MCSR_TXRQ;
+
+  s_mboxBusy |= (uint8_t) (0x01 << mb);
+
+} // can_mbox_load
+
+
+
+/**
+  \fn void can_tx_schedule(void)
+
+  \brief load free mailboxes from queue, or preempt least urgent mailbox (TX ISR must be locked)
+*/
+static void can_tx_schedule(void) {
+
+  uint32_t  prio, maxPrio;
+  uint8_t   mb, maxMb;
+
+  // fill free mailboxes
+  for (mb=0; (mb<CAN_MAILBOXES) && (s_txNum != 0); mb++) {
+    if (!(s_mboxBusy & (0x01 << mb)))
+      can_mbox_load(mb);
+  }
+  if (s_txNum == 0)
+    return;
+
+  // all mailboxes pending -> find least urgent one without abort request
+  maxMb   = 0xFF;
+  maxPrio = 0;
+  for (mb=0; mb<CAN_MAILBOXES; mb++) {
+    prio = can_priority(&(s_mbox[mb]));
+    if (!(s_mboxAbort & (0x01 << mb)) && ((maxMb == 0xFF) || (prio > maxPrio))) {
+      maxMb   = mb;
+      maxPrio = prio;
+    }
+  }
+
+  // abort it if queue head is more urgent. Frame is re-queued in ISR unless already sent
+  if ((maxMb != 0xFF) && (can_priority(&(s_txQueue[0])) < maxPrio)) {
+    s_mboxAbort |= (uint8_t) (0x01 << maxMb);
+    CAN_PAGE(s_mboxPage[maxMb]);
+    _CAN_MCSR |= _CAN_MCSR_ABRQ;
+  }
+
+} // can_tx_schedule
+
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn uint8_t can_init(void)
+
+  \brief init CAN controller
+
+  \return CAN_OK, or CAN_ERR_INIT if mode change is not acknowledged
+
+  Set bit timing and acceptance filters, enable interrupts and enter normal
+  mode. Normal mode is entered after 11 recessive bits on the bus.
+  Interrupts must be enabled by application.
+*/
+uint8_t can_init(void) {
+
+  uint16_t  timeout;
+  uint8_t   i, j, shift;
+
+  // reset driver state
+  s_txNum     = 0;
+  s_mboxBusy  = 0;
+  s_mboxAbort = 0;
+  s_rxHead    = 0;
+  s_rxTail    = 0;
+  s_rxLost    = 0;
+
+  // enable CAN clock
+  _CLK_PCKENR2 |= _CLK_PCKENR2_CAN;
+
+  // enter init mode, leave sleep mode
+  _CAN_MCR = _CAN_MCR_INRQ;
+  for (timeout = CAN_INAK_WAIT; (timeout != 0) && !(_CAN_MSR & _CAN_MSR_INAK); timeout--);
+  if (timeout == 0)
+    return(CAN_ERR_INIT);
+
+  // automatic bus-off recovery, TX order by identifier, enable 3rd mailbox
+  _CAN_MCR = _CAN_MCR_INRQ | _CAN_MCR_ABOM;
+  _CAN_DGR = _CAN_DGR_TXM2E | (CAN_LOOPBACK ? _CAN_DGR_LBKM : 0x00);
+
+  // set bit timing
+  _CAN_PSR = CAN_PAGE_CFG;
+  s_page   = CAN_PAGE_CFG;
+  _CAN_BTR1 = (uint8_t) (((CAN_SJW - 1) << 6) | (CAN_BRP - 1));
+  _CAN_BTR2 = (uint8_t) (((CAN_BS2 - 1) << 4) | (CAN_BS1 - 1));
+
+  // deactivate all filters
+  _CAN_FCR1 = 0x00;
+  _CAN_FCR2 = 0x00;
+  _CAN_FCR3 = 0x00;
+
+  // configure filters from table
+  #if defined(CAN_FILTERS)
+    for (i=0; i<sizeof(s_filter)/sizeof(s_filter[0]); i++) {
+
+      // write filter registers (2 banks per page)
+      CAN_PAGE(CAN_PAGE_F01 + (s_filter[i].bank >> 1));
+      for (j=0; j<8; j++)
+        (&_CAN_F0R1)[((s_filter[i].bank & 0x01) << 3) + j] = s_filter[i].reg[j];
+
+      // set mode for both halves (FMLx, FMHx), then scale and activate (FACTx, FSCx)
+      CAN_PAGE(CAN_PAGE_CFG);
+      if (s_filter[i].config & 0x01) {
+        shift = (s_filter[i].bank & 0x03) << 1;
+        if (s_filter[i].bank < 4)
+          _CAN_FMR1 |= (uint8_t) (0x03 << shift);
+        else
+          _CAN_FMR2 |= (uint8_t) (0x03 << shift);
+      }
+      shift = (s_filter[i].bank & 0x01) << 2;
+      (&_CAN_FCR1)[s_filter[i].bank >> 1] |= (uint8_t) ((0x01 | (s_filter[i].config & 0x06)) << shift);
+    }
+  #endif
+
+  // enable interrupts for TX complete, RX pending and RX overrun
+  _CAN_IER = _CAN_IER_TMEIE | _CAN_IER_FMPIE | _CAN_IER_FOVIE;
+
+  // leave init mode
+  _CAN_MCR &= ~_CAN_MCR_INRQ;
+  for (timeout = CAN_INAK_WAIT; (timeout != 0) && (_CAN_MSR & _CAN_MSR_INAK); timeout--);
+  if (timeout == 0)
+    return(CAN_ERR_INIT);
+
+  return(CAN_OK);
+
+} // can_init
+
+
+
+/**
+  \fn uint8_t can_send(const can_msg_t *msg)
+
+  \brief queue frame for transmission
+
+  \param[in]  msg   CAN frame (copied)
+
+  \return CAN_OK or CAN_ERR_FULL
+
+  Frame is loaded into a free mailbox, or queued by priority.
+*/
+uint8_t can_send(const can_msg_t *msg) {
+
+  uint8_t  result;
+
+  CAN_TX_LOCK();
+  result = can_queue_insert(msg);
+  if (result == CAN_OK)
+    can_tx_schedule();
+  CAN_TX_UNLOCK();
+
+  return(result);
+
+} // can_send
+
+
+
+/**
+  \fn uint8_t can_receive(can_msg_t *msg)
+
+  \brief get received frame from buffer
+
+  \param[out] msg   received CAN frame
+
+  \return 1 if a frame was copied, 0 if buffer is empty
+*/
+uint8_t can_receive(can_msg_t *msg) {
+
+  uint8_t  tail = s_rxTail;
+
+  if (tail == s_rxHead)
+    return(0);
+
+  *msg = s_rxBuf[tail];
+  s_rxTail = (tail + 1) & (CAN_RX_BUFFER - 1);
+
+  return(1);
+
+} // can_receive
+
+
+
+/**
+  \fn uint8_t can_status(uint8_t *lostFrames)
+
+  \brief get error status
+
+  \param[out] lostFrames   number of RX frames lost since last call (NULL=ignore)
+
+  \return error status register (CAN_ESR), e.g. _CAN_ESR_BOFF for bus-off
+*/
+uint8_t can_status(uint8_t *lostFrames) {
+
+  uint8_t  esr;
+
+  // ISRs restore the page on exit -> no lock required
+  CAN_PAGE(CAN_PAGE_CFG);
+  esr = _CAN_ESR;
+
+  // read and reset lost frame counter with RX ISR locked
+  if (lostFrames != NULL) {
+    _CAN_IER &= ~(_CAN_IER_FMPIE | _CAN_IER_FOVIE);
+    *lostFrames = s_rxLost;
+    s_rxLost = 0;
+    _CAN_IER |= (_CAN_IER_FMPIE | _CAN_IER_FOVIE);
+  }
+
+  return(esr);
+
+} // can_status
+
+
+
+/**
+  \fn void CAN_RX_ISR(void)
+
+  \brief ISR for CAN FIFO message pending and overrun
+
+  Copy all frames from RX FIFO to ring buffer.
+
+  Notes:
+    - vector is shared with port F external interrupt on some devices
+    - for Cosmic compiler, add CAN_RX_ISR also to 'stm8_interrupt_vector.c'
+    - IAR compiler has an IRQ offset of +2 compared to STM8 datasheet (see below)
+*/
+#if defined(_IAR_)
+   #pragma vector = 2+__CAN_RX_VECTOR__    // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(CAN_RX_ISR, __CAN_RX_VECTOR__)
+{
+  can_msg_t  *msg;
+  uint8_t    page = s_page;
+  uint8_t    head, next, idr1, i;
+
+  // FIFO overrun -> count lost frame, clear flag
+  if (_CAN_RFR & _CAN_RFR_FOVR) {
+    _CAN_RFR = _CAN_RFR_FOVR;
+    s_rxLost++;
+  }
+
+  // drain FIFO
+  CAN_PAGE(CAN_PAGE_RX);
+  while (_CAN_RFR & _CAN_RFR_FMP) {
+
+    // buffer full -> drop frame
+    head = s_rxHead;
+    next = (head + 1) & (CAN_RX_BUFFER - 1);
+    if (next == s_rxTail) {
+      s_rxLost++;
+      _CAN_RFR = _CAN_RFR_RFOM;
+      continue;
+    }
+
+    // read identifier
+    msg  = &(s_rxBuf[head]);
+    idr1 = _CAN_MIDR1;
+    msg->flags = ((idr1 & _CAN_MIDR1_IDE) ? CAN_EXT : 0) | ((idr1 & _CAN_MIDR1_RTR) ? CAN_RTR : 0);
+    if (idr1 & _CAN_MIDR1_IDE)
+      msg->id = ((uint32_t) (idr1 & 0x1F) << 24) | ((uint32_t) _CAN_MIDR2 << 16) | ((uint16_t) _CAN_MIDR3 << 8) | _CAN_MIDR4;
+    else
+      msg->id = ((uint16_t) (idr1 & 0x1F) << 6) | (_CAN_MIDR2 >> 2);
+
+    // read data and filter match index
+    msg->dlc = _CAN_MDLCR & _CAN_MDLCR_DLC;
+    if (msg->dlc > 8)
+      msg->dlc = 8;
+    for (i=0; i<msg->dlc; i++)
+      msg->data[i] = (&_CAN_MDAR1)[i];
+    msg->fmi = _CAN_MFMIR;
+
+    // release FIFO output mailbox and publish frame
+    _CAN_RFR = _CAN_RFR_RFOM;
+    s_rxHead = next;
+
+  } // loop over FIFO
+
+  // restore page of interrupted code
+  CAN_PAGE(page);
+
+} // CAN_RX_ISR
+
+
+
+/**
+  \fn void CAN_TX_ISR(void)
+
+  \brief ISR for CAN TX request completed
+
+  Release completed mailboxes, re-queue aborted frames and load next frames.
+
+  Notes:
+    - for Cosmic compiler, add CAN_TX_ISR also to 'stm8_interrupt_vector.c'
+    - IAR compiler has an IRQ offset of +2 compared to STM8 datasheet (see below)
+*/
+#if defined(_IAR_)
+   #pragma vector = 2+__CAN_TX_VECTOR__    // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(CAN_TX_ISR, __CAN_TX_VECTOR__)
+{
+  can_msg_t  msg;
+  uint8_t    page = s_page;
+  uint8_t    tsr, mb, mask, requeue = 0;
+
+  // read and clear completed requests
+  tsr = _CAN_TSR;
+  _CAN_TSR = tsr & (_CAN_TSR_RQCP0 | _CAN_TSR_RQCP1 | _CAN_TSR_RQCP2);
+
+  // release mailboxes. Remember aborted frames which were not sent
+  for (mb=0; mb<CAN_MAILBOXES; mb++) {
+    mask = (uint8_t) (0x01 << mb);
+    if (!(tsr & (_CAN_TSR_RQCP0 << mb)))
+      continue;
+    s_mboxBusy &= ~mask;
+    if ((s_mboxAbort & mask) && !(tsr & (_CAN_TSR_TXOK0 << mb)))
+      requeue |= mask;
+    s_mboxAbort &= ~mask;
+  }
+
+  // re-queue aborted frames. If queue is full, first move queue head to mailbox
+  for (mb=0; mb<CAN_MAILBOXES; mb++) {
+    if (!(requeue & (0x01 << mb)))
+      continue;
+    if (s_txNum >= CAN_TX_QUEUE) {
+      msg = s_mbox[mb];
+      can_mbox_load(mb);
+      can_queue_insert(&msg);
+    }
+    else
+      can_queue_insert(&(s_mbox[mb]));
+  }
+
+  // load free mailboxes from queue
+  can_tx_schedule();
+
+  // restore page of interrupted code
+  CAN_PAGE(page);
+
+} // CAN_TX_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
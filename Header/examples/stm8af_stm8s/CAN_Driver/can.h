@@ -0,0 +1,131 @@
+/**
+  \file can.h
+
+  \brief declaration of interrupt-driven beCAN driver
+
+  CAN driver with
+    - cached page selection for the paged beCAN registers
+    - software TX queue sorted by CAN priority, feeding the 3 TX mailboxes.
+      A pending mailbox with lower priority is aborted for a more urgent frame
+    - acceptance filters configured from compile-time table CAN_FILTERS
+    - RX FIFO drained in ISR into a ring buffer
+  Bit timing is calculated at compile time from F_CPU and CAN_BAUDRATE.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _CAN_H_
+#define _CAN_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+#include <stddef.h>     // NULL
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// CPU clock = CAN clock [Hz]
+#if !defined(F_CPU)
+  #define F_CPU             16000000L     ///< CPU clock [Hz]
+#endif
+
+// CAN bitrate
+#if !defined(CAN_BAUDRATE)
+  #define CAN_BAUDRATE      500000L       ///< CAN bitrate [Bit/s]
+#endif
+
+// time quanta per bit (8..25). Sample point is at ~87.5%
+#if !defined(CAN_TQ)
+  #define CAN_TQ            16            ///< time quanta per bit (8..19)
+#endif
+
+// size of software TX queue (w/o 3 mailboxes)
+#if !defined(CAN_TX_QUEUE)
+  #define CAN_TX_QUEUE      8             ///< TX queue size [frames]
+#endif
+
+// size of RX ring buffer (power of 2)
+#if !defined(CAN_RX_BUFFER)
+  #define CAN_RX_BUFFER     16            ///< RX buffer size [frames]
+#endif
+
+// internal loopback mode for test without bus
+#if !defined(CAN_LOOPBACK)
+  #define CAN_LOOPBACK      0             ///< 1=loopback mode
+#endif
+
+// flags of CAN frame
+#define CAN_EXT             0x01          ///< 29-bit identifier
+#define CAN_RTR             0x02          ///< remote frame
+
+// return codes
+#define CAN_OK              0             ///< success
+#define CAN_ERR_FULL        1             ///< TX queue is full
+#define CAN_ERR_INIT        2             ///< init mode not entered/left (e.g. no bus)
+
+// filter bank configuration: bit 0=identifier list mode, bits 1-2=scale (FSC)
+#define CAN_FILTER_MASK16   0x04          ///< 2x 16-bit ID/mask pairs
+#define CAN_FILTER_LIST16   0x05          ///< 4x 16-bit IDs
+#define CAN_FILTER_MASK32   0x06          ///< 1x 32-bit ID/mask pair
+#define CAN_FILTER_LIST32   0x07          ///< 2x 32-bit IDs
+
+// 16-bit filter (2 bytes): STID[10:3] | STID[2:0] RTR IDE EXID[17:15]
+#define CAN_STD16(id)           (uint8_t) ((id) >> 3), (uint8_t) (((id) & 0x07) << 5)                ///< standard ID, IDE=0
+#define CAN_STD16_MASK(mask)    (uint8_t) ((mask) >> 3), (uint8_t) ((((mask) & 0x07) << 5) | 0x08)   ///< mask, IDE must match
+
+// 32-bit filter (4 bytes): STID[10:3] | STID[2:0] EXID[17:13] | EXID[12:5] | EXID[4:0] IDE RTR 0
+#define CAN_EXT32(id)           (uint8_t) ((id) >> 21), (uint8_t) ((id) >> 13), (uint8_t) ((id) >> 5), (uint8_t) ((((id) & 0x1F) << 3) | 0x04)  ///< extended ID, IDE=1
+#define CAN_EXT32_MASK(mask)    CAN_EXT32(mask)                                                        ///< mask, IDE must match
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// CAN frame
+typedef struct {
+  uint32_t  id;             ///< 11-bit or 29-bit identifier
+  uint8_t   flags;          ///< CAN_EXT, CAN_RTR
+  uint8_t   dlc;            ///< data length (0..8)
+  uint8_t   data[8];        ///< data bytes
+  uint8_t   fmi;            ///< filter match index (RX only)
+} can_msg_t;
+
+/// acceptance filter bank
+typedef struct {
+  uint8_t   bank;           ///< filter bank (0..5)
+  uint8_t   config;         ///< CAN_FILTER_MASK16 etc.
+  uint8_t   reg[8];         ///< filter registers FxR1..FxR8
+} can_filter_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+ISR_HANDLER(CAN_RX_ISR, __CAN_RX_VECTOR__);
+ISR_HANDLER(CAN_TX_ISR, __CAN_TX_VECTOR__);
+
+/// init CAN with bit timing and filters, and enter normal mode. Interrupts must be enabled by application
+uint8_t   can_init(void);
+
+/// queue frame for transmission
+uint8_t   can_send(const can_msg_t *msg);
+
+/// get received frame from buffer. Return 1 if a frame was copied, else 0
+uint8_t   can_receive(can_msg_t *msg);
+
+/// get error status register (ESR) and number of lost RX frames
+uint8_t   can_status(uint8_t *lostFrames);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _CAN_H_
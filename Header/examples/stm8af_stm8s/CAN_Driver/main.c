@@ -0,0 +1,102 @@
+/**********************
+  STM8 beCAN driver
+  Demonstrate CAN transmission via priority queue and reception via filters
+
+  Functionality:
+  - init FCPU to 16MHz
+  - init UART1 for printf()
+  - init CAN with 500kBit/s in loopback mode (see main.h)
+  - periodically queue a burst of standard and extended frames.
+    Urgent frames overtake pending ones, and frames not matching
+    a filter (see CAN_FILTERS in main.h) are dropped by hardware
+  - print received frames and CAN error status via UART1
+
+  Boards:
+  - STM8S208 / STM8AF52 boards with CAN (no transceiver required in loopback mode)
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "can.h"          // beCAN driver (declares CAN ISRs)
+
+// define communication speed
+#define BAUDRATE   9600
+
+// frames per burst
+#define NUM_FRAMES  6
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint16_t  BRR;
+  uint32_t  i;
+  uint8_t   j, result, lost, esr, count = 0;
+  can_msg_t msg;
+
+  // test frames: low priority first, urgent last. 0x2A0 and 0x18DAF1FF don't pass filters
+  static const uint32_t  id[NUM_FRAMES]    = { 0x1F0, 0x2A0, 0x18DA10F1, 0x18DAF1FF, 0x7DF, 0x100 };
+  static const uint8_t   flags[NUM_FRAMES] = { 0, 0, CAN_EXT, CAN_EXT, 0, 0 };
+
+
+  ////
+  // initialization
+  ////
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // set UART1 baudrate (note: BRR2 must be written before BRR1!)
+  BRR = (uint16_t) (((uint32_t) 16000000L)/BAUDRATE);
+  _UART1_BRR2 = (uint8_t) (((BRR & 0xF000) >> 8) | (BRR & 0x000F));
+  _UART1_BRR1 = (uint8_t) ((BRR & 0x0FF0) >> 4);
+
+  // enable UART1 sender
+  _UART1_CR2 |= _UART1_CR2_TEN;
+
+  // init CAN (bit timing and filters see main.h)
+  result = can_init();
+  printf("\nCAN init: %s\n", (result == CAN_OK) ? "ok" : "failed");
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // queue burst of frames. More urgent frames are sent first
+    for (j=0; j<NUM_FRAMES; j++) {
+      msg.id      = id[j];
+      msg.flags   = flags[j];
+      msg.dlc     = 2;
+      msg.data[0] = count;
+      msg.data[1] = j;
+      if (can_send(&msg) != CAN_OK)
+        printf("TX queue full\n");
+    }
+    count++;
+
+    // wait some time
+    for (i=0; i<500000L; i++)
+      NOP();
+
+    // print received frames
+    while (can_receive(&msg)) {
+      printf("RX id=0x%08lx %s dlc=%d fmi=%d data=%02x %02x\n", (unsigned long) msg.id,
+        (msg.flags & CAN_EXT) ? "ext" : "std", (int) msg.dlc, (int) msg.fmi, (int) msg.data[0], (int) msg.data[1]);
+    }
+
+    // print error status
+    esr = can_status(&lost);
+    printf("ESR=0x%02x, lost=%d\n\n", (int) esr, (int) lost);
+
+  } // main loop
+
+} // main()
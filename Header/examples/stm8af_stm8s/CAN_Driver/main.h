@@ -0,0 +1,23 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8S208RB.h"
+#include <stdio.h>
+
+
+/*----------------------------------------------------------
+    CAN CONFIGURATION
+----------------------------------------------------------*/
+
+// bit timing
+#define F_CPU           16000000L
+#define CAN_BAUDRATE    500000L
+
+// internal loopback for test without bus
+#define CAN_LOOPBACK    1
+
+// acceptance filters: {bank, mode, filter registers}
+#define CAN_FILTERS  { \
+  { 0, CAN_FILTER_MASK16, { CAN_STD16(0x100), CAN_STD16_MASK(0x700), CAN_STD16(0x7DF), CAN_STD16_MASK(0x7FF) } },  /* 0x100-0x1FF, 0x7DF */ \
+  { 1, CAN_FILTER_LIST32, { CAN_EXT32(0x18DAF110), CAN_EXT32(0x18DA10F1) } },                                     /* 2 extended IDs */ \
+}
@@ -0,0 +1,224 @@
+/**
+  \file clock.c
+
+  \brief implementation of clock tree configuration
+
+  HSE is activated via automatic clock switching, i.e. the CPU keeps running
+  on HSI until HSE is stable. If HSE doesn't start within CLK_TIMEOUT polls,
+  the switch is aborted and HSE is disabled. Then the CPU continues on HSI,
+  and F_CPU is kept if it is reachable with HSI.
+
+  If the clock security system detects a HSE failure at runtime, hardware
+  switches to HSI/8. The CSS ISR then restores the HSI divider, which keeps
+  F_CPU for a HSE of 16, 8, 4 or 2MHz. The actual clock is available via
+  clk_fcpu().
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if (CLK_HSIDIV < 0) || (CLK_HSIDIV > 3)
+  #error CLK_HSIDIV must be 0..3
+#endif
+#if (CLK_CPUDIV < 0) || (CLK_CPUDIV > 7)
+  #error CLK_CPUDIV must be 0..7
+#endif
+#if CLK_HSE && ((CLK_HSE < 1000000L) || (CLK_HSE > 24000000L))
+  #error CLK_HSE must be 1..24MHz
+#endif
+#if (F_MASTER > 16000000L)
+  #warning f_master >16MHz requires 1 flash wait state (option byte WAITSTATE)
+#endif
+
+// divider register value
+#define CLK_CKDIVR_VAL      ((CLK_HSIDIV << 3) | CLK_CPUDIV)
+
+// HSI divider for fallback to HSI. If possible keep F_CPU, else use fastest clock
+#if CLK_HSE == 16000000L
+  #define CLK_HSIDIV_FAIL   0
+#elif CLK_HSE == 8000000L
+  #define CLK_HSIDIV_FAIL   1
+#elif CLK_HSE == 4000000L
+  #define CLK_HSIDIV_FAIL   2
+#elif CLK_HSE == 2000000L
+  #define CLK_HSIDIV_FAIL   3
+#else
+  #define CLK_HSIDIV_FAIL   0
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// clock status
+static volatile uint8_t  s_status;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn uint8_t clk_init(void)
+
+  \brief configure clock tree
+
+  \return CLK_OK, or CLK_ERR_HSE if HSE failed to start (CPU runs on HSI)
+
+  Set dividers, switch to HSE (if CLK_HSE>0) with CSS, and enable only
+  the peripheral clocks selected via CLK_PERIPH. Call before any other
+  peripheral init.
+*/
+uint8_t clk_init(void) {
+
+  #if CLK_HSE
+    uint16_t  timeout;
+  #endif
+
+  s_status = CLK_OK;
+
+  // set dividers. Peripherals run with f_cpu
+  _CLK_CKDIVR = CLK_CKDIVR_VAL;
+
+  // gate peripheral clocks
+  _CLK_PCKENR1 = (uint8_t) (CLK_PERIPH);
+  _CLK_PCKENR2 = (uint8_t) (CLK_PERIPH >> 8);
+
+  #if CLK_HSE
+
+    // automatic switch to HSE, i.e. switch when HSE is stable
+    _CLK_SWCR |= _CLK_SWCR_SWEN;
+    _CLK_SWR   = _CLK_SWR_SWI_HSE;
+    for (timeout = CLK_TIMEOUT; (timeout != 0) && (_CLK_SWCR & _CLK_SWCR_SWBSY); timeout--);
+
+    // timeout -> abort switch, stop HSE and keep HSI
+    if ((timeout == 0) || (_CLK_CMSR != _CLK_SWR_SWI_HSE)) {
+      _CLK_SWCR &= ~(_CLK_SWCR_SWEN | _CLK_SWCR_SWBSY);
+      _CLK_ECKR &= ~_CLK_ECKR_HSEEN;
+      _CLK_CKDIVR = (CLK_HSIDIV_FAIL << 3) | CLK_CPUDIV;
+      s_status = CLK_ERR_HSE;
+      return(CLK_ERR_HSE);
+    }
+
+    // clock security system with interrupt
+    #if CLK_CSS
+      _CLK_CSSR = _CLK_CSSR_CSSEN | _CLK_CSSR_CSSDIE;
+    #endif
+
+  #endif // CLK_HSE
+
+  return(CLK_OK);
+
+} // clk_init
+
+
+
+/**
+  \fn uint32_t clk_fcpu(void)
+
+  \brief get actual CPU clock
+
+  \return CPU clock [Hz], calculated from clock registers
+*/
+uint32_t clk_fcpu(void) {
+
+  uint32_t  f;
+
+  // master clock source
+  if (_CLK_CMSR == _CLK_SWR_SWI_HSE)
+    f = CLK_HSE;
+  else if (_CLK_CMSR == _CLK_SWR_SWI_LSI)
+    f = 128000L;
+  else
+    f = 16000000L >> ((_CLK_CKDIVR & _CLK_CKDIVR_HSIDIV) >> 3);
+
+  return(f >> (_CLK_CKDIVR & _CLK_CKDIVR_CPUDIV));
+
+} // clk_fcpu
+
+
+
+/**
+  \fn uint8_t clk_status(void)
+
+  \brief get clock status
+
+  \return CLK_OK, CLK_ERR_HSE (HSE didn't start) or CLK_ERR_CSS (HSE failed)
+*/
+uint8_t clk_status(void) {
+
+  return(s_status);
+
+} // clk_status
+
+
+
+/**
+  \fn void clk_enable(uint16_t periph)
+
+  \brief enable peripheral clocks
+
+  \param[in]  periph   peripherals (CLK_USE_xxx)
+*/
+void clk_enable(uint16_t periph) {
+
+  _CLK_PCKENR1 |= (uint8_t) (periph);
+  _CLK_PCKENR2 |= (uint8_t) (periph >> 8);
+
+} // clk_enable
+
+
+
+/**
+  \fn void clk_disable(uint16_t periph)
+
+  \brief disable peripheral clocks
+
+  \param[in]  periph   peripherals (CLK_USE_xxx)
+*/
+void clk_disable(uint16_t periph) {
+
+  _CLK_PCKENR1 &= (uint8_t) ~(periph);
+  _CLK_PCKENR2 &= (uint8_t) ~(periph >> 8);
+
+} // clk_disable
+
+
+
+/**
+  \fn void CLK_ISR(void)
+
+  \brief ISR for clock security system
+
+  On HSE failure hardware switches to HSI/8. Restore HSI divider, clear
+  flag and report error via clk_status().
+
+  Notes:
+    - for Cosmic compiler, add CLK_ISR also to 'stm8_interrupt_vector.c'
+    - IAR compiler has an IRQ offset of +2 compared to STM8 datasheet (see below)
+*/
+#if defined(_IAR_)
+   #pragma vector = 2+__CLK_VECTOR__    // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(CLK_ISR, __CLK_VECTOR__)
+{
+  if (_CLK_CSSR & _CLK_CSSR_CSSD) {
+    _CLK_CSSR &= ~(_CLK_CSSR_CSSD | _CLK_CSSR_CSSDIE);
+    _CLK_CKDIVR = (CLK_HSIDIV_FAIL << 3) | CLK_CPUDIV;
+    s_status = CLK_ERR_CSS;
+  }
+
+} // CLK_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
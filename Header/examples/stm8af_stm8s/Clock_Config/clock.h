@@ -0,0 +1,111 @@
+/**
+  \file clock.h
+
+  \brief declaration of clock tree configuration
+
+  Configure master clock source (HSI or HSE), clock dividers, clock security
+  system (CSS) and peripheral clock gating from compile-time settings. The
+  resulting CPU clock is exported as constant F_CPU for all other modules.
+
+  Include this header at the end of main.h, after the clock settings. Then
+  all modules which include main.h use the same F_CPU.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// frequency of external crystal/clock. 0=use internal 16MHz RC (HSI)
+#if !defined(CLK_HSE)
+  #define CLK_HSE           0             ///< HSE frequency [Hz] or 0
+#endif
+
+// HSI prescaler 2^n (0..3), only used for HSI
+#if !defined(CLK_HSIDIV)
+  #define CLK_HSIDIV        0             ///< HSI divider exponent
+#endif
+
+// CPU prescaler 2^n (0..7)
+#if !defined(CLK_CPUDIV)
+  #define CLK_CPUDIV        0             ///< CPU divider exponent
+#endif
+
+// enable clock security system (only for HSE)
+#if !defined(CLK_CSS)
+  #define CLK_CSS           1             ///< 1=enable CSS
+#endif
+
+// max. polls for HSE startup and clock switch
+#if !defined(CLK_TIMEOUT)
+  #define CLK_TIMEOUT       0xFFFF        ///< switch timeout [polls]
+#endif
+
+// peripheral clocks: low byte = PCKENR1, high byte = PCKENR2
+#define CLK_USE_I2C         0x0001        ///< I2C
+#define CLK_USE_SPI         0x0002        ///< SPI
+#define CLK_USE_UART1       0x0004        ///< UART1
+#define CLK_USE_UART2       0x0008        ///< UART2/UART3/UART4, depending on device
+#define CLK_USE_TIM4        0x0010        ///< TIM4/TIM6
+#define CLK_USE_TIM2        0x0020        ///< TIM2/TIM5
+#define CLK_USE_TIM3        0x0040        ///< TIM3
+#define CLK_USE_TIM1        0x0080        ///< TIM1
+#define CLK_USE_AWU         0x0400        ///< AWU
+#define CLK_USE_ADC         0x0800        ///< ADC1/ADC2
+#define CLK_USE_CAN         0x8000        ///< beCAN
+#define CLK_USE_ALL         0x8CFF        ///< all peripherals (reset state)
+
+// used peripherals. Clocks of all others are disabled to save current
+#if !defined(CLK_PERIPH)
+  #define CLK_PERIPH        CLK_USE_ALL   ///< used peripherals
+#endif
+
+/// master clock frequency [Hz]
+#if CLK_HSE
+  #define F_MASTER          (CLK_HSE)
+#else
+  #define F_MASTER          (16000000L >> CLK_HSIDIV)
+#endif
+
+/// CPU and peripheral clock frequency [Hz]
+#define F_CPU               (F_MASTER >> CLK_CPUDIV)
+
+// return codes
+#define CLK_OK              0             ///< clock configured as requested
+#define CLK_ERR_HSE         1             ///< HSE not ready or switch timeout, still on HSI
+#define CLK_ERR_CSS         2             ///< HSE failed at runtime, switched back to HSI
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+ISR_HANDLER(CLK_ISR, __CLK_VECTOR__);
+
+/// configure clock tree and peripheral clock gating. Return CLK_OK or CLK_ERR_HSE
+uint8_t   clk_init(void);
+
+/// get actual CPU clock [Hz]. Differs from F_CPU after HSE failure
+uint32_t  clk_fcpu(void);
+
+/// get clock status, i.e. CLK_OK, CLK_ERR_HSE or CLK_ERR_CSS
+uint8_t   clk_status(void);
+
+/// enable peripheral clocks (CLK_USE_xxx) at runtime
+void      clk_enable(uint16_t periph);
+
+/// disable peripheral clocks (CLK_USE_xxx) at runtime
+void      clk_disable(uint16_t periph);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _CLOCK_H_
@@ -0,0 +1,84 @@
+/**********************
+  STM8 clock tree configuration
+  Demonstrate HSE switch, clock security system and peripheral clock gating
+
+  Functionality:
+  - switch to 16MHz HSE with timeout, stay on HSI if crystal fails to start
+  - enable clock security system. On HSE failure continue with HSI
+  - enable only clocks of used peripherals (UART2, TIM4)
+  - derive UART2 baudrate and TIM4 period from F_CPU at compile time
+  - print clock status and actual CPU clock via UART2 every 1s
+
+  Boards:
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"         // includes clock.h (declares CLK_ISR)
+
+// define communication speed
+#define BAUDRATE   9600
+
+// UART2 baudrate divider
+#define BRR        ((F_CPU + BAUDRATE/2) / BAUDRATE)
+
+// TIM4 period 1ms with prescaler 2^7
+#define TIM4_ARR   (F_CPU / 128L / 1000L - 1)
+#if (TIM4_ARR < 1) || (TIM4_ARR > 255)
+  #error TIM4_ARR out of range for F_CPU
+#endif
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint8_t   result;
+  uint16_t  ms = 0;
+
+  ////
+  // initialization
+  ////
+
+  // configure clock tree before any other peripheral
+  result = clk_init();
+
+  // set UART2 baudrate (note: BRR2 must be written before BRR1!)
+  _UART2_BRR2 = (uint8_t) (((BRR & 0xF000) >> 8) | (BRR & 0x000F));
+  _UART2_BRR1 = (uint8_t) ((BRR & 0x0FF0) >> 4);
+
+  // enable UART2 sender
+  _UART2_CR2 |= _UART2_CR2_TEN;
+
+  // TIM4 1ms period (polled)
+  _TIM4_PSCR = 7;
+  _TIM4_ARR  = TIM4_ARR;
+  _TIM4_CR   = _TIM4_CR_ARPE | _TIM4_CR_CEN;
+
+  // enable interrupts (for CSS)
+  ENABLE_INTERRUPTS();
+
+  printf("\nclk_init: %s\n", (result == CLK_OK) ? "HSE" : "HSE failed, HSI");
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // wait for 1ms tick
+    while (!(_TIM4_SR & _TIM4_SR_UIF));
+    _TIM4_SR = 0x00;
+
+    // print status every 1s
+    if (++ms == 1000) {
+      ms = 0;
+      printf("status %d, f_cpu %ldHz (F_CPU %ldHz)\n", (int) clk_status(), (long) clk_fcpu(), (long) F_CPU);
+    }
+
+  } // main loop
+
+} // main()
@@ -0,0 +1,20 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8S105K6.h"	// sduino-uno (https://github.com/roybaer/sduino_uno)
+#include "stdio.h"
+
+
+/*----------------------------------------------------------
+    CLOCK CONFIGURATION
+----------------------------------------------------------*/
+
+// 16MHz crystal. Without crystal CPU keeps running on HSI with same clock
+#define CLK_HSE         16000000L
+#define CLK_CPUDIV      0
+
+// only clock used peripherals
+#define CLK_PERIPH      (CLK_USE_UART2 | CLK_USE_TIM4)
+
+// clock module exports F_CPU for all modules
+#include "clock.h"
@@ -0,0 +1,620 @@
+/**
+  \file eeprom_kv.c
+
+  \brief implementation of wear-leveled key-value store in data EEPROM
+
+  EEPROM layout: the store is split into 2 banks of KV_EEPROM_SIZE/2 bytes.
+  Each bank starts with a 4B header containing a magic byte and a 16b
+  generation counter. The bank with the highest valid generation is active.
+  The header is followed by the record log. Each record consists of a 4B
+  header (key, length, generation tag, checksum) followed by the value,
+  padded to 4B. All writes are 4B aligned, so each word costs only one
+  program cycle in word programming mode.
+
+  A record is only valid if its tag matches the bank generation and its
+  checksum is correct. The first invalid record marks the end of the log.
+  Record data is written before the record header, and a new bank header is
+  written only after all live records were copied. A reset during a write
+  therefore loses at most the record currently being written.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "eeprom_kv.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if ((KV_EEPROM_START % 4) != 0) || ((KV_EEPROM_SIZE % 8) != 0)
+  #error KV_EEPROM_START must be multiple of 4, KV_EEPROM_SIZE multiple of 8
+#endif
+#if (KV_MAX_KEYS > 254) || (KV_MAX_LEN > 252)
+  #error KV_MAX_KEYS or KV_MAX_LEN too large
+#endif
+
+#define KV_BANK_SIZE      (KV_EEPROM_SIZE/2)                                ///< size [B] of one bank
+#define KV_BANK_ADDR(b)   ((uint16_t) (KV_EEPROM_START + (b)*KV_BANK_SIZE))   ///< start address of bank
+#define KV_MAGIC          0x4B                                              ///< magic byte of bank header ('K')
+#define KV_HDR_SIZE       4                                                 ///< size [B] of bank and record headers
+#define KV_REC_SIZE(len)  (KV_HDR_SIZE + (((len)+3) & ~3))                  ///< size [B] of record incl. padding
+#define KV_BYTE(addr)     (*((volatile uint8_t*) (addr)))                   ///< access EEPROM byte
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// value buffered in RAM until next kv_flush()
+typedef struct {
+  uint8_t   key;                  ///< key (0=unused)
+  uint8_t   len;                  ///< length of value (0=delete key)
+  uint8_t   data[KV_MAX_LEN];     ///< value
+} kv_cache_t;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+static uint8_t     s_bank;                    ///< active bank (0 or 1)
+static uint16_t    s_gen;                     ///< generation of active bank
+static uint16_t    s_end;                     ///< offset of next free record in active bank
+static uint16_t    s_index[KV_MAX_KEYS];      ///< record offset per key in active bank (0=not stored)
+static kv_cache_t  s_cache[KV_CACHE_SIZE];    ///< write buffer
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn uint8_t kv_checksum(const uint8_t *hdr, const uint8_t *data, uint8_t len)
+
+  \brief calculate record checksum
+
+  \param[in]  hdr    first 3B of record header (key, len, tag)
+  \param[in]  data   value (in RAM or EEPROM)
+  \param[in]  len    length of value
+
+  \return checksum over header and value
+*/
+static uint8_t kv_checksum(const uint8_t *hdr, const uint8_t *data, uint8_t len) {
+
+  uint8_t  chk = 0xA5;
+  uint8_t  i;
+
+  // rotate & XOR, detects swapped and zeroed bytes
+  for (i=0; i<3; i++)
+    chk = (uint8_t) ((chk << 1) | (chk >> 7)) ^ hdr[i];
+  for (i=0; i<len; i++)
+    chk = (uint8_t) ((chk << 1) | (chk >> 7)) ^ data[i];
+
+  return(chk);
+
+} // kv_checksum
+
+
+
+/**
+  \fn void kv_unlock(void)
+
+  \brief unlock write access to data EEPROM
+*/
+static void kv_unlock(void) {
+
+  _FLASH_DUKR = 0xAE;               // unlock w/e access to EEPROM
+  _FLASH_DUKR = 0x56;
+  while (!(_FLASH_IAPSR & _FLASH_IAPSR_DUL));
+
+} // kv_unlock
+
+
+
+/**
+  \fn void kv_lock(void)
+
+  \brief lock write access to data EEPROM
+*/
+static void kv_lock(void) {
+
+  _FLASH_IAPSR &= ~_FLASH_IAPSR_DUL;
+
+} // kv_lock
+
+
+
+/**
+  \fn void kv_write_word(uint16_t addr, const uint8_t *word)
+
+  \brief write 4B to EEPROM (EEPROM must be unlocked)
+
+  \param[in]  addr   EEPROM address (multiple of 4)
+  \param[in]  word   data to write
+
+  Write aligned 4B to EEPROM. Words which are already up to date are
+  skipped to avoid an unnecessary erase/program cycle.
+*/
+static void kv_write_word(uint16_t addr, const uint8_t *word) {
+
+  uint8_t  i;
+
+  // skip if EEPROM already contains data
+  for (i=0; (i<4) && (KV_BYTE(addr+i) == word[i]); i++);
+  if (i == 4)
+    return;
+
+#if KV_WORD_PROGRAM
+
+  // enable word programming (CR2 and NCR2 must be complementary)
+  _FLASH_CR2  |=  _FLASH_CR2_WPRG;
+  _FLASH_NCR2 &= ~_FLASH_CR2_WPRG;
+
+  // write 4B, then programming starts automatically
+  KV_BYTE(addr)   = word[0];
+  KV_BYTE(addr+1) = word[1];
+  KV_BYTE(addr+2) = word[2];
+  KV_BYTE(addr+3) = word[3];
+  while (!(_FLASH_IAPSR & _FLASH_IAPSR_EOP));
+
+#else // KV_WORD_PROGRAM
+
+  // byte programming, only write changed bytes
+  for (i=0; i<4; i++) {
+    if (KV_BYTE(addr+i) != word[i]) {
+      KV_BYTE(addr+i) = word[i];
+      while (!(_FLASH_IAPSR & _FLASH_IAPSR_EOP));
+    }
+  }
+
+#endif // KV_WORD_PROGRAM
+
+} // kv_write_word
+
+
+
+/**
+  \fn uint16_t kv_append(uint8_t bank, uint16_t offset, uint8_t key, const uint8_t *data, uint8_t len, uint8_t tag)
+
+  \brief append record to bank (EEPROM must be unlocked)
+
+  \param[in]  bank     bank to write to
+  \param[in]  offset   offset of record in bank
+  \param[in]  key      key of record
+  \param[in]  data     value (in RAM)
+  \param[in]  len      length of value
+  \param[in]  tag      generation tag of bank
+
+  \return offset of next record
+
+  Write record value first and record header last, so that an interrupted
+  write leaves an invalid record.
+*/
+static uint16_t kv_append(uint8_t bank, uint16_t offset, uint8_t key, const uint8_t *data, uint8_t len, uint8_t tag) {
+
+  uint16_t  addr = KV_BANK_ADDR(bank) + offset;
+  uint8_t   word[4];
+  uint8_t   i, j;
+
+  // write value in 4B words, pad with 0x00
+  for (i=0; i<len; i+=4) {
+    for (j=0; j<4; j++)
+      word[j] = ((i+j) < len) ? data[i+j] : 0x00;
+    kv_write_word(addr+KV_HDR_SIZE+i, word);
+  }
+
+  // write record header
+  word[0] = key;
+  word[1] = len;
+  word[2] = tag;
+  word[3] = kv_checksum(word, data, len);
+  kv_write_word(addr, word);
+
+  // return offset of next record
+  return(offset + KV_REC_SIZE(len));
+
+} // kv_append
+
+
+
+/**
+  \fn uint8_t kv_read_bank(uint8_t bank, uint16_t *gen)
+
+  \brief read generation of bank
+
+  \param[in]  bank   bank to check
+  \param[out] gen    generation of bank
+
+  \return 1 if bank header is valid, else 0
+*/
+static uint8_t kv_read_bank(uint8_t bank, uint16_t *gen) {
+
+  uint16_t  addr = KV_BANK_ADDR(bank);
+
+  if ((KV_BYTE(addr) != KV_MAGIC) || (KV_BYTE(addr+3) != (uint8_t) ~(KV_MAGIC ^ KV_BYTE(addr+1) ^ KV_BYTE(addr+2))))
+    return(0);
+  *gen = ((uint16_t) KV_BYTE(addr+2) << 8) | KV_BYTE(addr+1);
+  return(1);
+
+} // kv_read_bank
+
+
+
+/**
+  \fn void kv_write_bank(uint8_t bank, uint16_t gen)
+
+  \brief write bank header (EEPROM must be unlocked)
+
+  \param[in]  bank   bank to write to
+  \param[in]  gen    generation of bank
+*/
+static void kv_write_bank(uint8_t bank, uint16_t gen) {
+
+  uint8_t  word[4];
+
+  word[0] = KV_MAGIC;
+  word[1] = (uint8_t) gen;
+  word[2] = (uint8_t) (gen >> 8);
+  word[3] = (uint8_t) ~(KV_MAGIC ^ word[1] ^ word[2]);
+  kv_write_word(KV_BANK_ADDR(bank), word);
+
+} // kv_write_bank
+
+
+
+/**
+  \fn kv_cache_t *kv_cache_find(uint8_t key)
+
+  \brief find buffered value for key
+
+  \param[in]  key   key to search
+
+  \return pointer to cache entry, or NULL if not buffered
+*/
+static kv_cache_t *kv_cache_find(uint8_t key) {
+
+  uint8_t  i;
+
+  for (i=0; i<KV_CACHE_SIZE; i++) {
+    if (s_cache[i].key == key)
+      return(&(s_cache[i]));
+  }
+  return(NULL);
+
+} // kv_cache_find
+
+
+
+/**
+  \fn uint8_t kv_compact(void)
+
+  \brief copy live values to other bank (EEPROM must be unlocked)
+
+  \return KV_OK or KV_ERR_FULL
+
+  Copy latest value of all keys, incl. buffered values, to the inactive
+  bank and activate it. Deleted keys are dropped.
+*/
+static uint8_t kv_compact(void) {
+
+  uint8_t      bank = s_bank ^ 0x01;
+  uint16_t     gen = s_gen + 1;
+  uint16_t     offset = KV_HDR_SIZE;
+  uint8_t      buf[KV_MAX_LEN];
+  const uint8_t *data;
+  kv_cache_t   *entry;
+  uint8_t      key, len, i;
+
+  // check if all live values fit into new bank. On error old bank remains active
+  for (key=1; key<=KV_MAX_KEYS; key++) {
+    entry = kv_cache_find(key);
+    if (entry != NULL)
+      len = entry->len;
+    else if (s_index[key-1] != 0)
+      len = KV_BYTE(KV_BANK_ADDR(s_bank) + s_index[key-1] + 1);
+    else
+      continue;
+    if (len != 0)
+      offset += KV_REC_SIZE(len);
+  }
+  if (offset > KV_BANK_SIZE)
+    return(KV_ERR_FULL);
+  offset = KV_HDR_SIZE;
+
+  // copy all live values to new bank
+  for (key=1; key<=KV_MAX_KEYS; key++) {
+
+    // get latest value from write buffer or from active bank
+    entry = kv_cache_find(key);
+    if (entry != NULL) {
+      len  = entry->len;
+      data = entry->data;
+    }
+    else if (s_index[key-1] != 0) {
+      len = KV_BYTE(KV_BANK_ADDR(s_bank) + s_index[key-1] + 1);
+      for (i=0; i<len; i++)
+        buf[i] = KV_BYTE(KV_BANK_ADDR(s_bank) + s_index[key-1] + KV_HDR_SIZE + i);
+      data = buf;
+    }
+    else
+      continue;
+
+    // drop deleted keys
+    if (len == 0) {
+      s_index[key-1] = 0;
+      continue;
+    }
+
+    // copy value to new bank
+    s_index[key-1] = offset;
+    offset = kv_append(bank, offset, key, data, len, (uint8_t) gen);
+
+  } // loop over keys
+
+  // activate new bank
+  kv_write_bank(bank, gen);
+  s_bank = bank;
+  s_gen  = gen;
+  s_end  = offset;
+
+  // all buffered values are stored now
+  for (i=0; i<KV_CACHE_SIZE; i++)
+    s_cache[i].key = 0;
+
+  return(KV_OK);
+
+} // kv_compact
+
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn uint8_t kv_init(void)
+
+  \brief init key-value store
+
+  \return number of stored keys
+
+  Select active bank and scan record log to build RAM index. Format
+  EEPROM if no valid bank exists.
+*/
+uint8_t kv_init(void) {
+
+  uint16_t  gen0, gen1, addr, offset;
+  uint8_t   valid0, valid1;
+  uint8_t   hdr[4];
+  uint8_t   i, numKeys;
+
+  // select bank with newest generation (handle overflow)
+  valid0 = kv_read_bank(0, &gen0);
+  valid1 = kv_read_bank(1, &gen1);
+  if (valid0 && valid1)
+    s_bank = ((int16_t) (gen1 - gen0) > 0) ? 1 : 0;
+  else if (valid0 || valid1)
+    s_bank = valid1;
+
+  // no valid bank -> format bank 0 with empty log
+  else {
+    hdr[0] = hdr[1] = hdr[2] = hdr[3] = 0x00;
+    kv_unlock();
+    kv_write_word(KV_BANK_ADDR(0) + KV_HDR_SIZE, hdr);
+    kv_write_bank(0, 0);
+    kv_lock();
+    s_bank = 0;
+    gen0 = 0;
+  }
+  s_gen = (s_bank == 0) ? gen0 : gen1;
+
+  // clear index and write buffer
+  for (i=0; i<KV_MAX_KEYS; i++)
+    s_index[i] = 0;
+  for (i=0; i<KV_CACHE_SIZE; i++)
+    s_cache[i].key = 0;
+
+  // scan record log until first invalid record. Newer records overwrite older ones
+  offset = KV_HDR_SIZE;
+  while (offset + KV_HDR_SIZE <= KV_BANK_SIZE) {
+    addr = KV_BANK_ADDR(s_bank) + offset;
+    for (i=0; i<4; i++)
+      hdr[i] = KV_BYTE(addr+i);
+    if ((hdr[0] == 0) || (hdr[0] > KV_MAX_KEYS) || (hdr[1] > KV_MAX_LEN) || (hdr[2] != (uint8_t) s_gen))
+      break;
+    if (offset + KV_REC_SIZE(hdr[1]) > KV_BANK_SIZE)
+      break;
+    if (hdr[3] != kv_checksum(hdr, (const uint8_t*) (addr+KV_HDR_SIZE), hdr[1]))
+      break;
+    s_index[hdr[0]-1] = (hdr[1] != 0) ? offset : 0;
+    offset += KV_REC_SIZE(hdr[1]);
+  }
+  s_end = offset;
+
+  // count stored keys
+  numKeys = 0;
+  for (i=0; i<KV_MAX_KEYS; i++) {
+    if (s_index[i] != 0)
+      numKeys++;
+  }
+
+  return(numKeys);
+
+} // kv_init
+
+
+
+/**
+  \fn uint8_t kv_get(uint8_t key, void *buf, uint8_t maxLen)
+
+  \brief read value of key
+
+  \param[in]  key      key to read (1..KV_MAX_KEYS)
+  \param[out] buf      buffer for value
+  \param[in]  maxLen   size of buffer
+
+  \return length of value, or 0 if key not stored
+
+  Read latest value from write buffer or EEPROM. Copy at most maxLen bytes.
+*/
+uint8_t kv_get(uint8_t key, void *buf, uint8_t maxLen) {
+
+  kv_cache_t  *entry;
+  uint16_t    addr;
+  uint8_t     len, i;
+
+  // check key
+  if ((key == 0) || (key > KV_MAX_KEYS))
+    return(0);
+
+  // value is buffered in RAM
+  entry = kv_cache_find(key);
+  if (entry != NULL) {
+    len = entry->len;
+    for (i=0; (i<len) && (i<maxLen); i++)
+      ((uint8_t*) buf)[i] = entry->data[i];
+    return(len);
+  }
+
+  // value is stored in EEPROM
+  if (s_index[key-1] == 0)
+    return(0);
+  addr = KV_BANK_ADDR(s_bank) + s_index[key-1];
+  len  = KV_BYTE(addr+1);
+  for (i=0; (i<len) && (i<maxLen); i++)
+    ((uint8_t*) buf)[i] = KV_BYTE(addr+KV_HDR_SIZE+i);
+
+  return(len);
+
+} // kv_get
+
+
+
+/**
+  \fn uint8_t kv_set(uint8_t key, const void *data, uint8_t len)
+
+  \brief buffer new value for key
+
+  \param[in]  key    key to write (1..KV_MAX_KEYS)
+  \param[in]  data   new value
+  \param[in]  len    length of value (0=delete key)
+
+  \return KV_OK or error code
+
+  Store value in RAM write buffer. Repeated writes to the same key before
+  kv_flush() are coalesced into one EEPROM write. If the buffer is full,
+  it is flushed first.
+*/
+uint8_t kv_set(uint8_t key, const void *data, uint8_t len) {
+
+  kv_cache_t  *entry;
+  uint8_t     i, result;
+
+  // check parameters
+  if ((key == 0) || (key > KV_MAX_KEYS))
+    return(KV_ERR_KEY);
+  if (len > KV_MAX_LEN)
+    return(KV_ERR_LEN);
+
+  // overwrite pending value, else use free entry. If buffer is full, flush it
+  entry = kv_cache_find(key);
+  if (entry == NULL)
+    entry = kv_cache_find(0);
+  if (entry == NULL) {
+    result = kv_flush();
+    if (result != KV_OK)
+      return(result);
+    entry = &(s_cache[0]);
+  }
+
+  // buffer value
+  entry->key = key;
+  entry->len = len;
+  for (i=0; i<len; i++)
+    entry->data[i] = ((const uint8_t*) data)[i];
+
+  return(KV_OK);
+
+} // kv_set
+
+
+
+/**
+  \fn uint8_t kv_flush(void)
+
+  \brief write buffered values to EEPROM
+
+  \return KV_OK or error code
+
+  Append buffered values to the active bank. Values identical to the stored
+  ones are skipped. If the bank is full, live values are copied to the other bank.
+*/
+uint8_t kv_flush(void) {
+
+  kv_cache_t  *entry;
+  uint16_t    addr;
+  uint8_t     i, j, len, result = KV_OK;
+
+  kv_unlock();
+
+  for (i=0; i<KV_CACHE_SIZE; i++) {
+
+    entry = &(s_cache[i]);
+    if (entry->key == 0)
+      continue;
+
+    // skip write if value is unchanged
+    if (s_index[entry->key-1] == 0)
+      len = 0;
+    else {
+      addr = KV_BANK_ADDR(s_bank) + s_index[entry->key-1];
+      len  = KV_BYTE(addr+1);
+      for (j=0; (j<len) && (KV_BYTE(addr+KV_HDR_SIZE+j) == entry->data[j]); j++);
+      if (j != len)
+        len = 0xFF;
+    }
+    if (len == entry->len) {
+      entry->key = 0;
+      continue;
+    }
+
+    // bank full -> copy all live values incl. buffered ones to other bank
+    if (s_end + KV_REC_SIZE(entry->len) > KV_BANK_SIZE) {
+      result = kv_compact();
+      break;
+    }
+
+    // append record and update index
+    s_index[entry->key-1] = (entry->len != 0) ? s_end : 0;
+    s_end = kv_append(s_bank, s_end, entry->key, entry->data, entry->len, (uint8_t) s_gen);
+    entry->key = 0;
+
+  } // loop over buffered values
+
+  kv_lock();
+
+  return(result);
+
+} // kv_flush
+
+
+
+/**
+  \fn uint16_t kv_free(void)
+
+  \brief get free space in active bank
+
+  \return number of free bytes in active bank
+*/
+uint16_t kv_free(void) {
+
+  return(KV_BANK_SIZE - s_end);
+
+} // kv_free
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,83 @@
+/**
+  \file eeprom_kv.h
+
+  \brief declaration of wear-leveled key-value store in data EEPROM
+
+  Log-structured key-value store in data EEPROM. Values are appended as
+  records instead of being rewritten in place. The EEPROM is split into two
+  banks, and live records are copied to the other bank once the active
+  bank is full. An index in RAM is built by kv_init() and gives O(1) lookup.
+  Writes are buffered in RAM via kv_set() and committed via kv_flush().
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _EEPROM_KV_H_
+#define _EEPROM_KV_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// EEPROM area used for key-value store. Default is complete data EEPROM
+#if !defined(KV_EEPROM_START)
+  #define KV_EEPROM_START     STM8_EEPROM_START     ///< first address of key-value store (multiple of 4)
+#endif
+#if !defined(KV_EEPROM_SIZE)
+  #define KV_EEPROM_SIZE      STM8_EEPROM_SIZE      ///< size [B] of key-value store (multiple of 8)
+#endif
+
+// size of RAM index and write buffer
+#if !defined(KV_MAX_KEYS)
+  #define KV_MAX_KEYS         32                    ///< number of keys (valid keys are 1..KV_MAX_KEYS)
+#endif
+#if !defined(KV_MAX_LEN)
+  #define KV_MAX_LEN          16                    ///< max. length [B] of a value
+#endif
+#if !defined(KV_CACHE_SIZE)
+  #define KV_CACHE_SIZE       4                     ///< number of values buffered in RAM until kv_flush()
+#endif
+
+// use word programming (4B per cycle). Supported by STM8S and STM8AF data EEPROM
+#if !defined(KV_WORD_PROGRAM)
+  #define KV_WORD_PROGRAM     1                     ///< 1=word programming, 0=byte programming
+#endif
+
+// return codes
+#define KV_OK                 0                     ///< operation successful
+#define KV_ERR_KEY            1                     ///< key out of range
+#define KV_ERR_LEN            2                     ///< value too long
+#define KV_ERR_FULL           3                     ///< live values don't fit into a bank
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// scan EEPROM and build RAM index. Return number of stored keys
+uint8_t   kv_init(void);
+
+/// read value for key to buffer. Return length of value (0=not found)
+uint8_t   kv_get(uint8_t key, void *buf, uint8_t maxLen);
+
+/// buffer new value for key in RAM (len=0 deletes key). Return KV_OK or error code
+uint8_t   kv_set(uint8_t key, const void *data, uint8_t len);
+
+/// write buffered values to EEPROM. Return KV_OK or error code
+uint8_t   kv_flush(void);
+
+/// get number of free bytes in active bank
+uint16_t  kv_free(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _EEPROM_KV_H_
@@ -0,0 +1,112 @@
+/**********************
+  STM8 wear-leveled key-value store in data EEPROM
+  Demonstrate log-structured EEPROM access with word programming
+
+  Functionality:
+  - init FCPU to 16MHz
+  - init UART2
+  - no interrupts
+  - build RAM index of key-value store at startup
+  - on byte received via UART2
+    - if 'r' print all stored keys
+    - if 'f' write buffered values to EEPROM
+    - if 'c' increase boot counter (key 1) and flush
+    - else save received byte as value of key 2 (buffered)
+
+  Boards:
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"         // sduino-UNO
+#include "eeprom_kv.h"    // key-value store in EEPROM
+
+// define communication speed
+#define BAUDRATE   9600
+
+// keys used in this example
+#define KEY_COUNTER   1     // 32-bit counter
+#define KEY_CHAR      2     // last received character
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint16_t  BRR;
+  uint32_t  counter;
+  uint8_t   buf[KV_MAX_LEN];
+  uint8_t   key, len, i;
+
+  ////
+  // initialization
+  ////
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // set UART2 baudrate (note: BRR2 must be written before BRR1!)
+  BRR = (uint16_t) (((uint32_t) 16000000L)/BAUDRATE);
+  _UART2_BRR2 = (uint8_t) (((BRR & 0xF000) >> 8) | (BRR & 0x000F));
+  _UART2_BRR1 = (uint8_t) ((BRR & 0x0FF0) >> 4);
+
+  // enable UART2 receiver & sender
+  _UART2_CR2 |= (_UART2_CR2_REN | _UART2_CR2_TEN);
+
+  // build RAM index of key-value store
+  printf("found %d keys, %d bytes free\n", (int) kv_init(), (int) kv_free());
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // if byte received, execute command
+    if (_UART2_SR & _UART2_SR_RXNE) {
+
+      // read byte from receive buffer
+      uint8_t c = _UART2_DR;
+
+      // print all stored keys
+      if (c == 'r') {
+        for (key=1; key<=KV_MAX_KEYS; key++) {
+          len = kv_get(key, buf, sizeof(buf));
+          if (len == 0)
+            continue;
+          printf("key %d:", (int) key);
+          for (i=0; i<len; i++)
+            printf(" %02x", (int) buf[i]);
+          printf("\n");
+        }
+        printf("%d bytes free\n", (int) kv_free());
+      }
+
+      // write buffered values to EEPROM
+      else if (c == 'f') {
+        printf("flush ... %d\n", (int) kv_flush());
+      }
+
+      // increase counter and store immediately
+      else if (c == 'c') {
+        counter = 0;
+        kv_get(KEY_COUNTER, &counter, sizeof(counter));
+        counter++;
+        kv_set(KEY_COUNTER, &counter, sizeof(counter));
+        printf("counter %ld ... %d\n", (long) counter, (int) kv_flush());
+      }
+
+      // buffer last character. Repeated writes are coalesced until flush
+      else {
+        kv_set(KEY_CHAR, &c, 1);
+        printf("buffered '%c'\n", c);
+      }
+
+    } // byte received
+
+  } // main loop
+
+} // main()
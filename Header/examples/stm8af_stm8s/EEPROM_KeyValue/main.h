@@ -0,0 +1,5 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8S105K6.h"
+#include <stdio.h>
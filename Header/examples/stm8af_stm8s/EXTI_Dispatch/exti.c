@@ -0,0 +1,384 @@
+/**
+  \file exti.c
+
+  \brief implementation of external interrupt dispatcher
+
+  Port sensitivity is set to both edges, and the edge filter of each handler
+  is applied in software. This allows handlers with different edges on the
+  same port, as _EXTI only supports one sensitivity per port.
+
+  The handler table is sorted by priority on attach, and each port ISR only
+  evaluates the pins which changed since the last interrupt. Debounced pins
+  are masked in _PORTx_CR2 after the first edge, i.e. bouncing causes no
+  further interrupts. After the debounce time the pin is unmasked and its
+  handler is called if the stable state differs from the last one.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "exti.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// number of ports with external interrupt
+#define EXTI_PORTS          5
+
+// port registers via port index (5 registers per port, starting with port A)
+#define EXTI_IDR(port)      _SFR(uint8_t, PORTA_AddressBase + 0x05*(port) + 0x01)
+#define EXTI_CR2(port)      _SFR(uint8_t, PORTA_AddressBase + 0x05*(port) + 0x04)
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL TYPES
+-----------------------------------------------------------------------------*/
+
+// entry of handler table
+typedef struct {
+  uint8_t         port;       // port index
+  uint8_t         mask;       // pin bit mask
+  uint8_t         flags;      // edge and debounce flags
+  uint8_t         prio;       // priority (0=highest)
+  exti_handler_t  handler;    // handler function
+} exti_entry_t;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// pin number to bit mask. Avoid slow variable shift
+static const uint8_t  s_pinMask[8] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+
+// handler table, sorted by priority
+static exti_entry_t   s_entry[EXTI_MAX_HANDLERS];
+static uint8_t        s_num;
+
+// last (debounced) input state and attached pins per port
+static uint8_t        s_last[EXTI_PORTS];
+static uint8_t        s_used[EXTI_PORTS];
+
+#if (EXTI_DEBOUNCE_MS > 0)
+
+  // debounced pins, masked pins and remaining debounce time per port
+  static uint8_t            s_debounce[EXTI_PORTS];
+  static uint8_t            s_masked[EXTI_PORTS];
+  static volatile uint8_t   s_timer[EXTI_PORTS];
+
+#endif // EXTI_DEBOUNCE_MS
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void exti_dispatch(uint8_t port, uint8_t changed, uint8_t idr)
+
+  \brief call handlers of changed pins in priority order
+
+  \param[in]  port      port index
+  \param[in]  changed   bit mask of changed pins
+  \param[in]  idr       new input state of port
+*/
+static void exti_dispatch(uint8_t port, uint8_t changed, uint8_t idr) {
+
+  exti_entry_t  *e = s_entry;
+  uint8_t       i;
+
+  for (i=0; i<s_num; i++, e++) {
+
+    // skip other ports and unchanged pins
+    if ((e->port != port) || (!(changed & e->mask)))
+      continue;
+
+    // apply edge filter
+    if (idr & e->mask) {
+      if (e->flags & EXTI_RISING)
+        e->handler(1);
+    }
+    else {
+      if (e->flags & EXTI_FALLING)
+        e->handler(0);
+    }
+
+  } // loop i
+
+} // exti_dispatch
+
+
+
+/**
+  \fn void exti_port(uint8_t port, uint8_t idr)
+
+  \brief evaluate port interrupt
+
+  \param[in]  port      port index
+  \param[in]  idr       input state of port, read in ISR
+
+  Find changed pins via XOR with last state. Start debouncing of changed
+  debounced pins and dispatch all other pins immediately.
+*/
+static void exti_port(uint8_t port, uint8_t idr) {
+
+  uint8_t   changed = (idr ^ s_last[port]) & s_used[port];
+
+  #if (EXTI_DEBOUNCE_MS > 0)
+    uint8_t   bounce = changed & s_debounce[port] & ~s_masked[port];
+
+    // mask debounced pins and (re-)start debounce timer. Already masked pins are evaluated by exti_tick()
+    if (bounce) {
+      EXTI_CR2(port) &= ~bounce;
+      s_masked[port] |= bounce;
+      s_timer[port] = EXTI_DEBOUNCE_MS;
+    }
+    changed &= ~s_debounce[port];
+  #endif // EXTI_DEBOUNCE_MS
+
+  // store new state of non-debounced pins and call handlers
+  if (changed) {
+    s_last[port] ^= changed;
+    exti_dispatch(port, changed, idr);
+  }
+
+} // exti_port
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn uint8_t exti_attach(uint8_t port, uint8_t pin, uint8_t flags, uint8_t prio, exti_handler_t handler)
+
+  \brief attach handler to pin
+
+  \param[in]  port      port index (EXTI_PORTA..EXTI_PORTE)
+  \param[in]  pin       pin number (0..7)
+  \param[in]  flags     edges (EXTI_RISING, EXTI_FALLING, EXTI_BOTH), optionally | EXTI_DEBOUNCED
+  \param[in]  prio      priority, lower value is called first. Same priority in attach order
+  \param[in]  handler   function called on edge
+
+  \return EXTI_OK, EXTI_ERR_PARAM or EXTI_ERR_FULL
+
+  Pin must be configured as input by application. Sets port sensitivity to
+  both edges and enables the pin interrupt. As _EXTI_CRx can only be written
+  with interrupts disabled, call before ENABLE_INTERRUPTS().
+*/
+uint8_t exti_attach(uint8_t port, uint8_t pin, uint8_t flags, uint8_t prio, exti_handler_t handler) {
+
+  exti_entry_t  *e;
+  uint8_t       i;
+
+  // check parameters
+  if ((port >= EXTI_PORTS) || (!((EXTI_PORT_MASK >> port) & 0x01)) || (pin > 7) || (handler == 0))
+    return(EXTI_ERR_PARAM);
+  if (s_num >= EXTI_MAX_HANDLERS)
+    return(EXTI_ERR_FULL);
+
+  // sorted insert, after entries with same priority
+  for (i=s_num; (i > 0) && (s_entry[i-1].prio > prio); i--)
+    s_entry[i] = s_entry[i-1];
+  e = &(s_entry[i]);
+  e->port    = port;
+  e->mask    = s_pinMask[pin];
+  e->flags   = flags;
+  e->prio    = prio;
+  e->handler = handler;
+  s_num++;
+
+  // store current pin state as reference
+  s_used[port] |= e->mask;
+  s_last[port] = (s_last[port] & ~e->mask) | (EXTI_IDR(port) & e->mask);
+  #if (EXTI_DEBOUNCE_MS > 0)
+    if (flags & EXTI_DEBOUNCED)
+      s_debounce[port] |= e->mask;
+  #endif
+
+  // set port sensitivity to rising and falling edge (port A..D in CR1, port E in CR2)
+  if (port < EXTI_PORTE)
+    _EXTI_CR1 |= (uint8_t) (0x03 << (port << 1));
+  else
+    _EXTI_CR2 |= _EXTI_CR2_PEIS;
+
+  // enable pin interrupt
+  EXTI_CR2(port) |= e->mask;
+
+  return(EXTI_OK);
+
+} // exti_attach
+
+
+
+#if (EXTI_DEBOUNCE_MS > 0)
+
+/**
+  \fn void exti_tick(void)
+
+  \brief debounce timing
+
+  Call every 1ms from timer ISR. After debounce time unmask the pins and
+  call handlers of pins with changed stable state. Pins are unmasked before
+  reading the input, i.e. edges after the read trigger a new port interrupt.
+  Timer ISR must have same priority as port ISRs, as both modify the state.
+*/
+void exti_tick(void) {
+
+  uint8_t   port, masked, changed, idr;
+
+  for (port=0; port<EXTI_PORTS; port++) {
+
+    // skip idle ports
+    if ((s_timer[port] == 0) || (--s_timer[port] != 0))
+      continue;
+
+    // unmask pins, then read stable state
+    masked = s_masked[port];
+    s_masked[port] = 0;
+    EXTI_CR2(port) |= masked;
+    idr = EXTI_IDR(port);
+
+    // call handlers of pins with new stable state
+    changed = (idr ^ s_last[port]) & masked;
+    if (changed) {
+      s_last[port] ^= changed;
+      exti_dispatch(port, changed, idr);
+    }
+
+  } // loop port
+
+} // exti_tick
+
+#endif // EXTI_DEBOUNCE_MS
+
+
+
+#if (EXTI_PORT_MASK & 0x01)
+
+/**
+  \fn void PORTA_ISR(void)
+
+  \brief ISR for port A interrupt
+
+  Read input state and call pin handlers.
+  Notes:
+    - for Cosmic compiler need to declare as "@near @interrupt void PORTA_ISR(void)"
+    - for IAR compiler need to insert "#pragma vector = 2+__PORTA_VECTOR__" before ISR
+*/
+#if defined(_IAR_)
+  #pragma vector = 2+__PORTA_VECTOR__     // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(PORTA_ISR, __PORTA_VECTOR__) {
+
+  exti_port(EXTI_PORTA, _PORTA_IDR);
+
+} // PORTA_ISR
+
+#endif // port A
+
+
+
+#if (EXTI_PORT_MASK & 0x02)
+
+/**
+  \fn void PORTB_ISR(void)
+
+  \brief ISR for port B interrupt
+
+  Read input state and call pin handlers.
+  Notes:
+    - for Cosmic compiler need to declare as "@near @interrupt void PORTB_ISR(void)"
+    - for IAR compiler need to insert "#pragma vector = 2+__PORTB_VECTOR__" before ISR
+*/
+#if defined(_IAR_)
+  #pragma vector = 2+__PORTB_VECTOR__     // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(PORTB_ISR, __PORTB_VECTOR__) {
+
+  exti_port(EXTI_PORTB, _PORTB_IDR);
+
+} // PORTB_ISR
+
+#endif // port B
+
+
+
+#if (EXTI_PORT_MASK & 0x04)
+
+/**
+  \fn void PORTC_ISR(void)
+
+  \brief ISR for port C interrupt
+
+  Read input state and call pin handlers.
+  Notes:
+    - for Cosmic compiler need to declare as "@near @interrupt void PORTC_ISR(void)"
+    - for IAR compiler need to insert "#pragma vector = 2+__PORTC_VECTOR__" before ISR
+*/
+#if defined(_IAR_)
+  #pragma vector = 2+__PORTC_VECTOR__     // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(PORTC_ISR, __PORTC_VECTOR__) {
+
+  exti_port(EXTI_PORTC, _PORTC_IDR);
+
+} // PORTC_ISR
+
+#endif // port C
+
+
+
+#if (EXTI_PORT_MASK & 0x08)
+
+/**
+  \fn void PORTD_ISR(void)
+
+  \brief ISR for port D interrupt
+
+  Read input state and call pin handlers.
+  Notes:
+    - for Cosmic compiler need to declare as "@near @interrupt void PORTD_ISR(void)"
+    - for IAR compiler need to insert "#pragma vector = 2+__PORTD_VECTOR__" before ISR
+*/
+#if defined(_IAR_)
+  #pragma vector = 2+__PORTD_VECTOR__     // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(PORTD_ISR, __PORTD_VECTOR__) {
+
+  exti_port(EXTI_PORTD, _PORTD_IDR);
+
+} // PORTD_ISR
+
+#endif // port D
+
+
+
+#if (EXTI_PORT_MASK & 0x10)
+
+/**
+  \fn void PORTE_ISR(void)
+
+  \brief ISR for port E interrupt
+
+  Read input state and call pin handlers.
+  Notes:
+    - for Cosmic compiler need to declare as "@near @interrupt void PORTE_ISR(void)"
+    - for IAR compiler need to insert "#pragma vector = 2+__PORTE_VECTOR__" before ISR
+*/
+#if defined(_IAR_)
+  #pragma vector = 2+__PORTE_VECTOR__     // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(PORTE_ISR, __PORTE_VECTOR__) {
+
+  exti_port(EXTI_PORTE, _PORTE_IDR);
+
+} // PORTE_ISR
+
+#endif // port E
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,104 @@
+/**
+  \file exti.h
+
+  \brief declaration of external interrupt dispatcher
+
+  All pins of a port share one interrupt vector. The dispatcher keeps the
+  last input state of each port and finds the changed pins with a single XOR.
+  Handlers are attached per pin and edge, and are called in priority order.
+  Optionally pins are debounced: after an edge the pin interrupt is masked
+  for EXTI_DEBOUNCE_MS, then the stable pin state is evaluated.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _EXTI_H_
+#define _EXTI_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// ports served by dispatcher: bit 0=port A .. bit 4=port E. Other port vectors stay free for application
+#if !defined(EXTI_PORT_MASK)
+  #define EXTI_PORT_MASK    0x1F          ///< ports with dispatcher ISR
+#endif
+
+// max. number of attached handlers
+#if !defined(EXTI_MAX_HANDLERS)
+  #define EXTI_MAX_HANDLERS 8             ///< size of handler table
+#endif
+
+// debounce time in calls of exti_tick(). 0=no debounce support
+#if !defined(EXTI_DEBOUNCE_MS)
+  #define EXTI_DEBOUNCE_MS  20            ///< debounce time [ms]
+#endif
+
+// port index for exti_attach()
+#define EXTI_PORTA          0             ///< port A
+#define EXTI_PORTB          1             ///< port B
+#define EXTI_PORTC          2             ///< port C
+#define EXTI_PORTD          3             ///< port D
+#define EXTI_PORTE          4             ///< port E
+
+// flags for exti_attach()
+#define EXTI_RISING         0x01          ///< call handler on rising edge
+#define EXTI_FALLING        0x02          ///< call handler on falling edge
+#define EXTI_BOTH           0x03          ///< call handler on both edges
+#define EXTI_DEBOUNCED      0x04          ///< debounce pin (requires EXTI_DEBOUNCE_MS>0)
+
+// return codes
+#define EXTI_OK             0             ///< handler attached
+#define EXTI_ERR_PARAM      1             ///< invalid port or pin
+#define EXTI_ERR_FULL       2             ///< handler table full
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// pin handler, called from ISR with new pin state (0=low, 1=high)
+typedef void (*exti_handler_t)(uint8_t level);
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+#if (EXTI_PORT_MASK & 0x01)
+  ISR_HANDLER(PORTA_ISR, __PORTA_VECTOR__);
+#endif
+#if (EXTI_PORT_MASK & 0x02)
+  ISR_HANDLER(PORTB_ISR, __PORTB_VECTOR__);
+#endif
+#if (EXTI_PORT_MASK & 0x04)
+  ISR_HANDLER(PORTC_ISR, __PORTC_VECTOR__);
+#endif
+#if (EXTI_PORT_MASK & 0x08)
+  ISR_HANDLER(PORTD_ISR, __PORTD_VECTOR__);
+#endif
+#if (EXTI_PORT_MASK & 0x10)
+  ISR_HANDLER(PORTE_ISR, __PORTE_VECTOR__);
+#endif
+
+/// attach handler to pin with priority (0=called first). Call with interrupts disabled
+uint8_t   exti_attach(uint8_t port, uint8_t pin, uint8_t flags, uint8_t prio, exti_handler_t handler);
+
+#if (EXTI_DEBOUNCE_MS > 0)
+  /// debounce timing. Call every 1ms from timer ISR with same priority as port ISRs
+  void    exti_tick(void);
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _EXTI_H_
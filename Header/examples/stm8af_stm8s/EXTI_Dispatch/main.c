@@ -0,0 +1,144 @@
+/**********************
+  STM8 external interrupt dispatcher
+  Demonstrate per-pin handlers and debouncing for port interrupts
+
+  Functionality:
+  - init FCPU to 16MHz
+  - rotary encoder A/B on PC1/PC2: handler on both edges of A, highest priority
+  - push button on PD2 (against GND): debounced handler on falling edge
+  - TIM4 1ms interrupt for debouncing
+  - button resets encoder position and toggles LED
+  - print encoder position via UART2 on change
+
+  Boards:
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "exti.h"         // declares port ISRs
+
+// define communication speed
+#define BAUDRATE   9600
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file!!!
+ISR_HANDLER(TIM4_UPD_ISR, __TIM4_UPD_OVF_VECTOR__);
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// encoder position (modified in port ISR)
+volatile int16_t   g_position = 0;
+
+
+////////
+// TIM4 update ISR: 1ms tick for debouncing
+////////
+#if defined(_IAR_)
+   #pragma vector = 2+__TIM4_UPD_OVF_VECTOR__    // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(TIM4_UPD_ISR, __TIM4_UPD_OVF_VECTOR__)
+{
+  _TIM4_SR &= ~_TIM4_SR_UIF;
+  exti_tick();
+
+} // TIM4_UPD_ISR
+
+
+////////
+// encoder handler: edge on channel A (PC1). Direction from channel B (PC2)
+////////
+void encoder_A(uint8_t level) {
+
+  if (((_PORTC_IDR & _PORT_PIN2) != 0) == level)
+    g_position--;
+  else
+    g_position++;
+
+} // encoder_A
+
+
+////////
+// button handler: debounced falling edge on PD2
+////////
+void button(uint8_t level) {
+
+  (void) level;
+  g_position = 0;
+  _PORTC_ODR ^= _PORT_PIN5;
+
+} // button
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  int16_t   position, last = 1;
+
+  ////
+  // initialization
+  ////
+
+  // disable interrupts for initialization
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // LED (PC5) to output push-pull
+  _PORTC_DDR |= _PORT_PIN5;
+  _PORTC_CR1 |= _PORT_PIN5;
+
+  // encoder (PC1, PC2) and button (PD2) to input with pull-up
+  _PORTC_CR1 |= _PORT_PIN1 | _PORT_PIN2;
+  _PORTD_CR1 |= _PORT_PIN2;
+
+  // attach pin handlers. Encoder has higher priority than button
+  exti_attach(EXTI_PORTC, 1, EXTI_BOTH, 0, encoder_A);
+  exti_attach(EXTI_PORTD, 2, EXTI_FALLING | EXTI_DEBOUNCED, 1, button);
+
+  // TIM4 1ms interrupt (16MHz/2^6=250kHz, 250 ticks)
+  _TIM4_PSCR = 6;
+  _TIM4_ARR  = 249;
+  _TIM4_IER  = _TIM4_IER_UIE;
+  _TIM4_CR   = _TIM4_CR_ARPE | _TIM4_CR_CEN;
+
+  // set UART2 to 9.6kBaud (note: BRR2 must be written before BRR1!)
+  _UART2_BRR2 = (uint8_t) ((((16000000L/BAUDRATE) & 0xF000) >> 8) | ((16000000L/BAUDRATE) & 0x000F));
+  _UART2_BRR1 = (uint8_t) (((16000000L/BAUDRATE) & 0x0FF0) >> 4);
+  _UART2_CR2 |= _UART2_CR2_TEN;
+
+  // enable interrupts after initialization
+  ENABLE_INTERRUPTS();
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // copy position. Is modified by port C and TIM4 ISR (button)
+    DISABLE_INTERRUPTS();
+    position = g_position;
+    ENABLE_INTERRUPTS();
+
+    // print position on change
+    if (position != last) {
+      last = position;
+      printf("position %d\n", (int) position);
+    }
+
+  } // main loop
+
+} // main()
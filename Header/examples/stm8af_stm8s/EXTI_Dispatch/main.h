@@ -0,0 +1,19 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8S105K6.h"	// sduino-uno (https://github.com/roybaer/sduino_uno)
+#include "stdio.h"
+
+
+/*----------------------------------------------------------
+    EXTI CONFIGURATION
+----------------------------------------------------------*/
+
+// dispatch only port C and D interrupts
+#define EXTI_PORT_MASK    0x0C
+
+// max. number of pin handlers
+#define EXTI_MAX_HANDLERS 4
+
+// debounce time for push button [ms]
+#define EXTI_DEBOUNCE_MS  20
@@ -0,0 +1,86 @@
+/**********************
+  STM8 fast startup
+  Demonstrate early clock switch and noinit variables via custom startup code
+
+  Functionality:
+  - startup.c switches to 16MHz before initializing variables
+  - set pin D6 (PD3) high at start of main(). Measure time from reset to
+    rising edge with scope, and compare with startup.c removed
+  - count warm resets in noinit variable
+  - print reset counter and checksum of initialized data via UART2
+  - press reset button to increase counter
+
+  Boards:
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "startup.h"
+
+// define communication speed
+#define BAUDRATE   9600
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// noinit data, kept over warm reset
+typedef struct {
+  uint16_t  magic;        // 0x55AA if valid
+  uint16_t  resets;       // number of warm resets
+} noinit_t;
+__noinit noinit_t   g_noinit;
+
+// initialized data (.data) and zeroed data (.bss) for startup demo
+uint8_t    g_table[256] = {1, 2, 3, 4, 5, 6, 7, 8};
+uint8_t    g_buffer[1024];
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint16_t  i, sum = 0;
+
+  ////
+  // initialization
+  ////
+
+  // set D6 (PD3) high for boot time measurement
+  _PORTD_DDR |= _PORT_PIN3;
+  _PORTD_CR1 |= _PORT_PIN3;
+  _PORTD_ODR |= _PORT_PIN3;
+
+  // power-on: init noinit data. Else count warm reset
+  if (g_noinit.magic != 0x55AA) {
+    g_noinit.magic  = 0x55AA;
+    g_noinit.resets = 0;
+  }
+  else
+    g_noinit.resets++;
+
+  // set UART2 to 9.6kBaud (clock is already 16MHz, see startup.c)
+  _UART2_BRR2 = (uint8_t) ((((16000000L/BAUDRATE) & 0xF000) >> 8) | ((16000000L/BAUDRATE) & 0x000F));
+  _UART2_BRR1 = (uint8_t) (((16000000L/BAUDRATE) & 0x0FF0) >> 4);
+  _UART2_CR2 |= _UART2_CR2_TEN;
+
+  // check variable initialization (expect 36)
+  for (i=0; i<sizeof(g_table); i++)
+    sum += g_table[i];
+  for (i=0; i<sizeof(g_buffer); i++)
+    sum += g_buffer[i];
+
+  printf("\nwarm resets %u, checksum %u\n", (unsigned int) g_noinit.resets, (unsigned int) sum);
+
+
+  ////
+  // main loop
+  ////
+  while (1);
+
+} // main()
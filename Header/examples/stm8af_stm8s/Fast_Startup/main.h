@@ -0,0 +1,16 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8S105K6.h"	// sduino-uno (https://github.com/roybaer/sduino_uno)
+#include "stdio.h"
+
+
+/*----------------------------------------------------------
+    STARTUP CONFIGURATION
+----------------------------------------------------------*/
+
+// switch to 16MHz HSI before variable initialization
+#define STARTUP_CKDIVR      0x00
+
+// size of noinit struct in main.c
+#define STARTUP_NOINIT_SIZE 4
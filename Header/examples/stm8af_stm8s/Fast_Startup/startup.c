@@ -0,0 +1,109 @@
+/**
+  \file startup.c
+
+  \brief implementation of fast startup code
+
+  SDCC calls __sdcc_external_startup() after setting the stack pointer and
+  before initializing static variables. If it returns a non-zero value,
+  the default initialization is skipped. Here the clock is switched first,
+  then .data (area INITIALIZED) is copied from flash and .bss (area DATA)
+  is cleared, using the section lengths from the linker. Absolute variables
+  (__at) are not part of these areas, i.e. __noinit variables are kept.
+
+  IAR calls __low_level_init() before segment initialization. It only
+  switches the clock, and the IAR startup code handles __no_init.
+
+  Note: static variables are not initialized yet, i.e. these functions
+  must not access any.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "startup.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check compiler
+#if defined(_SDCC_)
+  #if SDCC_VERSION < 40000
+    #error __sdcc_external_startup() for STM8 requires SDCC >=4.0
+  #endif
+#elif !defined(_IAR_)
+  #error compiler not supported
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+#if defined(_SDCC_)
+
+/**
+  \fn unsigned char __sdcc_external_startup(void)
+
+  \brief switch clock and initialize variables
+
+  \return 1 to skip SDCC variable initialization
+*/
+unsigned char __sdcc_external_startup(void) {
+
+  // switch clock before time consuming initialization
+  _CLK_CKDIVR = STARTUP_CKDIVR;
+
+  // copy .data initializers from flash and clear .bss. Loops count from section length down to 1
+  __asm
+    ldw   x, #l_INITIALIZER
+    jreq  00002$
+  00001$:
+    ld    a, (s_INITIALIZER - 1, x)
+    ld    (s_INITIALIZED - 1, x), a
+    decw  x
+    jrne  00001$
+  00002$:
+    ldw   x, #l_DATA
+    jreq  00004$
+  00003$:
+    clr   (s_DATA - 1, x)
+    decw  x
+    jrne  00003$
+  00004$:
+  __endasm;
+
+  // skip default initialization
+  return(1);
+
+} // __sdcc_external_startup
+
+#endif // _SDCC_
+
+
+
+#if defined(_IAR_)
+
+/**
+  \fn int __low_level_init(void)
+
+  \brief switch clock before segment initialization
+
+  \return 1 to let IAR startup code initialize segments
+*/
+int __low_level_init(void) {
+
+  // switch clock before time consuming initialization
+  _CLK_CKDIVR = STARTUP_CKDIVR;
+
+  // initialize segments (except __no_init)
+  return(1);
+
+} // __low_level_init
+
+#endif // _IAR_
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,72 @@
+/**
+  \file startup.h
+
+  \brief declaration of fast startup code
+
+  Replace the initialization part of the compiler startup code. The clock
+  is switched via _CLK_CKDIVR before static variables are initialized,
+  i.e. copying .data and clearing .bss runs at 16MHz instead of the 2MHz
+  reset clock. Only the used length of both sections is initialized.
+
+  Variables declared with __noinit are not initialized, and keep their
+  value over warm resets (watchdog, software reset, reset pin). Their
+  content is undefined after power-on.
+
+  Just link startup.c to the project. No call from main() is required.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _STARTUP_H_
+#define _STARTUP_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// clock divider set before variable initialization. 0x00 = HSI 16MHz, no divider
+#if !defined(STARTUP_CKDIVR)
+  #define STARTUP_CKDIVR      0x00          ///< value for _CLK_CKDIVR
+#endif
+
+// size of noinit RAM [B]
+#if !defined(STARTUP_NOINIT_SIZE)
+  #define STARTUP_NOINIT_SIZE 16            ///< size of noinit variable
+#endif
+
+// address of noinit RAM. Default is below the 512B stack at end of RAM. Variables must not exceed it
+#if !defined(STARTUP_NOINIT_ADDR)
+  #define STARTUP_NOINIT_ADDR (STM8_RAM_SIZE - 0x200 - STARTUP_NOINIT_SIZE)   ///< address of noinit variable
+#endif
+
+/// declare variable as not initialized by startup code. SDCC: absolute address, i.e. only one (struct) variable
+#if defined(_SDCC_)
+  #define __noinit            __at(STARTUP_NOINIT_ADDR)
+#elif defined(_IAR_)
+  #define __noinit            __no_init
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// hook called by startup code before variable initialization. Don't call from application
+#if defined(_SDCC_)
+  unsigned char __sdcc_external_startup(void);
+#elif defined(_IAR_)
+  int __low_level_init(void);
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _STARTUP_H_
@@ -0,0 +1,474 @@
+/**
+  \file i2c_master.c
+
+  \brief implementation of interrupt-driven I2C master
+
+  The transfer is driven by the I2C event, buffer and error interrupts
+  according to the master sequences in the STM8S reference manual (RM0016).
+  Reading 1, 2 or >=3 bytes requires different handling of ACK, POS and
+  STOP to NACK the last byte:
+    - 1 byte: clear ACK before ADDR is cleared, then set STOP
+    - 2 bytes: set POS and ACK before address, clear ACK after ADDR, wait for BTF
+    - >=3 bytes: read via RXNE until 3 bytes are left, then wait for BTF
+  The buffer interrupt is disabled while waiting for BTF.
+
+  Queue and state are protected against the ISR by disabling the I2C
+  interrupts only, other interrupts are not blocked.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "i2c_master.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// peripheral clock in MHz for FREQR and TRISER
+#define I2C_FREQ_MHZ    (F_CPU / 1000000L)
+
+// check clock
+#if ((F_CPU % 1000000L) != 0) || (I2C_FREQ_MHZ < 1) || (I2C_FREQ_MHZ > 24)
+  #error F_CPU must be an integer multiple of 1MHz in 1..24MHz
+#endif
+
+// standard mode: t_high = t_low = CCR/F_CPU, max. rise time 1000ns
+#if (I2C_SPEED <= 100000L)
+  #define I2C_CCR       ((F_CPU + 2*I2C_SPEED - 1) / (2*I2C_SPEED))
+  #define I2C_CCR_MIN   4
+  #define I2C_CCRH_MODE 0x00
+  #define I2C_TRISE     (I2C_FREQ_MHZ + 1)
+
+// fast mode (DUTY=0): t_high = CCR/F_CPU, t_low = 2*CCR/F_CPU, max. rise time 300ns
+#elif (I2C_SPEED <= 400000L)
+  #if (I2C_FREQ_MHZ < 4)
+    #error I2C fast mode requires F_CPU >= 4MHz
+  #endif
+  #define I2C_CCR       ((F_CPU + 3*I2C_SPEED - 1) / (3*I2C_SPEED))
+  #define I2C_CCR_MIN   1
+  #define I2C_CCRH_MODE _I2C_CCRH_FS
+  #define I2C_TRISE     ((I2C_FREQ_MHZ * 3) / 10 + 1)
+
+#else
+  #error I2C_SPEED must be <= 400kHz
+#endif
+
+// check CCR range (12 bit)
+#if (I2C_CCR < I2C_CCR_MIN) || (I2C_CCR > 0x0FFF)
+  #error I2C_SPEED not supported for this F_CPU
+#endif
+
+// interrupts during transfer
+#define I2C_ITR_ACTIVE  (_I2C_ITR_ITEVTEN | _I2C_ITR_ITERREN)
+
+// max. polls for end of stop condition before next start
+#define I2C_STOP_WAIT   255
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+static i2c_trans_t       *s_cur;       ///< active transaction (head of queue), NULL if idle
+static i2c_trans_t       *s_tail;      ///< last transaction in queue
+static uint8_t           s_idx;        ///< index in tx or rx buffer
+static uint8_t           s_rx;         ///< 0=write phase, 1=read phase
+static volatile uint8_t  s_ticks;      ///< calls of i2c_timeout() without bus event
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void i2c_config(void)
+
+  \brief configure I2C peripheral for master mode
+
+  Timing registers can only be written with peripheral disabled.
+*/
+static void i2c_config(void) {
+
+  _I2C_CR1    = 0x00;
+  _I2C_FREQR  = (uint8_t) I2C_FREQ_MHZ;
+  _I2C_CCRL   = (uint8_t) (I2C_CCR & 0xFF);
+  _I2C_CCRH   = (uint8_t) (I2C_CCRH_MODE | (I2C_CCR >> 8));
+  _I2C_TRISER = (uint8_t) I2C_TRISE;
+  _I2C_OARH   = _I2C_OARH_ADDCONF;     // must always be written as 1
+  _I2C_ITR    = 0x00;
+  _I2C_CR1    = _I2C_CR1_PE;
+
+} // i2c_config
+
+
+
+/**
+  \fn void i2c_start(void)
+
+  \brief start active transaction s_cur
+
+  Generate start condition and enable interrupts. Called with I2C interrupts disabled.
+*/
+static void i2c_start(void) {
+
+  uint8_t  i;
+
+  // reset state. Transaction without write phase starts with read
+  s_idx   = 0;
+  s_rx    = ((s_cur->txLen == 0) && (s_cur->rxLen != 0));
+  s_ticks = 0;
+
+  // start must not be set before stop of previous transaction is sent (few us)
+  for (i=0; (i<I2C_STOP_WAIT) && (_I2C_CR2 & _I2C_CR2_STOP); i++);
+
+  // generate start condition, continue in ISR
+  _I2C_CR2 |= _I2C_CR2_START;
+  _I2C_ITR  = I2C_ITR_ACTIVE;
+
+} // i2c_start
+
+
+
+/**
+  \fn void i2c_finish(uint8_t status)
+
+  \brief finish active transaction and start next one
+
+  \param[in]  status   result of transaction
+
+  Called from ISR or with I2C interrupts disabled. The next transaction is
+  started before the callback, which may submit new transactions.
+*/
+static void i2c_finish(uint8_t status) {
+
+  i2c_trans_t  *trans = s_cur;
+
+  // reset read configuration
+  _I2C_CR2 &= ~(_I2C_CR2_ACK | _I2C_CR2_POS);
+
+  // remove from queue and start next transaction
+  s_cur = trans->next;
+  if (s_cur != NULL)
+    i2c_start();
+  else
+    _I2C_ITR = 0x00;
+
+  // report result
+  trans->status = status;
+  if (trans->callback != NULL)
+    trans->callback(status);
+
+} // i2c_finish
+
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void i2c_init(void)
+
+  \brief init I2C master
+
+  Configure I2C for I2C_SPEED and clear queue. Interrupts must be enabled by application.
+*/
+void i2c_init(void) {
+
+  s_cur  = NULL;
+  s_tail = NULL;
+  i2c_config();
+
+} // i2c_init
+
+
+
+/**
+  \fn uint8_t i2c_submit(i2c_trans_t *trans, uint8_t addr, const uint8_t *txBuf, uint8_t txLen, uint8_t *rxBuf, uint8_t rxLen, i2c_callback_t callback)
+
+  \brief set up transaction and append to queue
+
+  \param[in]  trans      transaction (memory provided by application)
+  \param[in]  addr       7-bit slave address
+  \param[in]  txBuf      data to write
+  \param[in]  txLen      number of bytes to write (0=read only)
+  \param[in]  rxBuf      buffer for read data
+  \param[in]  rxLen      number of bytes to read (0=write only)
+  \param[in]  callback   called on end of transaction (NULL=none)
+
+  \return I2C_PENDING, or I2C_ERR_QUEUED if transaction is already in queue
+
+  Write and read phase are separated by a repeated start. If txLen and rxLen
+  are both 0, only the address is sent, e.g. to probe for a slave. Can be
+  called from a transaction callback.
+*/
+uint8_t i2c_submit(i2c_trans_t *trans, uint8_t addr, const uint8_t *txBuf, uint8_t txLen, uint8_t *rxBuf, uint8_t rxLen, i2c_callback_t callback) {
+
+  i2c_trans_t  *p;
+  uint8_t      itr;
+
+  // block I2C ISR
+  itr = _I2C_ITR;
+  _I2C_ITR = 0x00;
+
+  // transaction must not be modified while queued
+  for (p = s_cur; p != NULL; p = p->next) {
+    if (p == trans) {
+      _I2C_ITR = itr;
+      return(I2C_ERR_QUEUED);
+    }
+  }
+
+  // set up transaction
+  trans->next     = NULL;
+  trans->addr     = addr;
+  trans->txBuf    = txBuf;
+  trans->txLen    = txLen;
+  trans->rxBuf    = rxBuf;
+  trans->rxLen    = rxLen;
+  trans->callback = callback;
+  trans->status   = I2C_PENDING;
+
+  // bus idle -> start immediately (enables ISR)
+  if (s_cur == NULL) {
+    s_cur  = trans;
+    s_tail = trans;
+    i2c_start();
+  }
+
+  // append to queue
+  else {
+    s_tail->next = trans;
+    s_tail = trans;
+    _I2C_ITR = itr;
+  }
+
+  return(I2C_PENDING);
+
+} // i2c_submit
+
+
+
+/**
+  \fn uint8_t i2c_idle(void)
+
+  \brief check if no transaction is queued or in progress
+
+  \return 1 if queue is empty, else 0
+*/
+uint8_t i2c_idle(void) {
+
+  uint8_t  itr, idle;
+
+  itr = _I2C_ITR;
+  _I2C_ITR = 0x00;
+  idle = (s_cur == NULL);
+  _I2C_ITR = itr;
+
+  return(idle);
+
+} // i2c_idle
+
+
+
+/**
+  \fn void i2c_timeout(void)
+
+  \brief supervise bus activity
+
+  Call periodically, e.g. every 1ms. If no bus event occurs within I2C_TIMEOUT
+  calls, e.g. because a slave holds SCL low, the peripheral is reset and the
+  active transaction is finished with I2C_ERR_TIMEOUT. Then the callback is
+  called from this function.
+*/
+void i2c_timeout(void) {
+
+  uint8_t  itr;
+
+  // block I2C ISR
+  itr = _I2C_ITR;
+  _I2C_ITR = 0x00;
+
+  // no bus event for too long -> reset peripheral and abort transaction
+  if ((s_cur != NULL) && (++s_ticks >= I2C_TIMEOUT)) {
+    _I2C_CR2 = _I2C_CR2_SWRST;
+    _I2C_CR2 = 0x00;
+    i2c_config();
+    i2c_finish(I2C_ERR_TIMEOUT);
+  }
+  else
+    _I2C_ITR = itr;
+
+} // i2c_timeout
+
+
+
+/**
+  \fn void I2C_ISR(void)
+
+  \brief ISR for I2C events, buffer and errors
+
+  Execute next step of active transaction.
+
+  Notes:
+    - for Cosmic compiler, add I2C_ISR also to 'stm8_interrupt_vector.c'
+    - IAR compiler has an IRQ offset of +2 compared to STM8 datasheet (see below)
+*/
+#if defined(_IAR_)
+   #pragma vector = 2+__I2C_VECTOR__    // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(I2C_ISR, __I2C_VECTOR__)
+{
+  i2c_trans_t  *t = s_cur;
+  uint8_t      sr1, sr2, rest;
+
+  // bus activity
+  s_ticks = 0;
+
+  // check for errors
+  sr2 = _I2C_SR2;
+  if (sr2 & (_I2C_SR2_BERR | _I2C_SR2_ARLO | _I2C_SR2_AF | _I2C_SR2_OVR)) {
+    _I2C_SR2 = 0x00;
+    if (t == NULL)
+      return;
+    if (sr2 & _I2C_SR2_ARLO)            // bus already released by hardware
+      i2c_finish(I2C_ERR_ARLO);
+    else {
+      _I2C_CR2 |= _I2C_CR2_STOP;        // release bus
+      i2c_finish((sr2 & _I2C_SR2_AF) ? I2C_ERR_NACK : I2C_ERR_BUS);
+    }
+    return;
+  }
+
+  // spurious event
+  if (t == NULL) {
+    _I2C_ITR = 0x00;
+    return;
+  }
+
+  // read SR1 as 1st step for clearing SB, ADDR and BTF
+  sr1 = _I2C_SR1;
+
+  ////
+  // start sent (EV5) -> send address. Writing DR clears SB
+  ////
+  if (sr1 & _I2C_SR1_SB) {
+    if (s_rx) {
+      if (t->rxLen == 2)
+        _I2C_CR2 |= (_I2C_CR2_ACK | _I2C_CR2_POS);
+      else if (t->rxLen > 2)
+        _I2C_CR2 |= _I2C_CR2_ACK;
+      _I2C_DR = (uint8_t) ((t->addr << 1) | 0x01);
+    }
+    else
+      _I2C_DR = (uint8_t) (t->addr << 1);
+    return;
+  }
+
+  ////
+  // address acknowledged (EV6). Reading SR3 clears ADDR
+  ////
+  if (sr1 & _I2C_SR1_ADDR) {
+
+    // write phase: send data via TXE, or stop for address-only transaction
+    if (!s_rx) {
+      (void) _I2C_SR3;
+      if (t->txLen != 0)
+        _I2C_ITR |= _I2C_ITR_ITBUFEN;
+      else {
+        _I2C_CR2 |= _I2C_CR2_STOP;
+        i2c_finish(I2C_OK);
+      }
+    }
+
+    // read 1 byte: NACK and stop after this byte
+    else if (t->rxLen == 1) {
+      _I2C_CR2 &= ~_I2C_CR2_ACK;
+      (void) _I2C_SR3;
+      _I2C_CR2 |= _I2C_CR2_STOP;
+      _I2C_ITR |= _I2C_ITR_ITBUFEN;
+    }
+
+    // read 2 bytes: NACK 2nd byte (POS), wait for BTF
+    else if (t->rxLen == 2) {
+      (void) _I2C_SR3;
+      _I2C_CR2 &= ~_I2C_CR2_ACK;
+    }
+
+    // read >=3 bytes: via RXNE until 3 bytes are left, then wait for BTF
+    else {
+      (void) _I2C_SR3;
+      if (t->rxLen > 3)
+        _I2C_ITR |= _I2C_ITR_ITBUFEN;
+    }
+    return;
+  }
+
+  ////
+  // read phase
+  ////
+  if (s_rx) {
+    rest = t->rxLen - s_idx;
+
+    // 2 bytes left, N-1 in DR and N in shift register (EV7_3) -> stop, read both
+    if ((sr1 & _I2C_SR1_BTF) && (rest == 2)) {
+      _I2C_CR2 |= _I2C_CR2_STOP;
+      t->rxBuf[s_idx++] = _I2C_DR;
+      t->rxBuf[s_idx++] = _I2C_DR;
+      i2c_finish(I2C_OK);
+    }
+
+    // 3 bytes left, N-2 in DR and N-1 in shift register (EV7_2) -> NACK N, read N-2, stop, read N-1
+    else if ((sr1 & _I2C_SR1_BTF) && (rest == 3)) {
+      _I2C_CR2 &= ~_I2C_CR2_ACK;
+      t->rxBuf[s_idx++] = _I2C_DR;
+      _I2C_CR2 |= _I2C_CR2_STOP;
+      t->rxBuf[s_idx++] = _I2C_DR;
+      _I2C_ITR |= _I2C_ITR_ITBUFEN;
+    }
+
+    // byte received (EV7)
+    else if (sr1 & _I2C_SR1_RXNE) {
+      t->rxBuf[s_idx++] = _I2C_DR;
+      rest--;
+      if (rest == 0)
+        i2c_finish(I2C_OK);
+      else if (rest == 3)
+        _I2C_ITR &= ~_I2C_ITR_ITBUFEN;
+    }
+    return;
+  }
+
+  ////
+  // write phase
+  ////
+
+  // DR empty (EV8) -> send next byte. After last byte wait for BTF
+  if (s_idx < t->txLen) {
+    if (sr1 & _I2C_SR1_TXE) {
+      _I2C_DR = t->txBuf[s_idx++];
+      if (s_idx == t->txLen)
+        _I2C_ITR &= ~_I2C_ITR_ITBUFEN;
+    }
+  }
+
+  // last byte sent (EV8_2) -> repeated start for read phase, or stop. Both clear BTF
+  else if (sr1 & _I2C_SR1_BTF) {
+    if (t->rxLen != 0) {
+      s_rx  = 1;
+      s_idx = 0;
+      _I2C_CR2 |= _I2C_CR2_START;
+    }
+    else {
+      _I2C_CR2 |= _I2C_CR2_STOP;
+      i2c_finish(I2C_OK);
+    }
+  }
+
+} // I2C_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
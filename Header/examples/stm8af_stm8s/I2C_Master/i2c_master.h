@@ -0,0 +1,101 @@
+/**
+  \file i2c_master.h
+
+  \brief declaration of interrupt-driven I2C master
+
+  Non-blocking I2C master with transaction queue. A transaction consists of
+  an optional write phase and an optional read phase. If both are present,
+  they are separated by a repeated start. Transactions are processed in the
+  I2C ISR, and the result is reported via status flag and optional callback.
+  Bus timing registers are calculated at compile time from F_CPU and I2C_SPEED.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _I2C_MASTER_H_
+#define _I2C_MASTER_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+#include <stddef.h>     // NULL
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// CPU clock = I2C peripheral clock [Hz]
+#if !defined(F_CPU)
+  #define F_CPU             16000000L     ///< CPU clock [Hz]
+#endif
+
+// I2C bus speed (max. 100kHz standard mode, max. 400kHz fast mode)
+#if !defined(I2C_SPEED)
+  #define I2C_SPEED         100000L       ///< SCL frequency [Hz]
+#endif
+
+// abort transaction if no bus event within this number of i2c_timeout() calls
+#if !defined(I2C_TIMEOUT)
+  #define I2C_TIMEOUT       10            ///< timeout [calls of i2c_timeout()]
+#endif
+
+// transaction status
+#define I2C_OK              0             ///< transaction finished successfully
+#define I2C_PENDING         1             ///< transaction queued or in progress
+#define I2C_ERR_NACK        2             ///< address or data not acknowledged
+#define I2C_ERR_ARLO        3             ///< arbitration lost (multi-master)
+#define I2C_ERR_BUS         4             ///< misplaced start/stop condition
+#define I2C_ERR_TIMEOUT     5             ///< no bus event, e.g. SCL held low
+#define I2C_ERR_QUEUED      6             ///< transaction is already queued
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// callback on end of transaction. Called from ISR context!
+typedef void (*i2c_callback_t)(uint8_t status);
+
+/// I2C transaction. Memory is provided by the application and must stay valid until finished
+typedef struct i2c_trans {
+  struct i2c_trans  *next;          ///< next transaction in queue (internal)
+  uint8_t           addr;           ///< 7-bit slave address
+  const uint8_t     *txBuf;         ///< data to write
+  uint8_t           txLen;          ///< number of bytes to write (0=read only)
+  uint8_t           *rxBuf;         ///< buffer for read data
+  uint8_t           rxLen;          ///< number of bytes to read (0=write only)
+  i2c_callback_t    callback;       ///< called on end of transaction (NULL=none)
+  volatile uint8_t  status;         ///< I2C_PENDING until finished, then I2C_OK or error
+} i2c_trans_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+ISR_HANDLER(I2C_ISR, __I2C_VECTOR__);
+
+/// init I2C master. Interrupts must be enabled by application
+void      i2c_init(void);
+
+/// set up transaction and append to queue. Return I2C_PENDING or I2C_ERR_QUEUED
+uint8_t   i2c_submit(i2c_trans_t *trans, uint8_t addr, const uint8_t *txBuf, uint8_t txLen, uint8_t *rxBuf, uint8_t rxLen, i2c_callback_t callback);
+
+/// check if transaction is finished
+#define   i2c_done(trans)     ((trans)->status != I2C_PENDING)
+
+/// check if no transaction is queued or in progress
+uint8_t   i2c_idle(void);
+
+/// supervise bus activity, call periodically e.g. every 1ms
+void      i2c_timeout(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _I2C_MASTER_H_
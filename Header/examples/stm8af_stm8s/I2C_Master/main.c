@@ -0,0 +1,134 @@
+/**********************
+  STM8 interrupt-driven I2C master
+  Demonstrate non-blocking I2C transactions with repeated start
+
+  Functionality:
+  - init FCPU to 16MHz
+  - init UART2
+  - set up TIM4 interrupt for time-keeping
+  - init I2C master (100kHz, SCL=PB4, SDA=PB5, external pull-ups required)
+  - every 500ms read temperature from LM75 sensor (write pointer, repeated start, read 2 bytes)
+  - print result via UART2 in completion, together with number of main loop
+    iterations during the last 500ms (I2C transfer does not block main loop)
+
+  Boards:
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"         // sduino-UNO
+#include "i2c_master.h"   // I2C master (declares I2C_ISR)
+
+// define communication speed
+#define BAUDRATE   9600
+
+// LM75 temperature sensor with A2..A0=GND
+#define LM75_ADDR  0x48
+#define LM75_TEMP  0x00
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file!!!
+ISR_HANDLER(TIM4_UPD_ISR, __TIM4_UPD_OVF_VECTOR__);
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// global ms counter (increased in TIM4_UPD_ISR)
+uint32_t   g_millis = 0;
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint16_t         BRR;
+  uint32_t         millis, lastMillis = 0, lastRead = 0;
+  uint16_t         loops = 0;
+  int16_t          temp;
+  i2c_trans_t      trans;
+  static const uint8_t  reg = LM75_TEMP;
+  uint8_t          data[2];
+  uint8_t          busy = 0;
+
+  ////
+  // initialization
+  ////
+
+  // disable interrupts for initialization
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // set UART2 baudrate (note: BRR2 must be written before BRR1!)
+  BRR = (uint16_t) (((uint32_t) 16000000L)/BAUDRATE);
+  _UART2_BRR2 = (uint8_t) (((BRR & 0xF000) >> 8) | (BRR & 0x000F));
+  _UART2_BRR1 = (uint8_t) ((BRR & 0x0FF0) >> 4);
+
+  // enable UART2 sender
+  _UART2_CR2 |= _UART2_CR2_TEN;
+
+  // init TIM4 for 1ms interrupt
+  _TIM4_CR      |= _TIM4_CR_ARPE;      // auto-reload value buffered
+  _TIM4.PSCR.PSC = 6;                  // set clock prescaler to 6 -> 16Mhz/2^6 = 250kHz -> 4us resolution
+  _TIM4_ARR      = 250;                // set autoreload period to 1ms (=250*4us)
+  _TIM4_IER     |= _TIM4_IER_UIE;      // enable timer 4 interrupt
+  _TIM4_CR      |= _TIM4_CR_CEN;       // start timer
+
+  // init I2C master
+  i2c_init();
+
+  // enable interrupts after initialization
+  ENABLE_INTERRUPTS();
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // count main loop iterations
+    loops++;
+
+    // copy ms counter with interrupts disabled (32bit access is not atomic on 8bit CPU)
+    DISABLE_INTERRUPTS();
+    millis = g_millis;
+    ENABLE_INTERRUPTS();
+
+    // every 1ms supervise I2C bus
+    if (millis != lastMillis) {
+      lastMillis = millis;
+      i2c_timeout();
+    }
+
+    // every 500ms start reading LM75 temperature register (pointer write + repeated start + 2 byte read)
+    if ((!busy) && ((uint32_t) (millis - lastRead) >= 500)) {
+      lastRead = millis;
+      i2c_submit(&trans, LM75_ADDR, &reg, 1, data, 2, NULL);
+      busy = 1;
+    }
+
+    // transaction finished -> print result and number of loops meanwhile
+    if (busy && i2c_done(&trans)) {
+      busy = 0;
+      if (trans.status == I2C_OK) {
+        temp = (int16_t) (((uint16_t) data[0] << 8) | data[1]) / 128;      // 0.5degC resolution
+        printf("T = %s%d.%dC, loops = %u\n", (temp < 0) ? "-" : "", ((temp < 0) ? -temp : temp) / 2, (temp & 0x01) ? 5 : 0, loops);
+      }
+      else
+        printf("I2C error %d, loops = %u\n", (int) trans.status, loops);
+      loops = 0;
+    }
+
+  } // main loop
+
+} // main()
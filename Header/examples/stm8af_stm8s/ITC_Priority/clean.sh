@@ -0,0 +1,16 @@
+#!/bin/bash 
+
+# change to current working directory
+cd `dirname $0`
+
+# SDCC output
+rm -fr *.asm
+rm -fr *.lst
+rm -fr *.rel
+rm -fr *.rst
+rm -fr *.sym
+rm -fr *.cdb
+rm -fr *.ihx
+rm -fr *.lk
+rm -fr *.map
+rm -fr *.SRC
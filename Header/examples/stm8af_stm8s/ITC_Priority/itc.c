@@ -0,0 +1,149 @@
+/**
+  \file itc.c
+
+  \brief implementation of interrupt priority configuration and critical sections
+
+  The CPU interrupt level is stored in bits I1 (bit 5) and I0 (bit 3) of the
+  condition code register CC, with the same coding as the SPRx fields. An
+  interrupt is only served if its priority is higher than the current level.
+  As CC is a core register, it is accessed via inline assembler. Between
+  reading and writing CC, interrupts are disabled for a few cycles.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "itc.h"
+#if defined(_IAR_)
+  #include <intrinsics.h>
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check table
+#if (ITC_DIFF(0) & 0x03)
+  #error TLI (vector 0) has fixed priority
+#endif
+#if (ITC_DIFF(7) & 0xF0)
+  #error vector number out of range
+#endif
+
+// interrupt mask bits I1, I0 in CC
+#define ITC_CC_MASK         0x28
+
+// CC save/restore of family header, available for SDCC and IAR
+#if !defined(SAVE_AND_DISABLE_INTERRUPTS)
+  #error compiler not supported
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// interrupt state incl. priority bits I1, I0. Only accessed with interrupts disabled
+volatile uint8_t      g_itcCC;
+
+// level from (I1<<1 | I0), and I1/I0 bits from level
+static const uint8_t  s_ccLevel[4] = {2, 1, 0, 3};
+static const uint8_t  s_levelCC[4] = {0x20, 0x08, 0x00, 0x28};
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void itc_init(void)
+
+  \brief set interrupt priorities
+
+  Write software priority registers from ITC_TABLE. Registers with reset
+  value are skipped at compile time. Priorities must not be changed while
+  the respective interrupt is enabled, therefore call before ENABLE_INTERRUPTS().
+*/
+void itc_init(void) {
+
+  if (ITC_DIFF(0)) _ITC_SPR1 = ITC_SPR(0);
+  if (ITC_DIFF(1)) _ITC_SPR2 = ITC_SPR(1);
+  if (ITC_DIFF(2)) _ITC_SPR3 = ITC_SPR(2);
+  if (ITC_DIFF(3)) _ITC_SPR4 = ITC_SPR(3);
+  if (ITC_DIFF(4)) _ITC_SPR5 = ITC_SPR(4);
+  if (ITC_DIFF(5)) _ITC_SPR6 = ITC_SPR(5);
+  if (ITC_DIFF(6)) _ITC_SPR7 = ITC_SPR(6);
+  if (ITC_DIFF(7)) _ITC_SPR8 = ITC_SPR(7);
+
+} // itc_init
+
+
+
+/**
+  \fn uint8_t itc_raise(uint8_t level)
+
+  \brief start critical section
+
+  \param[in]  level   block all interrupts with priority <= level (1..3)
+
+  \return previous state for itc_restore()
+
+  The level is never lowered, i.e. nested calls and calls from ISRs are safe.
+*/
+uint8_t itc_raise(uint8_t level) {
+
+  uint8_t  state, cur;
+
+  SAVE_AND_DISABLE_INTERRUPTS(g_itcCC);
+  state = g_itcCC;
+  cur = s_ccLevel[((state >> 4) & 0x02) | ((state >> 3) & 0x01)];
+  if (level > cur)
+    g_itcCC = (state & ~ITC_CC_MASK) | s_levelCC[level & 0x03];
+  RESTORE_INTERRUPTS(g_itcCC);
+
+  return(state);
+
+} // itc_raise
+
+
+
+/**
+  \fn void itc_restore(uint8_t state)
+
+  \brief end critical section
+
+  \param[in]  state   return value of matching itc_raise()
+*/
+void itc_restore(uint8_t state) {
+
+  SAVE_AND_DISABLE_INTERRUPTS(g_itcCC);
+  g_itcCC = (g_itcCC & ~ITC_CC_MASK) | (state & ITC_CC_MASK);
+  RESTORE_INTERRUPTS(g_itcCC);
+
+} // itc_restore
+
+
+
+/**
+  \fn uint8_t itc_level(void)
+
+  \brief get current interrupt level
+
+  \return CPU interrupt level (0=main .. 3=all blocked)
+*/
+uint8_t itc_level(void) {
+
+  uint8_t  cc;
+
+  SAVE_AND_DISABLE_INTERRUPTS(g_itcCC);
+  cc = g_itcCC;
+  RESTORE_INTERRUPTS(g_itcCC);
+
+  return(s_ccLevel[((cc >> 4) & 0x02) | ((cc >> 3) & 0x01)]);
+
+} // itc_level
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,85 @@
+/**
+  \file itc.h
+
+  \brief declaration of interrupt priority configuration and critical sections
+
+  Interrupt priorities are given as compile-time table ITC_TABLE(X) in main.h,
+  which lists X(vector, level) for each vector with non-default priority.
+  The software priority registers (SPRx) are calculated by the preprocessor,
+  and itc_init() only writes the registers which differ from reset.
+
+  Critical sections raise the CPU interrupt level instead of disabling all
+  interrupts, i.e. ISRs with higher priority stay active. They can be nested.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _ITC_H_
+#define _ITC_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// empty table if not defined in main.h
+#if !defined(ITC_TABLE)
+  #define ITC_TABLE(X)
+#endif
+
+// interrupt levels (main=0). ISRs are only interrupted by ISRs with higher level
+#define ITC_LEVEL_MAIN      0             ///< main program, all interrupts enabled
+#define ITC_LEVEL_1         1             ///< lowest ISR priority
+#define ITC_LEVEL_2         2             ///< medium ISR priority
+#define ITC_LEVEL_3         3             ///< highest ISR priority (reset value), i.e. all interrupts blocked
+
+// SPR code of level: 1=01, 2=00, 3=11 (10 is forbidden)
+#define _ITC_CODE(l)        (((l) == 1) ? 0x01 : (((l) == 2) ? 0x00 : 0x03))
+
+// XOR of SPR reset value (11) and level code, shifted to field of vector in register n
+#define _ITC_FIELD(v,l,n)   ((((v) >> 2) == (n)) ? ((0x03 ^ _ITC_CODE(l)) << (((v) & 0x03) << 1)) : 0)
+
+// accumulate fields of all table entries for SPR1..SPR8
+#define _ITC_X0(v,l)        | _ITC_FIELD(v,l,0)
+#define _ITC_X1(v,l)        | _ITC_FIELD(v,l,1)
+#define _ITC_X2(v,l)        | _ITC_FIELD(v,l,2)
+#define _ITC_X3(v,l)        | _ITC_FIELD(v,l,3)
+#define _ITC_X4(v,l)        | _ITC_FIELD(v,l,4)
+#define _ITC_X5(v,l)        | _ITC_FIELD(v,l,5)
+#define _ITC_X6(v,l)        | _ITC_FIELD(v,l,6)
+#define _ITC_X7(v,l)        | _ITC_FIELD(v,l,7)
+
+/// bits of SPR(n+1), n=0..7, which differ from reset value (0 = no write required)
+#define ITC_DIFF(n)         (0 ITC_TABLE(_ITC_X##n))
+
+/// value of SPR(n+1), n=0..7
+#define ITC_SPR(n)          ((uint8_t) (0xFF ^ ITC_DIFF(n)))
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// set interrupt priorities from ITC_TABLE. Call with interrupts disabled
+void      itc_init(void);
+
+/// block interrupts up to given level (nesting-safe). Return state for itc_restore()
+uint8_t   itc_raise(uint8_t level);
+
+/// end critical section, i.e. restore interrupt state from itc_raise()
+void      itc_restore(uint8_t state);
+
+/// get current CPU interrupt level (0..3)
+uint8_t   itc_level(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _ITC_H_
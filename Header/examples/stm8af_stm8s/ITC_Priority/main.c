@@ -0,0 +1,140 @@
+/**********************
+  STM8 interrupt priorities and critical sections
+  Demonstrate nested interrupts and critical sections without global interrupt disable
+
+  Functionality:
+  - init FCPU to 16MHz
+  - set interrupt priorities from table in main.h
+  - TIM2 ISR (10kHz, highest priority) toggles pin D6 (PD3)
+  - TIM4 ISR (1ms, lowest priority) simulates slow processing
+  - main reads ms counter in critical section, which only blocks TIM4
+  - blink LED every 500ms
+  - D6 shows low jitter, as TIM2 interrupts TIM4 ISR and main critical sections
+
+  Boards:
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "itc.h"
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file!!!
+ISR_HANDLER(TIM2_UPD_ISR, __TIM2_UPD_OVF_VECTOR__);
+ISR_HANDLER(TIM4_UPD_ISR, __TIM4_UPD_OVF_VECTOR__);
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// global ms counter (increased in TIM4_UPD_ISR)
+volatile uint32_t   g_millis = 0;
+
+
+////////
+// TIM2 update ISR: fast control loop (10kHz)
+////////
+#if defined(_IAR_)
+   #pragma vector = 2+__TIM2_UPD_OVF_VECTOR__    // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(TIM2_UPD_ISR, __TIM2_UPD_OVF_VECTOR__)
+{
+  // clear flag and toggle D6
+  _TIM2_SR1 &= ~_TIM2_SR1_UIF;
+  _PORTD_ODR ^= _PORT_PIN3;
+
+} // TIM2_UPD_ISR
+
+
+////////
+// TIM4 update ISR: slow background task (1ms)
+////////
+#if defined(_IAR_)
+   #pragma vector = 2+__TIM4_UPD_OVF_VECTOR__    // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(TIM4_UPD_ISR, __TIM4_UPD_OVF_VECTOR__)
+{
+  uint16_t  i;
+
+  // clear flag and count ms
+  _TIM4_SR &= ~_TIM4_SR_UIF;
+  g_millis++;
+
+  // simulate slow processing (~300us), e.g. protocol handling
+  for (i=0; i<800; i++)
+    NOP();
+
+} // TIM4_UPD_ISR
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint32_t  millis, lastToggle = 0;
+  uint8_t   state;
+
+  ////
+  // initialization
+  ////
+
+  // disable interrupts for initialization
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // set interrupt priorities (see main.h)
+  itc_init();
+
+  // LED (PC5) and D6 (PD3) to output push-pull
+  _PORTC_DDR |= _PORT_PIN5;
+  _PORTC_CR1 |= _PORT_PIN5;
+  _PORTD_DDR |= _PORT_PIN3;
+  _PORTD_CR1 |= _PORT_PIN3;
+
+  // TIM2 10kHz interrupt (16MHz/2^4=1MHz, 100 ticks)
+  _TIM2_PSCR = 4;
+  _TIM2_ARRH = 0;
+  _TIM2_ARRL = 99;
+  _TIM2_IER  = _TIM2_IER_UIE;
+  _TIM2_CR1  = _TIM2_CR1_ARPE | _TIM2_CR1_CEN;
+
+  // TIM4 1ms interrupt (16MHz/2^6=250kHz, 250 ticks)
+  _TIM4_PSCR = 6;
+  _TIM4_ARR  = 249;
+  _TIM4_IER  = _TIM4_IER_UIE;
+  _TIM4_CR   = _TIM4_CR_ARPE | _TIM4_CR_CEN;
+
+  // enable interrupts after initialization
+  ENABLE_INTERRUPTS();
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // copy ms counter. Only block TIM4 ISR, TIM2 ISR stays active
+    state = itc_raise(ITC_LEVEL_1);
+    millis = g_millis;
+    itc_restore(state);
+
+    // blink LED every 500ms
+    if ((millis - lastToggle) >= 500) {
+      lastToggle = millis;
+      _PORTC_ODR ^= _PORT_PIN5;
+    }
+
+  } // main loop
+
+} // main()
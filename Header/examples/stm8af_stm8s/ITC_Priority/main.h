@@ -0,0 +1,14 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8S105K6.h"	// sduino-uno (https://github.com/roybaer/sduino_uno)
+
+
+/*----------------------------------------------------------
+    INTERRUPT PRIORITIES
+----------------------------------------------------------*/
+
+// priority 1 (lowest) .. 3 (highest) per vector. Vectors not listed keep level 3
+#define ITC_TABLE(X) \
+  X(__TIM2_UPD_OVF_VECTOR__,  3)    /* fast control loop */ \
+  X(__TIM4_UPD_OVF_VECTOR__,  1)    /* slow background task */
@@ -0,0 +1,368 @@
+/**
+  \file capture.c
+
+  \brief implementation of input capture for frequency and duty measurement
+
+  Timer runs free with ARR=0xFFFF, and period and high time are calculated
+  as 16-bit differences of capture timestamps, which is correct across
+  counter overflows. CC1 captures rising and CC2 captures falling edges of
+  TI1 (indirect mode). If both flags are pending in the ISR, the expected
+  edge is read first to keep the timestamps in order.
+
+  The CAPCOM ISR only copies 2 bytes and a flag per edge. Search for the
+  latest rise-fall-rise sequence and all arithmetic are done in cap_get()
+  and the helper functions, i.e. only when the application asks for it.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "capture.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if (CAP_PRESCALER < 0) || (CAP_PRESCALER > 15)
+  #error CAP_PRESCALER must be 0..15
+#endif
+#if (CAP_FILTER < 0) || (CAP_FILTER > 15)
+  #error CAP_FILTER must be 0..15
+#endif
+#if (CAP_BUFFER < 4) || ((CAP_BUFFER & (CAP_BUFFER-1)) != 0)
+  #error CAP_BUFFER must be a power of 2 and >=4
+#endif
+
+// access registers of selected timer, e.g. CAP_REG(_CCMR1) -> _TIM2_CCMR1
+#define _CAP_CAT(a,b,c)     a ## b ## c
+#define _CAP_REG(t,r)       _CAP_CAT(_TIM, t, r)
+#define CAP_REG(r)          _CAP_REG(CAP_TIMER, r)
+
+// status and interrupt bits of selected timer
+#define CAP_CC1IE           CAP_REG(_IER_CC1IE)
+#define CAP_CC2IE           CAP_REG(_IER_CC2IE)
+#define CAP_CC1IF           CAP_REG(_SR1_CC1IF)
+#define CAP_CC2IF           CAP_REG(_SR1_CC2IF)
+#define CAP_CC1OF           CAP_REG(_SR2_CC1OF)
+#define CAP_CC2OF           CAP_REG(_SR2_CC2OF)
+
+// input capture: CC1S=01 (IC1 on TI1), CC2S=10 (IC2 on TI1), no input prescaler
+#define CAP_CCMR1           ((CAP_FILTER << 4) | 0x01)
+#define CAP_CCMR2           ((CAP_FILTER << 4) | 0x02)
+
+// edge type in buffer
+#define CAP_RISE            1
+#define CAP_FALL            0
+
+// block capture ISR
+#define CAP_LOCK()          (CAP_REG(_IER) &= ~(CAP_CC1IE | CAP_CC2IE))
+#define CAP_UNLOCK()        (CAP_REG(_IER) |=  (CAP_CC1IE | CAP_CC2IE))
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// edge timestamps and types. Oldest entries are overwritten
+static uint16_t          s_time[CAP_BUFFER];
+static uint8_t           s_edge[CAP_BUFFER];
+static uint8_t           s_head;                ///< next write index
+static uint8_t           s_count;               ///< valid entries (max. CAP_BUFFER)
+
+// next expected edge
+static uint8_t           s_next;
+
+// new rising edge since last cap_get()
+static volatile uint8_t  s_new;
+
+// number of overcaptures
+static volatile uint8_t  s_overrun;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void cap_push(uint16_t time, uint8_t edge)
+
+  \brief store edge timestamp in ring buffer (ISR context)
+
+  \param[in]  time   capture timestamp
+  \param[in]  edge   CAP_RISE or CAP_FALL
+*/
+static void cap_push(uint16_t time, uint8_t edge) {
+
+  s_time[s_head] = time;
+  s_edge[s_head] = edge;
+  s_head = (s_head + 1) & (CAP_BUFFER - 1);
+  if (s_count < CAP_BUFFER)
+    s_count++;
+
+  if (edge == CAP_RISE) {
+    s_new  = 1;
+    s_next = CAP_FALL;
+  }
+  else
+    s_next = CAP_RISE;
+
+} // cap_push
+
+
+
+/**
+  \fn void cap_read_rise(void)
+
+  \brief store pending rising edge (CC1) in buffer (ISR context)
+
+  Read MSB first. Reading LSB clears the flag.
+*/
+static void cap_read_rise(void) {
+
+  uint16_t  time;
+
+  if (CAP_REG(_SR1) & CAP_CC1IF) {
+    time  = ((uint16_t) CAP_REG(_CCR1H)) << 8;
+    time |= CAP_REG(_CCR1L);
+    cap_push(time, CAP_RISE);
+  }
+
+} // cap_read_rise
+
+
+
+/**
+  \fn void cap_read_fall(void)
+
+  \brief store pending falling edge (CC2) in buffer (ISR context)
+
+  Read MSB first. Reading LSB clears the flag.
+*/
+static void cap_read_fall(void) {
+
+  uint16_t  time;
+
+  if (CAP_REG(_SR1) & CAP_CC2IF) {
+    time  = ((uint16_t) CAP_REG(_CCR2H)) << 8;
+    time |= CAP_REG(_CCR2L);
+    cap_push(time, CAP_FALL);
+  }
+
+} // cap_read_fall
+
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void cap_init(void)
+
+  \brief init and start input capture
+
+  Configure channel 1 and 2 of CAP_TIMER to capture both edges of TI1
+  with CAP_FILTER, and start the free-running counter.
+*/
+void cap_init(void) {
+
+  // reset buffer
+  s_head    = 0;
+  s_count   = 0;
+  s_next    = CAP_RISE;
+  s_new     = 0;
+  s_overrun = 0;
+
+  // stop timer
+  CAP_REG(_CR1)   = 0x00;
+  CAP_REG(_CCER1) = 0x00;
+
+  // set timer prescaler. TIM1 has linear 16-bit prescaler, others 2^n
+  #if (CAP_TIMER == 1)
+    _TIM1_PSCRH = (uint8_t) (((1L << CAP_PRESCALER) - 1) >> 8);
+    _TIM1_PSCRL = (uint8_t) ((1L << CAP_PRESCALER) - 1);
+  #else
+    CAP_REG(_PSCR) = CAP_PRESCALER;
+  #endif
+
+  // free-running counter over full 16-bit range
+  CAP_REG(_ARRH) = 0xFF;
+  CAP_REG(_ARRL) = 0xFF;
+
+  // CC1 captures rising, CC2 captures falling edge of TI1
+  CAP_REG(_CCMR1) = CAP_CCMR1;
+  CAP_REG(_CCMR2) = CAP_CCMR2;
+  CAP_REG(_CCER1) = CAP_REG(_CCER1_CC1E) | CAP_REG(_CCER1_CC2E) | CAP_REG(_CCER1_CC2P);
+
+  // load prescaler, clear flags, enable capture interrupts and start timer
+  CAP_REG(_EGR) = CAP_REG(_EGR_UG);
+  CAP_REG(_SR1) = 0x00;
+  CAP_REG(_SR2) = 0x00;
+  CAP_REG(_IER) = CAP_CC1IE | CAP_CC2IE;
+  CAP_REG(_CR1) = CAP_REG(_CR1_CEN);
+
+} // cap_init
+
+
+
+/**
+  \fn uint8_t cap_get(cap_t *result)
+
+  \brief get latest complete signal period
+
+  \param[out] result   period and high time [timer ticks]
+
+  \return 1 if a new period was measured since last call, else 0
+
+  Search the buffer backwards for the latest sequence rise-fall-rise.
+  If no edge is captured for a long time, e.g. for a constant signal,
+  no new result is returned. Timeout is handled by the application.
+*/
+uint8_t cap_get(cap_t *result) {
+
+  uint16_t  time[3];
+  uint8_t   edge[3];
+  uint8_t   idx, count, i;
+
+  // copy latest entries with ISR locked
+  CAP_LOCK();
+  if (!s_new) {
+    CAP_UNLOCK();
+    return(0);
+  }
+  s_new = 0;
+  idx   = s_head;
+  count = s_count;
+  for (i=0; (i<count) && (i<CAP_BUFFER); i++) {
+
+    // newest first
+    idx = (idx - 1) & (CAP_BUFFER - 1);
+
+    // shift window of 3 edges
+    time[2] = time[1];  edge[2] = edge[1];
+    time[1] = time[0];  edge[1] = edge[0];
+    time[0] = s_time[idx];
+    edge[0] = s_edge[idx];
+
+    // found rise(2) - fall(1) - rise(0), i.e. time[2] is newest
+    if ((i >= 2) && (edge[2] == CAP_RISE) && (edge[1] == CAP_FALL) && (edge[0] == CAP_RISE)) {
+      CAP_UNLOCK();
+      result->period = time[2] - time[0];
+      result->high   = time[1] - time[0];
+      return(1);
+    }
+
+  } // loop over buffer
+  CAP_UNLOCK();
+
+  // no complete period yet
+  return(0);
+
+} // cap_get
+
+
+
+/**
+  \fn uint32_t cap_freq(const cap_t *result)
+
+  \brief get signal frequency
+
+  \param[in]  result   result of cap_get()
+
+  \return frequency [Hz], 0 if invalid
+*/
+uint32_t cap_freq(const cap_t *result) {
+
+  if (result->period == 0)
+    return(0);
+  return(((uint32_t) CAP_CLOCK + (result->period >> 1)) / result->period);
+
+} // cap_freq
+
+
+
+/**
+  \fn uint16_t cap_duty(const cap_t *result)
+
+  \brief get duty cycle
+
+  \param[in]  result   result of cap_get()
+
+  \return duty cycle [0.1%], 0 if invalid
+*/
+uint16_t cap_duty(const cap_t *result) {
+
+  if (result->period == 0)
+    return(0);
+  return((uint16_t) (((uint32_t) result->high * 1000L + (result->period >> 1)) / result->period));
+
+} // cap_duty
+
+
+
+/**
+  \fn uint8_t cap_overruns(void)
+
+  \brief get and reset number of overcaptures
+
+  \return number of overcaptures since last call
+
+  An overcapture means that an edge was lost, e.g. if signal is faster
+  than the ISR. Affected periods are ignored by cap_get().
+*/
+uint8_t cap_overruns(void) {
+
+  uint8_t  num;
+
+  CAP_LOCK();
+  num = s_overrun;
+  s_overrun = 0;
+  CAP_UNLOCK();
+
+  return(num);
+
+} // cap_overruns
+
+
+
+/**
+  \fn void CAP_ISR(void)
+
+  \brief ISR for capture events of CAP_TIMER
+
+  Store timestamps of rising and falling edges in ring buffer.
+
+  Notes:
+    - vector of TIM2 and TIM5 is shared, but only one exists per device
+    - for Cosmic compiler, add CAP_ISR also to 'stm8_interrupt_vector.c'
+    - IAR compiler has an IRQ offset of +2 compared to STM8 datasheet (see below)
+*/
+#if defined(_IAR_)
+   #pragma vector = 2+CAP_VECTOR    // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(CAP_ISR, CAP_VECTOR)
+{
+  // edge lost -> restart sequence, i.e. drop buffer
+  if (CAP_REG(_SR2) & (CAP_CC1OF | CAP_CC2OF)) {
+    CAP_REG(_SR2) = 0x00;
+    s_count = 0;
+    s_overrun++;
+  }
+
+  // read both channels, expected edge first
+  if (s_next == CAP_RISE) {
+    cap_read_rise();
+    cap_read_fall();
+  }
+  else {
+    cap_read_fall();
+    cap_read_rise();
+  }
+
+} // CAP_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,108 @@
+/**
+  \file capture.h
+
+  \brief declaration of input capture for frequency and duty measurement
+
+  Measure period and high time of a signal on channel 1 of TIM1, TIM2,
+  TIM3 or TIM5 (selected via CAP_TIMER). Both edges are captured by
+  hardware, i.e. CC1 on rising and CC2 on falling edge of TI1. The CAPCOM
+  ISR only stores timestamps in a ring buffer. Period and duty cycle are
+  calculated when requested by the application.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _CAPTURE_H_
+#define _CAPTURE_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// CPU clock = timer clock [Hz]
+#if !defined(F_CPU)
+  #define F_CPU             16000000L     ///< CPU clock [Hz]
+#endif
+
+// capture timer (1, 2, 3 or 5), input is channel 1
+#if !defined(CAP_TIMER)
+  #define CAP_TIMER         2             ///< timer for capture
+#endif
+
+// timer clock = F_CPU / 2^CAP_PRESCALER. Max. measurable period is 65536 ticks
+#if !defined(CAP_PRESCALER)
+  #define CAP_PRESCALER     0             ///< timer prescaler exponent (0..15)
+#endif
+
+// digital input filter ICxF, see reference manual (0=off)
+#if !defined(CAP_FILTER)
+  #define CAP_FILTER        0             ///< input filter (0..15)
+#endif
+
+// number of stored edges (power of 2, min. 4)
+#if !defined(CAP_BUFFER)
+  #define CAP_BUFFER        8             ///< ring buffer size [edges]
+#endif
+
+/// timer tick frequency [Hz]
+#define CAP_CLOCK           (F_CPU >> CAP_PRESCALER)
+
+// interrupt vector of selected timer
+#if (CAP_TIMER == 1)
+  #define CAP_VECTOR        __TIM1_CAPCOM_VECTOR__
+#elif (CAP_TIMER == 2)
+  #define CAP_VECTOR        __TIM2_CAPCOM_VECTOR__
+#elif (CAP_TIMER == 3)
+  #define CAP_VECTOR        __TIM3_CAPCOM_VECTOR__
+#elif (CAP_TIMER == 5)
+  #define CAP_VECTOR        __TIM5_CAPCOM_VECTOR__
+#else
+  #error CAP_TIMER must be 1, 2, 3 or 5
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// result of one signal period
+typedef struct {
+  uint16_t  period;         ///< period [timer ticks]
+  uint16_t  high;           ///< high time [timer ticks]
+} cap_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+ISR_HANDLER(CAP_ISR, CAP_VECTOR);
+
+/// init and start timer in input capture mode. Interrupts must be enabled by application
+void      cap_init(void);
+
+/// get latest complete period. Return 1 if a new period was measured since last call, else 0
+uint8_t   cap_get(cap_t *result);
+
+/// get signal frequency [Hz] from result
+uint32_t  cap_freq(const cap_t *result);
+
+/// get duty cycle [0.1%] from result
+uint16_t  cap_duty(const cap_t *result);
+
+/// get and reset number of capture overruns (ISR too slow or signal too fast)
+uint8_t   cap_overruns(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _CAPTURE_H_
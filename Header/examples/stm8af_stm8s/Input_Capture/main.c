@@ -0,0 +1,87 @@
+/**********************
+  STM8 measure frequency and duty cycle via input capture
+  Demonstrate capture of both edges with lazy evaluation
+
+  Functionality:
+  - init FCPU to 16MHz
+  - init UART2
+  - generate test signal via TIM2 (D6=PD3, 1kHz, 30%)
+  - capture both edges via TIM1 (PC1). Connect PD3 to PC1
+  - print frequency and duty cycle via UART2
+
+  Boards:
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "capture.h"      // input capture (declares CAP_ISR)
+
+// define communication speed
+#define BAUDRATE   9600
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint16_t  BRR;
+  uint32_t  i;
+  cap_t     result;
+
+  ////
+  // initialization
+  ////
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // set UART2 baudrate (note: BRR2 must be written before BRR1!)
+  BRR = (uint16_t) (((uint32_t) 16000000L)/BAUDRATE);
+  _UART2_BRR2 = (uint8_t) (((BRR & 0xF000) >> 8) | (BRR & 0x000F));
+  _UART2_BRR1 = (uint8_t) ((BRR & 0x0FF0) >> 4);
+
+  // enable UART2 sender
+  _UART2_CR2 |= _UART2_CR2_TEN;
+
+  // test signal on TIM2_CC2 (PD3): 1MHz timer clock, 1kHz, 30%
+  _PORTD_DDR |= _PORT_PIN3;
+  _PORTD_CR1 |= _PORT_PIN3;
+  _TIM2_PSCR  = 4;
+  _TIM2_ARRH  = (uint8_t) (999 >> 8);
+  _TIM2_ARRL  = (uint8_t) (999 & 0xFF);
+  _TIM2_CCR2H = (uint8_t) (300 >> 8);
+  _TIM2_CCR2L = (uint8_t) (300 & 0xFF);
+  _TIM2_CCMR2 = (6 << 4) | _TIM2_CCMR2_OC2PE;  // PWM mode 1 with preload
+  _TIM2_CCER1 = _TIM2_CCER1_CC2E;
+  _TIM2_CR1   = _TIM2_CR1_ARPE | _TIM2_CR1_CEN;
+
+  // init input capture (see main.h)
+  cap_init();
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // evaluate latest period
+    if (cap_get(&result))
+      printf("f=%ldHz  duty=%d.%d%%  overruns=%d\n", (long) cap_freq(&result),
+        cap_duty(&result) / 10, cap_duty(&result) % 10, (int) cap_overruns());
+    else
+      printf("no signal\n");
+
+    // wait a while
+    for (i=0; i<500000L; i++)
+      NOP();
+
+  } // main loop
+
+} // main()
@@ -0,0 +1,20 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8S105K6.h"	// sduino-uno (https://github.com/roybaer/sduino_uno)
+#include "stdio.h"
+
+
+/*----------------------------------------------------------
+    CAPTURE CONFIGURATION
+----------------------------------------------------------*/
+
+// timer clock
+#define F_CPU           16000000L
+
+// capture on TIM1_CH1 (PC1) with 1MHz resolution, i.e. max. 65.5ms period
+#define CAP_TIMER       1
+#define CAP_PRESCALER   4
+
+// input filter: 8 samples at fMaster/8
+#define CAP_FILTER      9
@@ -0,0 +1,167 @@
+/**********************
+  STM8 tickless low-power scheduler
+  Demonstrate WAIT, Active-Halt with AWU and Halt modes
+
+  Functionality:
+  - init FCPU to 16MHz
+  - configure LED pin as output and button pin as input with interrupt
+  - flash LED for 20ms every 3s (Active-Halt in between)
+  - on falling edge of button pin, flash LED 3x (event task)
+  - CPU sleeps in lowest possible power mode between tasks
+
+  Boards:
+  - STM8SDiscovery   https://www.st.com/en/evaluation-tools/stm8s-discovery.html
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"         // defines board & STM8 device
+#include "timebase.h"     // timebase (incl. TIM4 ISR declaration)
+#include "scheduler.h"    // low-power scheduler (incl. AWU ISR declaration)
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file!!!
+ISR_HANDLER(PORTB_ISR, __PORTB_VECTOR__);
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// task handles
+uint8_t   g_taskLedOff;
+uint8_t   g_taskButton;
+
+// remaining LED flashes after button press
+uint8_t   g_numFlash;
+
+
+// switch LED on
+void LED_on(void) {
+
+  #if BOARD == STM8S_DISCOVERY     // STM8S-Discovery -> PD0 (low active)
+    _PORTD_ODR &= ~_PORT_PIN0;
+  #else                            // sduino-UNO -> PC5
+    _PORTC_ODR |= _PORT_PIN5;
+  #endif
+
+} // LED_on
+
+
+// switch LED off
+void LED_off(void) {
+
+  #if BOARD == STM8S_DISCOVERY     // STM8S-Discovery -> PD0 (low active)
+    _PORTD_ODR |= _PORT_PIN0;
+  #else                            // sduino-UNO -> PC5
+    _PORTC_ODR &= ~_PORT_PIN5;
+  #endif
+
+} // LED_off
+
+
+// periodic task: switch LED on, single-shot task switches it off after 20ms
+void task_heartbeat(void) {
+
+  LED_on();
+  sched_start(g_taskLedOff, 20);
+
+} // task_heartbeat
+
+
+// single-shot task: switch LED off, repeat for button flashes
+void task_LED_off(void) {
+
+  LED_off();
+  if (g_numFlash && --g_numFlash)
+    sched_start(g_taskButton, 200);
+
+} // task_LED_off
+
+
+// event task: started from button ISR, flash LED 3x
+void task_button(void) {
+
+  if (g_numFlash == 0)
+    g_numFlash = 3;
+  LED_on();
+  sched_start(g_taskLedOff, 100);
+
+} // task_button
+
+
+/**
+  \fn void PORTB_ISR(void)
+
+  \brief ISR for port B external interrupt
+
+  Trigger button task. Also wakes CPU from Halt.
+
+  Notes:
+    - for Cosmic compiler, add PORTB_ISR also to 'stm8_interrupt_vector.c'
+    - IAR compiler has an IRQ offset of +2 compared to STM8 datasheet (see below)
+*/
+#if defined(_IAR_)
+   #pragma vector = 2+__PORTB_VECTOR__    // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(PORTB_ISR, __PORTB_VECTOR__)
+{
+  sched_trigger(g_taskButton);
+
+} // PORTB_ISR
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  ////
+  // initialization
+  ////
+
+  // disable interrupts for initialization
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz clock (reset is 2MHz). Must match F_CPU in timebase.h
+  _CLK_CKDIVR = 0x00;
+
+  // configure LED pin to output push-pull
+  #if BOARD == STM8S_DISCOVERY     // STM8S-Discovery -> PD0
+    _PORTD_DDR |= _PORT_PIN0;
+    _PORTD_CR1 |= _PORT_PIN0;
+  #else                            // sduino-UNO -> PC5
+    _PORTC_DDR |= _PORT_PIN5;
+    _PORTC_CR1 |= _PORT_PIN5;
+  #endif
+  LED_off();
+
+  // configure button pin PB0 to input pull-up with interrupt on falling edge
+  _PORTB_CR1 |= _PORT_PIN0;
+  _PORTB_CR2 |= _PORT_PIN0;
+  _EXTI_CR1   = (_EXTI_CR1 & ~_EXTI_CR1_PBIS) | _EXTI_CR1_PBIS1;
+
+  // init scheduler and TIM4 timebase
+  sched_init();
+
+  // add tasks in order of priority
+  g_taskLedOff = sched_add(task_LED_off, SCHED_NEVER, 0);
+  g_taskButton = sched_add(task_button, SCHED_NEVER, 0);
+  sched_add(task_heartbeat, 3000, 3000);
+
+  // enable interrupts after initialization
+  ENABLE_INTERRUPTS();
+
+
+  ////
+  // main loop (never returns)
+  ////
+  sched_run();
+
+} // main()
@@ -0,0 +1,353 @@
+/**
+  \file scheduler.c
+
+  \brief implementation of tickless low-power cooperative scheduler
+
+  Time is kept by the TIM4 timebase, which only runs while the CPU is
+  active or in WAIT mode. For long waits the AWU is set to the longest
+  period not exceeding the next deadline, and the CPU enters Active-Halt.
+  After wake-up via AWU the programmed period is added to the timebase.
+  On wake-up by another interrupt the time spent in Active-Halt is unknown
+  and not compensated.
+
+  AWU timing assumes the nominal LSI frequency of 128kHz. Then the AWU
+  period is APRDIV * 2^(AWUTB-8) ms for AWUTB=8..13, i.e. 2ms to 2048ms.
+
+  The decision to sleep is taken with interrupts disabled. WFI and HALT
+  enable interrupts atomically, so a task triggered by an ISR just before
+  is never missed.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "scheduler.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if (SCHED_AHALT_MIN_MS < 2)
+  #error SCHED_AHALT_MIN_MS must be >=2ms (min. AWU period)
+#endif
+
+// max. AWU period with 1ms resolution
+#define SCHED_AWU_MAX_MS    2048                ///< max. AWU period [ms]
+
+// task flags
+#define SCHED_TIMED         0x01                ///< task timer running
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// task control block
+typedef struct {
+  sched_func_t  func;           ///< task function
+  uint32_t      due;            ///< next execution [ms]
+  uint16_t      period;         ///< period [ms] (0=single shot)
+  uint8_t       flags;          ///< task state
+} sched_task_t;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+static sched_task_t      s_task[SCHED_MAX_TASKS];    ///< task list
+static volatile uint8_t  s_ready[SCHED_MAX_TASKS];   ///< task triggered (byte access is atomic)
+static uint8_t           s_numTasks;                 ///< number of tasks
+static volatile uint8_t  s_awuWake;                  ///< wake-up via AWU
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn uint16_t sched_awu_setup(uint32_t wait)
+
+  \brief configure AWU for longest period not exceeding wait
+
+  \param[in]  wait   time until next deadline [ms] (>=2ms)
+
+  \return AWU period [ms]
+
+  Select smallest timebase with APRDIV<=64 for best resolution.
+*/
+static uint16_t sched_awu_setup(uint32_t wait) {
+
+  uint8_t  tb = 8;
+  uint8_t  aprdiv;
+
+  // limit to max. AWU period, longer waits are split
+  if (wait > SCHED_AWU_MAX_MS)
+    wait = SCHED_AWU_MAX_MS;
+
+  // period = APRDIV * 2^(tb-8) ms
+  while ((wait >> (tb-8)) > 64)
+    tb++;
+  aprdiv = (uint8_t) (wait >> (tb-8));
+
+  // set AWU registers (APR = APRDIV-2)
+  _AWU_APR = aprdiv - 2;
+  _AWU_TBR = tb;
+
+  return((uint16_t) aprdiv << (tb-8));
+
+} // sched_awu_setup
+
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void sched_init(void)
+
+  \brief init scheduler
+
+  Init TIM4 timebase, start LSI for AWU and configure low-power modes.
+  Interrupts must be enabled by application.
+*/
+void sched_init(void) {
+
+  // no tasks yet
+  s_numTasks = 0;
+
+  // init 1ms timebase
+  tb_init();
+
+  // start LSI as AWU clock
+  _CLK_ICKR |= _CLK_ICKR_LSIEN;
+  while (!(_CLK_ICKR & _CLK_ICKR_LSIRDY));
+
+  // power down flash in (Active-)Halt, and regulator in Active-Halt
+  _FLASH_CR1 |= (_FLASH_CR1_AHALT | _FLASH_CR1_HALT);
+  _CLK_ICKR  |= _CLK_ICKR_REGAH;
+
+  // AWU disabled until needed
+  _AWU_CSR = 0x00;
+
+} // sched_init
+
+
+
+/**
+  \fn uint8_t sched_add(sched_func_t func, uint16_t delay, uint16_t period)
+
+  \brief add task to scheduler
+
+  \param[in]  func     task function
+  \param[in]  delay    delay until first execution [ms] (SCHED_NEVER=event only)
+  \param[in]  period   period for repeated execution [ms] (0=single shot)
+
+  \return task handle, or SCHED_NONE if task list is full
+
+  Tasks with lower handle (i.e. added first) have higher priority.
+*/
+uint8_t sched_add(sched_func_t func, uint16_t delay, uint16_t period) {
+
+  uint8_t  task = s_numTasks;
+
+  if (task >= SCHED_MAX_TASKS)
+    return(SCHED_NONE);
+
+  s_task[task].func   = func;
+  s_task[task].period = period;
+  s_task[task].flags  = 0;
+  s_ready[task] = 0;
+  s_numTasks++;
+
+  if (delay != SCHED_NEVER)
+    sched_start(task, delay);
+
+  return(task);
+
+} // sched_add
+
+
+
+/**
+  \fn void sched_start(uint8_t task, uint16_t delay)
+
+  \brief (re-)start task timer
+
+  \param[in]  task    task handle
+  \param[in]  delay   delay until next execution [ms]
+
+  Start task timer. The task period is kept. Call from main context only.
+*/
+void sched_start(uint8_t task, uint16_t delay) {
+
+  s_task[task].due   = tb_millis() + delay;
+  s_task[task].flags |= SCHED_TIMED;
+
+} // sched_start
+
+
+
+/**
+  \fn void sched_trigger(uint8_t task)
+
+  \brief mark task as ready
+
+  \param[in]  task    task handle
+
+  Task is executed in next scheduler loop. Can be called from ISR.
+*/
+void sched_trigger(uint8_t task) {
+
+  s_ready[task] = 1;
+
+} // sched_trigger
+
+
+
+/**
+  \fn void sched_run(void)
+
+  \brief scheduler main loop
+
+  Execute due and triggered tasks in order of priority. Then sleep in the
+  lowest power mode which meets the next deadline. Never returns.
+*/
+void sched_run(void) {
+
+  sched_task_t  *t;
+  uint32_t      now, expire;
+  int32_t       wait, minWait;
+  uint16_t      sleep;
+  uint8_t       i, run, timed;
+
+  while (1) {
+
+    ////
+    // execute due and triggered tasks
+    ////
+    run = 0;
+    now = tb_millis();
+    for (i=0; i<s_numTasks; i++) {
+      t = &(s_task[i]);
+
+      // check for triggered task (atomic byte access)
+      if (s_ready[i]) {
+        s_ready[i] = 0;
+        run = 1;
+      }
+
+      // check task timer. Periodic tasks keep phase unless an execution was missed
+      else if ((t->flags & SCHED_TIMED) && ((int32_t) (now - t->due) >= 0)) {
+        if (t->period != 0) {
+          t->due += t->period;
+          if ((int32_t) (now - t->due) >= 0)
+            t->due = now + t->period;
+        }
+        else
+          t->flags &= ~SCHED_TIMED;
+        run = 1;
+      }
+      else
+        continue;
+
+      // execute task
+      t->func();
+
+    } // loop over tasks
+
+    // execute software timers of timebase
+    tb_poll();
+
+    // check again before sleeping
+    if (run)
+      continue;
+
+
+    ////
+    // sleep until next deadline. Decide with interrupts disabled
+    ////
+    DISABLE_INTERRUPTS();
+
+    // find next deadline, abort if task was triggered meanwhile
+    now = tb_millis();
+    minWait = INT32_MAX;
+    timed = 0;
+    for (i=0; i<s_numTasks; i++) {
+      if (s_ready[i])
+        break;
+      if (s_task[i].flags & SCHED_TIMED) {
+        wait = (int32_t) (s_task[i].due - now);
+        if (wait < minWait)
+          minWait = wait;
+        timed = 1;
+      }
+    }
+
+    // software timers of timebase need TIM4 or AWU wake-up, too
+    if ((i == s_numTasks) && tb_next_expiry(&expire)) {
+      wait = (int32_t) (expire - now);
+      if (wait < minWait)
+        minWait = wait;
+      timed = 1;
+    }
+    if ((i < s_numTasks) || (timed && (minWait <= 0))) {
+      ENABLE_INTERRUPTS();
+      continue;
+    }
+
+    // no timed task or timer -> Halt mode, wake-up only via external interrupt
+    if (!timed) {
+      ENTER_HALT();
+    }
+
+    // short wait -> WAIT mode, wake-up via 1ms timebase interrupt
+    else if (minWait < SCHED_AHALT_MIN_MS) {
+      WAIT_FOR_INTERRUPT();
+    }
+
+    // long wait -> Active-Halt mode with AWU, then compensate timebase
+    else {
+      sleep = sched_awu_setup((uint32_t) minWait);
+      s_awuWake = 0;
+      _AWU_CSR = _AWU_CSR_AWUEN;
+      ENTER_HALT();
+      _AWU_CSR = 0x00;
+      if (s_awuWake)
+        tb_advance(sleep);
+    }
+
+  } // main loop
+
+} // sched_run
+
+
+
+/**
+  \fn void AWU_ISR(void)
+
+  \brief ISR for auto wake-up
+
+  Wake-up from Active-Halt via AWU. Reading AWU_CSR clears the AWUF flag.
+
+  Notes:
+    - for Cosmic compiler, add AWU_ISR also to 'stm8_interrupt_vector.c'
+    - IAR compiler has an IRQ offset of +2 compared to STM8 datasheet (see below)
+*/
+#if defined(_IAR_)
+   #pragma vector = 2+__AWU_VECTOR__    // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(AWU_ISR, __AWU_VECTOR__)
+{
+  // read and clear AWU flag
+  if (_AWU_CSR & _AWU_CSR_AWUF)
+    s_awuWake = 1;
+
+} // AWU_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
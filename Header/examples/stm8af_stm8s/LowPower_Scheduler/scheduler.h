@@ -0,0 +1,84 @@
+/**
+  \file scheduler.h
+
+  \brief declaration of tickless low-power cooperative scheduler
+
+  Cooperative scheduler for periodic and event-triggered tasks. When no
+  task is due, the CPU sleeps in the lowest power mode that still meets
+  the next deadline:
+    - WAIT mode for short waits (TIM4 timebase keeps running)
+    - Active-Halt mode with AWU wake-up for long waits
+    - Halt mode with wake-up via external interrupt if no task is timed
+  Running software timers of the timebase are deadlines, too. Time spent in
+  Active-Halt is added to the timebase after wake-up.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+#include "timebase.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// max. number of tasks
+#if !defined(SCHED_MAX_TASKS)
+  #define SCHED_MAX_TASKS       8             ///< max. number of tasks
+#endif
+
+// shorter waits use WAIT mode, longer waits use Active-Halt mode
+#if !defined(SCHED_AHALT_MIN_MS)
+  #define SCHED_AHALT_MIN_MS    10            ///< min. wait [ms] for Active-Halt mode
+#endif
+
+// task is only triggered via sched_trigger()
+#define SCHED_NEVER             0xFFFF        ///< delay for event-triggered tasks
+
+// invalid task handle
+#define SCHED_NONE              0xFF          ///< sched_add() failed
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// task function. Must return to scheduler (cooperative)
+typedef void (*sched_func_t)(void);
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+ISR_HANDLER(AWU_ISR, __AWU_VECTOR__);
+
+/// init scheduler and timebase. Interrupts must be enabled by application
+void      sched_init(void);
+
+/// add task with initial delay (SCHED_NEVER=event only) and period (0=single shot). Return handle
+uint8_t   sched_add(sched_func_t func, uint16_t delay, uint16_t period);
+
+/// (re-)start task timer with delay [ms]. Period is kept
+void      sched_start(uint8_t task, uint16_t delay);
+
+/// mark task as ready, e.g. from ISR
+void      sched_trigger(uint8_t task);
+
+/// execute tasks and sleep in between. Never returns
+void      sched_run(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _SCHEDULER_H_
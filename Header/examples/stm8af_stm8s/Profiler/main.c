@@ -0,0 +1,183 @@
+/**********************
+  STM8 hot-path profiler
+  Demonstrate cycle measurement of functions and ISRs with PROF_ENTER/PROF_EXIT
+
+  Functionality:
+  - init FCPU to 16MHz
+  - init UART2 and TIM4 1ms interrupt
+  - main loop filters a sample buffer and calculates a checksum
+  - main loop, functions and TIM4 ISR are instrumented
+  - on key 'p' send binary dump via UART2
+  - evaluate on PC with 'benchmark/prof_report.py -i main.h <dumpfile>'
+  - requires -DSTM8_PROF (see Makefile), else instrumentation is removed
+
+  Boards:
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "prof.h"
+
+// define communication speed
+#define BAUDRATE   115200
+
+// number of samples
+#define NUM_SAMPLES  16
+
+// declaration of TIM4 ISR
+ISR_HANDLER(TIM4_UPD_ISR, __TIM4_UPD_OVF_VECTOR__);
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// ms counter (increased in TIM4_UPD_ISR)
+volatile uint16_t   g_millis = 0;
+
+// sample buffer and filter output
+uint16_t            g_sample[NUM_SAMPLES];
+uint16_t            g_filter[NUM_SAMPLES];
+
+
+/**
+  \fn void TIM4_UPD_ISR(void)
+
+  \brief TIM4 update ISR, 1ms time base
+*/
+ISR_HANDLER(TIM4_UPD_ISR, __TIM4_UPD_OVF_VECTOR__) {
+
+  PROF_ENTER(PROF_ID_TIM4);
+  _TIM4_SR = 0x00;
+  g_millis++;
+  PROF_EXIT(PROF_ID_TIM4);
+
+} // TIM4_UPD_ISR
+
+
+
+/**
+  \fn uint16_t checksum(uint16_t *buf, uint8_t len)
+
+  \brief calculate 16-bit checksum
+
+  \param[in]  buf   data
+  \param[in]  len   number of values
+
+  \return sum over data
+*/
+uint16_t checksum(uint16_t *buf, uint8_t len) {
+
+  uint16_t  sum = 0;
+
+  PROF_ENTER(PROF_ID_SUM);
+  while (len--)
+    sum += *(buf++);
+  PROF_EXIT(PROF_ID_SUM);
+
+  return(sum);
+
+} // checksum
+
+
+
+/**
+  \fn uint16_t filter(void)
+
+  \brief moving average over 4 samples, then checksum of result
+
+  \return checksum of filter output
+*/
+uint16_t filter(void) {
+
+  uint8_t   i;
+  uint16_t  sum;
+
+  PROF_ENTER(PROF_ID_FILTER);
+  for (i=3; i<NUM_SAMPLES; i++)
+    g_filter[i] = (g_sample[i] + g_sample[i-1] + g_sample[i-2] + g_sample[i-3]) >> 2;
+  sum = checksum(g_filter, NUM_SAMPLES);
+  PROF_EXIT(PROF_ID_FILTER);
+
+  return(sum);
+
+} // filter
+
+
+
+/**
+  \fn void uart_send(uint8_t data)
+
+  \brief send byte via UART2
+
+  \param[in]  data   byte to send
+*/
+void uart_send(uint8_t data) {
+
+  while (!(_UART2_SR & _UART2_SR_TXE));
+  _UART2_DR = data;
+
+} // uart_send
+
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint8_t   i;
+  uint16_t  last = 0;
+
+
+  ////
+  // initialization
+  ////
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // set UART2 baudrate (note: BRR2 must be written before BRR1!) and enable receiver & sender
+  _UART2_BRR2 = (uint8_t) ((((F_CPU/BAUDRATE) & 0xF000) >> 8) | ((F_CPU/BAUDRATE) & 0x000F));
+  _UART2_BRR1 = (uint8_t) (((F_CPU/BAUDRATE) & 0x0FF0) >> 4);
+  _UART2_CR2 |= (_UART2_CR2_REN | _UART2_CR2_TEN);
+
+  // init TIM4 for 1ms interrupt (16MHz/2^6 = 250kHz, 250 ticks)
+  _TIM4_PSCR = 6;
+  _TIM4_ARR  = 249;
+  _TIM4_IER  = _TIM4_IER_UIE;
+  _TIM4_CR   = _TIM4_CR_ARPE | _TIM4_CR_CEN;
+
+  // start profiler timestamp
+  prof_init();
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // every 10ms process new data
+    if ((uint16_t) (g_millis - last) >= 10) {
+      last += 10;
+
+      PROF_ENTER(PROF_ID_LOOP);
+      for (i=0; i<NUM_SAMPLES; i++)
+        g_sample[i] += i;
+      filter();
+      PROF_EXIT(PROF_ID_LOOP);
+    }
+
+    // on key 'p' send profile
+    if ((_UART2_SR & _UART2_SR_RXNE) && (_UART2_DR == 'p'))
+      prof_dump(uart_send);
+
+  } // main loop
+
+} // main()
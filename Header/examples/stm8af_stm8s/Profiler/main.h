@@ -0,0 +1,23 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8S105K6.h"	// sduino-uno (https://github.com/roybaer/sduino_uno)
+
+
+/*----------------------------------------------------------
+    PROFILER CONFIGURATION
+----------------------------------------------------------*/
+
+// CPU clock
+#define F_CPU           16000000L
+
+// TIM1 timestamp with 1 CPU cycle resolution, 128 events
+#define PROF_TIMER      1
+#define PROF_PSCR       0
+#define PROF_SIZE       128
+
+// section IDs (0..127). Names are read by prof_report.py
+#define PROF_ID_LOOP    1
+#define PROF_ID_FILTER  2
+#define PROF_ID_SUM     3
+#define PROF_ID_TIM4    4
@@ -0,0 +1,216 @@
+/**
+  \file prof.c
+
+  \brief implementation of hot-path profiler
+
+  Each event stores the 16-bit timer counter and a tag (ID, bit 7 = exit).
+  The timer is read first, so the recorded time excludes the store. Time and
+  tag are kept in separate arrays, which avoids a multiplication for indexing.
+  Storing is done with interrupts disabled, so ISRs can be profiled as well.
+  Dump format (little endian, see benchmark/prof_report.py):
+    - header:  'SPRF', timestamp frequency [kHz] (2B), CPU frequency [kHz] (2B), overhead [ticks] (2B), number of events (2B)
+    - event:   timestamp (2B), tag, oldest event first
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "prof.h"
+#if defined(_IAR_)
+  #include <intrinsics.h>
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if !defined(STM8_PROF)
+  #error compile with -DSTM8_PROF
+#endif
+#if (PROF_SIZE < 2) || (PROF_SIZE > 256) || (PROF_SIZE & (PROF_SIZE - 1))
+  #error PROF_SIZE must be a power of 2 (2..256)
+#endif
+#if (PROF_PSCR > 15)
+  #error PROF_PSCR must be 0..15
+#endif
+
+// timer registers. TIM1 has linear prescaler, TIM3 2^n
+#if (PROF_TIMER == 1)
+  #define PROF_CNTRH        _TIM1_CNTRH
+  #define PROF_CNTRL        _TIM1_CNTRL
+#elif (PROF_TIMER == 3) && defined(_TIM3_CNTRH)
+  #define PROF_CNTRH        _TIM3_CNTRH
+  #define PROF_CNTRL        _TIM3_CNTRL
+#else
+  #error PROF_TIMER not available
+#endif
+
+// index mask of ring buffer
+#define PROF_MASK           ((uint8_t) (PROF_SIZE - 1))
+
+// atomic timestamps need SAVE_AND_DISABLE_INTERRUPTS() of family header
+#if !defined(SAVE_AND_DISABLE_INTERRUPTS)
+  #error compiler not supported
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// interrupt state while storing a timestamp. Only accessed with interrupts disabled
+volatile uint8_t          g_profCC;
+
+// ring buffer of timestamps and tags
+static uint16_t           s_time[PROF_SIZE];
+static uint8_t            s_tag[PROF_SIZE];
+
+// index of next event, number of stored events and recording flag
+static volatile uint8_t   s_head;
+static volatile uint16_t  s_count;
+static volatile uint8_t   s_active;
+
+// timer ticks of an empty PROF_ENTER()/PROF_EXIT() pair
+static uint16_t           s_overhead;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void prof_put16(void (*out)(uint8_t), uint16_t data)
+
+  \brief send 16-bit value little endian
+
+  \param[in]  out     send function
+  \param[in]  data    value to send
+*/
+static void prof_put16(void (*out)(uint8_t), uint16_t data) {
+
+  out((uint8_t) data);
+  out((uint8_t) (data >> 8));
+
+} // prof_put16
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void prof_init(void)
+
+  \brief init profiler
+
+  Start timer as free running 16-bit counter with 2^PROF_PSCR prescaler.
+  Then measure the overhead of an empty section, which is subtracted on
+  the PC. Recording is active afterwards.
+*/
+void prof_init(void) {
+
+  // free running timer, load prescaler via update event
+#if (PROF_TIMER == 1)
+  _TIM1_CR1   = 0x00;
+  _TIM1_PSCRH = (uint8_t) (((1L << PROF_PSCR) - 1) >> 8);
+  _TIM1_PSCRL = (uint8_t) ((1L << PROF_PSCR) - 1);
+  _TIM1_ARRH  = 0xFF;
+  _TIM1_ARRL  = 0xFF;
+  _TIM1_EGR   = _TIM1_EGR_UG;
+  _TIM1_CR1   = _TIM1_CR1_CEN;
+#else
+  _TIM3_CR1   = 0x00;
+  _TIM3_PSCR  = PROF_PSCR;
+  _TIM3_ARRH  = 0xFF;
+  _TIM3_ARRL  = 0xFF;
+  _TIM3_EGR   = _TIM3_EGR_UG;
+  _TIM3_CR1   = _TIM3_CR1_CEN;
+#endif
+
+  // measure empty section, then clear buffer
+  s_active = 1;
+  s_head   = 0;
+  s_count  = 0;
+  prof_event(0);
+  prof_event(PROF_EXIT_FLAG);
+  s_overhead = s_time[1] - s_time[0];
+  s_head   = 0;
+  s_count  = 0;
+
+} // prof_init
+
+
+
+/**
+  \fn void prof_event(uint8_t tag)
+
+  \brief store event
+
+  \param[in]  tag     section ID, bit 7 set for exit
+
+  Read CNTRH first, which latches CNTRL until it is read.
+*/
+void prof_event(uint8_t tag) {
+
+  uint16_t  time;
+
+  SAVE_AND_DISABLE_INTERRUPTS(g_profCC);
+  time  = (uint16_t) PROF_CNTRH << 8;
+  time |= PROF_CNTRL;
+  if (s_active) {
+    s_time[s_head] = time;
+    s_tag[s_head]  = tag;
+    s_head = (s_head + 1) & PROF_MASK;
+    if (s_count < PROF_SIZE)
+      s_count++;
+  }
+  RESTORE_INTERRUPTS(g_profCC);
+
+} // prof_event
+
+
+
+/**
+  \fn void prof_dump(void (*out)(uint8_t))
+
+  \brief send ring buffer in binary format
+
+  \param[in]  out     send function for one byte, e.g. UART
+
+  Recording is paused during the dump, and the buffer is cleared afterwards.
+  Events of sections which are open during the dump lose their partner
+  and are skipped on the PC.
+*/
+void prof_dump(void (*out)(uint8_t)) {
+
+  uint16_t  i;
+  uint8_t   idx;
+
+  s_active = 0;
+
+  // header
+  out('S'); out('P'); out('R'); out('F');
+  prof_put16(out, PROF_FREQ_KHZ);
+  prof_put16(out, (uint16_t) (F_CPU / 1000L));
+  prof_put16(out, s_overhead);
+  prof_put16(out, s_count);
+
+  // events, oldest first
+  idx = (s_head - (uint8_t) s_count) & PROF_MASK;
+  for (i=0; i<s_count; i++) {
+    prof_put16(out, s_time[idx]);
+    out(s_tag[idx]);
+    idx = (idx + 1) & PROF_MASK;
+  }
+
+  s_head   = 0;
+  s_count  = 0;
+  s_active = 1;
+
+} // prof_dump
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,86 @@
+/**
+  \file prof.h
+
+  \brief declaration of hot-path profiler
+
+  Instrumented code sections are enclosed by PROF_ENTER(id) and PROF_EXIT(id),
+  which store a 16-bit timestamp of TIM1 or TIM3 in a RAM ring buffer, if the
+  project is compiled with -DSTM8_PROF. Else the macros are empty, i.e. the
+  instrumentation can stay in the code.
+  The buffer is dumped in binary format and evaluated on the PC with
+  benchmark/prof_report.py, which calculates inclusive and exclusive cycles
+  per ID. Sections must be properly nested, also in ISRs.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _PROF_H_
+#define _PROF_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// CPU clock [Hz]. Is set via CLK_CKDIVR in main()
+#if !defined(F_CPU)
+  #define F_CPU             16000000L     ///< CPU frequency [Hz]
+#endif
+
+// timer for timestamp (1 or 3). Is reserved for the profiler
+#if !defined(PROF_TIMER)
+  #define PROF_TIMER        1             ///< TIM1 or TIM3
+#endif
+
+// timer clock = fMASTER / 2^PROF_PSCR. Default 1 CPU cycle, i.e. wrap after 4ms. Time between events must be shorter
+#if !defined(PROF_PSCR)
+  #define PROF_PSCR         0             ///< timestamp prescaler exponent
+#endif
+
+// number of events in ring buffer (3B each). Must be a power of 2. When full, oldest events are overwritten
+#if !defined(PROF_SIZE)
+  #define PROF_SIZE         128           ///< size of ring buffer
+#endif
+
+/// max. section ID (bit 7 marks exit)
+#define PROF_ID_MAX         127
+
+/// exit flag in event tag
+#define PROF_EXIT_FLAG      0x80
+
+/// timestamp frequency [kHz] for dump header
+#define PROF_FREQ_KHZ       ((uint16_t) ((F_CPU / 1000L) >> PROF_PSCR))
+
+// record events or remove instrumentation
+#if defined(STM8_PROF)
+  #define PROF_ENTER(id)    prof_event(id)                      ///< start of section id (0..127)
+  #define PROF_EXIT(id)     prof_event((id) | PROF_EXIT_FLAG)   ///< end of section id (0..127)
+#else
+  #define PROF_ENTER(id)
+  #define PROF_EXIT(id)
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// init ring buffer and start timestamp timer. Measure overhead of an empty section
+void      prof_init(void);
+
+/// store event with timestamp. Use via PROF_ENTER() and PROF_EXIT()
+void      prof_event(uint8_t tag);
+
+/// send ring buffer in binary format byte-wise via callback function, then clear buffer
+void      prof_dump(void (*out)(uint8_t));
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _PROF_H_
@@ -0,0 +1,113 @@
+/**********************
+  STM8 register access trace
+  Demonstrate recording of register accesses and binary dump for decoding on PC
+
+  Functionality:
+  - init FCPU to 16MHz
+  - init UART2 and ADC1
+  - measure ADC1 channel 0 with traced register accesses (SFR_READ/SFR_WRITE)
+  - toggle LED (PC5) with traced access
+  - on key 'd' stop trace and send binary dump via UART2, then restart trace
+  - decode on PC with 'host/trace_decode.py -d STM8S105K6 <dumpfile>'
+  - requires -DSTM8_TRACE (see Makefile), else accesses are not recorded
+
+  Boards:
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "trace.h"
+
+// define communication speed
+#define BAUDRATE   115200
+
+// define ADC channel to measure (A0=PB0=AIN0)
+#define A0      0
+
+
+/**
+  \fn void uart_send(uint8_t data)
+
+  \brief send byte via UART2 (not traced)
+
+  \param[in]  data   byte to send
+*/
+void uart_send(uint8_t data) {
+
+  while (!(_UART2_SR & _UART2_SR_TXE));
+  _UART2_DR = data;
+
+} // uart_send
+
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint16_t  value;
+  uint32_t  i;
+
+
+  ////
+  // initialization
+  ////
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // LED (PC5) to output push-pull
+  _PORTC_DDR |= _PORT_PIN5;
+  _PORTC_CR1 |= _PORT_PIN5;
+
+  // set UART2 baudrate (note: BRR2 must be written before BRR1!) and enable receiver & sender
+  _UART2_BRR2 = (uint8_t) ((((F_CPU/BAUDRATE) & 0xF000) >> 8) | ((F_CPU/BAUDRATE) & 0x000F));
+  _UART2_BRR1 = (uint8_t) (((F_CPU/BAUDRATE) & 0x0FF0) >> 4);
+  _UART2_CR2 |= (_UART2_CR2_REN | _UART2_CR2_TEN);
+
+  // start timestamp and recording. Initialization of ADC is traced
+  trace_init();
+  trace_start();
+
+  // init ADC: channel 0, fADC = fMASTER/18, right alignment
+  SFR_WRITE(_ADC1_CSR, A0);
+  SFR_WRITE(_ADC1_CR1, _ADC1_CR1_SPSEL);
+  SFR_WRITE(_ADC1_CR2, _ADC1_CR2_ALIGN);
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // perform ADC measurement. Conversion is started by second ADON
+    SFR_WRITE(_ADC1_CSR, SFR_READ(_ADC1_CSR) & ~_ADC1_CSR_EOC);
+    SFR_WRITE(_ADC1_CR1, SFR_READ(_ADC1_CR1) | _ADC1_CR1_ADON);
+    SFR_WRITE(_ADC1_CR1, SFR_READ(_ADC1_CR1) | _ADC1_CR1_ADON);
+    while (!(SFR_READ(_ADC1_CSR) & _ADC1_CSR_EOC));
+
+    // get ADC result (read low byte first for right alignment!)
+    value  = (uint16_t) SFR_READ(_ADC1_DRL);
+    value |= (uint16_t) SFR_READ(_ADC1_DRH) << 8;
+
+    // toggle LED
+    SFR_WRITE(_PORTC_ODR, SFR_READ(_PORTC_ODR) ^ _PORT_PIN5);
+
+    // on key 'd' send trace (not traced)
+    if ((_UART2_SR & _UART2_SR_RXNE) && (_UART2_DR == 'd')) {
+      trace_stop();
+      trace_dump(uart_send);
+      trace_start();
+    }
+
+    // wait a while
+    for (i=0; i<100000L; i++)
+      NOP();
+
+  } // main loop
+
+} // main()
@@ -0,0 +1,16 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8S105K6.h"	// sduino-uno (https://github.com/roybaer/sduino_uno)
+
+
+/*----------------------------------------------------------
+    TRACE CONFIGURATION
+----------------------------------------------------------*/
+
+// CPU clock
+#define F_CPU           16000000L
+
+// record up to 64 accesses with 1us timestamp
+#define TRACE_SIZE      64
+#define TRACE_PSCR      4
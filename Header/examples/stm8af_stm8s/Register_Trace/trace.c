@@ -0,0 +1,270 @@
+/**
+  \file trace.c
+
+  \brief implementation of register access trace recorder
+
+  Each access via SFR_READ()/SFR_WRITE() stores a 6B record with 16-bit
+  TIM2 timestamp, register address, value and access type. Appending is
+  done with interrupts disabled, so ISRs can be traced as well. The
+  recorder itself accesses registers directly, i.e. it is not traced.
+  Dump format (little endian, see host/trace_decode.py):
+    - header:  'STRC', timestamp frequency [kHz] (2B), timestamp size (2), 0, number of records (2B)
+    - record:  timestamp (2B), address (2B), value, type (0=read, 1=write)
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "trace.h"
+#if defined(_IAR_)
+  #include <intrinsics.h>
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if !defined(STM8_TRACE)
+  #error compile with -DSTM8_TRACE
+#endif
+#if (TRACE_SIZE < 1) || (TRACE_SIZE > 255)
+  #error TRACE_SIZE must be 1..255
+#endif
+#if (TRACE_PSCR > 15)
+  #error TRACE_PSCR must be 0..15
+#endif
+
+// access types
+#define TRACE_READ          0
+#define TRACE_WRITE         1
+
+// atomic recording needs SAVE_AND_DISABLE_INTERRUPTS() of family header
+#if !defined(SAVE_AND_DISABLE_INTERRUPTS)
+  #error compiler not supported
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL TYPES
+-----------------------------------------------------------------------------*/
+
+// trace record. Stored in native byte order, converted by trace_dump()
+typedef struct {
+  uint16_t  time;         // TIM2 counter
+  uint16_t  addr;         // register address
+  uint8_t   value;        // read or written value
+  uint8_t   type;         // TRACE_READ or TRACE_WRITE
+} trace_record_t;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// interrupt state while recording an access. Only accessed with interrupts disabled
+volatile uint8_t          g_traceCC;
+
+// trace buffer, number of records and recording flag
+static trace_record_t     s_trace[TRACE_SIZE];
+static volatile uint8_t   s_count;
+static volatile uint8_t   s_active;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void trace_add(volatile uint8_t *reg, uint8_t value, uint8_t type)
+
+  \brief append record to trace buffer
+
+  \param[in]  reg     register address
+  \param[in]  value   read or written value
+  \param[in]  type    TRACE_READ or TRACE_WRITE
+
+  Read CNTRH first, which latches CNTRL until it is read.
+*/
+static void trace_add(volatile uint8_t *reg, uint8_t value, uint8_t type) {
+
+  trace_record_t  *rec;
+
+  SAVE_AND_DISABLE_INTERRUPTS(g_traceCC);
+  if ((s_active) && (s_count < TRACE_SIZE)) {
+    rec = &(s_trace[s_count++]);
+    rec->time  = (uint16_t) _TIM2_CNTRH << 8;
+    rec->time |= _TIM2_CNTRL;
+    rec->addr  = (uint16_t) reg;
+    rec->value = value;
+    rec->type  = type;
+  }
+  RESTORE_INTERRUPTS(g_traceCC);
+
+} // trace_add
+
+
+
+/**
+  \fn void trace_put16(void (*out)(uint8_t), uint16_t data)
+
+  \brief send 16-bit value little endian
+
+  \param[in]  out     send function
+  \param[in]  data    value to send
+*/
+static void trace_put16(void (*out)(uint8_t), uint16_t data) {
+
+  out((uint8_t) data);
+  out((uint8_t) (data >> 8));
+
+} // trace_put16
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn uint8_t stm8_trace_read(volatile uint8_t *reg)
+
+  \brief read register and record access. Called via SFR_READ()
+
+  \param[in]  reg     register address
+
+  \return register value
+*/
+uint8_t stm8_trace_read(volatile uint8_t *reg) {
+
+  uint8_t   value = *reg;
+
+  trace_add(reg, value, TRACE_READ);
+  return(value);
+
+} // stm8_trace_read
+
+
+
+/**
+  \fn void stm8_trace_write(volatile uint8_t *reg, uint8_t value)
+
+  \brief write register and record access. Called via SFR_WRITE()
+
+  \param[in]  reg     register address
+  \param[in]  value   value to write
+*/
+void stm8_trace_write(volatile uint8_t *reg, uint8_t value) {
+
+  *reg = value;
+  trace_add(reg, value, TRACE_WRITE);
+
+} // stm8_trace_write
+
+
+
+/**
+  \fn void trace_init(void)
+
+  \brief init trace buffer and timestamp
+
+  Start TIM2 as free running 16-bit counter with 2^TRACE_PSCR prescaler.
+  Recording is stopped until trace_start().
+*/
+void trace_init(void) {
+
+  s_active = 0;
+  s_count  = 0;
+
+  // TIM2 free running, load prescaler via update event
+  _TIM2_CR1  = 0x00;
+  _TIM2_PSCR = TRACE_PSCR;
+  _TIM2_ARRH = 0xFF;
+  _TIM2_ARRL = 0xFF;
+  _TIM2_EGR  = _TIM2_EGR_UG;
+  _TIM2_CR1  = _TIM2_CR1_CEN;
+
+} // trace_init
+
+
+
+/**
+  \fn void trace_start(void)
+
+  \brief start recording
+*/
+void trace_start(void) {
+
+  s_active = 1;
+
+} // trace_start
+
+
+
+/**
+  \fn void trace_stop(void)
+
+  \brief stop recording
+*/
+void trace_stop(void) {
+
+  s_active = 0;
+
+} // trace_stop
+
+
+
+/**
+  \fn uint8_t trace_count(void)
+
+  \brief get number of records
+
+  \return number of recorded accesses
+*/
+uint8_t trace_count(void) {
+
+  return(s_count);
+
+} // trace_count
+
+
+
+/**
+  \fn void trace_dump(void (*out)(uint8_t))
+
+  \brief send trace in binary format
+
+  \param[in]  out     send function for one byte, e.g. UART
+
+  Recording is paused during the dump, and the buffer is cleared afterwards.
+*/
+void trace_dump(void (*out)(uint8_t)) {
+
+  uint8_t   active = s_active;
+  uint8_t   i;
+
+  s_active = 0;
+
+  // header
+  out('S'); out('T'); out('R'); out('C');
+  trace_put16(out, TRACE_FREQ_KHZ);
+  out(sizeof(s_trace[0].time));
+  out(0x00);
+  trace_put16(out, s_count);
+
+  // records
+  for (i=0; i<s_count; i++) {
+    trace_put16(out, s_trace[i].time);
+    trace_put16(out, s_trace[i].addr);
+    out(s_trace[i].value);
+    out(s_trace[i].type);
+  }
+
+  s_count  = 0;
+  s_active = active;
+
+} // trace_dump
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,71 @@
+/**
+  \file trace.h
+
+  \brief declaration of register access trace recorder
+
+  Register accesses via SFR_READ()/SFR_WRITE() are stored with timestamp in
+  a RAM buffer, if the project is compiled with -DSTM8_TRACE. Else these
+  macros access the register directly without overhead.
+  The buffer is dumped in binary format and decoded on the PC with
+  host/trace_decode.py. The same format is written by the register simulator
+  via host_trace_start(), see host/host.h.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// CPU clock [Hz]. Is set via CLK_CKDIVR in main()
+#if !defined(F_CPU)
+  #define F_CPU             16000000L     ///< CPU frequency [Hz]
+#endif
+
+// number of records in buffer (6B each). Recording stops when full
+#if !defined(TRACE_SIZE)
+  #define TRACE_SIZE        64            ///< max. number of trace records
+#endif
+
+// TIM2 prescaler for timestamp (2^PSCR). Default 1MHz at 16MHz, i.e. wrap after 65ms
+#if !defined(TRACE_PSCR)
+  #define TRACE_PSCR        4             ///< timestamp prescaler exponent
+#endif
+
+/// timestamp frequency [kHz] for trace header
+#define TRACE_FREQ_KHZ      ((uint16_t) ((F_CPU / 1000L) >> TRACE_PSCR))
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// init trace buffer and TIM2 timestamp. TIM2 is reserved for the recorder
+void      trace_init(void);
+
+/// start recording of register accesses
+void      trace_start(void);
+
+/// stop recording of register accesses
+void      trace_stop(void);
+
+/// get number of recorded accesses
+uint8_t   trace_count(void);
+
+/// send trace in binary format byte-wise via callback function, then clear buffer
+void      trace_dump(void (*out)(uint8_t));
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _TRACE_H_
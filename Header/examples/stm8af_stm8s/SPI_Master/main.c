@@ -0,0 +1,140 @@
+/**********************
+  STM8 SPI master block transfers
+  Demonstrate polled burst and interrupt-driven SPI transfers
+
+  Functionality:
+  - init FCPU to 16MHz
+  - init UART2
+  - init SPI master with 2MHz (SCK=PC5, MOSI=PC6, MISO=PC7, CS=PE5)
+  - read JEDEC ID of SPI flash (e.g. W25Qxx)
+  - read first page of flash with polled burst and with interrupts,
+    and compare both results
+  - on byte received via UART2 repeat interrupt-driven read
+
+  Boards:
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"         // sduino-UNO
+#include "string.h"
+#include "spi.h"          // SPI master (declares SPI_ISR)
+
+// define communication speed
+#define BAUDRATE   9600
+
+// chip select of SPI flash (PE5)
+#define CS_LOW()   (_PORTE_ODR &= ~_PORT_PIN5)
+#define CS_HIGH()  (_PORTE_ODR |= _PORT_PIN5)
+
+// SPI flash commands
+#define FLASH_READ_ID     0x9F
+#define FLASH_READ        0x03
+
+// page size of SPI flash
+#define PAGE_SIZE  256
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// page buffers for polled and interrupt-driven read
+uint8_t   g_pagePoll[PAGE_SIZE];
+uint8_t   g_pageIrq[PAGE_SIZE];
+
+
+////////
+// release chip select at end of interrupt-driven transfer (ISR context)
+////////
+void transfer_done(uint8_t status) {
+
+  CS_HIGH();
+
+} // transfer_done
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint16_t  BRR;
+  uint8_t   id[3];
+  uint16_t  i;
+  static const uint8_t  cmdRead[4] = {FLASH_READ, 0x00, 0x00, 0x00};
+
+  ////
+  // initialization
+  ////
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // set UART2 baudrate (note: BRR2 must be written before BRR1!)
+  BRR = (uint16_t) (((uint32_t) 16000000L)/BAUDRATE);
+  _UART2_BRR2 = (uint8_t) (((BRR & 0xF000) >> 8) | (BRR & 0x000F));
+  _UART2_BRR1 = (uint8_t) ((BRR & 0x0FF0) >> 4);
+
+  // enable UART2 receiver & sender
+  _UART2_CR2 |= (_UART2_CR2_REN | _UART2_CR2_TEN);
+
+  // configure CS pin to output push-pull, high
+  CS_HIGH();
+  _PORTE_DDR |= _PORT_PIN5;
+  _PORTE_CR1 |= _PORT_PIN5;
+
+  // init SPI master (SPI_BR see main.h, mode 0)
+  spi_init();
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+
+  ////
+  // read flash ID and first page
+  ////
+
+  // read JEDEC ID (polled)
+  CS_LOW();
+  spi_transfer(FLASH_READ_ID);
+  spi_burst(NULL, id, 3);
+  CS_HIGH();
+  printf("JEDEC ID: %02x %02x %02x\n", (int) id[0], (int) id[1], (int) id[2]);
+
+  // read page with polled burst
+  CS_LOW();
+  spi_burst(cmdRead, NULL, 4);
+  spi_burst(NULL, g_pagePoll, PAGE_SIZE);
+  CS_HIGH();
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // read page in background, CS is released in callback
+    memset(g_pageIrq, 0x00, PAGE_SIZE);
+    CS_LOW();
+    spi_burst(cmdRead, NULL, 4);
+    spi_start(NULL, g_pageIrq, PAGE_SIZE, transfer_done);
+
+    // main loop is free meanwhile
+    i = 0;
+    while (spi_status() == SPI_BUSY)
+      i++;
+
+    // compare with polled read
+    printf("IRQ read: status %d, %u loops, %s\n", (int) spi_status(), i,
+      memcmp(g_pagePoll, g_pageIrq, PAGE_SIZE) ? "mismatch" : "ok");
+
+    // wait for byte received via UART2
+    while (!(_UART2_SR & _UART2_SR_RXNE));
+    (void) _UART2_DR;
+
+  } // main loop
+
+} // main()
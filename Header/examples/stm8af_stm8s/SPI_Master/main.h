@@ -0,0 +1,8 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8S105K6.h"
+#include <stdio.h>
+
+// SPI clock 16MHz/8 = 2MHz. At 8MHz (SPI_BR=0) only polled bursts are fast enough
+#define SPI_BR   2
@@ -0,0 +1,466 @@
+/**
+  \file spi.c
+
+  \brief implementation of SPI master block transfer engine
+
+  At f_master/2 a byte is shifted out in 16 CPU cycles, which is about the
+  duration of a simple polling loop. To avoid gaps between bytes, the next
+  byte is always written to the TX buffer while the current byte is still
+  shifted out ("one byte ahead"):
+    - write-only bursts are unrolled and only poll TXE. Received data is
+      discarded at the end, which also clears the resulting overrun flag
+    - full-duplex and read-only bursts read byte n after byte n+1 was
+      written to the TX buffer
+    - interrupt-driven transfers prefill TX buffer and shift register,
+      then each RXNE interrupt reads one byte and writes the next
+
+  With CRC enabled, the CRC is reset at the start of each transfer. After
+  the last data byte CRCNEXT is set, so the TX CRC is appended and the
+  received CRC is checked by hardware.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "spi.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if (SPI_BR < 0) || (SPI_BR > 7) || (SPI_MODE < 0) || (SPI_MODE > 3)
+  #error illegal SPI_BR or SPI_MODE
+#endif
+
+// wait for TX buffer empty, then write byte
+#define SPI_PUT(b)        do { while (!(_SPI_SR & _SPI_SR_TXE)); _SPI_DR = (b); } while (0)
+
+// wait for RX buffer full or overrun. Overrun must be checked afterwards, as RXNE is not set again
+#define SPI_WAIT_RX()     while (!(_SPI_SR & (_SPI_SR_RXNE | _SPI_SR_OVR)))
+
+// abort polled transfer on receive overrun
+#define SPI_CHECK_OVR()   do { if (_SPI_SR & _SPI_SR_OVR) return(spi_overrun()); } while (0)
+
+// append CRC after last byte written to TX buffer
+#define SPI_CRC_NEXT()    do { if (s_crc) _SPI_CR2 |= _SPI_CR2_CRCNEXT; } while (0)
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+static uint8_t                  s_crc;          ///< CRC enabled
+static const uint8_t            s_dummy = SPI_DUMMY;    ///< transmit data for read-only transfers
+
+// state of interrupt-driven transfer
+static const uint8_t            *s_tx;          ///< next byte to send
+static uint8_t                  s_txInc;        ///< 1=increment tx pointer, 0=send dummy
+static uint8_t                  *s_rx;          ///< next byte to receive (NULL=discard)
+static uint16_t                 s_txLeft;       ///< bytes left to write to TX buffer
+static uint16_t                 s_rxLeft;       ///< bytes left to receive (incl. CRC)
+static spi_callback_t           s_callback;     ///< called at end of transfer
+static volatile uint8_t         s_status;       ///< SPI_BUSY or result
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void spi_wait_idle(void)
+
+  \brief wait until last byte is sent
+*/
+static void spi_wait_idle(void) {
+
+  while (!(_SPI_SR & _SPI_SR_TXE));
+  while (_SPI_SR & _SPI_SR_BSY);
+
+} // spi_wait_idle
+
+
+
+/**
+  \fn uint8_t spi_overrun(void)
+
+  \brief abort polled transfer after receive overrun
+
+  \return SPI_ERR_OVR
+
+  A received byte was lost, e.g. because an ISR delayed reading DR by more
+  than one byte. Wait until the TX buffer is sent, then clear OVR by reading
+  DR, then SR.
+*/
+static uint8_t spi_overrun(void) {
+
+  spi_wait_idle();
+  (void) _SPI_DR;
+  (void) _SPI_SR;
+
+  return(SPI_ERR_OVR);
+
+} // spi_overrun
+
+
+
+/**
+  \fn void spi_crc_reset(void)
+
+  \brief reset CRC registers if CRC is enabled
+
+  CRCEN must only be changed with SPI disabled. SPI must be idle.
+*/
+static void spi_crc_reset(void) {
+
+  if (!s_crc)
+    return;
+
+  _SPI_CR1 &= ~_SPI_CR1_SPE;
+  _SPI_CR2 &= ~_SPI_CR2_CRCEN;
+  _SPI_CR2 |= _SPI_CR2_CRCEN;
+  _SPI_CR1 |= _SPI_CR1_SPE;
+
+} // spi_crc_reset
+
+
+
+/**
+  \fn uint8_t spi_crc_result(void)
+
+  \brief get and clear CRC error flag after transfer
+
+  \return SPI_OK or SPI_ERR_CRC
+*/
+static uint8_t spi_crc_result(void) {
+
+  if (s_crc && (_SPI_SR & _SPI_SR_CRCERR)) {
+    _SPI_SR &= ~_SPI_SR_CRCERR;
+    return(SPI_ERR_CRC);
+  }
+  return(SPI_OK);
+
+} // spi_crc_result
+
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void spi_init(void)
+
+  \brief init SPI master
+
+  Configure SPI as master with software slave management, SPI_BR and
+  SPI_MODE, MSB first. CRC is disabled.
+*/
+void spi_init(void) {
+
+  s_crc    = 0;
+  s_status = SPI_OK;
+
+  _SPI_CR1 = 0x00;
+  _SPI_ICR = 0x00;
+  _SPI_CR2 = (_SPI_CR2_SSM | _SPI_CR2_SSI);
+  _SPI_CR1 = (uint8_t) (_SPI_CR1_MSTR | (SPI_BR << 3) | SPI_MODE);
+  _SPI_CR1 |= _SPI_CR1_SPE;
+
+} // spi_init
+
+
+
+/**
+  \fn void spi_crc(uint8_t poly)
+
+  \brief enable or disable hardware CRC
+
+  \param[in]  poly   CRC polynomial, e.g. 0x07 for CRC-8 (0=disable CRC)
+
+  If enabled, each transfer is followed by one CRC byte.
+*/
+void spi_crc(uint8_t poly) {
+
+  spi_wait_idle();
+  _SPI_CR1 &= ~_SPI_CR1_SPE;
+  if (poly != 0) {
+    _SPI_CRCPR = poly;
+    _SPI_CR2 |= _SPI_CR2_CRCEN;
+  }
+  else
+    _SPI_CR2 &= ~_SPI_CR2_CRCEN;
+  _SPI_CR1 |= _SPI_CR1_SPE;
+  s_crc = (poly != 0);
+
+} // spi_crc
+
+
+
+/**
+  \fn uint8_t spi_transfer(uint8_t data)
+
+  \brief exchange single byte
+
+  \param[in]  data   byte to send
+
+  \return received byte
+
+  Polled single byte transfer without CRC, e.g. for commands.
+*/
+uint8_t spi_transfer(uint8_t data) {
+
+  _SPI_DR = data;
+  while (!(_SPI_SR & _SPI_SR_RXNE));
+  return(_SPI_DR);
+
+} // spi_transfer
+
+
+
+/**
+  \fn uint8_t spi_burst(const uint8_t *tx, uint8_t *rx, uint16_t len)
+
+  \brief polled block transfer
+
+  \param[in]  tx     data to send (NULL=send SPI_DUMMY)
+  \param[out] rx     buffer for received data (NULL=discard)
+  \param[in]  len    number of data bytes (w/o CRC)
+
+  \return SPI_OK, SPI_ERR_CRC or SPI_ERR_OVR
+
+  Transfer block with TX buffer kept one byte ahead, i.e. without gaps.
+  Interrupts may delay the transfer. If an ISR takes longer than one byte,
+  a received byte is lost and the transfer is aborted with SPI_ERR_OVR.
+  Write-only transfers are not affected.
+*/
+uint8_t spi_burst(const uint8_t *tx, uint8_t *rx, uint16_t len) {
+
+  uint8_t  txInc;
+
+  if (len == 0)
+    return(SPI_OK);
+
+  // no interrupt-driven transfer may be running
+  while (s_status == SPI_BUSY);
+  spi_crc_reset();
+
+  ////
+  // write only: 4x unrolled, only poll TXE
+  ////
+  if (rx == NULL) {
+
+    // clock only, e.g. dummy cycles
+    if (tx == NULL) {
+      while (len--)
+        SPI_PUT(SPI_DUMMY);
+    }
+
+    // send data
+    else {
+      while (len >= 4) {
+        SPI_PUT(*tx++);
+        SPI_PUT(*tx++);
+        SPI_PUT(*tx++);
+        SPI_PUT(*tx++);
+        len -= 4;
+      }
+      while (len--)
+        SPI_PUT(*tx++);
+    }
+    SPI_CRC_NEXT();
+
+    // wait until done, then discard received data. Reading DR and SR clears OVR
+    spi_wait_idle();
+    (void) _SPI_DR;
+    (void) _SPI_SR;
+
+    // received CRC is meaningless for write-only
+    _SPI_SR &= ~_SPI_SR_CRCERR;
+    return(SPI_OK);
+
+  } // write only
+
+
+  ////
+  // full-duplex or read-only: read byte n after writing byte n+1
+  ////
+
+  // for read-only send dummy byte without incrementing pointer
+  txInc = 1;
+  if (tx == NULL) {
+    tx    = &s_dummy;
+    txInc = 0;
+  }
+
+  // prefill TX buffer
+  _SPI_DR = *tx;
+  tx += txInc;
+  if (--len == 0)
+    SPI_CRC_NEXT();
+
+  // loop over bytes 2..n
+  while (len--) {
+    SPI_PUT(*tx);
+    tx += txInc;
+    if (len == 0)
+      SPI_CRC_NEXT();
+    SPI_WAIT_RX();
+    SPI_CHECK_OVR();
+    *rx++ = _SPI_DR;
+  }
+
+  // last data byte
+  SPI_WAIT_RX();
+  SPI_CHECK_OVR();
+  *rx = _SPI_DR;
+
+  // receive CRC byte. CRCERR is set by hardware
+  if (s_crc) {
+    SPI_WAIT_RX();
+    SPI_CHECK_OVR();
+    (void) _SPI_DR;
+    return(spi_crc_result());
+  }
+
+  return(SPI_OK);
+
+} // spi_burst
+
+
+
+/**
+  \fn uint8_t spi_start(const uint8_t *tx, uint8_t *rx, uint16_t len, spi_callback_t callback)
+
+  \brief start interrupt-driven block transfer
+
+  \param[in]  tx         data to send (NULL=send SPI_DUMMY)
+  \param[out] rx         buffer for received data (NULL=discard)
+  \param[in]  len        number of data bytes (w/o CRC)
+  \param[in]  callback   called from ISR at end of transfer (NULL=none)
+
+  \return SPI_BUSY if started, or SPI_OK for len=0
+
+  Buffers must stay valid until end of transfer, see spi_status().
+  Overrun occurs if the ISR is delayed by more than one byte time.
+*/
+uint8_t spi_start(const uint8_t *tx, uint8_t *rx, uint16_t len, spi_callback_t callback) {
+
+  if (len == 0)
+    return(SPI_OK);
+
+  // wait for previous transfer
+  while (s_status == SPI_BUSY);
+  spi_crc_reset();
+
+  // set up transfer
+  s_txInc    = 1;
+  if (tx == NULL) {
+    tx      = &s_dummy;
+    s_txInc = 0;
+  }
+  s_tx       = tx;
+  s_rx       = rx;
+  s_txLeft   = len;
+  s_rxLeft   = len + s_crc;
+  s_callback = callback;
+  s_status   = SPI_BUSY;
+
+  // clear old RX data and overrun
+  (void) _SPI_DR;
+  (void) _SPI_SR;
+
+  // fill shift register and TX buffer, i.e. up to 2 bytes ahead
+  _SPI_DR = *s_tx;
+  s_tx += s_txInc;
+  if (--s_txLeft == 0) {
+    SPI_CRC_NEXT();
+  }
+  else {
+    SPI_PUT(*s_tx);
+    s_tx += s_txInc;
+    if (--s_txLeft == 0)
+      SPI_CRC_NEXT();
+  }
+
+  // continue in ISR on each received byte
+  _SPI_ICR = _SPI_ICR_RXIE;
+
+  return(SPI_BUSY);
+
+} // spi_start
+
+
+
+/**
+  \fn uint8_t spi_status(void)
+
+  \brief get status of interrupt-driven transfer
+
+  \return SPI_BUSY while in progress, else SPI_OK or error of last transfer
+*/
+uint8_t spi_status(void) {
+
+  return(s_status);
+
+} // spi_status
+
+
+
+/**
+  \fn void SPI_ISR(void)
+
+  \brief ISR for SPI receive buffer full
+
+  Read received byte and write next byte to TX buffer.
+
+  Notes:
+    - for Cosmic compiler, add SPI_ISR also to 'stm8_interrupt_vector.c'
+    - IAR compiler has an IRQ offset of +2 compared to STM8 datasheet (see below)
+*/
+#if defined(_IAR_)
+   #pragma vector = 2+__SPI_VECTOR__    // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(SPI_ISR, __SPI_VECTOR__)
+{
+  uint8_t  sr, data;
+
+  // read status and data. OVR is only cleared by reading DR, then SR (see below)
+  sr   = _SPI_SR;
+  data = _SPI_DR;
+
+  // store data byte, skip CRC byte
+  if ((s_rx != NULL) && (s_rxLeft > s_crc))
+    *s_rx++ = data;
+
+  // keep TX buffer one byte ahead. Append CRC after last byte
+  if (s_txLeft != 0) {
+    _SPI_DR = *s_tx;
+    s_tx += s_txInc;
+    if (--s_txLeft == 0)
+      SPI_CRC_NEXT();
+  }
+
+  // end of transfer or overrun
+  if ((--s_rxLeft == 0) || (sr & _SPI_SR_OVR)) {
+    _SPI_ICR = 0x00;
+    if (sr & _SPI_SR_OVR) {
+      spi_wait_idle();
+      (void) _SPI_DR;
+      (void) _SPI_SR;
+      s_status = SPI_ERR_OVR;
+    }
+    else {
+      spi_wait_idle();
+      s_status = spi_crc_result();
+    }
+    if (s_callback != NULL)
+      s_callback(s_status);
+  }
+
+} // SPI_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,86 @@
+/**
+  \file spi.h
+
+  \brief declaration of SPI master block transfer engine
+
+  SPI master with polled burst transfers for maximum throughput, and
+  interrupt-driven transfers for long blocks in background. Both modes
+  optionally append and check a hardware CRC. Chip select is handled by
+  the application.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _SPI_H_
+#define _SPI_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+#include <stddef.h>     // NULL
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// SPI clock = f_master / 2^(SPI_BR+1), i.e. 0=f/2 ... 7=f/256
+#if !defined(SPI_BR)
+  #define SPI_BR            0             ///< baudrate prescaler (0..7)
+#endif
+
+// SPI mode 0..3 = (CPOL<<1) | CPHA
+#if !defined(SPI_MODE)
+  #define SPI_MODE          0             ///< clock polarity and phase
+#endif
+
+// byte sent if no transmit data is given
+#define SPI_DUMMY           0xFF          ///< dummy byte for read-only transfers
+
+// transfer status
+#define SPI_OK              0             ///< transfer finished successfully
+#define SPI_BUSY            1             ///< interrupt-driven transfer in progress
+#define SPI_ERR_CRC         2             ///< received CRC mismatch
+#define SPI_ERR_OVR         3             ///< receive overrun (SPI ISR too slow, or polled transfer delayed by other ISR)
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// callback on end of interrupt-driven transfer. Called from ISR context!
+typedef void (*spi_callback_t)(uint8_t status);
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+ISR_HANDLER(SPI_ISR, __SPI_VECTOR__);
+
+/// init SPI master with SPI_BR and SPI_MODE, CRC disabled
+void      spi_init(void);
+
+/// enable hardware CRC with polynomial (0=disable). Applies to following transfers
+void      spi_crc(uint8_t poly);
+
+/// exchange single byte (polled)
+uint8_t   spi_transfer(uint8_t data);
+
+/// polled block transfer. tx=NULL sends SPI_DUMMY, rx=NULL discards data. Return status
+uint8_t   spi_burst(const uint8_t *tx, uint8_t *rx, uint16_t len);
+
+/// start interrupt-driven block transfer. tx=NULL sends SPI_DUMMY, rx=NULL discards data
+uint8_t   spi_start(const uint8_t *tx, uint8_t *rx, uint16_t len, spi_callback_t callback);
+
+/// get status of interrupt-driven transfer (SPI_BUSY while in progress)
+uint8_t   spi_status(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _SPI_H_
@@ -0,0 +1,91 @@
+/**********************
+  STM8 3-phase PWM with complementary outputs using TIM1
+  Demonstrate dead-time, preloaded burst updates and ADC triggered by PWM
+
+  Functionality:
+  - init FCPU to 16MHz
+  - init TIM1 for 20kHz center-aligned PWM with 500ns dead-time
+    (CH1..3=PC1..PC3, CH1N..3N=PB0..PB2 via option byte AFR5)
+  - init ADC1 triggered by TIM1 update, i.e. in the middle of the PWM period
+  - output 3-phase sine, amplitude is set via potentiometer (PB3=AIN3)
+
+  Boards:
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "pwm.h"          // TIM1 PWM (declares TIM1_UPD_ISR)
+
+// ADC channel for amplitude (PB3=AIN3)
+#define AIN_AMPL    3
+
+// sine table length and phase offset (~120deg)
+#define SINE_LEN    32
+#define PHASE_120   (SINE_LEN / 3)
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  // sine 0..255, centered at 128
+  static const uint8_t  sine[SINE_LEN] = {
+    128, 152, 176, 198, 218, 234, 245, 253, 255, 253, 245, 234, 218, 198, 176, 152,
+    128, 103,  79,  57,  37,  21,  10,   2,   0,   2,  10,  21,  37,  57,  79, 103 };
+
+  uint16_t  ampl = 0;       // amplitude (0..PWM_MAX)
+  uint8_t   phase = 0;
+  uint16_t  i;
+
+
+  ////
+  // initialization
+  ////
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // init PWM, outputs are still disabled
+  pwm_init();
+
+  // init ADC1: start conversion on TIM1 TRGO, right alignment
+  _ADC1_CSR = AIN_AMPL;
+  _ADC1_CR1 = (7 << 4);                       // ADC clock = fMaster/18
+  _ADC1_CR2 = _ADC1_CR2_EXTTRIG | _ADC1_CR2_ALIGN;   // EXTSEL=00: TIM1 TRGO
+  _ADC1_CR1 |= _ADC1_CR1_ADON;                // power on. Conversion is started by trigger
+
+  // enable interrupts and PWM outputs
+  ENABLE_INTERRUPTS();
+  pwm_enable(1);
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // get latest amplitude (read low byte first for right alignment!)
+    if (_ADC1_CSR & _ADC1_CSR_EOC) {
+      i = _ADC1_DRL;
+      i |= ((uint16_t) _ADC1_DRH) << 8;
+      _ADC1_CSR &= ~_ADC1_CSR_EOC;
+      ampl = (uint16_t) (((uint32_t) i * PWM_MAX) >> 10);
+    }
+
+    // next step of 3-phase sine. Duty cycles of all phases change at the same update event
+    phase = (phase + 1) % SINE_LEN;
+    pwm_update((uint16_t) (((uint32_t) sine[phase] * ampl) >> 8),
+               (uint16_t) (((uint32_t) sine[(phase + PHASE_120) % SINE_LEN] * ampl) >> 8),
+               (uint16_t) (((uint32_t) sine[(phase + 2*PHASE_120) % SINE_LEN] * ampl) >> 8));
+
+    // set rotation speed
+    for (i=0; i<10000; i++)
+      NOP();
+
+  } // main loop
+
+} // main()
@@ -0,0 +1,20 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8S105K6.h"
+
+
+/*----------------------------------------------------------
+    PWM CONFIGURATION
+----------------------------------------------------------*/
+
+// timer clock
+#define F_CPU           16000000L
+
+// 20kHz center-aligned PWM with 500ns dead-time
+#define PWM_FREQ        20000L
+#define PWM_DEADTIME    500
+#define PWM_CENTER      1
+
+// no break input (TIM1_BKIN not available on 32-pin package)
+#define PWM_BREAK       0
@@ -0,0 +1,250 @@
+/**
+  \file pwm.c
+
+  \brief implementation of TIM1 3-phase PWM with complementary outputs
+
+  The compare registers are preloaded, i.e. values written to CCRx are
+  transferred to the active registers only at the update event. For
+  consistent duty cycles, all 3 channels must be written within the same
+  PWM period. Therefore pwm_update() only splits the values into bytes in
+  RAM, and the update ISR copies them to the 6 CCR bytes with plain byte
+  moves. The ISR is enabled only while an update is pending.
+
+  In center-aligned mode the repetition counter is set such that the update
+  event occurs once per PWM period, i.e. at counter underflow (CNT=0). This
+  is the center of the active phase of CH1-CH3, far from all switching edges.
+  The update event is routed to TRGO for synchronous ADC sampling.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "pwm.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check period
+#if (PWM_ARR < 2) || (PWM_ARR > 65535L)
+  #error PWM_FREQ out of range for F_CPU (no prescaler)
+#endif
+
+// repetition counter: update every PWM_REPEAT periods. Center-aligned has 2 counter events per period
+#define PWM_RCR             ((PWM_REPEAT) * (PWM_CENTER + 1) - 1)
+#if (PWM_REPEAT < 1) || (PWM_RCR > 255)
+  #error PWM_REPEAT out of range
+#endif
+
+// dead-time in timer clocks (rounded up)
+#define PWM_DT_CLK          (((F_CPU / 1000000L) * (PWM_DEADTIME) + 999) / 1000)
+
+// dead-time generator register, see RM0016 TIM1_DTR. 4 ranges with different step size
+#define PWM_DTG             ((PWM_DT_CLK <= 127) ? (PWM_DT_CLK) : \
+                             (PWM_DT_CLK <= 254) ? (0x80 | ((PWM_DT_CLK + 1) / 2 - 64)) : \
+                             (PWM_DT_CLK <= 504) ? (0xC0 | ((PWM_DT_CLK + 7) / 8 - 32)) : \
+                                                   (0xE0 | ((PWM_DT_CLK + 15) / 16 - 32)))
+#if (PWM_DT_CLK > 1008)
+  #error PWM_DEADTIME too long for F_CPU
+#endif
+
+// output compare mode: PWM mode 1 with preload
+#define PWM_CCMR            ((6 << 4) | _TIM1_CCMR1_OC1PE)
+
+// enable CHx and CHxN of channels 1-3
+#define PWM_CCER1           (_TIM1_CCER1_CC1E | _TIM1_CCER1_CC1NE | _TIM1_CCER1_CC2E | _TIM1_CCER1_CC2NE)
+#define PWM_CCER2           (_TIM1_CCER2_CC3E | _TIM1_CCER2_CC3NE)
+
+// break register w/o MOE. On MOE=0 drive outputs to idle level (OISR=0 -> low) after dead-time
+#if PWM_BREAK
+  #define PWM_BKR           (_TIM1_BKR_OSSI | _TIM1_BKR_OSSR | _TIM1_BKR_BKE)
+#else
+  #define PWM_BKR           (_TIM1_BKR_OSSI | _TIM1_BKR_OSSR)
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// next compare values as CCR1H, CCR1L, CCR2H, CCR2L, CCR3H, CCR3L
+static uint8_t  s_ccr[6];
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void pwm_init(void)
+
+  \brief init and start TIM1 PWM
+
+  Configure TIM1 channels 1-3 with complementary outputs, dead-time and
+  break input, and start timer with 0% duty. Outputs stay disabled until
+  pwm_enable(1). Pins use the default or alternate TIM1 function (see
+  datasheet, may require option byte AFR).
+*/
+void pwm_init(void) {
+
+  // stop and reset timer
+  _TIM1_CR1  = 0x00;
+  _TIM1_IER  = 0x00;
+
+  // period and repetition counter, no prescaler
+  _TIM1_PSCRH = 0x00;
+  _TIM1_PSCRL = 0x00;
+  _TIM1_ARRH  = (uint8_t) (PWM_ARR >> 8);
+  _TIM1_ARRL  = (uint8_t) (PWM_ARR);
+  _TIM1_RCR   = PWM_RCR;
+
+  // PWM mode 1 with preload on channels 1-3, start with 0%
+  _TIM1_CCMR1 = PWM_CCMR;
+  _TIM1_CCMR2 = PWM_CCMR;
+  _TIM1_CCMR3 = PWM_CCMR;
+  _TIM1_CCR1H = 0x00;  _TIM1_CCR1L = 0x00;
+  _TIM1_CCR2H = 0x00;  _TIM1_CCR2L = 0x00;
+  _TIM1_CCR3H = 0x00;  _TIM1_CCR3L = 0x00;
+
+  // enable complementary outputs with dead-time. Pins are controlled by MOE
+  _TIM1_CCER1 = PWM_CCER1;
+  _TIM1_CCER2 = PWM_CCER2;
+  _TIM1_OISR  = 0x00;
+  _TIM1_DTR   = PWM_DTG;
+  _TIM1_BKR   = PWM_BKR;
+
+  // update event -> TRGO (MMS=010)
+  _TIM1_CR2 = (0x02 << 4);
+
+  // load preload registers and repetition counter, clear flags
+  _TIM1_EGR = _TIM1_EGR_UG;
+  _TIM1_SR1 = 0x00;
+
+  // break interrupt
+  #if PWM_BREAK
+    _TIM1_IER = _TIM1_IER_BIE;
+  #endif
+
+  // start timer with preloaded auto-reload. Center-aligned mode 1
+  #if PWM_CENTER
+    _TIM1_CR1 = _TIM1_CR1_ARPE | (0x01 << 5) | _TIM1_CR1_CEN;
+  #else
+    _TIM1_CR1 = _TIM1_CR1_ARPE | _TIM1_CR1_CEN;
+  #endif
+
+} // pwm_init
+
+
+
+/**
+  \fn void pwm_enable(uint8_t on)
+
+  \brief enable or disable PWM outputs
+
+  \param[in]  on   1=enable outputs, 0=drive outputs to idle level
+
+  Enabling also clears a previous break event.
+*/
+void pwm_enable(uint8_t on) {
+
+  if (on) {
+    _TIM1_SR1 = (uint8_t) ~_TIM1_SR1_BIF;
+    #if PWM_BREAK
+      _TIM1_IER |= _TIM1_IER_BIE;
+    #endif
+    _TIM1_BKR |= _TIM1_BKR_MOE;
+  }
+  else
+    _TIM1_BKR &= ~_TIM1_BKR_MOE;
+
+} // pwm_enable
+
+
+
+/**
+  \fn void pwm_update(uint16_t duty1, uint16_t duty2, uint16_t duty3)
+
+  \brief set duty cycles of all channels
+
+  \param[in]  duty1   duty cycle of channel 1 (0..PWM_MAX)
+  \param[in]  duty2   duty cycle of channel 2 (0..PWM_MAX)
+  \param[in]  duty3   duty cycle of channel 3 (0..PWM_MAX)
+
+  Values are copied to CCRx in the update ISR, and become active together
+  at the following update event. A pending update is overwritten.
+*/
+void pwm_update(uint16_t duty1, uint16_t duty2, uint16_t duty3) {
+
+  // lock ISR while buffer is modified
+  _TIM1_IER &= ~_TIM1_IER_UIE;
+
+  s_ccr[0] = (uint8_t) (duty1 >> 8);
+  s_ccr[1] = (uint8_t) (duty1);
+  s_ccr[2] = (uint8_t) (duty2 >> 8);
+  s_ccr[3] = (uint8_t) (duty2);
+  s_ccr[4] = (uint8_t) (duty3 >> 8);
+  s_ccr[5] = (uint8_t) (duty3);
+
+  // copy in next update ISR. Clear old event to avoid copy late in PWM period
+  _TIM1_SR1 = (uint8_t) ~_TIM1_SR1_UIF;
+  _TIM1_IER |= _TIM1_IER_UIE;
+
+} // pwm_update
+
+
+
+/**
+  \fn uint8_t pwm_break(void)
+
+  \brief check for break event
+
+  \return 1 if outputs were disabled via break input, else 0
+*/
+uint8_t pwm_break(void) {
+
+  return((_TIM1_SR1 & _TIM1_SR1_BIF) ? 1 : 0);
+
+} // pwm_break
+
+
+
+/**
+  \fn void TIM1_UPD_ISR(void)
+
+  \brief ISR for TIM1 update and break
+
+  Copy pending duty cycles to compare preload registers. High byte must be
+  written first. Break event only disables the interrupt, outputs were
+  already disabled by hardware.
+
+  Notes:
+    - for Cosmic compiler, add TIM1_UPD_ISR also to 'stm8_interrupt_vector.c'
+    - IAR compiler has an IRQ offset of +2 compared to STM8 datasheet (see below)
+*/
+#if defined(_IAR_)
+   #pragma vector = 2+__TIM1_UPD_OVF_VECTOR__    // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(TIM1_UPD_ISR, __TIM1_UPD_OVF_VECTOR__)
+{
+  // break -> keep BIF for pwm_break(), disable break interrupt until pwm_enable()
+  if (_TIM1_SR1 & _TIM1_SR1_BIF)
+    _TIM1_IER &= ~_TIM1_IER_BIE;
+
+  // burst update of all compare registers (if pending)
+  if ((_TIM1_IER & _TIM1_IER_UIE) && (_TIM1_SR1 & _TIM1_SR1_UIF)) {
+    _TIM1_CCR1H = s_ccr[0];
+    _TIM1_CCR1L = s_ccr[1];
+    _TIM1_CCR2H = s_ccr[2];
+    _TIM1_CCR2L = s_ccr[3];
+    _TIM1_CCR3H = s_ccr[4];
+    _TIM1_CCR3L = s_ccr[5];
+    _TIM1_IER &= ~_TIM1_IER_UIE;
+    _TIM1_SR1 = (uint8_t) ~_TIM1_SR1_UIF;
+  }
+
+} // TIM1_UPD_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
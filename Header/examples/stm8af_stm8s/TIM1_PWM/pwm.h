@@ -0,0 +1,97 @@
+/**
+  \file pwm.h
+
+  \brief declaration of TIM1 3-phase PWM with complementary outputs
+
+  PWM on TIM1 channels 1-3 and complementary outputs CH1N-CH3N with
+    - period, dead-time and repetition counter calculated at compile time
+    - duty cycles of all channels updated at once via preload registers
+    - optional center-aligned mode. Update event is output as TRGO, e.g.
+      to trigger ADC1 synchronous to PWM
+    - optional break input, which disables all outputs in hardware
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _PWM_H_
+#define _PWM_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// CPU clock = TIM1 clock [Hz]
+#if !defined(F_CPU)
+  #define F_CPU             16000000L     ///< CPU clock [Hz]
+#endif
+
+// PWM frequency
+#if !defined(PWM_FREQ)
+  #define PWM_FREQ          20000L        ///< PWM frequency [Hz]
+#endif
+
+// dead-time between switch-off of one output and switch-on of complementary output
+#if !defined(PWM_DEADTIME)
+  #define PWM_DEADTIME      500           ///< dead-time [ns]
+#endif
+
+// 0=edge-aligned, 1=center-aligned PWM
+#if !defined(PWM_CENTER)
+  #define PWM_CENTER        0             ///< PWM alignment
+#endif
+
+// duty cycle update (and TRGO) every N PWM periods (1..128)
+#if !defined(PWM_REPEAT)
+  #define PWM_REPEAT        1             ///< PWM periods per update
+#endif
+
+// 1=enable break input TIM1_BKIN (active low)
+#if !defined(PWM_BREAK)
+  #define PWM_BREAK         0             ///< break input enable
+#endif
+
+// auto-reload value. Center-aligned counts up and down -> half value
+#if PWM_CENTER
+  #define PWM_ARR           (F_CPU / (2 * PWM_FREQ))
+#else
+  #define PWM_ARR           (F_CPU / PWM_FREQ - 1)
+#endif
+
+/// duty cycle for 100% (0=0%)
+#define PWM_MAX             (PWM_ARR + 1)
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+ISR_HANDLER(TIM1_UPD_ISR, __TIM1_UPD_OVF_VECTOR__);
+
+/// init and start TIM1 PWM with 0% duty. Outputs are disabled until pwm_enable()
+void      pwm_init(void);
+
+/// enable (1) or disable (0) all PWM outputs. Also re-enables after break
+void      pwm_enable(uint8_t on);
+
+/// set duty cycles (0..PWM_MAX) of channels 1-3. Applied together at next update event
+void      pwm_update(uint16_t duty1, uint16_t duty2, uint16_t duty3);
+
+/// check if last pwm_update() is pending
+#define   pwm_busy()          (_TIM1_IER & _TIM1_IER_UIE)
+
+/// check if outputs were disabled via break input
+uint8_t   pwm_break(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _PWM_H_
@@ -0,0 +1,19 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8S105K6.h"	// sduino-uno (https://github.com/roybaer/sduino_uno)
+
+
+/*----------------------------------------------------------
+    DRIVER CONFIGURATION
+----------------------------------------------------------*/
+
+// CPU clock
+#define F_CPU           16000000L
+
+// UART 115.2kBaud, PWM 1kHz
+#define UART_BAUD       115200L
+#define PWM_FREQ        1000L
+
+// board specific pin setup for UART
+#define UART_PINS()     // UART2 controls TX/RX pins
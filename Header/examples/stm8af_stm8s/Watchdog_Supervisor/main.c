@@ -0,0 +1,93 @@
+/**********************
+  STM8 watchdog supervisor
+  Demonstrate IWDG/WWDG supervision of multiple tasks and reset cause analysis
+
+  Functionality:
+  - init FCPU to 16MHz
+  - print reset cause, number of watchdog resets and hung tasks via UART2
+  - start IWDG (500ms) and WWDG (kick every 20ms)
+  - task 0 (LED) checks in every 100ms, task 1 every 200ms
+  - after 5s task 1 hangs, while main loop keeps kicking
+  - IWDG detects missing check-in and resets after 500ms
+
+  Boards:
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "wdg.h"
+
+// define communication speed
+#define BAUDRATE   9600
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint8_t   taskLed, taskSlow;
+  uint16_t  ms = 0;
+
+  ////
+  // initialization
+  ////
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // LED (PC5) to output push-pull
+  _PORTC_DDR |= _PORT_PIN5;
+  _PORTC_CR1 |= _PORT_PIN5;
+
+  // set UART2 to 9.6kBaud (note: BRR2 must be written before BRR1!)
+  _UART2_BRR2 = (uint8_t) ((((F_CPU/BAUDRATE) & 0xF000) >> 8) | ((F_CPU/BAUDRATE) & 0x000F));
+  _UART2_BRR1 = (uint8_t) (((F_CPU/BAUDRATE) & 0x0FF0) >> 4);
+  _UART2_CR2 |= _UART2_CR2_TEN;
+
+  // TIM4 1ms period (polled)
+  _TIM4_PSCR = 7;
+  _TIM4_ARR  = 124;
+  _TIM4_CR   = _TIM4_CR_ARPE | _TIM4_CR_CEN;
+
+  // print reset cause before starting watchdogs (UART output is slower than WWDG timeout)
+  wdg_init();
+  printf("\nreset 0x%02x, wdg resets %d, hung tasks 0x%02x\n", (int) wdg_cause(), (int) wdg_resets(), (int) wdg_hung());
+  while (!(_UART2_SR & _UART2_SR_TC));
+
+  // register tasks and start watchdogs
+  taskLed  = wdg_register();
+  taskSlow = wdg_register();
+  wdg_start();
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // wait for 1ms tick
+    while (!(_TIM4_SR & _TIM4_SR_UIF));
+    _TIM4_SR = 0x00;
+    ms++;
+
+    // task 0: blink LED
+    if ((ms % 100) == 0) {
+      _PORTC_ODR ^= _PORT_PIN5;
+      wdg_checkin(taskLed);
+    }
+
+    // task 1: hangs after 5s
+    if (((ms % 200) == 0) && (ms < 5000))
+      wdg_checkin(taskSlow);
+
+    // periodic watchdog kick
+    if ((ms % WDG_KICK_MS) == 0)
+      wdg_kick();
+
+  } // main loop
+
+} // main()
@@ -0,0 +1,20 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8S105K6.h"	// sduino-uno (https://github.com/roybaer/sduino_uno)
+#include "stdio.h"
+
+
+/*----------------------------------------------------------
+    WATCHDOG CONFIGURATION
+----------------------------------------------------------*/
+
+// CPU clock
+#define F_CPU           16000000L
+
+// tasks must check in within 500ms
+#define WDG_MAX_TASKS   2
+#define WDG_IWDG_MS     500
+
+// kick period (WWDG window 10.7ms..40.0ms at 16MHz)
+#define WDG_KICK_MS     20
@@ -0,0 +1,271 @@
+/**
+  \file wdg.c
+
+  \brief implementation of watchdog supervisor with per-task check-in
+
+  Each task has its own check-in flag byte. Setting a byte is atomic, i.e.
+  tasks can check in from ISRs without lock. wdg_kick() collects the flags
+  into a mask and only refreshes the IWDG if all registered tasks checked
+  in. The mask of missing tasks is stored in noinit RAM on every kick, so
+  after an IWDG reset it shows which task hung.
+
+  The WWDG counter and window are calculated at compile time from F_CPU and
+  WDG_KICK_MS. A refresh outside the window causes an immediate reset.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "wdg.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if (WDG_MAX_TASKS < 1) || (WDG_MAX_TASKS > 8)
+  #error WDG_MAX_TASKS must be 1..8
+#endif
+#if (WDG_IWDG_MS < 16) || (WDG_IWDG_MS > 1020)
+  #error WDG_IWDG_MS must be 16..1020ms
+#endif
+#if (WDG_WWDG_TIMEOUT > 64) || (WDG_WWDG_EARLY < 1)
+  #error WDG_KICK_MS out of WWDG range for F_CPU
+#endif
+#if (WDG_WWDG_TIMEOUT <= WDG_WWDG_EARLY)
+  #error WDG_KICK_MS too short for F_CPU, WWDG refresh window is empty
+#endif
+
+// marker for valid noinit record
+#define WDG_MAGIC           0xA5
+
+// watchdog reset flags
+#define WDG_RST_WDG         (_RST_SR_IWDGF | _RST_SR_WWDGF)
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL TYPES
+-----------------------------------------------------------------------------*/
+
+// record in noinit RAM, kept over reset
+typedef struct {
+  uint8_t   magic;        // WDG_MAGIC if valid
+  uint8_t   check;        // inverted magic
+  uint8_t   cause;        // _RST_SR of last reset
+  uint8_t   resets;       // watchdog resets since power-on
+  uint8_t   missing;      // tasks missing at last kick
+  uint8_t   hung;         // tasks missing before last watchdog reset
+} wdg_noinit_t;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// noinit record at fixed address, not cleared by startup code. Compiler specific
+#if defined(_SDCC_)
+  __at(WDG_NOINIT_ADDR) wdg_noinit_t    g_wdgNoinit;
+#elif defined(_IAR_)
+  __no_init wdg_noinit_t  g_wdgNoinit @ WDG_NOINIT_ADDR;
+#else
+  #error compiler not supported
+#endif
+
+// check-in flag per task and number of registered tasks
+static volatile uint8_t   s_checkin[WDG_MAX_TASKS];
+static uint8_t            s_tasks;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void wdg_init(void)
+
+  \brief store reset cause
+
+  Read and clear reset flags and update the noinit record. RAM content
+  is undefined after power-on, therefore the record is cleared if no reset
+  flag is set or the record is invalid.
+*/
+void wdg_init(void) {
+
+  uint8_t   cause;
+
+  // read and clear reset flags (write 1 to clear)
+  cause = _RST_SR;
+  _RST_SR = cause;
+
+  // after power-on or invalid record start with empty record
+  if ((cause == 0) || (g_wdgNoinit.magic != WDG_MAGIC) || (g_wdgNoinit.check != (uint8_t) ~WDG_MAGIC)) {
+    g_wdgNoinit.magic   = WDG_MAGIC;
+    g_wdgNoinit.check   = (uint8_t) ~WDG_MAGIC;
+    g_wdgNoinit.resets  = 0;
+    g_wdgNoinit.hung    = 0;
+  }
+
+  // on watchdog reset keep tasks missing at last kick
+  if (cause & WDG_RST_WDG) {
+    g_wdgNoinit.hung = g_wdgNoinit.missing;
+    if (g_wdgNoinit.resets < 0xFF)
+      g_wdgNoinit.resets++;
+  }
+  g_wdgNoinit.cause   = cause;
+  g_wdgNoinit.missing = 0;
+
+} // wdg_init
+
+
+
+/**
+  \fn void wdg_start(void)
+
+  \brief start IWDG and WWDG
+
+  Watchdogs cannot be stopped, therefore call after time consuming
+  initialization. First wdg_kick() is due after WDG_KICK_MS.
+*/
+void wdg_start(void) {
+
+  // start IWDG and set timeout (LSI is enabled automatically)
+  _IWDG_KR  = _IWDG_KR_KEY_ENABLE;
+  _IWDG_KR  = _IWDG_KR_KEY_ACCESS;
+  _IWDG_PR  = WDG_IWDG_PR;
+  _IWDG_RLR = WDG_IWDG_RLR;
+  _IWDG_KR  = _IWDG_KR_KEY_REFRESH;
+
+  // start WWDG. Window must be set before activation
+  _WWDG_WR  = WDG_WWDG_W;
+  _WWDG_CR  = _WWDG_CR_WDGA | WDG_WWDG_T;
+
+} // wdg_start
+
+
+
+/**
+  \fn uint8_t wdg_register(void)
+
+  \brief register task for check-in
+
+  \return task ID for wdg_checkin(), or WDG_ERR_FULL
+
+  Task must check in within WDG_IWDG_MS after registration.
+*/
+uint8_t wdg_register(void) {
+
+  if (s_tasks >= WDG_MAX_TASKS)
+    return(WDG_ERR_FULL);
+
+  s_checkin[s_tasks] = 1;
+  return(s_tasks++);
+
+} // wdg_register
+
+
+
+/**
+  \fn void wdg_checkin(uint8_t id)
+
+  \brief task check-in
+
+  \param[in]  id    task ID from wdg_register()
+*/
+void wdg_checkin(uint8_t id) {
+
+  if (id < WDG_MAX_TASKS)
+    s_checkin[id] = 1;
+
+} // wdg_checkin
+
+
+
+/**
+  \fn uint8_t wdg_kick(void)
+
+  \brief refresh watchdogs
+
+  \return mask of tasks which did not check in yet (bit n = task n)
+
+  Refresh WWDG. Refresh IWDG and clear check-in flags only if all registered
+  tasks checked in since the last IWDG refresh. Must be called every
+  WDG_KICK_MS, otherwise the WWDG window is violated.
+*/
+uint8_t wdg_kick(void) {
+
+  uint8_t   i, bit, missing = 0;
+
+  // collect missing tasks
+  for (i=0, bit=0x01; i<s_tasks; i++, bit<<=1) {
+    if (!s_checkin[i])
+      missing |= bit;
+  }
+
+  // all tasks alive -> refresh IWDG and start new round
+  if (!missing) {
+    _IWDG_KR = _IWDG_KR_KEY_REFRESH;
+    for (i=0; i<s_tasks; i++)
+      s_checkin[i] = 0;
+  }
+
+  // keep for reset analysis
+  g_wdgNoinit.missing = missing;
+
+  // refresh WWDG
+  _WWDG_CR = _WWDG_CR_WDGA | WDG_WWDG_T;
+
+  return(missing);
+
+} // wdg_kick
+
+
+
+/**
+  \fn uint8_t wdg_cause(void)
+
+  \brief get reset cause
+
+  \return _RST_SR of last reset (_RST_SR_WWDGF, _RST_SR_IWDGF, ...). 0=power-on or reset pin
+
+  Note: SW_RESET() also sets _RST_SR_WWDGF.
+*/
+uint8_t wdg_cause(void) {
+
+  return(g_wdgNoinit.cause);
+
+} // wdg_cause
+
+
+
+/**
+  \fn uint8_t wdg_hung(void)
+
+  \brief get tasks missing at last watchdog reset
+
+  \return mask of tasks (bit n = task n). 0=WWDG timing violation or no watchdog reset
+*/
+uint8_t wdg_hung(void) {
+
+  return(g_wdgNoinit.hung);
+
+} // wdg_hung
+
+
+
+/**
+  \fn uint8_t wdg_resets(void)
+
+  \brief get number of watchdog resets
+
+  \return number of watchdog resets since power-on or reset pin (saturated at 255)
+*/
+uint8_t wdg_resets(void) {
+
+  return(g_wdgNoinit.resets);
+
+} // wdg_resets
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
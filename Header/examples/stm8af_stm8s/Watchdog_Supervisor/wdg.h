@@ -0,0 +1,122 @@
+/**
+  \file wdg.h
+
+  \brief declaration of watchdog supervisor with per-task check-in
+
+  Combine both watchdogs for detection of different failures:
+    - IWDG: each registered task must check in within WDG_IWDG_MS. The IWDG
+      is only refreshed after all tasks checked in, i.e. a single hanging
+      task causes a reset, even if other tasks keep running
+    - WWDG: wdg_kick() must be called periodically every WDG_KICK_MS. Too late
+      or too early calls (e.g. runaway loop) cause a reset
+
+  The reset cause and the tasks missing at a watchdog reset are stored in
+  RAM which is not initialized by the startup code.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _WDG_H_
+#define _WDG_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// CPU clock [Hz]. Is set via CLK_CKDIVR in main()
+#if !defined(F_CPU)
+  #define F_CPU             16000000L     ///< CPU frequency [Hz]
+#endif
+
+// max. number of tasks (<=8)
+#if !defined(WDG_MAX_TASKS)
+  #define WDG_MAX_TASKS     8             ///< number of task check-in slots
+#endif
+
+// IWDG timeout, i.e. max. time between check-ins of each task (16..1020ms)
+#if !defined(WDG_IWDG_MS)
+  #define WDG_IWDG_MS       500           ///< IWDG timeout [ms]
+#endif
+
+// period of wdg_kick() calls. WWDG resets if period is <50% or >200% of this
+#if !defined(WDG_KICK_MS)
+  #define WDG_KICK_MS       20            ///< nominal kick period [ms]
+#endif
+
+// address of noinit RAM (8 bytes). Default is below the 512B stack at end of RAM. Variables must not exceed it
+#if !defined(WDG_NOINIT_ADDR)
+  #define WDG_NOINIT_ADDR   (STM8_RAM_SIZE - 0x200 - 8)   ///< address of noinit record
+#endif
+
+// IWDG prescaler: select smallest one with <=256 ticks per timeout (IWDG clock = LSI/2 = 64kHz)
+#if (WDG_IWDG_MS * 16L) <= 256
+  #define WDG_IWDG_PR       0             ///< IWDG prescaler /4
+#elif (WDG_IWDG_MS * 8L) <= 256
+  #define WDG_IWDG_PR       1             ///< IWDG prescaler /8
+#elif (WDG_IWDG_MS * 4L) <= 256
+  #define WDG_IWDG_PR       2             ///< IWDG prescaler /16
+#elif (WDG_IWDG_MS * 2L) <= 256
+  #define WDG_IWDG_PR       3             ///< IWDG prescaler /32
+#elif (WDG_IWDG_MS * 1L) <= 256
+  #define WDG_IWDG_PR       4             ///< IWDG prescaler /64
+#elif (WDG_IWDG_MS / 2L) <= 256
+  #define WDG_IWDG_PR       5             ///< IWDG prescaler /128
+#else
+  #define WDG_IWDG_PR       6             ///< IWDG prescaler /256
+#endif
+#define WDG_IWDG_RLR        ((WDG_IWDG_MS * 64L) / (4L << WDG_IWDG_PR) - 1)   ///< IWDG reload value
+
+// WWDG ticks (12288 CPU cycles) for timeout (2x kick period) and window (0.5x kick period)
+#define WDG_WWDG_TIMEOUT    ((2L * WDG_KICK_MS * (F_CPU / 1000L)) / 12288L)           ///< WWDG ticks until reset
+#define WDG_WWDG_EARLY      ((WDG_KICK_MS * (F_CPU / 1000L) + 2L * 12288L - 1) / (2L * 12288L))   ///< WWDG ticks before refresh allowed
+
+/// WWDG counter value after refresh (reset when T6 is cleared, i.e. counter <0x40)
+#define WDG_WWDG_T          (0x3F + WDG_WWDG_TIMEOUT)
+
+/// WWDG window value (refresh only allowed if counter <= window)
+#define WDG_WWDG_W          (WDG_WWDG_T - WDG_WWDG_EARLY)
+
+// return code of wdg_register()
+#define WDG_ERR_FULL        0xFF          ///< no free task slot
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// store reset cause from _RST_SR. Call as early as possible
+void      wdg_init(void);
+
+/// start IWDG and WWDG
+void      wdg_start(void);
+
+/// register task for check-in. Return task ID or WDG_ERR_FULL
+uint8_t   wdg_register(void);
+
+/// task check-in. Safe from ISRs
+void      wdg_checkin(uint8_t id);
+
+/// refresh WWDG, and IWDG if all tasks checked in. Call every WDG_KICK_MS. Return mask of missing tasks
+uint8_t   wdg_kick(void);
+
+/// get reset cause (_RST_SR_xxx flags, 0=power-on or external reset)
+uint8_t   wdg_cause(void);
+
+/// get mask of tasks which had not checked in before last watchdog reset
+uint8_t   wdg_hung(void);
+
+/// get number of watchdog resets since power-on
+uint8_t   wdg_resets(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _WDG_H_
@@ -40,6 +40,8 @@ uint32_t   g_millis = 0;
 ////////
 void main(void) {
 
+  uint32_t  millis, lastToggle = 0;
+
   ////
   // initialization
   ////
@@ -80,9 +82,14 @@ void main(void) {
   ////
   while (1) {
 
+    // copy ms counter with interrupts disabled (32bit access is not atomic on 8bit CPU)
+    DISABLE_INTERRUPTS();
+    millis = g_millis;
+    ENABLE_INTERRUPTS();
+
     // blink LED every 500ms
-    if (g_millis > 500) {
-      g_millis = 0;
+    if ((uint32_t) (millis - lastToggle) >= 500) {
+      lastToggle = millis;
 
       // toggle LED
       #if BOARD == STM8S_DISCOVERY     // STM8S-Discovery -> PD0
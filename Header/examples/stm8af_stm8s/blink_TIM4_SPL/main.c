@@ -61,6 +61,8 @@ extern uint32_t   g_millis;
 ////////
 void main(void) {
 
+  uint32_t  millis, lastToggle = 0;
+
   ////
   // initialization
   ////
@@ -94,9 +96,14 @@ void main(void) {
   ////
   while (1) {
 
+    // copy ms counter with interrupts disabled (32bit access is not atomic on 8bit CPU)
+    DISABLE_INTERRUPTS();
+    millis = g_millis;
+    ENABLE_INTERRUPTS();
+
     // blink LED every 500ms (direct bitwise access)
-    if (g_millis > 500) {
-      g_millis = 0;
+    if ((uint32_t) (millis - lastToggle) >= 500) {
+      lastToggle = millis;
 
       // toggle LED
       #if BOARD == STM8S_DISCOVERY     // STM8S-Discovery -> PD0
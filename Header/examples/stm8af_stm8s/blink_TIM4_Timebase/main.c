@@ -0,0 +1,116 @@
+/**********************
+  STM8 blink LED with TIM4 timebase and software timers
+  Demonstrate atomic time-keeping and low-power waiting
+
+  Functionality:
+  - init FCPU to 16MHz
+  - configure LED pin as output
+  - set up TIM4 timebase with 1ms interrupt
+  - blink pin every 500ms via periodic software timer
+  - short flash every 2s via single-shot software timer
+  - wait for interrupt instead of busy loop
+
+  Boards:
+  - STM8SDiscovery   https://www.st.com/en/evaluation-tools/stm8s-discovery.html
+  - sduino-UNO       https://github.com/roybaer/sduino_uno
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"        // defines board & STM8 device
+#include "timebase.h"    // timebase & software timers (incl. ISR declaration)
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// software timers
+tb_timer_t   g_timerBlink;
+tb_timer_t   g_timerFlash;
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+// toggle LED
+void toggle_LED(void) {
+
+  #if BOARD == STM8S_DISCOVERY     // STM8S-Discovery -> PD0
+    _PORTD_ODR ^= _PORT_PIN0;
+  #else                            // sduino-UNO -> PC5
+    _PORTC_ODR ^= _PORT_PIN5;
+  #endif
+
+} // toggle_LED
+
+
+// toggle LED twice within 50ms
+void flash_LED(void) {
+
+  toggle_LED();
+  tb_delay_ms(50);
+  toggle_LED();
+
+} // flash_LED
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  tb_deadline_t  deadline;
+
+  ////
+  // initialization
+  ////
+
+  // disable interrupts for initialization
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz clock (reset is 2MHz). Must match F_CPU in timebase.h
+  _CLK_CKDIVR = 0x00;
+
+  // configure LED pin to output push-pull
+  #if BOARD == STM8S_DISCOVERY     // STM8S-Discovery -> PD0
+    _PORTD_DDR |= _PORT_PIN0;
+    _PORTD_CR1 |= _PORT_PIN0;
+  #else                            // sduino-UNO -> PC5
+    _PORTC_DDR |= _PORT_PIN5;
+    _PORTC_CR1 |= _PORT_PIN5;
+  #endif
+
+  // init TIM4 timebase with 1ms interrupt
+  tb_init();
+
+  // start periodic blink timer
+  tb_timer_start(&g_timerBlink, 500, 500, toggle_LED);
+
+  // enable interrupts after initialization
+  ENABLE_INTERRUPTS();
+
+
+  ////
+  // main loop
+  ////
+  deadline = tb_deadline(2000);
+  while (1) {
+
+    // every 2s start a single-shot timer for a short flash
+    if (tb_expired(deadline)) {
+      deadline += 2000;
+      tb_timer_start(&g_timerFlash, 250, 0, flash_LED);
+    }
+
+    // execute callbacks of expired timers
+    tb_poll();
+
+    // sleep until next interrupt (at least every 1ms)
+    WAIT_FOR_INTERRUPT();
+
+  } // main loop
+
+} // main()
@@ -0,0 +1,452 @@
+/**
+  \file timebase.c
+
+  \brief implementation of millisecond/microsecond timebase via TIM4
+
+  TIM4 generates a 1ms interrupt which increases the millisecond counter.
+  The microsecond time is composed from this counter and TIM4_CNTR.
+
+  Software timers are kept in a timer wheel with TB_WHEEL_SIZE slots,
+  sorted by expiry time. Each ms the ISR only checks the timers in one
+  slot, independent of the total number of timers. The ISR only marks
+  expired timers, and their callbacks are executed from tb_poll() in the
+  main loop. Timer lists are protected against the ISR by disabling the
+  TIM4 interrupt only, other interrupts are not blocked.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "timebase.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if (TB_TICKS_PER_MS > 256) || ((F_CPU % (1000L << TB_TIM4_PSC)) != 0)
+  #error F_CPU not supported by TIM4 timebase
+#endif
+#if (TB_WHEEL_SIZE & (TB_WHEEL_SIZE-1)) != 0
+  #error TB_WHEEL_SIZE must be a power of 2
+#endif
+
+// convert TIM4 ticks to us. Avoid division if possible
+#if (1000 % TB_TICKS_PER_MS) == 0
+  #define TB_TICKS_TO_US(cnt)   ((uint16_t) (cnt) * (uint16_t) (1000 / TB_TICKS_PER_MS))
+#else
+  #define TB_TICKS_TO_US(cnt)   ((uint16_t) (((uint32_t) (cnt) * 1000L) / TB_TICKS_PER_MS))
+#endif
+
+// wheel slot of expiry time
+#define TB_SLOT(expire)         ((uint8_t) (expire) & (TB_WHEEL_SIZE-1))
+
+// block TIM4 ISR during modification of timer lists
+#define TB_LOCK()               (_TIM4_IER &= ~_TIM4_IER_UIE)
+#define TB_UNLOCK()             (_TIM4_IER |= _TIM4_IER_UIE)
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+static volatile uint32_t   s_millis;                    ///< ms counter, increased in TIM4 ISR
+static volatile uint8_t    s_pending;                   ///< at least one timer expired
+static tb_timer_t          *s_wheel[TB_WHEEL_SIZE];     ///< timer wheel slots
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void tb_unlink(tb_timer_t *timer)
+
+  \brief remove timer from its wheel slot (TIM4 ISR must be locked)
+
+  \param[in]  timer   timer to remove
+*/
+static void tb_unlink(tb_timer_t *timer) {
+
+  tb_timer_t  **p = &(s_wheel[TB_SLOT(timer->expire)]);
+
+  while (*p != NULL) {
+    if (*p == timer) {
+      *p = timer->next;
+      break;
+    }
+    p = &((*p)->next);
+  }
+  timer->flags = 0;
+
+} // tb_unlink
+
+
+
+/**
+  \fn void tb_insert(tb_timer_t *timer)
+
+  \brief add timer to wheel slot of its expiry time (TIM4 ISR must be locked)
+
+  \param[in]  timer   timer to add
+*/
+static void tb_insert(tb_timer_t *timer) {
+
+  uint8_t  slot = TB_SLOT(timer->expire);
+
+  timer->next = s_wheel[slot];
+  s_wheel[slot] = timer;
+  timer->flags = TB_TIMER_ACTIVE;
+
+} // tb_insert
+
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void tb_init(void)
+
+  \brief init TIM4 for 1ms interrupt
+
+  Configure TIM4 for 1ms update interrupt and reset counters.
+  Interrupts must be enabled by application.
+*/
+void tb_init(void) {
+
+  uint8_t  i;
+
+  // reset state
+  s_millis  = 0;
+  s_pending = 0;
+  for (i=0; i<TB_WHEEL_SIZE; i++)
+    s_wheel[i] = NULL;
+
+  // stop timer and set period to 1ms
+  _TIM4_CR   = 0x00;
+  _TIM4_PSCR = TB_TIM4_PSC;
+  _TIM4_ARR  = (uint8_t) (TB_TICKS_PER_MS - 1);
+  _TIM4_CNTR = 0x00;
+
+  // load prescaler immediately, then clear resulting update flag
+  _TIM4_EGR  = _TIM4_EGR_UG;
+  _TIM4_SR   = 0x00;
+
+  // enable interrupt and start timer
+  _TIM4_IER  = _TIM4_IER_UIE;
+  _TIM4_CR   = (_TIM4_CR_ARPE | _TIM4_CR_CEN);
+
+} // tb_init
+
+
+
+/**
+  \fn uint32_t tb_millis(void)
+
+  \brief get milliseconds since tb_init()
+
+  \return milliseconds since tb_init()
+
+  Read ms counter without disabling interrupts. 32bit access is not
+  atomic on STM8, so repeat read until the ISR didn't change the counter.
+*/
+uint32_t tb_millis(void) {
+
+  uint32_t  ms;
+
+  do {
+    ms = s_millis;
+  } while (ms != s_millis);
+
+  return(ms);
+
+} // tb_millis
+
+
+
+/**
+  \fn uint32_t tb_micros(void)
+
+  \brief get microseconds since tb_init()
+
+  \return microseconds since tb_init()
+
+  Combine ms counter and TIM4 counter. If TIM4 already overflowed but the
+  ISR is not yet executed (e.g. interrupts disabled), correct the ms count.
+  Resolution is one TIM4 tick, e.g. 4us @ 16MHz.
+*/
+uint32_t tb_micros(void) {
+
+  uint32_t  ms;
+  uint8_t   cnt, uif;
+
+  // read consistent set of ms counter and TIM4 registers
+  do {
+    ms  = s_millis;
+    cnt = _TIM4_CNTR;
+    uif = _TIM4_SR & _TIM4_SR_UIF;
+  } while (ms != s_millis);
+
+  // overflow pending, counter already restarted
+  if (uif && (cnt < (TB_TICKS_PER_MS/2)))
+    ms++;
+
+  return(ms * 1000L + TB_TICKS_TO_US(cnt));
+
+} // tb_micros
+
+
+
+/**
+  \fn void tb_delay_ms(uint16_t ms)
+
+  \brief sleep for some milliseconds
+
+  \param[in]  ms   duration [ms]
+
+  Wait in WAIT mode until time has passed. CPU wakes up at least every
+  1ms via TIM4 interrupt. Interrupts must be enabled.
+*/
+void tb_delay_ms(uint16_t ms) {
+
+  tb_deadline_t  deadline = tb_deadline(ms);
+
+  while (!tb_expired(deadline))
+    WAIT_FOR_INTERRUPT();
+
+} // tb_delay_ms
+
+
+
+/**
+  \fn void tb_advance(uint32_t ms)
+
+  \brief advance ms counter
+
+  \param[in]  ms   time to add [ms]
+
+  Add time during which TIM4 was stopped, e.g. in Active-Halt mode.
+  Timers which expired meanwhile are marked for the next tb_poll().
+*/
+void tb_advance(uint32_t ms) {
+
+  tb_timer_t  *timer;
+  uint8_t     slot;
+
+  TB_LOCK();
+
+  // advance counter. Access is atomic while ISR is locked
+  s_millis += ms;
+
+  // mark timers in all slots, the ISR only checks one slot per ms
+  for (slot=0; slot<TB_WHEEL_SIZE; slot++) {
+    for (timer = s_wheel[slot]; timer != NULL; timer = timer->next) {
+      if ((int32_t) (s_millis - timer->expire) >= 0) {
+        timer->flags |= TB_TIMER_EXPIRED;
+        s_pending = 1;
+      }
+    }
+  }
+
+  TB_UNLOCK();
+
+} // tb_advance
+
+
+
+/**
+  \fn void tb_timer_start(tb_timer_t *timer, uint16_t delay, uint16_t period, tb_callback_t callback)
+
+  \brief start software timer
+
+  \param[in]  timer      timer to start (memory provided by application)
+  \param[in]  delay      delay until first expiry [ms] (min. 1ms)
+  \param[in]  period     period for repeated expiry [ms] (0=single shot)
+  \param[in]  callback   function called from tb_poll() on expiry
+
+  Start or restart software timer. Callback is executed from tb_poll(), not from ISR.
+*/
+void tb_timer_start(tb_timer_t *timer, uint16_t delay, uint16_t period, tb_callback_t callback) {
+
+  TB_LOCK();
+
+  // restart running timer
+  if (timer->flags & TB_TIMER_ACTIVE)
+    tb_unlink(timer);
+
+  // set parameters and sort into wheel. Counter is constant while ISR is locked
+  if (delay == 0)
+    delay = 1;
+  timer->expire   = s_millis + delay;
+  timer->period   = period;
+  timer->callback = callback;
+  tb_insert(timer);
+
+  TB_UNLOCK();
+
+} // tb_timer_start
+
+
+
+/**
+  \fn void tb_timer_stop(tb_timer_t *timer)
+
+  \brief stop software timer
+
+  \param[in]  timer      timer to stop
+*/
+void tb_timer_stop(tb_timer_t *timer) {
+
+  TB_LOCK();
+
+  if (timer->flags & TB_TIMER_ACTIVE)
+    tb_unlink(timer);
+
+  TB_UNLOCK();
+
+} // tb_timer_stop
+
+
+
+/**
+  \fn void tb_poll(void)
+
+  \brief execute callbacks of expired timers
+
+  Call periodically from main loop. Periodic timers are restarted with
+  constant phase, single-shot timers are stopped. Callbacks are executed
+  with TIM4 interrupt enabled.
+*/
+void tb_poll(void) {
+
+  tb_timer_t     *timer;
+  tb_callback_t  callback;
+  uint8_t        slot;
+
+  // fast exit if no timer expired
+  if (!s_pending)
+    return;
+  s_pending = 0;
+
+  // search wheel for expired timers
+  for (slot=0; slot<TB_WHEEL_SIZE; slot++) {
+
+    TB_LOCK();
+    timer = s_wheel[slot];
+    while (timer != NULL) {
+
+      // skip running timers
+      if (!(timer->flags & TB_TIMER_EXPIRED)) {
+        timer = timer->next;
+        continue;
+      }
+
+      // restart periodic timer or stop single-shot timer
+      tb_unlink(timer);
+      if (timer->period != 0) {
+        timer->expire += timer->period;
+        tb_insert(timer);
+      }
+      callback = timer->callback;
+
+      // execute callback with ISR enabled, then restart search in this slot
+      TB_UNLOCK();
+      if (callback != NULL)
+        callback();
+      TB_LOCK();
+      timer = s_wheel[slot];
+
+    } // loop over slot
+    TB_UNLOCK();
+
+  } // loop over wheel
+
+} // tb_poll
+
+
+
+/**
+  \fn uint8_t tb_next_expiry(uint32_t *expire)
+
+  \brief get earliest expiry time of software timers
+
+  \param[out] expire   earliest expiry time [ms]. Current time if a callback is pending
+
+  \return 1 if a timer is running or a callback is pending, else 0
+
+  E.g. for a scheduler which stops TIM4 in Halt mode. Searches all wheel slots.
+*/
+uint8_t tb_next_expiry(uint32_t *expire) {
+
+  tb_timer_t  *timer;
+  uint8_t     slot, found = 0;
+
+  TB_LOCK();
+
+  // expired timer -> callback due now
+  if (s_pending) {
+    *expire = s_millis;
+    found = 1;
+  }
+
+  // search earliest running timer. Counter is constant while ISR is locked
+  else {
+    for (slot=0; slot<TB_WHEEL_SIZE; slot++) {
+      for (timer = s_wheel[slot]; timer != NULL; timer = timer->next) {
+        if ((!found) || ((int32_t) (timer->expire - *expire) < 0))
+          *expire = timer->expire;
+        found = 1;
+      }
+    }
+  }
+
+  TB_UNLOCK();
+
+  return(found);
+
+} // tb_next_expiry
+
+
+
+/**
+  \fn void TIM4_UPD_ISR(void)
+
+  \brief ISR for TIM4 update
+
+  Increase ms counter and mark expired timers in current wheel slot.
+
+  Notes:
+    - for Cosmic compiler, add TIM4_UPD_ISR also to 'stm8_interrupt_vector.c'
+    - IAR compiler has an IRQ offset of +2 compared to STM8 datasheet (see below)
+*/
+#if defined(_IAR_)
+   #pragma vector = 2+__TIM4_UPD_OVF_VECTOR__    // IAR with +2 IRQ offset!
+#endif
+ISR_HANDLER(TIM4_UPD_ISR, __TIM4_UPD_OVF_VECTOR__)
+{
+  tb_timer_t  *timer;
+  uint32_t    ms;
+
+  // reset ISR flag
+  _TIM4_SR &= ~_TIM4_SR_UIF;
+
+  // increase ms counter (use local copy to avoid volatile accesses)
+  ms = s_millis + 1;
+  s_millis = ms;
+
+  // mark expired timers in current slot
+  for (timer = s_wheel[TB_SLOT(ms)]; timer != NULL; timer = timer->next) {
+    if ((int32_t) (ms - timer->expire) >= 0) {
+      timer->flags |= TB_TIMER_EXPIRED;
+      s_pending = 1;
+    }
+  }
+
+} // TIM4_UPD_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,127 @@
+/**
+  \file timebase.h
+
+  \brief declaration of millisecond/microsecond timebase via TIM4
+
+  Timebase with 1ms TIM4 interrupt. Provides atomic reads of the
+  millisecond and microsecond counters, deadlines and software timers.
+  All software timers share the single TIM4 interrupt via a timer wheel.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _TIMEBASE_H_
+#define _TIMEBASE_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stddef.h>     // NULL
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// CPU clock [Hz]. Is set via CLK_CKDIVR in main()
+#if !defined(F_CPU)
+  #define F_CPU             16000000L           ///< CPU frequency [Hz]
+#endif
+
+// TIM4 prescaler: select smallest one with <=256 ticks per ms
+#if (F_CPU/1000L) <= 256
+  #define TB_TIM4_PSC       0                   ///< TIM4 prescaler 2^0
+#elif (F_CPU/2000L) <= 256
+  #define TB_TIM4_PSC       1                   ///< TIM4 prescaler 2^1
+#elif (F_CPU/4000L) <= 256
+  #define TB_TIM4_PSC       2                   ///< TIM4 prescaler 2^2
+#elif (F_CPU/8000L) <= 256
+  #define TB_TIM4_PSC       3                   ///< TIM4 prescaler 2^3
+#elif (F_CPU/16000L) <= 256
+  #define TB_TIM4_PSC       4                   ///< TIM4 prescaler 2^4
+#elif (F_CPU/32000L) <= 256
+  #define TB_TIM4_PSC       5                   ///< TIM4 prescaler 2^5
+#elif (F_CPU/64000L) <= 256
+  #define TB_TIM4_PSC       6                   ///< TIM4 prescaler 2^6
+#else
+  #define TB_TIM4_PSC       7                   ///< TIM4 prescaler 2^7
+#endif
+#define TB_TICKS_PER_MS     (F_CPU/(1000L << TB_TIM4_PSC))  ///< TIM4 ticks per ms (=ARR+1)
+
+// number of timer wheel slots (power of 2). Timers are sorted into slots by expiry time
+#if !defined(TB_WHEEL_SIZE)
+  #define TB_WHEEL_SIZE     8                   ///< number of timer wheel slots
+#endif
+
+// flags of software timer
+#define TB_TIMER_ACTIVE     0x01                ///< timer is running
+#define TB_TIMER_EXPIRED    0x02                ///< timer expired, callback pending
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// callback function of software timer
+typedef void (*tb_callback_t)(void);
+
+/// software timer. Memory is provided by the application
+typedef struct tb_timer_s {
+  struct tb_timer_s  *next;       ///< next timer in same wheel slot
+  uint32_t           expire;      ///< expiry time [ms]
+  uint16_t           period;      ///< period [ms] (0=single shot)
+  tb_callback_t      callback;    ///< function called from tb_poll()
+  volatile uint8_t   flags;       ///< timer state
+} tb_timer_t;
+
+/// deadline for polling timeouts [ms]
+typedef uint32_t  tb_deadline_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+ISR_HANDLER(TIM4_UPD_ISR, __TIM4_UPD_OVF_VECTOR__);
+
+/// init TIM4 for 1ms interrupt. Interrupts must be enabled by application
+void      tb_init(void);
+
+/// get milliseconds since tb_init() (atomic)
+uint32_t  tb_millis(void);
+
+/// get microseconds since tb_init() (atomic)
+uint32_t  tb_micros(void);
+
+/// sleep for some milliseconds (CPU in WAIT mode)
+void      tb_delay_ms(uint16_t ms);
+
+/// advance ms counter by time with TIM4 stopped, e.g. in Active-Halt mode
+void      tb_advance(uint32_t ms);
+
+/// get deadline some milliseconds in the future
+#define   tb_deadline(ms)           (tb_millis() + (uint32_t) (ms))
+
+/// check if deadline has passed (handles counter overflow)
+#define   tb_expired(deadline)      ((int32_t) (tb_millis() - (deadline)) >= 0)
+
+/// start software timer with initial delay and period (0=single shot)
+void      tb_timer_start(tb_timer_t *timer, uint16_t delay, uint16_t period, tb_callback_t callback);
+
+/// stop software timer
+void      tb_timer_stop(tb_timer_t *timer);
+
+/// call callbacks of expired timers. Call periodically from main loop
+void      tb_poll(void);
+
+/// get earliest expiry time of software timers. Return 0 if no timer is running
+uint8_t   tb_next_expiry(uint32_t *expire);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _TIMEBASE_H_
@@ -5,11 +5,27 @@ cd ADC2_Measure          & cmd /c ".\clean.bat" & cd ..
 cd blink_noISR           & cmd /c ".\clean.bat" & cd ..
 cd blink_TIM4_ISR        & cmd /c ".\clean.bat" & cd ..
 cd blink_TIM4_SPL        & cmd /c ".\clean.bat" & cd ..
+cd blink_TIM4_Timebase   & cmd /c ".\clean.bat" & cd ..
+cd CAN_Driver            & cmd /c ".\clean.bat" & cd ..
+cd Clock_Config          & cmd /c ".\clean.bat" & cd ..
+cd EEPROM_KeyValue       & cmd /c ".\clean.bat" & cd ..
+cd EXTI_Dispatch         & cmd /c ".\clean.bat" & cd ..
+cd Fast_Startup          & cmd /c ".\clean.bat" & cd ..
 cd Flash_EEPROM          & cmd /c ".\clean.bat" & cd ..
+cd I2C_Master            & cmd /c ".\clean.bat" & cd ..
+cd Input_Capture         & cmd /c ".\clean.bat" & cd ..
+cd ITC_Priority          & cmd /c ".\clean.bat" & cd ..
+cd LowPower_Scheduler    & cmd /c ".\clean.bat" & cd ..
+cd Profiler              & cmd /c ".\clean.bat" & cd ..
+cd Register_Trace        & cmd /c ".\clean.bat" & cd ..
+cd SPI_Master            & cmd /c ".\clean.bat" & cd ..
+cd TIM1_PWM              & cmd /c ".\clean.bat" & cd ..
 cd TIM2_PWM              & cmd /c ".\clean.bat" & cd ..
 cd UART1_echo            & cmd /c ".\clean.bat" & cd ..
 cd UART1_Gets_Printf     & cmd /c ".\clean.bat" & cd ..
 cd UART2_echo            & cmd /c ".\clean.bat" & cd ..
 cd UART2_Gets_Printf     & cmd /c ".\clean.bat" & cd ..
+cd UART_TIM_Drivers       & cmd /c ".\clean.bat" & cd ..
+cd Watchdog_Supervisor    & cmd /c ".\clean.bat" & cd ..
 
 REM PAUSE test
@@ -10,11 +10,27 @@ cd ADC2_Measure       ; ./clean.sh; cd ..
 cd blink_noISR        ; ./clean.sh; cd ..
 cd blink_TIM4_ISR     ; ./clean.sh; cd ..
 cd blink_TIM4_SPL     ; ./clean.sh; cd ..
+cd blink_TIM4_Timebase; ./clean.sh; cd ..
+cd CAN_Driver         ; ./clean.sh; cd ..
+cd Clock_Config       ; ./clean.sh; cd ..
+cd EEPROM_KeyValue    ; ./clean.sh; cd ..
+cd EXTI_Dispatch      ; ./clean.sh; cd ..
+cd Fast_Startup       ; ./clean.sh; cd ..
 cd Flash_EEPROM       ; ./clean.sh; cd ..
+cd I2C_Master         ; ./clean.sh; cd ..
+cd Input_Capture      ; ./clean.sh; cd ..
+cd ITC_Priority       ; ./clean.sh; cd ..
+cd LowPower_Scheduler ; ./clean.sh; cd ..
+cd Profiler           ; ./clean.sh; cd ..
+cd Register_Trace     ; ./clean.sh; cd ..
+cd SPI_Master         ; ./clean.sh; cd ..
+cd TIM1_PWM           ; ./clean.sh; cd ..
 cd TIM2_PWM           ; ./clean.sh; cd ..
 cd UART1_echo         ; ./clean.sh; cd ..
 cd UART1_Gets_Printf  ; ./clean.sh; cd ..
 cd UART2_echo         ; ./clean.sh; cd ..
 cd UART2_Gets_Printf  ; ./clean.sh; cd ..
+cd UART_TIM_Drivers   ; ./clean.sh; cd ..
+cd Watchdog_Supervisor; ./clean.sh; cd ..
 
 #PAUSE test
@@ -0,0 +1,147 @@
+/**********************
+  Event-driven low-power mode manager for STM8L10x
+  Sample with 1kHz and wake on comparator edges via WFE, i.e. without ISR overhead
+
+  Functionality:
+  - init FCPU to 16MHz
+  - init power manager: TIM2 update events with 1kHz, comparator 1 edge via TIM2 capture
+  - wait for events in WFE mode. Interrupts stay disabled, no ISR is called
+  - on each sample event read comparator output, on each comparator event count edge
+  - every 1000 samples print samples high, edges, time in Run/WFE/Halt [ms],
+    average current [uA] and budget check via UART (115.2kBaud, polled)
+  - after IDLE_SEC seconds without comparator edge, alternate 1s sampling
+    with 1s Active-Halt (AWU)
+
+  Boards:
+  - see main.h
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "pwr.h"
+
+
+/**
+  \fn void uart_send(uint8_t data)
+
+  \brief send byte via USART (polling)
+
+  \param[in]  data   byte to send
+*/
+void uart_send(uint8_t data) {
+
+  while (!(_USART_SR & _USART_SR_TXE));
+  _USART_DR = data;
+
+} // uart_send
+
+
+
+/**
+  \fn void print_u32(uint32_t value, char sep)
+
+  \brief send decimal number and separator via USART
+
+  \param[in]  value   number to send
+  \param[in]  sep     separator after number
+*/
+void print_u32(uint32_t value, char sep) {
+
+  char      buf[10];
+  uint8_t   i = 0;
+
+  do {
+    buf[i++] = '0' + (char) (value % 10);
+    value /= 10;
+  } while (value);
+  while (i)
+    uart_send(buf[--i]);
+  uart_send(sep);
+
+} // print_u32
+
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint16_t  samples = 0, high = 0, edges = 0;
+  uint8_t   idle = 0, ev;
+
+
+  ////
+  // initialization
+  ////
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // init USART for 115.2kBaud, TX only (note: BRR2 must be written before BRR1!)
+  UART_PINS();
+  _CLK_PCKENR |= _CLK_PCKENR1_USART;
+  _USART_BRR2 = 0x0B;
+  _USART_BRR1 = 0x08;
+  _USART_CR2  = _USART_CR2_TEN;
+
+  // init power manager, arm comparator (rising edge) and start 1kHz sampling
+  pwr_init();
+  pwr_comp_arm(COMP_CHANNEL, 1);
+  pwr_sample_enable(1);
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // sleep until sample or comparator event
+    ev = pwr_wait_event();
+
+    // comparator edge
+    if (ev & PWR_EV_COMP)
+      edges++;
+
+    // sample comparator output
+    if (ev & PWR_EV_SAMPLE) {
+      samples++;
+      if (_COMP_CSR & _COMP_CSR_COMP1_OUT)
+        high++;
+    }
+
+    // every 1000 samples print statistics
+    if (samples >= PWR_SAMPLE_HZ) {
+      print_u32(high, ' ');
+      print_u32(edges, ' ');
+      print_u32(pwr_time_ms(PWR_RUN), ' ');
+      print_u32(pwr_time_ms(PWR_WFE), ' ');
+      print_u32(pwr_time_ms(PWR_HALT), ' ');
+      print_u32(pwr_current_avg(), ' ');
+      uart_send(pwr_budget_ok() ? '+' : '-');
+      uart_send('\n');
+      while (!(_USART_SR & _USART_SR_TC));
+
+      // count seconds without comparator edge
+      if (edges)
+        idle = 0;
+      else if (idle < IDLE_SEC)
+        idle++;
+
+      // restart statistics
+      samples = high = edges = 0;
+      pwr_reset_stats();
+
+      // after idle period alternate sampling and Active-Halt. Halt time is in next report
+      if (idle >= IDLE_SEC) {
+        pwr_sample_enable(0);
+        pwr_active_halt();
+        pwr_sample_enable(1);
+      }
+    }
+
+  } // main loop
+
+} // main()
@@ -0,0 +1,24 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8L101F3.h"	// generic STM8L101F3 board
+
+
+/*----------------------------------------------------------
+    DRIVER CONFIGURATION
+----------------------------------------------------------*/
+
+// CPU clock
+#define F_CPU           16000000L
+
+// 1kHz sampling via TIM2 update event
+#define PWR_SAMPLE_HZ   1000L
+
+// comparator 1 input channel (1..4) for wake-up
+#define COMP_CHANNEL    1
+
+// seconds without comparator edge before Active-Halt phases start
+#define IDLE_SEC        5
+
+// board specific pin setup for UART. Only TX is used
+#define UART_PINS()     do { _PORTC_DDR |= _PORT_PIN3; _PORTC_CR1 |= _PORT_PIN3; } while (0)   // TX (PC3) push-pull output
@@ -0,0 +1,441 @@
+/**
+  \file pwr.c
+
+  \brief implementation of low-power mode manager for STM8L10x
+
+  A peripheral generates a wake-up event if its interrupt is enabled in the
+  peripheral and the event is selected in _WFE_CR1/2. Interrupts are disabled
+  in the CPU (reset default), so the event never enters an ISR. As WFE only
+  wakes on new events, a pending flag is checked before entering WFE.
+  WFI and HALT enable interrupts in the CPU by themselves. Before entering
+  them, the TIM2 interrupts are disabled, and interrupts are disabled again
+  in the CPU after wake-up.
+  Time measurement: on each state change, the elapsed TIM3 ticks are added to
+  the previous state. TIM3 stops in Active-Halt, so the nominal AWU period is
+  added instead. Between two state changes, less than 65536 TIM3 ticks must
+  elapse.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "pwr.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if (PWR_ACC_PSCR < 0) || (PWR_ACC_PSCR > 7)
+  #error PWR_ACC_PSCR must be 0..7
+#endif
+
+// TIM2 prescaler for sample events: select smallest one with <=65536 ticks per period
+#define PWR_SAMPLE_TICKS    (F_CPU / PWR_SAMPLE_HZ)
+#if (PWR_SAMPLE_TICKS <= 65536L)
+  #define PWR_SAMPLE_PSCR   0             ///< TIM2 prescaler 2^0
+#elif ((PWR_SAMPLE_TICKS >> 1) <= 65536L)
+  #define PWR_SAMPLE_PSCR   1             ///< TIM2 prescaler 2^1
+#elif ((PWR_SAMPLE_TICKS >> 2) <= 65536L)
+  #define PWR_SAMPLE_PSCR   2             ///< TIM2 prescaler 2^2
+#elif ((PWR_SAMPLE_TICKS >> 3) <= 65536L)
+  #define PWR_SAMPLE_PSCR   3             ///< TIM2 prescaler 2^3
+#elif ((PWR_SAMPLE_TICKS >> 4) <= 65536L)
+  #define PWR_SAMPLE_PSCR   4             ///< TIM2 prescaler 2^4
+#elif ((PWR_SAMPLE_TICKS >> 5) <= 65536L)
+  #define PWR_SAMPLE_PSCR   5             ///< TIM2 prescaler 2^5
+#elif ((PWR_SAMPLE_TICKS >> 6) <= 65536L)
+  #define PWR_SAMPLE_PSCR   6             ///< TIM2 prescaler 2^6
+#elif ((PWR_SAMPLE_TICKS >> 7) <= 65536L)
+  #define PWR_SAMPLE_PSCR   7             ///< TIM2 prescaler 2^7
+#else
+  #error PWR_SAMPLE_HZ too low for F_CPU
+#endif
+#define PWR_SAMPLE_ARR      ((uint16_t) ((PWR_SAMPLE_TICKS >> PWR_SAMPLE_PSCR) - 1))
+
+// TIM2 flags used as wake sources
+#define PWR_TIM2_FLAGS      (_TIM2_SR1_UIF | _TIM2_SR1_CC1IF)
+
+// TIM3 ticks per AWU period
+#define PWR_AWU_TICKS       ((uint32_t) PWR_AWU_MS * PWR_TICKS_PER_MS)
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// typ. supply current per power state [uA]
+static const uint16_t     s_idd[PWR_NUM_STATES] = { PWR_IDD_RUN, PWR_IDD_WFE, PWR_IDD_WFI, PWR_IDD_HALT };
+
+// TIM3 ticks spent per power state
+static uint32_t           s_ticks[PWR_NUM_STATES];
+
+// TIM3 counter at last state change
+static uint16_t           s_last;
+
+// wake-up from Active-Halt via AWU, set in ISR
+static volatile uint8_t   s_awuWake;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn uint16_t pwr_counter(void)
+
+  \brief read TIM3 counter
+
+  \return TIM3 counter value
+
+  Reading the high byte first latches the low byte.
+*/
+static uint16_t pwr_counter(void) {
+
+  uint16_t  cnt;
+
+  cnt = ((uint16_t) _TIM3_CNTRH) << 8;
+  cnt |= _TIM3_CNTRL;
+
+  return(cnt);
+
+} // pwr_counter
+
+
+
+/**
+  \fn void pwr_account(uint8_t state)
+
+  \brief add time since last state change to state
+
+  \param[in]  state   power state which ends now
+*/
+static void pwr_account(uint8_t state) {
+
+  uint16_t  now = pwr_counter();
+
+  s_ticks[state] += (uint16_t) (now - s_last);
+  s_last = now;
+
+} // pwr_account
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void AWU_ISR(void)
+
+  \brief ISR for auto wake-up from Active-Halt
+
+  Reading CSR clears the AWUF flag.
+*/
+ISR_HANDLER(AWU_ISR, __AWU_VECTOR__) {
+
+  // read and clear AWU flag
+  if (_AWU_CSR & _AWU_CSR_AWUF)
+    s_awuWake = 1;
+
+} // AWU_ISR
+
+
+
+/**
+  \fn void pwr_init(void)
+
+  \brief init low-power mode manager
+
+  Enable peripheral clocks, start TIM3 for time measurement, configure TIM2
+  update event with PWR_SAMPLE_HZ (stopped) and AWU period. Only the TIM2
+  update is selected as WFE source. Comparator is disarmed.
+*/
+void pwr_init(void) {
+
+  // enable clocks (gated after reset)
+  _CLK_PCKENR |= _CLK_PCKENR1_TIM2 | _CLK_PCKENR1_TIM3 | _CLK_PCKENR1_AWU_BEEP;
+
+  // TIM3: free-running counter for time measurement. UG loads prescaler
+  _TIM3_CR1  = 0x00;
+  _TIM3_PSCR = PWR_ACC_PSCR;
+  _TIM3_EGR  = _TIM3_EGR_UG;
+  _TIM3_CR1  = _TIM3_CR1_CEN;
+
+  // TIM2: update event with sample rate, stopped. UG loads prescaler and sets UIF
+  _TIM2_CR1  = 0x00;
+  _TIM2_IER  = 0x00;
+  _TIM2_PSCR = PWR_SAMPLE_PSCR;
+  _TIM2_ARRH = (uint8_t) (PWR_SAMPLE_ARR >> 8);
+  _TIM2_ARRL = (uint8_t) PWR_SAMPLE_ARR;
+  _TIM2_EGR  = _TIM2_EGR_UG;
+  _TIM2_SR1  = 0x00;
+  _TIM2_IER  = _TIM2_IER_UIE;
+
+  // select TIM2 update as only wake event (reset: both TIM2 events)
+  _WFE_CR1 = _WFE_CR1_TIM2_EV0;
+  _WFE_CR2 = 0x00;
+
+  // comparator off
+  pwr_comp_disarm();
+
+  // AWU period for Active-Halt. Is enabled only in pwr_active_halt()
+  _AWU_CSR = 0x00;
+  _AWU_APR = PWR_AWU_APR - 2;            // APR field is APRDIV-2
+  _AWU_TBR = PWR_AWU_TBR;
+
+  // start measurement in Run mode
+  pwr_reset_stats();
+
+} // pwr_init
+
+
+
+/**
+  \fn void pwr_sample_enable(uint8_t enable)
+
+  \brief start or stop periodic sample events
+
+  \param[in]  enable   start (!=0) or stop (0) TIM2
+
+  On start, the first event occurs after one sample period.
+*/
+void pwr_sample_enable(uint8_t enable) {
+
+  if (enable) {
+    _TIM2_CNTRH = 0x00;
+    _TIM2_CNTRL = 0x00;
+    _TIM2_SR1   = (uint8_t) ~_TIM2_SR1_UIF;
+    _TIM2_CR1   = _TIM2_CR1_CEN;
+  }
+  else
+    _TIM2_CR1 = 0x00;
+
+} // pwr_sample_enable
+
+
+
+/**
+  \fn void pwr_comp_arm(uint8_t channel, uint8_t rising)
+
+  \brief arm comparator 1 as wake source
+
+  \param[in]  channel   comparator 1 input channel (1..4)
+  \param[in]  rising    event on rising (!=0) or falling (0) edge
+
+  Comparator 1 compares the input channel with the internal reference. Its
+  output is routed to TIM2 input capture 1, and the capture event is
+  selected as WFE source. TIM2 must be clocked, see pwr_init().
+*/
+void pwr_comp_arm(uint8_t channel, uint8_t rising) {
+
+  // comparator 1 on selected channel with internal reference, no COMP interrupt. Output to TIM2 IC1
+  _COMP_CSR = 0x00;
+  _COMP_CCS = (uint8_t) (_COMP_CCS_COMP1_CH1 << ((channel - 1) & 0x03));
+  _COMP_CR  = _COMP_CR_BIAS_EN | _COMP_CR_COMP1_EN | _COMP_CR_CNF_TIM0;
+
+  // TIM2 channel 1: input capture on TI1. CC1P selects falling edge
+  _TIM2_CCER1 &= (uint8_t) ~(_TIM2_CCER1_CC1E | _TIM2_CCER1_CC1P);
+  _TIM2_CCMR1  = _TIM2_CCMR1_CC1S0;
+  _TIM2_CCER1 |= (rising) ? _TIM2_CCER1_CC1E : (_TIM2_CCER1_CC1E | _TIM2_CCER1_CC1P);
+
+  // enable capture event
+  _TIM2_SR1  = (uint8_t) ~_TIM2_SR1_CC1IF;
+  _TIM2_IER |= _TIM2_IER_CC1IE;
+  _WFE_CR1  |= _WFE_CR1_TIM2_EV1;
+
+} // pwr_comp_arm
+
+
+
+/**
+  \fn void pwr_comp_disarm(void)
+
+  \brief disarm and power down comparator
+*/
+void pwr_comp_disarm(void) {
+
+  _WFE_CR1    &= (uint8_t) ~_WFE_CR1_TIM2_EV1;
+  _TIM2_IER   &= (uint8_t) ~_TIM2_IER_CC1IE;
+  _TIM2_CCER1 &= (uint8_t) ~_TIM2_CCER1_CC1E;
+  _TIM2_SR1    = (uint8_t) ~_TIM2_SR1_CC1IF;
+  _COMP_CR     = 0x00;
+  _COMP_CCS    = 0x00;
+
+} // pwr_comp_disarm
+
+
+
+/**
+  \fn uint8_t pwr_wait_event(void)
+
+  \brief wait for event
+
+  \return wake sources (PWR_EV_SAMPLE | PWR_EV_COMP), 0 if woken by other event
+
+  If an armed event is already pending, return immediately. Else enter WFE.
+  The pending flags are cleared.
+*/
+uint8_t pwr_wait_event(void) {
+
+  uint8_t   sr, ev = 0;
+
+  pwr_account(PWR_RUN);
+
+  // WFE only wakes on a new event -> skip if already pending
+  sr = _TIM2_SR1 & PWR_TIM2_FLAGS;
+  if (!sr) {
+    WAIT_FOR_EVENT();
+    sr = _TIM2_SR1 & PWR_TIM2_FLAGS;
+  }
+  pwr_account(PWR_WFE);
+
+  // clear flags (rc_w0, writing 1 has no effect)
+  _TIM2_SR1 = (uint8_t) ~sr;
+
+  if (sr & _TIM2_SR1_UIF)
+    ev |= PWR_EV_SAMPLE;
+  if (sr & _TIM2_SR1_CC1IF)
+    ev |= PWR_EV_COMP;
+
+  return(ev);
+
+} // pwr_wait_event
+
+
+
+/**
+  \fn void pwr_wait_interrupt(void)
+
+  \brief wait for interrupt
+
+  WFI enables interrupts in the CPU. TIM2 events are masked meanwhile, and
+  interrupts are disabled again after wake-up.
+*/
+void pwr_wait_interrupt(void) {
+
+  uint8_t   ier = _TIM2_IER;
+
+  pwr_account(PWR_RUN);
+  _TIM2_IER = 0x00;
+  WAIT_FOR_INTERRUPT();
+  DISABLE_INTERRUPTS();
+  _TIM2_IER = ier;
+  pwr_account(PWR_WFI);
+
+} // pwr_wait_interrupt
+
+
+
+/**
+  \fn void pwr_active_halt(void)
+
+  \brief enter Active-Halt until AWU or external interrupt
+
+  HALT enables interrupts in the CPU. TIM2 events are masked meanwhile, and
+  interrupts are disabled again after wake-up. TIM3 stops in Halt, so the
+  nominal AWU period is added to the time in Halt. After wake-up by another
+  interrupt the time in Halt is unknown and not added, i.e. the average
+  current is rather overestimated.
+*/
+void pwr_active_halt(void) {
+
+  uint8_t   ier = _TIM2_IER;
+
+  pwr_account(PWR_RUN);
+  _TIM2_IER = 0x00;
+  s_awuWake = 0;
+  _AWU_CSR  = _AWU_CSR_AWUEN;
+  ENTER_HALT();
+  DISABLE_INTERRUPTS();
+  _AWU_CSR  = 0x00;
+  _TIM2_IER = ier;
+  if (s_awuWake)
+    s_ticks[PWR_HALT] += PWR_AWU_TICKS;
+  pwr_account(PWR_RUN);
+
+} // pwr_active_halt
+
+
+
+/**
+  \fn uint32_t pwr_time_ms(uint8_t state)
+
+  \brief get time spent in power state
+
+  \param[in]  state   power state (PWR_RUN..PWR_HALT)
+
+  \return time [ms] since last reset of statistics
+*/
+uint32_t pwr_time_ms(uint8_t state) {
+
+  pwr_account(PWR_RUN);
+
+  return(s_ticks[state] / PWR_TICKS_PER_MS);
+
+} // pwr_time_ms
+
+
+
+/**
+  \fn uint16_t pwr_current_avg(void)
+
+  \brief get average supply current
+
+  \return average current [uA] since last reset of statistics
+
+  The current is weighted with the time in each state. To avoid overflow of
+  the charge [uA*ms], reset statistics at least every 20min.
+*/
+uint16_t pwr_current_avg(void) {
+
+  uint32_t  charge = 0, total = 0, ms;
+  uint8_t   state;
+
+  for (state = 0; state < PWR_NUM_STATES; state++) {
+    ms = pwr_time_ms(state);
+    charge += ms * s_idd[state];
+    total  += ms;
+  }
+  if (total == 0)
+    return(0);
+
+  return((uint16_t) (charge / total));
+
+} // pwr_current_avg
+
+
+
+/**
+  \fn uint8_t pwr_budget_ok(void)
+
+  \brief check average supply current against budget
+
+  \return 1 if average current <= PWR_BUDGET_UA, else 0
+*/
+uint8_t pwr_budget_ok(void) {
+
+  return(pwr_current_avg() <= PWR_BUDGET_UA);
+
+} // pwr_budget_ok
+
+
+
+/**
+  \fn void pwr_reset_stats(void)
+
+  \brief reset time statistics of all power states
+*/
+void pwr_reset_stats(void) {
+
+  uint8_t   state;
+
+  for (state = 0; state < PWR_NUM_STATES; state++)
+    s_ticks[state] = 0;
+  s_last = pwr_counter();
+
+} // pwr_reset_stats
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
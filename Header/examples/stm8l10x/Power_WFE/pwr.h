@@ -0,0 +1,146 @@
+/**
+  \file pwr.h
+
+  \brief declaration of low-power mode manager for STM8L10x
+
+  Event-driven power manager using WFE instead of WFI. In WFE mode the CPU
+  resumes directly after the WFE instruction when an event configured in
+  _WFE_CR1/2 occurs, i.e. without ISR entry/exit and context save. Pending
+  flags of the event sources are polled and cleared by pwr_wait_event().
+  Wake sources:
+    - TIM2 update with PWR_SAMPLE_HZ (periodic sampling)
+    - comparator 1, routed to TIM2 input capture 1
+    - AWU for long idle phases in Active-Halt mode (via ISR, as Halt requires an interrupt)
+  Time spent in each power state is measured with the free-running TIM3 and
+  weighted with a per-state current table to calculate the average supply
+  current, which is compared to a budget.
+  Note: TIM2 interrupts must not be enabled via rim() while events are armed,
+  else the event sources are served as interrupts. TIM2 and TIM3 are reserved.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _PWR_H_
+#define _PWR_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// CPU clock [Hz]. Is set via CLK_CKDIVR in main()
+#if !defined(F_CPU)
+  #define F_CPU             16000000L     ///< CPU frequency [Hz]
+#endif
+
+// rate of TIM2 update events for sampling [Hz]
+#if !defined(PWR_SAMPLE_HZ)
+  #define PWR_SAMPLE_HZ     1000L         ///< sample events per second
+#endif
+
+// TIM3 clock for time measurement = F_CPU / 2^PWR_ACC_PSCR (0..7). TIM3 wraps after 65536 ticks, i.e. 524ms at 16MHz
+#if !defined(PWR_ACC_PSCR)
+  #define PWR_ACC_PSCR      7             ///< TIM3 prescaler exponent
+#endif
+
+// AWU period in Active-Halt = 2^(PWR_AWU_TBR-1) * PWR_AWU_APR / fLSI. Default ~1s with nominal 38kHz LSI
+#if !defined(PWR_AWU_APR)
+  #define PWR_AWU_APR       38            ///< AWU asynchronous prescaler (2..64)
+#endif
+#if !defined(PWR_AWU_TBR)
+  #define PWR_AWU_TBR       11            ///< AWU timebase selection (1..12)
+#endif
+#if !defined(PWR_AWU_MS)
+  #define PWR_AWU_MS        1024L         ///< nominal AWU period [ms] for time measurement
+#endif
+#if (PWR_AWU_APR < 2) || (PWR_AWU_APR > 64)
+  #error PWR_AWU_APR must be 2..64
+#endif
+#if (PWR_AWU_TBR < 1) || (PWR_AWU_TBR > 12)
+  #error PWR_AWU_TBR must be 1..12
+#endif
+
+// typ. supply current per state [uA] at 16MHz, 3V. Adapt to measurement on own board
+#if !defined(PWR_IDD_RUN)
+  #define PWR_IDD_RUN       2400          ///< Run mode, code from flash
+#endif
+#if !defined(PWR_IDD_WFE)
+  #define PWR_IDD_WFE       900           ///< Wait for event, TIM2 and COMP active
+#endif
+#if !defined(PWR_IDD_WFI)
+  #define PWR_IDD_WFI       900           ///< Wait for interrupt
+#endif
+#if !defined(PWR_IDD_HALT)
+  #define PWR_IDD_HALT      1             ///< Active-Halt with AWU (LSI)
+#endif
+
+// allowed average supply current [uA]
+#if !defined(PWR_BUDGET_UA)
+  #define PWR_BUDGET_UA     1500          ///< average current budget
+#endif
+
+/// TIM3 ticks per ms for time measurement
+#define PWR_TICKS_PER_MS    ((F_CPU / 1000L) >> PWR_ACC_PSCR)
+
+// power states, index in current table
+#define PWR_RUN             0             ///< CPU running
+#define PWR_WFE             1             ///< wait for event
+#define PWR_WFI             2             ///< wait for interrupt
+#define PWR_HALT            3             ///< Active-Halt with AWU
+#define PWR_NUM_STATES      4             ///< number of power states
+
+// wake sources returned by pwr_wait_event()
+#define PWR_EV_SAMPLE       0x01          ///< TIM2 update (sample period)
+#define PWR_EV_COMP         0x02          ///< comparator 1 edge
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+ISR_HANDLER(AWU_ISR, __AWU_VECTOR__);
+
+/// init TIM2 sample events, TIM3 time measurement and AWU. Sampling is stopped
+void      pwr_init(void);
+
+/// start (!=0) or stop (0) periodic TIM2 sample events
+void      pwr_sample_enable(uint8_t enable);
+
+/// arm comparator 1 on input channel 1..4 as wake source. Event on rising (!=0) or falling (0) edge
+void      pwr_comp_arm(uint8_t channel, uint8_t rising);
+
+/// disarm and power down comparator
+void      pwr_comp_disarm(void);
+
+/// enter WFE until an armed event occurs. Return PWR_EV_* flags of the wake sources
+uint8_t   pwr_wait_event(void);
+
+/// enter WFI until next interrupt
+void      pwr_wait_interrupt(void);
+
+/// enter Active-Halt until AWU or external interrupt
+void      pwr_active_halt(void);
+
+/// get time spent in power state [ms] since last reset of statistics
+uint32_t  pwr_time_ms(uint8_t state);
+
+/// get average supply current [uA] since last reset of statistics
+uint16_t  pwr_current_avg(void);
+
+/// check average supply current against PWR_BUDGET_UA. Return 1 if within budget
+uint8_t   pwr_budget_ok(void);
+
+/// reset time statistics of all power states
+void      pwr_reset_stats(void);
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _PWR_H_
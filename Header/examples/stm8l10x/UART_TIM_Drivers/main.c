@@ -0,0 +1,106 @@
+/**********************
+  Family independent UART, timebase and PWM drivers
+  Demonstrate shared drivers in folder 'common' on STM8AF/S, STM8L10x and STM8TL5x
+
+  Functionality:
+  - init FCPU to 16MHz
+  - init interrupt-driven UART, 1ms TIM4 timebase and TIM2 PWM (channels 1+2)
+  - echo received characters via UART
+  - fade PWM channel 1 up and channel 2 down with 1s period
+  - print uptime [s] every second via UART
+  - the same main.c is used for all families, only main.h differs
+
+  Boards:
+  - see main.h
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "uart.h"
+#include "tick.h"
+#include "pwm.h"
+
+
+/**
+  \fn void print_u32(uint32_t value)
+
+  \brief send decimal number via UART
+
+  \param[in]  value   number to send
+*/
+void print_u32(uint32_t value) {
+
+  char      buf[10];
+  uint8_t   i = 0;
+
+  do {
+    buf[i++] = '0' + (char) (value % 10);
+    value /= 10;
+  } while (value);
+  while (i)
+    uart_write(buf[--i]);
+
+} // print_u32
+
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint32_t  last = 0;
+  uint16_t  duty = 0;
+  uint8_t   data;
+
+
+  ////
+  // initialization
+  ////
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // init drivers
+  UART_PINS();
+  uart_init();
+  tick_init();
+  pwm_init();
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    // echo received characters
+    while (uart_read(&data))
+      uart_write(data);
+
+    // every 10ms step PWM duty, 100 steps per second
+    if ((tick_millis() - last) >= 10) {
+      last += 10;
+      duty += PWM_PERIOD / 100;
+      if (duty > PWM_PERIOD)
+        duty = 0;
+      PWM_SET1(duty);
+      pwm_set(2, PWM_PERIOD - duty);
+
+      // every 1s print uptime
+      if ((last % 1000) == 0) {
+        print_u32(last / 1000);
+        uart_write('\n');
+      }
+    }
+
+    // sleep until next interrupt
+    WAIT_FOR_INTERRUPT();
+
+  } // main loop
+
+} // main()
@@ -0,0 +1,19 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8L101F3.h"	// generic STM8L101F3 board
+
+
+/*----------------------------------------------------------
+    DRIVER CONFIGURATION
+----------------------------------------------------------*/
+
+// CPU clock
+#define F_CPU           16000000L
+
+// UART 115.2kBaud, PWM 1kHz
+#define UART_BAUD       115200L
+#define PWM_FREQ        1000L
+
+// board specific pin setup for UART
+#define UART_PINS()     do { _PORTC_DDR |= _PORT_PIN3; _PORTC_CR1 |= (_PORT_PIN3 | _PORT_PIN2); } while (0)   // TX (PC3) push-pull output, RX (PC2) pull-up
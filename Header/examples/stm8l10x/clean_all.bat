@@ -0,0 +1,6 @@
+REM clean all sub-projects
+
+cd Power_WFE              & cmd /c ".\clean.bat" & cd ..
+cd UART_TIM_Drivers       & cmd /c ".\clean.bat" & cd ..
+
+REM PAUSE test
@@ -0,0 +1,118 @@
+/**********************
+  ProxSense touch keys for STM8TL5x
+  Interrupt-driven multi-slot PXS acquisition with baseline tracking and debouncing
+
+  Functionality:
+  - init FCPU to 16MHz
+  - init UART, 1ms TIM4 timebase and PXS touch engine
+  - scan 12 keys (2 TX x 6 RX) every 5ms. Slots are chained in the PXS EOC interrupt
+  - on change of the touched keys print bit mask (hex) via UART
+  - after 10s without touch switch to low-power scan of slot 0 every 100ms,
+    return to normal scan on touch
+  - sleep in WAIT mode between interrupts
+
+  Boards:
+  - see main.h
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main.h"
+#include "uart.h"
+#include "tick.h"
+#include "pxs.h"
+
+
+/**
+  \fn void print_hex(uint16_t value)
+
+  \brief send 16-bit number in hex via UART
+
+  \param[in]  value   number to send
+*/
+void print_hex(uint16_t value) {
+
+  uint8_t   i, digit;
+
+  for (i = 0; i < 4; i++) {
+    digit = (uint8_t) (value >> 12);
+    uart_write((digit < 10) ? ('0' + digit) : ('A' - 10 + digit));
+    value <<= 4;
+  }
+
+} // print_hex
+
+
+
+////////
+// main routine
+////////
+void main(void) {
+
+  uint32_t  lastScan = 0, lastTouch = 0, now;
+  uint16_t  keys, keysOld = 0;
+  uint8_t   lowPower = 0;
+
+
+  ////
+  // initialization
+  ////
+
+  // switch to 16MHz clock (reset is 2MHz)
+  _CLK_CKDIVR = 0x00;
+
+  // init drivers
+  UART_PINS();
+  uart_init();
+  tick_init();
+  pxs_init();
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+
+  ////
+  // main loop
+  ////
+  while (1) {
+
+    now = tick_millis();
+
+    // start scan with period of current mode
+    if ((now - lastScan) >= ((lowPower) ? SCAN_LP_MS : SCAN_MS)) {
+      lastScan = now;
+      pxs_start();
+    }
+
+    // evaluate scan
+    if (pxs_done()) {
+      keys = pxs_process();
+
+      // print touched keys on change
+      if (keys != keysOld) {
+        keysOld = keys;
+        print_hex(keys);
+        uart_write('\n');
+      }
+
+      // on touch return to normal scan. Switch to low-power after timeout
+      if (keys) {
+        lastTouch = now;
+        if (lowPower) {
+          lowPower = 0;
+          pxs_set_lowpower(0);
+        }
+      }
+      else if ((!lowPower) && ((now - lastTouch) >= LP_TIMEOUT_MS)) {
+        lowPower = 1;
+        pxs_set_lowpower(1);
+      }
+    }
+
+    // sleep until next interrupt
+    WAIT_FOR_INTERRUPT();
+
+  } // main loop
+
+} // main()
@@ -0,0 +1,40 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8TL52F4.h"	// generic STM8TL52F4 board
+
+
+/*----------------------------------------------------------
+    DRIVER CONFIGURATION
+----------------------------------------------------------*/
+
+// CPU clock
+#define F_CPU           16000000L
+
+// UART 115.2kBaud
+#define UART_BAUD       115200L
+
+// board specific pin setup for UART. Only TX is used. Can be overridden via DEFINES in Makefile
+#if !defined(UART_PINS)
+  #define UART_PINS()   do { _PORTD_DDR |= _PORT_PIN5; _PORTD_CR1 |= _PORT_PIN5; } while (0)   // TX (PD5) push-pull output
+#endif
+
+// scan period [ms] in normal and low-power mode. Switch to low-power after timeout [ms] without touch
+#define SCAN_MS         5
+#define SCAN_LP_MS      100
+#define LP_TIMEOUT_MS   10000
+
+
+/*----------------------------------------------------------
+    TOUCH CONFIGURATION
+----------------------------------------------------------*/
+
+// conversion slots X(TX mask, RX mask). Slot 0 is also used for low-power scan
+#define PXS_SLOT_TABLE(X) \
+  X(0x0001, 0x003F)     /* TX0, RX0..5 */ \
+  X(0x0002, 0x003F)     /* TX1, RX0..5 */
+
+// keys X(slot, receiver, touch threshold [counts]). 2 TX x 6 RX matrix
+#define PXS_KEY_TABLE(X) \
+  X(0, 0, 40)   X(0, 1, 40)   X(0, 2, 40)   X(0, 3, 40)   X(0, 4, 40)   X(0, 5, 40) \
+  X(1, 0, 40)   X(1, 1, 40)   X(1, 2, 40)   X(1, 3, 40)   X(1, 4, 40)   X(1, 5, 40)
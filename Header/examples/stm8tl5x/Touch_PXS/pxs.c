@@ -0,0 +1,367 @@
+/**
+  \file pxs.c
+
+  \brief implementation of ProxSense (PXS) touch acquisition engine for STM8TL5x
+
+  A touch increases the electrode capacitance, i.e. decreases the number of
+  charge transfers until the threshold voltage is reached. The signal of a key
+  is therefore delta = baseline - raw.
+  The EOC ISR stores the counters of the current slot and starts the next
+  slot, so a scan needs no CPU time between conversions. The baseline is
+  stored with 8 fractional bits. Without touch it follows lower counts with
+  time constant 2^PXS_BASE_SHIFT scans and higher counts immediately. While
+  a key is touched or a touch is being debounced, the baseline is frozen.
+  Call pxs_process() before starting the next scan, as the ISR overwrites the
+  raw values.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "pxs.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check configuration
+#if (PXS_NUM_SLOTS < 1) || (PXS_NUM_KEYS < 1) || (PXS_NUM_KEYS > 16)
+  #error PXS_SLOT_TABLE needs >=1 slot and PXS_KEY_TABLE 1..16 keys
+#endif
+#if (PXS_LP_SLOTS < 1) || (PXS_LP_SLOTS > PXS_NUM_SLOTS)
+  #error PXS_LP_SLOTS must be 1..number of slots
+#endif
+#if (PXS_MAX_COUNT < 1) || (PXS_MAX_COUNT > 0xFFFF)
+  #error PXS_MAX_COUNT must be 1..65535
+#endif
+#define _PXS_CHECK(s,r,t)   || ((s) >= PXS_NUM_SLOTS) || ((r) > 9)
+#if (0 PXS_KEY_TABLE(_PXS_CHECK))
+  #error PXS_KEY_TABLE: slot or receiver out of range
+#endif
+
+// extract columns of tables
+#define _PXS_TX(tx,rx)      (uint16_t) (tx),
+#define _PXS_RX(tx,rx)      (uint16_t) (rx),
+#define _PXS_SLOT(s,r,t)    (uint8_t) (s),
+#define _PXS_RXNUM(s,r,t)   (uint8_t) (r),
+#define _PXS_THR(s,r,t)     (uint16_t) (t),
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// TX and RX enable mask per slot
+static const uint16_t     s_slotTx[PXS_NUM_SLOTS] = { PXS_SLOT_TABLE(_PXS_TX) };
+static const uint16_t     s_slotRx[PXS_NUM_SLOTS] = { PXS_SLOT_TABLE(_PXS_RX) };
+
+// slot, receiver and touch threshold per key
+static const uint8_t      s_keySlot[PXS_NUM_KEYS] = { PXS_KEY_TABLE(_PXS_SLOT) };
+static const uint8_t      s_keyRx[PXS_NUM_KEYS]   = { PXS_KEY_TABLE(_PXS_RXNUM) };
+static const uint16_t     s_keyThr[PXS_NUM_KEYS]  = { PXS_KEY_TABLE(_PXS_THR) };
+
+// raw counter values, written by ISR
+static volatile uint16_t  s_raw[PXS_NUM_KEYS];
+
+// baseline with 8 fractional bits (0 = not initialized), debounce counter and touch state per key
+static uint32_t           s_base[PXS_NUM_KEYS];
+static uint8_t            s_debounce[PXS_NUM_KEYS];
+static uint16_t           s_touched;
+
+// scan state. Slot and number of slots are written by pxs_start() only while no scan is active
+static volatile uint8_t   s_slot;
+static volatile uint8_t   s_numSlots;
+static volatile uint8_t   s_busy;
+static volatile uint8_t   s_done;
+static uint8_t            s_lowPower;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void pxs_convert(uint8_t slot)
+
+  \brief start conversion of slot
+
+  \param[in]  slot   index in PXS_SLOT_TABLE
+*/
+static void pxs_convert(uint8_t slot) {
+
+  uint16_t  tx = s_slotTx[slot];
+  uint16_t  rx = s_slotRx[slot];
+
+  _PXS_TXENRH  = (uint8_t) (tx >> 8);
+  _PXS_TXENRL  = (uint8_t) tx;
+  _PXS_RXENRH  = (uint8_t) (rx >> 8);
+  _PXS_RXENRL  = (uint8_t) rx;
+  _PXS_MAXENRH = (uint8_t) (rx >> 8);
+  _PXS_MAXENRL = (uint8_t) rx;
+  _PXS_CR1     = _PXS_CR1_PXSEN | _PXS_CR1_START | ((s_lowPower) ? _PXS_CR1_LOW_POWER : 0);
+
+} // pxs_convert
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void PXS_ISR(void)
+
+  \brief ISR for PXS end of conversion
+
+  Store counters of keys in current slot and start next slot. Receivers
+  without valid data (counter limit reached) are saturated to PXS_MAX_COUNT.
+*/
+ISR_HANDLER(PXS_ISR, __PXS_VECTOR__) {
+
+  uint8_t            slot = s_slot;
+  uint8_t            key, rx;
+  uint16_t           valid;
+  volatile uint8_t   *cnt;
+
+  // clear flag and get valid receivers
+  _PXS_ISR = (uint8_t) ~_PXS_ISR_EOCF;
+  valid = ((uint16_t) _PXS_RXSRH << 8) | _PXS_RXSRL;
+
+  // store counters of keys in this slot. Counter registers are 2B apart
+  for (key = 0; key < PXS_NUM_KEYS; key++) {
+    if (s_keySlot[key] != slot)
+      continue;
+    rx = s_keyRx[key];
+    if (valid & ((uint16_t) 1 << rx)) {
+      cnt = &_PXS_RX0CNTRH + (rx << 1);
+      s_raw[key] = ((uint16_t) cnt[0] << 8) | cnt[1];
+    }
+    else
+      s_raw[key] = PXS_MAX_COUNT;
+  }
+
+  // start next slot or end scan
+  if (++slot < s_numSlots)
+    pxs_convert(slot);
+  else {
+    s_busy = 0;
+    s_done = 1;
+  }
+  s_slot = slot;
+
+} // PXS_ISR
+
+
+
+/**
+  \fn void pxs_init(void)
+
+  \brief init PXS and key states
+
+  Enable PXS with EOC interrupt and counter limit. Clock, conversion and
+  capacitor settings keep their reset values. Baselines are initialized
+  with the first scan.
+*/
+void pxs_init(void) {
+
+  uint8_t   key;
+
+  // enable clock (gated after reset)
+  _CLK_PCKENR1 |= _CLK_PCKENR1_PXS;
+
+  // counter limit, EOC interrupt, enable PXS
+  _PXS_CR1   = 0x00;
+  _PXS_MAXRH = (uint8_t) (PXS_MAX_COUNT >> 8);
+  _PXS_MAXRL = (uint8_t) PXS_MAX_COUNT;
+  _PXS_CR2   = _PXS_CR2_EOCITEN;
+  _PXS_ISR   = 0x00;
+  _PXS_CR1   = _PXS_CR1_PXSEN;
+
+  // reset key states
+  for (key = 0; key < PXS_NUM_KEYS; key++) {
+    s_base[key] = 0;
+    s_debounce[key] = 0;
+  }
+  s_touched  = 0;
+  s_busy     = 0;
+  s_done     = 0;
+  s_lowPower = 0;
+
+} // pxs_init
+
+
+
+/**
+  \fn void pxs_set_lowpower(uint8_t enable)
+
+  \brief select normal or low-power scan
+
+  \param[in]  enable   normal (0) or low-power (!=0) scan
+
+  Takes effect with the next pxs_start(). Keys which are not converted in
+  low-power scan are released.
+*/
+void pxs_set_lowpower(uint8_t enable) {
+
+  uint8_t   key;
+
+  s_lowPower = enable;
+  if (enable) {
+    for (key = 0; key < PXS_NUM_KEYS; key++) {
+      if (s_keySlot[key] >= PXS_LP_SLOTS) {
+        s_touched &= (uint16_t) ~((uint16_t) 1 << key);
+        s_debounce[key] = 0;
+      }
+    }
+  }
+
+} // pxs_set_lowpower
+
+
+
+/**
+  \fn void pxs_start(void)
+
+  \brief start scan
+
+  Start conversion of first slot. Further slots are started by the ISR.
+  Ignored if a scan is in progress.
+*/
+void pxs_start(void) {
+
+  if (s_busy)
+    return;
+
+  s_numSlots = (s_lowPower) ? PXS_LP_SLOTS : PXS_NUM_SLOTS;
+  s_slot = 0;
+  s_done = 0;
+  s_busy = 1;
+  pxs_convert(0);
+
+} // pxs_start
+
+
+
+/**
+  \fn uint8_t pxs_done(void)
+
+  \brief check if last scan is complete
+
+  \return 1 if a scan is complete and not yet processed, else 0
+*/
+uint8_t pxs_done(void) {
+
+  return(s_done);
+
+} // pxs_done
+
+
+
+/**
+  \fn uint16_t pxs_process(void)
+
+  \brief evaluate completed scan
+
+  \return bit mask of touched keys (bit n = key n)
+
+  Update baselines and touch states of the keys converted in the last scan.
+  If no new scan is complete, return the current touch state.
+*/
+uint16_t pxs_process(void) {
+
+  uint8_t   key;
+  uint16_t  mask, raw, base, thr;
+  int32_t   delta;
+
+  if (!s_done)
+    return(s_touched);
+  s_done = 0;
+
+  for (key = 0, mask = 1; key < PXS_NUM_KEYS; key++, mask <<= 1) {
+
+    // key not converted in low-power scan
+    if (s_keySlot[key] >= s_numSlots)
+      continue;
+
+    // first scan: init baseline
+    raw = s_raw[key];
+    if (s_base[key] == 0) {
+      s_base[key] = (uint32_t) raw << 8;
+      continue;
+    }
+    base  = (uint16_t) (s_base[key] >> 8);
+    delta = (int32_t) base - (int32_t) raw;
+    thr   = s_keyThr[key];
+
+    // touched: release after PXS_DEBOUNCE scans below release threshold
+    if (s_touched & mask) {
+      if (delta < (int32_t) (thr - (thr >> PXS_HYST_SHIFT))) {
+        if (++s_debounce[key] >= PXS_DEBOUNCE) {
+          s_touched &= ~mask;
+          s_debounce[key] = 0;
+        }
+      }
+      else
+        s_debounce[key] = 0;
+    }
+
+    // not touched: touch after PXS_DEBOUNCE scans above threshold
+    else if (delta >= (int32_t) thr) {
+      if (++s_debounce[key] >= PXS_DEBOUNCE) {
+        s_touched |= mask;
+        s_debounce[key] = 0;
+      }
+    }
+
+    // no touch: update baseline. Higher counts immediately, lower counts via IIR
+    else {
+      s_debounce[key] = 0;
+      if (raw >= base)
+        s_base[key] = (uint32_t) raw << 8;
+      else
+        s_base[key] -= (s_base[key] - ((uint32_t) raw << 8)) >> PXS_BASE_SHIFT;
+    }
+
+  } // loop keys
+
+  return(s_touched);
+
+} // pxs_process
+
+
+
+/**
+  \fn uint16_t pxs_raw(uint8_t key)
+
+  \brief get last raw counter value of key
+
+  \param[in]  key   index in PXS_KEY_TABLE
+
+  \return counter value of last conversion
+*/
+uint16_t pxs_raw(uint8_t key) {
+
+  return(s_raw[key]);
+
+} // pxs_raw
+
+
+
+/**
+  \fn uint16_t pxs_baseline(uint8_t key)
+
+  \brief get baseline of key
+
+  \param[in]  key   index in PXS_KEY_TABLE
+
+  \return integer part of baseline
+*/
+uint16_t pxs_baseline(uint8_t key) {
+
+  return((uint16_t) (s_base[key] >> 8));
+
+} // pxs_baseline
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,107 @@
+/**
+  \file pxs.h
+
+  \brief declaration of ProxSense (PXS) touch acquisition engine for STM8TL5x
+
+  Open acquisition engine for the PXS peripheral. A scan consists of several
+  conversion slots, given as compile-time table PXS_SLOT_TABLE(X) in main.h,
+  which lists X(txMask, rxMask) per slot. In each slot, the enabled receivers
+  are converted in parallel. For self-capacitance keys txMask is 0, for mutual
+  (TX x RX) keys one TX line is enabled per slot, e.g. 2 TX x 6 RX = 12 keys.
+  The keys are given as table PXS_KEY_TABLE(X) in main.h with X(slot, rx, threshold).
+  The slots of a scan are chained in the EOC interrupt. After the scan,
+  pxs_process() updates an IIR baseline per key in fixed-point and detects
+  touches with hysteresis and debouncing.
+  Low-power scan: only the first PXS_LP_SLOTS slots are converted with
+  LOW_POWER set, e.g. a single wake-up key or all RX lines in parallel.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _PXS_H_
+#define _PXS_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "main.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// tables must be defined in main.h
+#if !defined(PXS_SLOT_TABLE) || !defined(PXS_KEY_TABLE)
+  #error PXS_SLOT_TABLE and PXS_KEY_TABLE must be defined in main.h
+#endif
+
+// max. conversion counter. Conversions exceeding it are saturated
+#if !defined(PXS_MAX_COUNT)
+  #define PXS_MAX_COUNT     4000          ///< PXS counter limit
+#endif
+
+// baseline IIR filter: base += (raw - base) / 2^PXS_BASE_SHIFT per scan without touch
+#if !defined(PXS_BASE_SHIFT)
+  #define PXS_BASE_SHIFT    4             ///< baseline time constant [scans] = 2^PXS_BASE_SHIFT
+#endif
+
+// release threshold = threshold - threshold / 2^PXS_HYST_SHIFT
+#if !defined(PXS_HYST_SHIFT)
+  #define PXS_HYST_SHIFT    2             ///< hysteresis (2 -> 25%)
+#endif
+
+// number of consecutive scans to confirm touch or release
+#if !defined(PXS_DEBOUNCE)
+  #define PXS_DEBOUNCE      2             ///< debounce [scans]
+#endif
+
+// number of slots converted in low-power scan
+#if !defined(PXS_LP_SLOTS)
+  #define PXS_LP_SLOTS      1             ///< slots in low-power scan
+#endif
+
+// count table entries
+#define _PXS_COUNT2(a,b)    + 1
+#define _PXS_COUNT3(a,b,c)  + 1
+
+/// number of conversion slots
+#define PXS_NUM_SLOTS       (0 PXS_SLOT_TABLE(_PXS_COUNT2))
+
+/// number of keys (max. 16)
+#define PXS_NUM_KEYS        (0 PXS_KEY_TABLE(_PXS_COUNT3))
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// SDCC requires ISR declaration in main file -> include this header in main.c
+ISR_HANDLER(PXS_ISR, __PXS_VECTOR__);
+
+/// init PXS and key states. Interrupts must be enabled by application
+void      pxs_init(void);
+
+/// select normal (0) or low-power (!=0) scan
+void      pxs_set_lowpower(uint8_t enable);
+
+/// start scan of all slots. Ignored if a scan is in progress
+void      pxs_start(void);
+
+/// check if last scan is complete
+uint8_t   pxs_done(void);
+
+/// evaluate completed scan. Return bit mask of touched keys
+uint16_t  pxs_process(void);
+
+/// get last raw counter value of key
+uint16_t  pxs_raw(uint8_t key);
+
+/// get baseline of key (integer part)
+uint16_t  pxs_baseline(uint8_t key);
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _PXS_H_
@@ -0,0 +1 @@
+C:\Users\Admin\Documents\stm8gal\stm8gal.exe -p COM17 -R 2 -V -w %1
@@ -0,0 +1,21 @@
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "STM8TL52F4.h"	// generic STM8TL52F4 board
+
+
+/*----------------------------------------------------------
+    DRIVER CONFIGURATION
+----------------------------------------------------------*/
+
+// CPU clock
+#define F_CPU           16000000L
+
+// UART 115.2kBaud, PWM 1kHz
+#define UART_BAUD       115200L
+#define PWM_FREQ        1000L
+
+// board specific pin setup for UART. Can be overridden via DEFINES in Makefile
+#if !defined(UART_PINS)
+  #define UART_PINS()   do { _PORTD_DDR |= _PORT_PIN5; _PORTD_CR1 |= (_PORT_PIN5 | _PORT_PIN6); } while (0)   // TX (PD5) push-pull output, RX (PD6) pull-up
+#endif
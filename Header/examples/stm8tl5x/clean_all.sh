@@ -0,0 +1,11 @@
+#!/bin/bash
+
+# change to current working directory
+cd `dirname $0`
+
+# clean all sub-projects
+
+cd Touch_PXS          ; ./clean.sh; cd ..
+cd UART_TIM_Drivers   ; ./clean.sh; cd ..
+
+#PAUSE test
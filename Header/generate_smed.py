@@ -0,0 +1,403 @@
+#!/usr/bin/python3
+# -*- coding: utf-8 -*-
+'''
+  Compile declarative state machine descriptions for the STLUX/STNRG SMED units
+  into register initialization tables, which are loaded by smed_load() (see
+  example project 'SMED_PWM'). Times are converted to SMED clock ticks and
+  validated against the 16-bit timer registers and the SMED clock.
+
+  Copyright (C) 2019 Georg Icking-Konert
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+  **notes**
+
+    - one description file (INI format) per SMED unit. Multiple files are combined into one header
+    - section [smed]: unit (0..5), name, clock (SMED clock, e.g. 96MHz), clk_smd (_CLK_SMDn),
+      cbox (_MSC_CBOXSn), dither (_SMEDn_CTR_DTR), cfg (_SMEDn_CFG), dmp (_SMEDn_DMP),
+      in0..in2 (off, rising, falling, high, low), latch, irq_overflow, irq_in0..irq_in2
+    - sections [S0]..[S3]: time, reset, pwm, hold_exit, cedge, latch_reset, irq, and the input
+      event transition: event (next state), event_edge, event_reset, event_pwm, event_hold, event_and
+    - section [IDLE]: as states, but without time and irq. Additionally qcoup_st
+    - a timer transition leaves Sx for S(x+1) mod 4 when the counter reaches Tx. With reset=1
+      (default) the counter is cleared, i.e. time is the state duration. Else time is the
+      absolute counter value and must increase along the timer transitions
+    - pwm is the PWM output level after the timer transition (PULS_CMP), event_pwm after the
+      event transition (PULS_EDG). Unspecified fields keep the register reset value 0
+    - times are given with unit (ns, us, ms, s) or as ticks without unit
+    - table layout (SMED_CFG_SIZE bytes, see smed.h): registers 0x02..0x1B, IER, ISEL, DMP,
+      CTR_TMR validation mask, CLK_SMDn, MSC_CBOXSn
+
+'''
+
+# import required modules
+import os, sys, re
+import configparser
+import argparse
+
+
+# print disclaimer
+print('')
+print(sys.argv[0] + ', a small utility to compile STLUX/STNRG SMED state machines.')
+print('')
+print('Copyright (C) 2019  Georg Icking-Konert')
+print('')
+print('This program comes with ABSOLUTELY NO WARRANTY!')
+print('This is free software, and you are welcome to redistribute it')
+print('under certain conditions; see source code for details.')
+print('')
+
+
+#-------------------------------------------------------------------
+# global settings
+#-------------------------------------------------------------------
+
+# number of SMED units and states
+NUM_UNITS   = 6
+NUM_STATES  = 4
+
+# offsets of burst registers in SMED unit (CTR_INP..CFG)
+OFFS_FIRST  = 0x02
+OFFS_LAST   = 0x1B
+OFFS_DTR    = 0x03
+OFFS_TMR    = 0x04        # T0L, T0H, T1L, ...
+OFFS_PRM_ID = 0x0C        # PRM_ID0..2, then PRM_S00..S32
+OFFS_CFG    = 0x1B
+
+# table indices after burst registers
+IDX_IER     = OFFS_LAST - OFFS_FIRST + 1
+IDX_ISEL    = IDX_IER + 1
+IDX_DMP     = IDX_IER + 2
+IDX_VALID   = IDX_IER + 3
+IDX_CLK     = IDX_IER + 4
+IDX_CBOX    = IDX_IER + 5
+CFG_SIZE    = IDX_IER + 6
+
+# time units
+UNITS       = {'ns': 1e-9, 'us': 1e-6, 'ms': 1e-3, 's': 1.0}
+
+# input modes: (RS_INSIG, EL_INSIG)
+INPUTS      = {'rising': (0, 0), 'falling': (1, 0), 'high': (0, 1), 'low': (1, 1)}
+
+
+
+#-------------------------------------------------------------------
+# helper functions
+#-------------------------------------------------------------------
+def error(msg):
+  """ Print error message and exit.
+
+  :param msg:   error message
+
+  """
+
+  sys.exit('error: ' + msg)
+
+
+
+def getInt(section, key, maxVal, default=0):
+  """ Get integer field (decimal or hex) and check range.
+
+  :param section:   section of configparser
+  :param key:       name of field
+  :param maxVal:    max. allowed value
+  :param default:   value if field is missing
+
+  :return: value
+
+  """
+
+  if key not in section:
+    return default
+  try:
+    val = int(section[key], 0)
+  except ValueError:
+    error('[' + section.name + '] ' + key + ': no integer')
+  if (val < 0) or (val > maxVal):
+    error('[' + section.name + '] ' + key + ': ' + str(val) + ' out of range 0..' + str(maxVal))
+  return val
+
+
+
+def getFreq(text):
+  """ Convert frequency with optional unit (Hz, kHz, MHz) to Hz.
+
+  :param text:   frequency, e.g. '96MHz'
+
+  :return: frequency [Hz]
+
+  """
+
+  match = re.match(r'^\s*([0-9.]+)\s*(Hz|kHz|MHz)?\s*$', text)
+  if not match:
+    error('invalid frequency ' + text)
+  return float(match.group(1)) * {None: 1, 'Hz': 1, 'kHz': 1e3, 'MHz': 1e6}[match.group(2)]
+
+
+
+def getTicks(text, clock, name, tol):
+  """ Convert time to SMED clock ticks and check range and quantization error.
+
+  :param text:    time with unit (ns, us, ms, s) or ticks without unit
+  :param clock:   SMED clock [Hz]
+  :param name:    name for messages
+  :param tol:     max. relative quantization error
+
+  :return: ticks (1..65535)
+
+  """
+
+  match = re.match(r'^\s*([0-9.]+)\s*(ns|us|ms|s)?\s*$', text)
+  if not match:
+    error(name + ': invalid time ' + text)
+  if match.group(2) is None:
+    try:
+      ticks = int(match.group(1), 0)
+    except ValueError:
+      error(name + ': ' + text + ': ticks must be an integer')
+  else:
+    try:
+      exact = float(match.group(1)) * UNITS[match.group(2)] * clock
+    except ValueError:
+      error(name + ': invalid time ' + text)
+    ticks = int(round(exact))
+    if (ticks > 0) and (abs(ticks - exact) > tol * exact):
+      print('warning: ' + name + ': ' + text + ' -> ' + str(ticks) + ' ticks, error ' + '%.2f%%' % (100.0 * (ticks - exact) / exact))
+  if (ticks < 1) or (ticks > 0xFFFF):
+    error(name + ': ' + text + ' = ' + str(ticks) + ' ticks, allowed 1..65535 (' + '%.3gns..%.3gus' % (1e9 / clock, 65535e6 / clock) + ')')
+  return ticks
+
+
+
+#-------------------------------------------------------------------
+# compile one SMED description
+#-------------------------------------------------------------------
+def compileSmed(filename, tol):
+  """ Compile SMED description to register table.
+
+  :param filename:   name of INI description
+  :param tol:        max. relative quantization error of times
+
+  :return: (unit, name, clock [Hz], table as list of bytes, report lines)
+
+  """
+
+  # read description
+  ini = configparser.ConfigParser(inline_comment_prefixes=(';', '#'))
+  ini.optionxform = str
+  if not ini.read(filename):
+    error('cannot read ' + filename)
+  if 'smed' not in ini:
+    error(filename + ': section [smed] missing')
+  smed  = ini['smed']
+  unit  = getInt(smed, 'unit', NUM_UNITS - 1)
+  name  = smed.get('name', os.path.splitext(os.path.basename(filename))[0])
+  if not re.match(r'^[A-Za-z_]\w*$', name):
+    error(filename + ': name ' + name + ' is no C identifier')
+  if 'clock' not in smed:
+    error(filename + ': [smed] clock missing')
+  clock = getFreq(smed['clock'])
+  for sect in ini.sections():
+    if sect not in ['smed', 'IDLE'] + ['S' + str(i) for i in range(NUM_STATES)]:
+      error(filename + ': unknown section [' + sect + ']')
+
+  # register image
+  table = [0] * CFG_SIZE
+  def reg(offs, val):
+    table[offs - OFFS_FIRST] = val
+
+  # inputs: polarity, edge/level and enable
+  ctrInp, isel = 0, 0
+  for i in range(3):
+    mode = smed.get('in' + str(i), 'off')
+    if mode == 'off':
+      continue
+    if mode not in INPUTS:
+      error(filename + ': in' + str(i) + ' must be off, ' + ', '.join(INPUTS))
+    rs, el = INPUTS[mode]
+    ctrInp |= (rs << i) | (el << (4 + i))
+    isel   |= 1 << i
+  isel |= getInt(smed, 'latch', 1) << 3
+  reg(OFFS_FIRST, getInt(smed, 'ctr_inp', 0xFF, ctrInp))
+  table[IDX_ISEL] = isel
+
+  # global settings
+  reg(OFFS_DTR, getInt(smed, 'dither', 0xFF))
+  reg(OFFS_CFG, getInt(smed, 'cfg', 0x0F))
+  ier = getInt(smed, 'irq_overflow', 1)
+  for i in range(3):
+    ier |= getInt(smed, 'irq_in' + str(i), 1) << (1 + i)
+  table[IDX_DMP]  = getInt(smed, 'dmp', 0x1F)
+  table[IDX_CLK]  = getInt(smed, 'clk_smd', 0xFF)
+  table[IDX_CBOX] = getInt(smed, 'cbox', 0xFF)
+  valid = 0x10 if 'dither' in smed else 0x00
+
+  # states and IDLE
+  states = {}
+  for i, sname in [(-1, 'IDLE')] + [(i, 'S' + str(i)) for i in range(NUM_STATES)]:
+    if sname not in ini:
+      continue
+    sect = ini[sname]
+    where = filename + ': [' + sname + ']'
+
+    # event transition (PRM_x0)
+    nxStat = 0
+    if 'event' in sect:
+      if sect['event'] not in ['S' + str(n) for n in range(NUM_STATES)]:
+        error(where + ' event: next state must be S0..S3')
+      nxStat = int(sect['event'][1])
+    prm0 = nxStat | (getInt(sect, 'event_edge', 3) << 2) | (getInt(sect, 'event_reset', 1) << 4) | \
+           (getInt(sect, 'event_pwm', 1) << 5) | (getInt(sect, 'event_hold', 1) << 6) | (getInt(sect, 'event_and', 1) << 7)
+
+    # timer transition (PRM_x1) and latch reset (PRM_x2)
+    prm1 = (getInt(sect, 'cedge', 3) << 2) | (getInt(sect, 'reset', 1, 1) << 4) | \
+           (getInt(sect, 'pwm', 1) << 5) | (getInt(sect, 'hold_exit', 1) << 6)
+    prm2 = getInt(sect, 'latch_reset', 1)
+    if sname == 'IDLE':
+      prm2 |= getInt(sect, 'qcoup_st', 1) << 7
+    base = OFFS_PRM_ID + 3 * (i + 1)
+    reg(base, prm0)
+    reg(base + 1, prm1)
+    reg(base + 2, prm2)
+
+    # timer register and interrupt of state
+    if i >= 0:
+      if 'time' not in sect:
+        error(where + ' time missing')
+      ticks = getTicks(sect['time'], clock, where + ' time', tol)
+      reg(OFFS_TMR + 2 * i, ticks & 0xFF)
+      reg(OFFS_TMR + 2 * i + 1, ticks >> 8)
+      valid |= 1 << i
+      ier   |= getInt(sect, 'irq', 1) << (4 + i)
+      states[i] = (ticks, bool(prm1 & 0x10), (prm1 >> 5) & 1)
+    else:
+      for key in ['time', 'irq']:
+        if key in sect:
+          error(where + ' ' + key + ' not allowed')
+
+  table[IDX_IER]   = ier
+  table[IDX_VALID] = valid
+  if 0 not in states:
+    error(filename + ': state [S0] missing')
+
+  # follow timer transitions from S0 with counter 0 and check absolute times
+  report  = []
+  state, count, time, high, seq = 0, 0, 0, 0, []
+  for step in range(NUM_STATES + 1):
+    if (state == 0) and (step > 0) and (count == 0):
+      period = time / clock
+      report.append('  FSM cycle %d ticks = %.6gus (%.6gkHz), PWM high %d ticks = %.1f%%' % (time, period * 1e6, 1e-3 / period, high, 100.0 * high / time))
+      break
+    if state not in states:
+      report.append('  timer transitions stop in S' + str(state) + ' (no state definition)')
+      break
+    ticks, reset, pwm = states[state]
+    if ticks <= count:
+      error(filename + ': [S' + str(state) + '] time ' + str(ticks) + ' <= counter ' + str(count) + ' at entry. Use reset=1 in previous state')
+    dur = ticks - count
+    seq.append('S%d %d' % (state, dur))
+    time += dur
+    # PWM level in state is set by timer transition from previous state
+    if states.get((state - 1) % NUM_STATES, (0, False, 0))[2]:
+      high += dur
+    count = 0 if reset else ticks
+    state = (state + 1) % NUM_STATES
+  else:
+    report.append('  timer transitions do not return to S0 with counter 0')
+  report.insert(0, '  timer sequence [ticks]: ' + ', '.join(seq))
+  report.insert(0, 'SMED' + str(unit) + ' \'' + name + '\' from ' + filename + ', clock ' + '%.6gMHz' % (clock / 1e6) + ', resolution ' + '%.4gns' % (1e9 / clock))
+
+  return unit, name, clock, table, report
+
+
+
+#-------------------------------------------------------------------
+# write header
+#-------------------------------------------------------------------
+def writeHeader(filename, results, sources):
+  """ Write C header with register tables.
+
+  :param filename:   output file
+  :param results:    list of compileSmed() results
+  :param sources:    names of description files
+
+  """
+
+  guard = '_' + re.sub(r'\W', '_', os.path.basename(filename)).upper() + '_'
+  lines = []
+  lines.append('/**')
+  lines.append('  \\file ' + os.path.basename(filename))
+  lines.append('')
+  lines.append('  \\brief SMED register tables for smed_load()')
+  lines.append('')
+  lines.append('  Generated by generate_smed.py from ' + ', '.join(os.path.basename(s) for s in sources) + '. Do not edit!')
+  lines.append('*/')
+  lines.append('')
+  lines.append('#ifndef ' + guard)
+  lines.append('#define ' + guard)
+  lines.append('')
+  lines.append('#include "smed.h"')
+  lines.append('')
+  lines.append('#if (SMED_CFG_SIZE != ' + str(CFG_SIZE) + ')')
+  lines.append('  #error table layout differs from smed.h, please regenerate')
+  lines.append('#endif')
+  for unit, name, clock, table, report in results:
+    lines.append('')
+    lines.append('')
+    lines.append('// ' + report[0])
+    lines.append('#define SMED_UNIT_' + name.upper() + ' ' * max(1, 24 - len(name)) + str(unit) + '    ///< SMED unit of \'' + name + '\'')
+    lines.append('#define SMED_CLOCK_' + name.upper() + ' ' * max(1, 23 - len(name)) + str(int(clock)) + 'L    ///< SMED clock [Hz] of \'' + name + '\'')
+    lines.append('')
+    lines.append('/// register table of \'' + name + '\'')
+    lines.append('static const uint8_t g_smed_' + name + '[SMED_CFG_SIZE] = {')
+    for i in range(0, CFG_SIZE, 8):
+      lines.append('  ' + ' '.join('0x%02X,' % b for b in table[i:i+8]))
+    lines.append('};')
+  lines.append('')
+  lines.append('#endif // ' + guard)
+
+  with open(filename, 'w', newline='\r\n') as fp:
+    fp.write('\n'.join(lines) + '\n')
+
+
+
+#-------------------------------------------------------------------
+# main program
+#-------------------------------------------------------------------
+if __name__ == '__main__':
+
+  # commandline parameters
+  parser = argparse.ArgumentParser(description='compile STLUX/STNRG SMED state machines to register tables')
+  parser.add_argument('files', nargs='+', help='SMED descriptions (INI format)')
+  parser.add_argument('-o', '--output', default='smed_cfg.h', help='output header (default: smed_cfg.h)')
+  parser.add_argument('-t', '--tol', type=float, default=0.5, help='max. quantization error of times [%%] (default: 0.5)')
+  args = parser.parse_args()
+
+  # compile and check for multiple use of units or names
+  results = []
+  for name in args.files:
+    results.append(compileSmed(name, args.tol / 100.0))
+  for key, what in [(0, 'unit'), (1, 'name')]:
+    vals = [r[key] for r in results]
+    for val in set(vals):
+      if vals.count(val) > 1:
+        error(what + ' ' + str(val) + ' used in multiple descriptions')
+
+  # report and output
+  for result in results:
+    print('\n'.join(result[4]))
+  writeHeader(args.output, results, args.files)
+  print('')
+  print('wrote ' + args.output)
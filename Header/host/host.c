@@ -0,0 +1,1044 @@
+/**
+  \file host.c
+
+  \brief implementation of STM8 register simulator for host builds
+
+  The 64kB address space is mapped twice to the same memory: the firmware
+  view (stm8_host_mem), in which pages with hooks are protected, and an
+  unprotected view for the models. A firmware access to a protected page
+  raises SIGSEGV. The handler calls the pre-read hook, unprotects the page
+  and sets the trap flag. After the access instruction SIGTRAP is raised,
+  which protects the page again and calls the post-read or write hook.
+  The access type is taken from the page fault error code, i.e. writes of
+  an unchanged value are also detected.
+
+  Time advances in steps up to the next model event, so interrupts are
+  requested at their exact event time. Pending ISRs are executed from the
+  SIGTRAP handler, i.e. directly after the register access during which
+  the interrupt occurred. Register accesses of the ISR nest into the same
+  handlers (SA_NODEFER).
+
+  Accesses can be recorded into a trace file, and values of register reads
+  can be replayed from a trace recorded on target or in an earlier run.
+
+  Requires x86-64 Linux. Don't run under a debugger with single stepping.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "host.h"
+
+#if !defined(__linux__) || !defined(__x86_64__)
+  #error register simulator requires x86-64 Linux
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// size of simulated address space and of a protection page
+#define HOST_MEM_SIZE       0x10000
+#define HOST_PAGE_SIZE      0x1000
+
+// register pages which are always protected, i.e. advance time on access
+#define HOST_IO_FIRST       0x5000        // peripheral registers
+#define HOST_IO_LAST        0x57FF
+#define HOST_CPU_FIRST      0x7F00        // CPU, ITC and SWIM registers
+#define HOST_CPU_LAST       0x7FFF
+
+// x86 trap flag and page fault write bit
+#define HOST_EFL_TF         0x100
+#define HOST_ERR_WRITE      0x02
+
+// max. polls of one register without model event before abort
+#define HOST_POLL_MAX       1000000L
+
+// number of interrupt vectors
+#define HOST_IRQS           32
+
+// trace file format, see trace_decode.py
+#define HOST_TRACE_MAGIC    "STRC"        // file identifier
+#define HOST_TRACE_HEADER   10            // header size [B]
+#define HOST_TRACE_READ     0             // record type: read
+#define HOST_TRACE_WRITE    1             // record type: write
+
+// CPU cycles -> HSI cycles (prescalers from _CLK_CKDIVR)
+#define HOST_CPU(cycles)    ((uint32_t) (cycles) << (host_clk_shift() + (host_peek(HOST_ADDR(_CLK_CKDIVR)) & _CLK_CKDIVR_CPUDIV)))
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL TYPES
+-----------------------------------------------------------------------------*/
+
+// entry of hook table
+typedef struct {
+  uint16_t      first;        // first address
+  uint16_t      last;         // last address
+  host_hook_t   hook;         // hook function
+} host_range_t;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+/// firmware view of simulated address space, used by _SFR()
+unsigned char   *stm8_host_mem = NULL;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// model view of simulated address space and protected pages
+static uint8_t          *s_raw = NULL;
+static uint8_t          s_protect[HOST_MEM_SIZE / HOST_PAGE_SIZE];
+
+// hooks
+static host_range_t     s_range[HOST_MAX_HOOKS];
+static uint8_t          s_numRange;
+static host_tick_t      s_tick[HOST_MAX_HOOKS];
+static uint8_t          s_numTick;
+
+// simulated time, next model event and access statistics
+static uint64_t         s_cycles;
+static uint32_t         s_next = HOST_IDLE;
+static uint32_t         s_accesses;
+static int32_t          s_lastRead = -1;
+static uint32_t         s_polls;
+
+// access in progress (between SIGSEGV and SIGTRAP)
+static int32_t          s_trapAddr = -1;
+static uint8_t          s_trapWrite;
+static uint8_t          s_trapOld;
+
+// interrupts
+static void             (*s_isr[HOST_IRQS])(void);
+static uint32_t         s_pending;
+static uint8_t          s_enabled;
+static uint8_t          s_inIsr;
+static uint64_t         s_request[HOST_IRQS];
+static host_isr_stat_t  s_stat[HOST_IRQS];
+
+// trace recorder
+static FILE             *s_traceFile;
+static uint32_t         s_traceCount;
+
+// replay: recorded read values in order, and per address index of next value
+static uint16_t         *s_replayAddr;
+static uint8_t          *s_replayValue;
+static uint32_t         s_replayNum;
+static uint32_t         *s_replayPos;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void host_fatal(const char *msg, uint32_t addr)
+
+  \brief print error and abort simulation
+
+  \param[in]  msg    error message
+  \param[in]  addr   related address
+*/
+static void host_fatal(const char *msg, uint32_t addr) {
+
+  fprintf(stderr, "host: %s (addr 0x%04x, cycle %llu)\n", msg, (unsigned int) addr, (unsigned long long) s_cycles);
+  abort();
+
+} // host_fatal
+
+
+
+/**
+  \fn void host_call(uint16_t addr, uint8_t access, uint8_t old)
+
+  \brief call hooks of address
+
+  \param[in]  addr     register address
+  \param[in]  access   HOST_PRE_READ, HOST_POST_READ or HOST_WRITE
+  \param[in]  old      value before access
+*/
+static void host_call(uint16_t addr, uint8_t access, uint8_t old) {
+
+  uint8_t   i;
+
+  for (i=0; i<s_numRange; i++) {
+    if ((addr >= s_range[i].first) && (addr <= s_range[i].last))
+      s_range[i].hook(addr, access, old);
+  }
+
+} // host_call
+
+
+
+/**
+  \fn void host_update(void)
+
+  \brief get time of next model event
+*/
+static void host_update(void) {
+
+  uint32_t  next;
+  uint8_t   i;
+
+  s_next = HOST_IDLE;
+  for (i=0; i<s_numTick; i++) {
+    next = s_tick[i](0);
+    if (next < s_next)
+      s_next = next;
+  }
+
+} // host_update
+
+
+
+/**
+  \fn void host_advance(uint32_t cycles)
+
+  \brief advance simulated time in steps of model events
+
+  \param[in]  cycles   HSI cycles
+
+  Time is updated before the models, i.e. interrupts requested by a model
+  get the timestamp of the event.
+*/
+static void host_advance(uint32_t cycles) {
+
+  uint32_t  step, next;
+  uint8_t   i;
+
+  while (cycles) {
+
+    // step to next event, at least 1 cycle
+    step = (cycles < s_next) ? cycles : s_next;
+    if (step == 0)
+      step = 1;
+
+    // advance time and models, get next event
+    s_cycles += step;
+    cycles   -= step;
+    s_next    = HOST_IDLE;
+    for (i=0; i<s_numTick; i++) {
+      next = s_tick[i](step);
+      if (next < s_next)
+        s_next = next;
+    }
+
+  } // loop cycles
+
+} // host_advance
+
+
+
+/**
+  \fn void host_dispatch(void)
+
+  \brief execute pending ISRs in order of vector number
+
+  ISRs are executed with interrupts disabled, like on STM8 with default
+  priorities. Entry and return take HOST_ISR_ENTRY/EXIT_CYCLES.
+*/
+static void host_dispatch(void) {
+
+  host_isr_stat_t   *stat;
+  uint64_t          start;
+  uint32_t          duration;
+  uint8_t           irq;
+
+  while (s_enabled && (!s_inIsr) && s_pending) {
+
+    for (irq=0; !(s_pending & (1UL << irq)); irq++);
+    s_pending &= ~(1UL << irq);
+
+    if (s_isr[irq] != NULL) {
+      s_inIsr   = 1;
+      s_enabled = 0;
+
+      // execute ISR incl. entry and return
+      start = s_cycles;
+      host_advance(HOST_CPU(HOST_ISR_ENTRY_CYCLES));
+      s_isr[irq]();
+      host_advance(HOST_CPU(HOST_ISR_EXIT_CYCLES));
+
+      // update statistics
+      stat     = &(s_stat[irq]);
+      duration = (uint32_t) (s_cycles - start);
+      stat->count++;
+      stat->cycles += duration;
+      if (duration > stat->maxCycles)
+        stat->maxCycles = duration;
+      if ((uint32_t) (start - s_request[irq]) > stat->maxLatency)
+        stat->maxLatency = (uint32_t) (start - s_request[irq]);
+
+      s_enabled = 1;
+      s_inIsr   = 0;
+    }
+
+  } // loop pending
+
+} // host_dispatch
+
+
+
+/**
+  \fn void host_trace_record(uint16_t addr, uint8_t type, uint8_t value)
+
+  \brief write access to trace file
+
+  \param[in]  addr    register address
+  \param[in]  type    HOST_TRACE_READ or HOST_TRACE_WRITE
+  \param[in]  value   read or written value
+*/
+static void host_trace_record(uint16_t addr, uint8_t type, uint8_t value) {
+
+  uint8_t   rec[8];
+  uint32_t  time = (uint32_t) s_cycles;
+
+  // record: time (4B), address (2B), value, type. Little endian
+  rec[0] = (uint8_t) time;
+  rec[1] = (uint8_t) (time >> 8);
+  rec[2] = (uint8_t) (time >> 16);
+  rec[3] = (uint8_t) (time >> 24);
+  rec[4] = (uint8_t) addr;
+  rec[5] = (uint8_t) (addr >> 8);
+  rec[6] = value;
+  rec[7] = type;
+  fwrite(rec, 1, sizeof(rec), s_traceFile);
+  s_traceCount++;
+
+} // host_trace_record
+
+
+
+/**
+  \fn void host_replay_read(uint16_t addr)
+
+  \brief set register to next recorded read value
+
+  \param[in]  addr   register address
+
+  If all recorded values of the address are used, the register is not changed.
+*/
+static void host_replay_read(uint16_t addr) {
+
+  uint32_t  i;
+
+  for (i = s_replayPos[addr]; (i < s_replayNum) && (s_replayAddr[i] != addr); i++);
+  if (i < s_replayNum) {
+    s_raw[addr] = s_replayValue[i];
+    i++;
+  }
+  s_replayPos[addr] = i;
+
+} // host_replay_read
+
+
+
+/**
+  \fn void host_segv(int sig, siginfo_t *info, void *context)
+
+  \brief signal handler for access to protected page
+
+  \param[in]  sig       signal number
+  \param[in]  info      signal information (fault address)
+  \param[in]  context   CPU context
+*/
+static void host_segv(int sig, siginfo_t *info, void *context) {
+
+  ucontext_t  *uc = (ucontext_t*) context;
+  uint8_t     *p  = (uint8_t*) info->si_addr;
+  uint16_t    addr;
+  uint32_t    cycles;
+
+  (void) sig;
+
+  // no simulator access -> restore default handler for crash
+  if ((stm8_host_mem == NULL) || (p < stm8_host_mem) || (p >= stm8_host_mem + HOST_MEM_SIZE) || (s_trapAddr >= 0)) {
+    signal(SIGSEGV, SIG_DFL);
+    return;
+  }
+  addr = (uint16_t) (p - stm8_host_mem);
+
+  // advance time. Repeated reads of same register (polling) skip to next model event
+  s_accesses++;
+  cycles = HOST_CPU(HOST_ACCESS_CYCLES);
+  if ((uc->uc_mcontext.gregs[REG_ERR] & HOST_ERR_WRITE) || (s_lastRead != addr)) {
+    s_polls = 0;
+    host_advance(cycles);
+  }
+  else if (s_next != HOST_IDLE) {
+    s_polls = 0;
+    host_advance((s_next > cycles) ? s_next : cycles);
+  }
+  else {
+    if (++s_polls > HOST_POLL_MAX)
+      host_fatal("polling register without pending model event", addr);
+    host_advance(cycles);
+  }
+
+  // store access and call pre-read hook
+  s_trapAddr  = addr;
+  s_trapWrite = (uc->uc_mcontext.gregs[REG_ERR] & HOST_ERR_WRITE) ? 1 : 0;
+  if (!s_trapWrite) {
+    host_call(addr, HOST_PRE_READ, s_raw[addr]);
+    if (s_replayNum)
+      host_replay_read(addr);
+  }
+  s_trapOld = s_raw[addr];
+
+  // allow access and single-step instruction
+  mprotect(stm8_host_mem + (addr & ~(HOST_PAGE_SIZE-1)), HOST_PAGE_SIZE, PROT_READ | PROT_WRITE);
+  uc->uc_mcontext.gregs[REG_EFL] |= HOST_EFL_TF;
+
+} // host_segv
+
+
+
+/**
+  \fn void host_trap(int sig, siginfo_t *info, void *context)
+
+  \brief signal handler after single-stepped access
+
+  \param[in]  sig       signal number
+  \param[in]  info      signal information
+  \param[in]  context   CPU context
+*/
+static void host_trap(int sig, siginfo_t *info, void *context) {
+
+  ucontext_t  *uc = (ucontext_t*) context;
+  uint16_t    addr;
+
+  (void) sig;
+  (void) info;
+
+  // no simulator access -> restore default handler
+  if (s_trapAddr < 0) {
+    signal(SIGTRAP, SIG_DFL);
+    return;
+  }
+  addr = (uint16_t) s_trapAddr;
+
+  // stop single-step and protect page again
+  uc->uc_mcontext.gregs[REG_EFL] &= ~HOST_EFL_TF;
+  mprotect(stm8_host_mem + (addr & ~(HOST_PAGE_SIZE-1)), HOST_PAGE_SIZE, PROT_NONE);
+  s_trapAddr = -1;
+
+  // record and call post-access hook
+  if (s_trapWrite || (s_raw[addr] != s_trapOld)) {
+    if (s_traceFile != NULL)
+      host_trace_record(addr, HOST_TRACE_WRITE, s_raw[addr]);
+    s_lastRead = -1;
+    host_call(addr, HOST_WRITE, s_trapOld);
+  }
+  else {
+    if (s_traceFile != NULL)
+      host_trace_record(addr, HOST_TRACE_READ, s_raw[addr]);
+    s_lastRead = addr;
+    host_call(addr, HOST_POST_READ, s_trapOld);
+  }
+
+  // hooks may have changed model state
+  host_update();
+
+  // execute interrupts requested during access
+  host_dispatch();
+
+} // host_trap
+
+
+
+/**
+  \fn void host_protect(uint16_t first, uint16_t last)
+
+  \brief protect pages of address range
+
+  \param[in]  first   first address
+  \param[in]  last    last address
+*/
+static void host_protect(uint16_t first, uint16_t last) {
+
+  uint8_t   page;
+
+  for (page = first / HOST_PAGE_SIZE; page <= last / HOST_PAGE_SIZE; page++) {
+    if (!s_protect[page]) {
+      s_protect[page] = 1;
+      mprotect(stm8_host_mem + page * HOST_PAGE_SIZE, HOST_PAGE_SIZE, PROT_NONE);
+    }
+  }
+
+} // host_protect
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void host_init(void)
+
+  \brief init simulator
+
+  Map simulated address space (all zero), install signal handlers and reset
+  time and interrupt state. Interrupts are disabled, like after STM8 reset.
+  Trace and replay are stopped. Registered ISRs are kept. Init models after
+  this function.
+*/
+void host_init(void) {
+
+  struct sigaction  sa;
+  int               fd;
+
+  // map memory twice (firmware and model view)
+  if (stm8_host_mem == NULL) {
+    fd = memfd_create("stm8", 0);
+    if ((fd < 0) || (ftruncate(fd, HOST_MEM_SIZE) != 0))
+      host_fatal("cannot create memory", 0);
+    stm8_host_mem = mmap(NULL, HOST_MEM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    s_raw         = mmap(NULL, HOST_MEM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if ((stm8_host_mem == MAP_FAILED) || (s_raw == MAP_FAILED))
+      host_fatal("cannot map memory", 0);
+  }
+
+  // reset memory, hooks and protection
+  mprotect(stm8_host_mem, HOST_MEM_SIZE, PROT_READ | PROT_WRITE);
+  memset(s_raw, 0, HOST_MEM_SIZE);
+  memset(s_protect, 0, sizeof(s_protect));
+  s_numRange = 0;
+  s_numTick  = 0;
+  host_protect(HOST_IO_FIRST, HOST_IO_LAST);
+  host_protect(HOST_CPU_FIRST, HOST_CPU_LAST);
+
+  // reset time and interrupts
+  s_cycles   = 0;
+  s_next     = HOST_IDLE;
+  s_accesses = 0;
+  s_lastRead = -1;
+  s_polls    = 0;
+  s_trapAddr = -1;
+  s_pending  = 0;
+  s_enabled  = 0;
+  s_inIsr    = 0;
+  memset(s_stat, 0, sizeof(s_stat));
+
+  // stop trace and replay
+  host_trace_stop();
+  free(s_replayAddr);
+  free(s_replayValue);
+  free(s_replayPos);
+  s_replayAddr  = NULL;
+  s_replayValue = NULL;
+  s_replayPos   = NULL;
+  s_replayNum   = 0;
+
+  // clock after reset: fMASTER = fHSI/8, fCPU = fMASTER
+  s_raw[HOST_ADDR(_CLK_CKDIVR)] = _CLK_CKDIVR_RESET_VALUE;
+
+  // install signal handlers. SIGTRAP handler executes ISRs -> allow nesting
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_flags = SA_SIGINFO;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_sigaction = host_segv;
+  sigaction(SIGSEGV, &sa, NULL);
+  sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+  sa.sa_sigaction = host_trap;
+  sigaction(SIGTRAP, &sa, NULL);
+
+} // host_init
+
+
+
+/**
+  \fn void host_attach(uint16_t first, uint16_t last, host_hook_t hook)
+
+  \brief attach access hook
+
+  \param[in]  first   first address
+  \param[in]  last    last address
+  \param[in]  hook    function called on access
+*/
+void host_attach(uint16_t first, uint16_t last, host_hook_t hook) {
+
+  if (s_numRange >= HOST_MAX_HOOKS)
+    host_fatal("too many hooks", first);
+
+  s_range[s_numRange].first = first;
+  s_range[s_numRange].last  = last;
+  s_range[s_numRange].hook  = hook;
+  s_numRange++;
+  host_protect(first, last);
+
+} // host_attach
+
+
+
+/**
+  \fn void host_attach_tick(host_tick_t tick)
+
+  \brief attach time hook. Attaching a hook twice has no effect
+
+  \param[in]  tick    function called when time advances
+*/
+void host_attach_tick(host_tick_t tick) {
+
+  uint8_t   i;
+
+  // ignore if already attached, e.g. model with several instances
+  for (i=0; i<s_numTick; i++) {
+    if (s_tick[i] == tick)
+      return;
+  }
+  if (s_numTick >= HOST_MAX_HOOKS)
+    host_fatal("too many time hooks", 0);
+
+  s_tick[s_numTick++] = tick;
+  host_update();
+
+} // host_attach_tick
+
+
+
+/**
+  \fn uint8_t host_peek(uint16_t addr)
+
+  \brief read memory without hooks
+
+  \param[in]  addr   address
+
+  \return memory content
+*/
+uint8_t host_peek(uint16_t addr) {
+
+  return(s_raw[addr]);
+
+} // host_peek
+
+
+
+/**
+  \fn void host_poke(uint16_t addr, uint8_t value)
+
+  \brief write memory without hooks
+
+  \param[in]  addr    address
+  \param[in]  value   new content
+*/
+void host_poke(uint16_t addr, uint8_t value) {
+
+  s_raw[addr] = value;
+
+} // host_poke
+
+
+
+/**
+  \fn void host_irq(uint8_t irq)
+
+  \brief request interrupt
+
+  \param[in]  irq   vector number (__xxx_VECTOR__)
+*/
+void host_irq(uint8_t irq) {
+
+  if ((irq < HOST_IRQS) && !(s_pending & (1UL << irq))) {
+    s_pending |= (1UL << irq);
+    s_request[irq] = s_cycles;
+  }
+
+} // host_irq
+
+
+
+/**
+  \fn void host_run(uint32_t cycles)
+
+  \brief advance time and execute ISRs
+
+  \param[in]  cycles   HSI cycles
+*/
+void host_run(uint32_t cycles) {
+
+  uint32_t  step;
+
+  host_update();
+  while (cycles) {
+    step = (cycles < s_next) ? cycles : s_next;
+    if (step == 0)
+      step = 1;
+    host_advance(step);
+    cycles -= step;
+    host_dispatch();
+  }
+
+} // host_run
+
+
+
+/**
+  \fn uint64_t host_cycles(void)
+
+  \brief get simulated time
+
+  \return HSI cycles since host_init()
+*/
+uint64_t host_cycles(void) {
+
+  return(s_cycles);
+
+} // host_cycles
+
+
+
+/**
+  \fn uint8_t host_clk_shift(void)
+
+  \brief get fMASTER prescaler
+
+  \return HSIDIV from _CLK_CKDIVR, fMASTER = fHSI >> shift
+*/
+uint8_t host_clk_shift(void) {
+
+  return((s_raw[HOST_ADDR(_CLK_CKDIVR)] & _CLK_CKDIVR_HSIDIV) >> 3);
+
+} // host_clk_shift
+
+
+
+/**
+  \fn uint32_t host_accesses(void)
+
+  \brief get number of register accesses
+
+  \return register accesses since host_init()
+*/
+uint32_t host_accesses(void) {
+
+  return(s_accesses);
+
+} // host_accesses
+
+
+
+/**
+  \fn uint8_t host_trace_start(const char *file)
+
+  \brief start recording of register accesses
+
+  \param[in]  file   name of trace file
+
+  \return 1 on success, 0 on error
+
+  Record time [HSI cycles], address, value and type of each access. Use
+  trace_decode.py to print the trace with register and bit names.
+*/
+uint8_t host_trace_start(const char *file) {
+
+  // header: magic, time base [kHz] (2B), time size [B], reserved, record count (2B). Little endian
+  uint8_t   hdr[HOST_TRACE_HEADER] = {'S', 'T', 'R', 'C', (uint8_t) (HOST_FHSI/1000L), (uint8_t) ((HOST_FHSI/1000L) >> 8), 4, 0, 0xFF, 0xFF};
+
+  host_trace_stop();
+  s_traceFile = fopen(file, "wb");
+  if (s_traceFile == NULL)
+    return(0);
+  fwrite(hdr, 1, sizeof(hdr), s_traceFile);
+  s_traceCount = 0;
+
+  return(1);
+
+} // host_trace_start
+
+
+
+/**
+  \fn void host_trace_stop(void)
+
+  \brief stop recording and close trace file
+*/
+void host_trace_stop(void) {
+
+  uint8_t   cnt[2];
+
+  if (s_traceFile == NULL)
+    return;
+
+  // store number of records, 0xFFFF = read until end of file
+  if (s_traceCount < 0xFFFF) {
+    cnt[0] = (uint8_t) s_traceCount;
+    cnt[1] = (uint8_t) (s_traceCount >> 8);
+    fseek(s_traceFile, HOST_TRACE_HEADER-2, SEEK_SET);
+    fwrite(cnt, 1, sizeof(cnt), s_traceFile);
+  }
+  fclose(s_traceFile);
+  s_traceFile = NULL;
+
+} // host_trace_stop
+
+
+
+/**
+  \fn uint32_t host_replay(const char *file, uint16_t first, uint16_t last)
+
+  \brief replay recorded register reads
+
+  \param[in]  file    trace file, recorded on target or by host_trace_start()
+  \param[in]  first   first address to replay
+  \param[in]  last    last address to replay
+
+  \return number of loaded read values, 0 on error
+
+  Each firmware read of an address in first..last returns the next value
+  read from this address in the trace, i.e. replay follows the order of
+  accesses per register, not the recorded time. This overrides models.
+  After all values of an address are used, the register is not changed.
+*/
+uint32_t host_replay(const char *file, uint16_t first, uint16_t last) {
+
+  FILE      *fp;
+  uint8_t   hdr[HOST_TRACE_HEADER], rec[8];
+  uint8_t   size;
+  uint32_t  num, alloc = 0;
+  uint16_t  addr;
+
+  // check header
+  fp = fopen(file, "rb");
+  if (fp == NULL)
+    return(0);
+  if ((fread(hdr, 1, sizeof(hdr), fp) != sizeof(hdr)) || (memcmp(hdr, HOST_TRACE_MAGIC, 4) != 0) || (hdr[6] < 1) || (hdr[6] > 4)) {
+    fclose(fp);
+    return(0);
+  }
+  size = hdr[6] + 4;
+  num  = ((uint32_t) hdr[9] << 8) | hdr[8];
+  if (num == 0xFFFF)
+    num = 0xFFFFFFFFUL;
+
+  // reset previous replay
+  free(s_replayAddr);
+  free(s_replayValue);
+  free(s_replayPos);
+  s_replayAddr  = NULL;
+  s_replayValue = NULL;
+  s_replayNum   = 0;
+  s_replayPos   = calloc(HOST_MEM_SIZE, sizeof(uint32_t));
+
+  // store reads in address range
+  while ((num--) && (fread(rec, 1, size, fp) == size)) {
+    addr = ((uint16_t) rec[size-3] << 8) | rec[size-4];
+    if ((rec[size-1] != HOST_TRACE_READ) || (addr < first) || (addr > last))
+      continue;
+    if (s_replayNum >= alloc) {
+      alloc = (alloc) ? 2*alloc : 256;
+      s_replayAddr  = realloc(s_replayAddr, alloc * sizeof(uint16_t));
+      s_replayValue = realloc(s_replayValue, alloc);
+    }
+    s_replayAddr[s_replayNum]  = addr;
+    s_replayValue[s_replayNum] = rec[size-2];
+    s_replayNum++;
+  }
+  fclose(fp);
+
+  // reads of replayed addresses must trap
+  host_protect(first, last);
+
+  return(s_replayNum);
+
+} // host_replay
+
+
+
+/**
+  \fn const host_isr_stat_t *host_isr_stat(uint8_t irq)
+
+  \brief get profiling data of ISR
+
+  \param[in]  irq   vector number
+
+  \return execution count, time and latency [HSI cycles]
+*/
+const host_isr_stat_t *host_isr_stat(uint8_t irq) {
+
+  return(&(s_stat[irq % HOST_IRQS]));
+
+} // host_isr_stat
+
+
+
+/**
+  \fn void host_isr_report(void)
+
+  \brief print ISR profiling data
+
+  Print count, load (share of simulated time), average and max. duration
+  and max. latency of each executed ISR. Times in us.
+*/
+void host_isr_report(void) {
+
+  host_isr_stat_t   *stat;
+  uint8_t           irq;
+
+  printf("irq    count   load[%%]   avg[us]   max[us]  latency[us]\n");
+  for (irq=0; irq<HOST_IRQS; irq++) {
+    stat = &(s_stat[irq]);
+    if (stat->count == 0)
+      continue;
+    printf("%3u %8lu %9.3f %9.2f %9.2f %12.2f\n", (unsigned int) irq, (unsigned long) stat->count,
+      (s_cycles) ? 100.0 * (double) stat->cycles / (double) s_cycles : 0.0,
+      1e6 * (double) stat->cycles / (double) stat->count / (double) HOST_FHSI,
+      1e6 * (double) stat->maxCycles / (double) HOST_FHSI,
+      1e6 * (double) stat->maxLatency / (double) HOST_FHSI);
+  }
+
+} // host_isr_report
+
+
+
+/**
+  \fn void stm8_host_isr(unsigned char irq, void (*func)(void))
+
+  \brief register ISR, called by ISR_HANDLER() before main()
+
+  \param[in]  irq    vector number
+  \param[in]  func   ISR function (NULL if only declared)
+*/
+void stm8_host_isr(unsigned char irq, void (*func)(void)) {
+
+  if ((irq < HOST_IRQS) && (func != NULL))
+    s_isr[irq] = func;
+
+} // stm8_host_isr
+
+
+
+/**
+  \fn void stm8_host_nop(void)
+
+  \brief simulate NOP(): 1 CPU cycle, execute pending ISRs
+*/
+void stm8_host_nop(void) {
+
+  host_advance(HOST_CPU(1));
+  host_dispatch();
+
+} // stm8_host_nop
+
+
+
+/**
+  \fn void stm8_host_sim(void)
+
+  \brief simulate DISABLE_INTERRUPTS()
+*/
+void stm8_host_sim(void) {
+
+  s_enabled = 0;
+
+} // stm8_host_sim
+
+
+
+/**
+  \fn void stm8_host_rim(void)
+
+  \brief simulate ENABLE_INTERRUPTS() and execute pending ISRs
+*/
+void stm8_host_rim(void) {
+
+  s_enabled = 1;
+  host_dispatch();
+
+} // stm8_host_rim
+
+
+
+/**
+  \fn unsigned char stm8_host_save_sim(void)
+
+  \brief simulate SAVE_AND_DISABLE_INTERRUPTS()
+
+  \return previous interrupt state (1=enabled)
+*/
+unsigned char stm8_host_save_sim(void) {
+
+  unsigned char  state = s_enabled;
+
+  s_enabled = 0;
+
+  return(state);
+
+} // stm8_host_save_sim
+
+
+
+/**
+  \fn void stm8_host_restore(unsigned char state)
+
+  \brief simulate RESTORE_INTERRUPTS() and execute pending ISRs if enabled
+
+  \param[in]  state   interrupt state from stm8_host_save_sim()
+*/
+void stm8_host_restore(unsigned char state) {
+
+  s_enabled = state;
+  if (state)
+    host_dispatch();
+
+} // stm8_host_restore
+
+
+
+/**
+  \fn void stm8_host_wfi(void)
+
+  \brief simulate WAIT_FOR_INTERRUPT()
+
+  Enable interrupts like STM8 WFI, skip time to next interrupt and execute
+  it. Abort if no interrupt occurs within HOST_WFI_TIMEOUT.
+*/
+void stm8_host_wfi(void) {
+
+  uint32_t  waited = 0, step;
+
+  s_enabled = 1;
+  host_update();
+  while (!s_pending) {
+    if (waited >= HOST_WFI_TIMEOUT)
+      host_fatal("no interrupt in WAIT_FOR_INTERRUPT()", 0);
+    step = HOST_WFI_TIMEOUT - waited;
+    if (s_next < step)
+      step = (s_next > 0) ? s_next : 1;
+    host_advance(step);
+    waited += step;
+  }
+  host_dispatch();
+
+} // stm8_host_wfi
+
+
+
+/**
+  \fn void stm8_host_trap(void)
+
+  \brief simulate TRIGGER_TRAP. Traps are not simulated
+*/
+void stm8_host_trap(void) {
+
+  host_fatal("TRAP not supported", 0);
+
+} // stm8_host_trap
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,203 @@
+/**
+  \file host.h
+
+  \brief declaration of STM8 register simulator for host builds
+
+  Compile firmware with -DSTM8_HOST on a PC (x86-64 Linux, gcc/clang). Then
+  _SFR() resolves into a simulated 64kB address space instead of absolute
+  addresses, and driver logic and ISRs can be unit-tested at native speed.
+
+  Pages with peripheral registers are access protected. Each register access
+  traps into the simulator, which calls the hooks of the peripheral models
+  before a read, after a read and after a write. This allows side effects
+  like clear-on-read flags or data transmission on write, without changes
+  to the firmware. Models use host_peek()/host_poke() for direct access.
+
+  Simulated time is a discrete-event clock counted in HSI cycles (16MHz).
+  fMASTER and fCPU are derived from _CLK_CKDIVR, i.e. peripherals count
+  fMASTER cycles, and each register access and ISR entry/exit costs CPU
+  cycles. Time advances on register accesses and host_run(). Polling loops
+  on a register skip to the next model event. Models raise interrupts at
+  their event time. ISRs are registered automatically via ISR_HANDLER()
+  and executed after the next register access, or in host_run(), NOP(),
+  ENABLE_INTERRUPTS() and WAIT_FOR_INTERRUPT(). Execution count, duration
+  and latency of each ISR are recorded for profiling.
+
+  All register accesses can be recorded into a trace file. Register reads
+  can be replayed from a trace recorded on target (see example project
+  Register_Trace) or by an earlier host run, e.g. to feed recorded IDR and
+  SR values into the firmware.
+
+  Limitations:
+    - byte accesses only (as used by the device headers)
+    - a write that reads the register first (e.g. |=) only calls the write hook
+    - models must not access registers via _SFR() from a hook
+    - no nested interrupts, priorities by vector number
+    - CPU time between register accesses is not counted, i.e. durations are
+      lower limits
+    - clock source is always HSI, _CLK_CMSR and clock switching are ignored
+    - memory accesses via plain pointers (e.g. *((uint8_t*) 0x4000)) are not
+      simulated, use _SFR(uint8_t, addr) instead
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _HOST_H_
+#define _HOST_H_
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stddef.h>     // NULL
+
+// simulated device. Must match firmware
+#if !defined(HOST_DEVICE)
+  #define HOST_DEVICE       "STM8S105K6.h"  ///< device header
+#endif
+#include HOST_DEVICE
+
+#if !defined(_HOST_)
+  #error host.h requires compilation with -DSTM8_HOST
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+/// HSI frequency [Hz], i.e. unit of simulated time
+#define HOST_FHSI           16000000L
+
+// CPU cycles per register access (approximation of code execution time)
+#if !defined(HOST_ACCESS_CYCLES)
+  #define HOST_ACCESS_CYCLES  2           ///< CPU cycles per register access
+#endif
+
+// CPU cycles for interrupt entry (latency) and return (IRET)
+#if !defined(HOST_ISR_ENTRY_CYCLES)
+  #define HOST_ISR_ENTRY_CYCLES  9        ///< CPU cycles for ISR entry
+#endif
+#if !defined(HOST_ISR_EXIT_CYCLES)
+  #define HOST_ISR_EXIT_CYCLES   11       ///< CPU cycles for ISR return
+#endif
+
+// max. number of hooks
+#if !defined(HOST_MAX_HOOKS)
+  #define HOST_MAX_HOOKS    16            ///< size of hook table
+#endif
+
+// max. simulated time for one WAIT_FOR_INTERRUPT() without wake-up
+#if !defined(HOST_WFI_TIMEOUT)
+  #define HOST_WFI_TIMEOUT  (HOST_FHSI)   ///< WFI timeout [HSI cycles]
+#endif
+
+/// address of register in simulated address space, e.g. HOST_ADDR(_TIM4_SR)
+#define HOST_ADDR(reg)      ((uint16_t) ((volatile uint8_t*) &(reg) - (volatile uint8_t*) stm8_host_mem))
+
+// access types for hooks
+#define HOST_PRE_READ       0             ///< before read, hook may update register value
+#define HOST_POST_READ      1             ///< after read, e.g. clear-on-read flags
+#define HOST_WRITE          2             ///< after write
+
+/// no pending event, returned by host_tick_t
+#define HOST_IDLE           0xFFFFFFFFUL
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// register access hook. old = value before access
+typedef void (*host_hook_t)(uint16_t addr, uint8_t access, uint8_t old);
+
+/// time hook. Advance model by HSI cycles, return HSI cycles until next event or HOST_IDLE
+typedef uint32_t (*host_tick_t)(uint32_t cycles);
+
+/// ISR profiling data [HSI cycles]
+typedef struct {
+  uint32_t  count;                      ///< number of executions
+  uint64_t  cycles;                     ///< total execution time incl. entry/exit
+  uint32_t  maxCycles;                  ///< longest execution time
+  uint32_t  maxLatency;                 ///< longest time from request to ISR start
+} host_isr_stat_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// init simulator: map address space, reset time and interrupts. Call before any register access
+void      host_init(void);
+
+/// attach access hook for address range first..last
+void      host_attach(uint16_t first, uint16_t last, host_hook_t hook);
+
+/// attach time hook of a peripheral model
+void      host_attach_tick(host_tick_t tick);
+
+/// read simulated memory without hooks
+uint8_t   host_peek(uint16_t addr);
+
+/// write simulated memory without hooks
+void      host_poke(uint16_t addr, uint8_t value);
+
+/// request interrupt at current time. Executed at next sync point if enabled
+void      host_irq(uint8_t irq);
+
+/// advance simulated time [HSI cycles] and execute pending ISRs
+void      host_run(uint32_t cycles);
+
+/// get simulated time [HSI cycles]
+uint64_t  host_cycles(void);
+
+/// get fMASTER prescaler from _CLK_CKDIVR: fMASTER = fHSI >> shift
+uint8_t   host_clk_shift(void);
+
+/// get profiling data of ISR
+const host_isr_stat_t *host_isr_stat(uint8_t irq);
+
+/// print ISR count, load and latency to stdout
+void      host_isr_report(void);
+
+/// start recording of all register accesses into file. Return 1 on success
+uint8_t   host_trace_start(const char *file);
+
+/// stop recording and close trace file
+void      host_trace_stop(void);
+
+/// replay recorded reads of addresses first..last. Return number of values
+uint32_t  host_replay(const char *file, uint16_t first, uint16_t last);
+
+/// get number of register accesses
+uint32_t  host_accesses(void);
+
+
+// peripheral models
+
+/// UART model with base address and TX/RX vectors. Return ID for host_uart_xxx()
+uint8_t   host_uart_init(uint16_t base, uint8_t irqTx, uint8_t irqRx);
+
+/// queue bytes for UART reception
+void      host_uart_send(uint8_t id, const uint8_t *data, uint16_t len);
+
+/// get bytes transmitted by UART. Return number of bytes
+uint16_t  host_uart_receive(uint8_t id, uint8_t *data, uint16_t max);
+
+/// timer model for TIM1..TIM6. Return 0 if timer doesn't exist
+uint8_t   host_tim_init(uint8_t timer);
+
+/// ADC1 model
+void      host_adc_init(void);
+
+/// set ADC1 input value (10bit) of channel
+void      host_adc_set(uint8_t channel, uint16_t value);
+
+/// FLASH/EEPROM programming model
+void      host_flash_init(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _HOST_H_
@@ -0,0 +1,189 @@
+/**
+  \file host_adc.c
+
+  \brief ADC1 model for STM8 register simulator
+
+  Simulates single and continuous conversions of the selected channel.
+  A conversion is started by setting ADON while the ADC is already on, and
+  takes 14 ADC clocks (fADC = fMASTER / SPSEL divider). Then the input
+  value set by host_adc_set() is stored in DRH/DRL according to ALIGN,
+  EOC is set and the interrupt is requested if EOCIE is set.
+  Scan mode, data buffers, external trigger and analog watchdog are not
+  simulated.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "host.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// check device
+#if !defined(_ADC1_CSR)
+  #error device has no ADC1
+#endif
+
+// number of ADC clocks per conversion
+#define ADC_CONV_CLOCKS     14
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// input value of channels
+static uint16_t     s_input[16];
+
+// cycles until end of conversion (0=idle)
+static uint32_t     s_convTime;
+
+// ADC clock divider for SPSEL[2:0]
+static const uint8_t s_divider[8] = {2, 3, 4, 6, 8, 10, 12, 18};
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void adc_start(void)
+
+  \brief start conversion
+*/
+static void adc_start(void) {
+
+  uint8_t   spsel = (host_peek(HOST_ADDR(_ADC1_CR1)) & _ADC1_CR1_SPSEL) >> 4;
+
+  s_convTime = ((uint32_t) ADC_CONV_CLOCKS * s_divider[spsel]) << host_clk_shift();
+
+} // adc_start
+
+
+
+/**
+  \fn void adc_hook(uint16_t addr, uint8_t access, uint8_t old)
+
+  \brief ADC1 register access hook
+
+  \param[in]  addr     register address
+  \param[in]  access   access type
+  \param[in]  old      value before access
+*/
+static void adc_hook(uint16_t addr, uint8_t access, uint8_t old) {
+
+  uint8_t   value = host_peek(addr);
+
+  if (access != HOST_WRITE)
+    return;
+
+  // ADON while on starts conversion. Clearing ADON stops it
+  if (addr == HOST_ADDR(_ADC1_CR1)) {
+    if ((value & _ADC1_CR1_ADON) && (old & _ADC1_CR1_ADON))
+      adc_start();
+    else if (!(value & _ADC1_CR1_ADON))
+      s_convTime = 0;
+  }
+
+  // EOC is only cleared by writing 0
+  else if (addr == HOST_ADDR(_ADC1_CSR)) {
+    host_poke(addr, value & (old | ~_ADC1_CSR_EOC));
+    if ((value & old & _ADC1_CSR_EOC) && (value & _ADC1_CSR_EOCIE))
+      host_irq(__ADC1_VECTOR__);
+  }
+
+} // adc_hook
+
+
+
+/**
+  \fn uint32_t adc_tick(uint32_t cycles)
+
+  \brief advance ADC1
+
+  \param[in]  cycles   HSI cycles
+
+  \return HSI cycles until end of conversion
+*/
+static uint32_t adc_tick(uint32_t cycles) {
+
+  uint8_t   csr;
+  uint16_t  value;
+
+  if (s_convTime == 0)
+    return(HOST_IDLE);
+  if (cycles < s_convTime) {
+    s_convTime -= cycles;
+    return(s_convTime);
+  }
+  s_convTime = 0;
+
+  // store result of selected channel
+  csr   = host_peek(HOST_ADDR(_ADC1_CSR));
+  value = s_input[csr & _ADC1_CSR_CH] & 0x03FF;
+  if (host_peek(HOST_ADDR(_ADC1_CR2)) & _ADC1_CR2_ALIGN) {
+    host_poke(HOST_ADDR(_ADC1_DRH), (uint8_t) (value >> 8));
+    host_poke(HOST_ADDR(_ADC1_DRL), (uint8_t) value);
+  }
+  else {
+    host_poke(HOST_ADDR(_ADC1_DRH), (uint8_t) (value >> 2));
+    host_poke(HOST_ADDR(_ADC1_DRL), (uint8_t) (value & 0x03));
+  }
+
+  // set flag and request interrupt
+  host_poke(HOST_ADDR(_ADC1_CSR), csr | _ADC1_CSR_EOC);
+  if (csr & _ADC1_CSR_EOCIE)
+    host_irq(__ADC1_VECTOR__);
+
+  // continuous mode -> next conversion
+  if (host_peek(HOST_ADDR(_ADC1_CR1)) & _ADC1_CR1_CONT)
+    adc_start();
+
+  return((s_convTime) ? s_convTime : HOST_IDLE);
+
+} // adc_tick
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void host_adc_init(void)
+
+  \brief init ADC1 model (ADC off, all inputs 0)
+*/
+void host_adc_init(void) {
+
+  uint8_t   i;
+
+  for (i=0; i<16; i++)
+    s_input[i] = 0;
+  s_convTime = 0;
+  host_attach(HOST_ADDR(_ADC1_CSR), HOST_ADDR(_ADC1_CR3), adc_hook);
+  host_attach_tick(adc_tick);
+
+} // host_adc_init
+
+
+
+/**
+  \fn void host_adc_set(uint8_t channel, uint16_t value)
+
+  \brief set input value of channel
+
+  \param[in]  channel   ADC channel (0..15)
+  \param[in]  value     10bit conversion result
+*/
+void host_adc_set(uint8_t channel, uint16_t value) {
+
+  s_input[channel & 0x0F] = value;
+
+} // host_adc_set
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
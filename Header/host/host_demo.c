@@ -0,0 +1,229 @@
+/**********************
+  STM8 register simulator demo
+  Unit-test unmodified firmware modules on a Linux PC
+
+  Functionality:
+  - compile timebase.c of example blink_TIM4_Timebase for the host
+  - check tb_delay_ms() timing with TIM4 model and interrupts
+  - check fMASTER prescaler from _CLK_CKDIVR
+  - count TIM2 update and compare interrupts
+  - send and receive bytes via UART2 model
+  - convert ADC1 channel 3
+  - write EEPROM byte with and without unlock
+  - record ADC1 accesses into trace file, then replay them without ADC model
+  - print results and ISR profile, return number of failed tests
+
+  Build and run with 'make test' (requires x86-64 Linux and gcc)
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdio.h>
+#include "host.h"
+#include "timebase.h"
+
+// UART2 baudrate
+#define BAUDRATE   9600
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// number of failed tests
+static int  g_fail = 0;
+
+// TIM2 interrupt counters
+static volatile uint16_t  g_tim2Upd = 0, g_tim2Cmp = 0;
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+// print result of test
+static void check(const char *name, int ok, unsigned long value) {
+
+  printf("%-28s %-4s (%lu)\n", name, ok ? "PASS" : "FAIL", value);
+  if (!ok)
+    g_fail++;
+
+} // check
+
+
+
+// TIM2 update ISR
+ISR_HANDLER(TIM2_UPD_ISR, __TIM2_UPD_OVF_VECTOR__) {
+
+  _TIM2_SR1 &= ~_TIM2_SR1_UIF;
+  g_tim2Upd++;
+
+} // TIM2_UPD_ISR
+
+
+
+// TIM2 compare ISR
+ISR_HANDLER(TIM2_CMP_ISR, __TIM2_CAPCOM_VECTOR__) {
+
+  _TIM2_SR1 &= ~_TIM2_SR1_CC1IF;
+  g_tim2Cmp++;
+
+} // TIM2_CMP_ISR
+
+
+
+////////
+// main routine
+////////
+int main(void) {
+
+  uint8_t   uart, buf[8], c;
+  uint16_t  BRR, result;
+  uint32_t  start, len, expire;
+  tb_timer_t  timer = {0};
+
+  ////
+  // init simulator and models
+  ////
+  host_init();
+  host_tim_init(2);
+  host_tim_init(4);
+  uart = host_uart_init(UART2_AddressBase, __UART2_TXE_VECTOR__, __UART2_RXF_VECTOR__);
+  host_adc_init();
+  host_flash_init();
+
+
+  ////
+  // timebase: 10ms delay in WAIT mode, 1 ISR per ms
+  ////
+  _CLK_CKDIVR = 0x00;                   // 16MHz (reset is 2MHz)
+  tb_init();
+  ENABLE_INTERRUPTS();
+  start = host_cycles();
+  tb_delay_ms(10);
+  check("tb_delay_ms(10) [ms]", tb_millis() == 10, tb_millis());
+  len = host_cycles() - start;
+  check("tb_delay_ms(10) [cycles]", (len > 9*(HOST_FHSI/1000)) && (len < 11*(HOST_FHSI/1000)), len);
+  check("tb_micros() [us]", tb_micros() / 1000 == 10, tb_micros());
+  check("TIM4 ISR latency [cycles]", host_isr_stat(__TIM4_UPD_OVF_VECTOR__)->maxLatency < 100, host_isr_stat(__TIM4_UPD_OVF_VECTOR__)->maxLatency);
+
+  // next timer expiry, e.g. for sleep decision of a scheduler
+  tb_timer_start(&timer, 5, 0, NULL);
+  c = tb_next_expiry(&expire);
+  check("tb_next_expiry() running", c && (expire == tb_millis() + 5), expire);
+  tb_timer_stop(&timer);
+  check("tb_next_expiry() stopped", !tb_next_expiry(&expire), 0);
+
+
+  ////
+  // clock: fMASTER = fHSI/2 -> TIM4 timebase runs at half speed
+  ////
+  _CLK_CKDIVR = 0x08;
+  start = host_cycles();
+  tb_delay_ms(10);
+  len = host_cycles() - start;
+  _CLK_CKDIVR = 0x00;
+  check("fMASTER/2 delay [cycles]", (len > 19*(HOST_FHSI/1000)) && (len < 21*(HOST_FHSI/1000)), len);
+
+
+  ////
+  // TIM2: 1ms period (1MHz count), compare at 0.5ms, count interrupts during 10ms
+  ////
+  _TIM2_PSCR  = 4;
+  _TIM2_ARRH  = (uint8_t) (999 >> 8);
+  _TIM2_ARRL  = (uint8_t) 999;
+  _TIM2_CCR1H = (uint8_t) (500 >> 8);
+  _TIM2_CCR1L = (uint8_t) 500;
+  _TIM2_IER   = _TIM2_IER_UIE | _TIM2_IER_CC1IE;
+  _TIM2_CR1   = _TIM2_CR1_CEN;
+  tb_delay_ms(10);
+  _TIM2_CR1   = 0x00;
+  check("TIM2 update ISRs", (g_tim2Upd >= 9) && (g_tim2Upd <= 11), g_tim2Upd);
+  check("TIM2 compare ISRs", (g_tim2Cmp >= 9) && (g_tim2Cmp <= 11), g_tim2Cmp);
+
+
+  ////
+  // UART2: send 2 bytes with polling, receive 1 byte
+  ////
+  BRR = (uint16_t) (HOST_FHSI/BAUDRATE);
+  _UART2_BRR2 = (uint8_t) (((BRR & 0xF000) >> 8) | (BRR & 0x000F));
+  _UART2_BRR1 = (uint8_t) ((BRR & 0x0FF0) >> 4);
+  _UART2_CR2 |= (_UART2_CR2_TEN | _UART2_CR2_REN);
+  start = host_cycles();
+  while (!(_UART2_SR & _UART2_SR_TXE));
+  _UART2_DR = 'O';
+  while (!(_UART2_SR & _UART2_SR_TXE));
+  _UART2_DR = 'K';
+  while (!(_UART2_SR & _UART2_SR_TC));
+  len = host_cycles() - start;
+  c = (uint8_t) host_uart_receive(uart, buf, sizeof(buf));
+  check("UART2 send", (c == 2) && (buf[0] == 'O') && (buf[1] == 'K'), c);
+  check("UART2 send [cycles]", (len >= 20L*BRR) && (len < 21L*BRR), len);
+  host_uart_send(uart, (const uint8_t*) "x", 1);
+  while (!(_UART2_SR & _UART2_SR_RXNE));
+  c = _UART2_DR;
+  check("UART2 receive", (c == 'x') && !(_UART2_SR & _UART2_SR_RXNE), c);
+
+
+  ////
+  // ADC1: single conversion of channel 3, right aligned. Record accesses
+  ////
+  host_trace_start("host_demo.trc");
+  host_adc_set(3, 512);
+  _ADC1_CR2 = _ADC1_CR2_ALIGN;
+  _ADC1_CSR = 3;
+  _ADC1_CR1 = _ADC1_CR1_ADON;           // power on
+  _ADC1_CR1 |= _ADC1_CR1_ADON;          // start conversion
+  while (!(_ADC1_CSR & _ADC1_CSR_EOC));
+  result  = _ADC1_DRL;
+  result |= (uint16_t) _ADC1_DRH << 8;
+  host_trace_stop();
+  check("ADC1 channel 3", result == 512, result);
+
+
+  ////
+  // EEPROM: write while locked is discarded, write after unlock succeeds
+  ////
+  _SFR(uint8_t, STM8_EEPROM_START) = 0x55;
+  check("EEPROM write locked", (_FLASH_IAPSR & _FLASH_IAPSR_WR_PG_DIS) && (_SFR(uint8_t, STM8_EEPROM_START) == 0x00), 0);
+  _FLASH_DUKR = 0xAE;
+  _FLASH_DUKR = 0x56;
+  while (!(_FLASH_IAPSR & _FLASH_IAPSR_DUL));
+  start = host_cycles();
+  _SFR(uint8_t, STM8_EEPROM_START) = 0x55;
+  while (!(_FLASH_IAPSR & _FLASH_IAPSR_EOP));
+  len = host_cycles() - start;
+  _FLASH_IAPSR &= ~_FLASH_IAPSR_DUL;
+  check("EEPROM write unlocked", _SFR(uint8_t, STM8_EEPROM_START) == 0x55, _SFR(uint8_t, STM8_EEPROM_START));
+  check("EEPROM write [cycles]", len >= 6*(HOST_FHSI/1000), len);
+  check("EEPROM lock", !(_FLASH_IAPSR & _FLASH_IAPSR_DUL), 0);
+
+
+  ////
+  // summary
+  ////
+  printf("\n");
+  host_isr_report();
+  printf("\n%lu register accesses, %lu cycles\n\n", (unsigned long) host_accesses(), (unsigned long) host_cycles());
+
+
+  ////
+  // replay: restart simulator without ADC model, feed recorded ADC1 reads
+  ////
+  host_init();
+  len = host_replay("host_demo.trc", HOST_ADDR(_ADC1_CSR), HOST_ADDR(_ADC1_DRL));
+  check("replay loaded", len > 0, len);
+  _ADC1_CR2 = _ADC1_CR2_ALIGN;
+  _ADC1_CSR = 3;
+  _ADC1_CR1 = _ADC1_CR1_ADON;
+  _ADC1_CR1 |= _ADC1_CR1_ADON;
+  while (!(_ADC1_CSR & _ADC1_CSR_EOC));
+  result  = _ADC1_DRL;
+  result |= (uint16_t) _ADC1_DRH << 8;
+  check("replay ADC1 channel 3", result == 512, result);
+  printf("\n%d failed\n", g_fail);
+
+  return(g_fail);
+
+} // main()
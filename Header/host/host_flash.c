@@ -0,0 +1,224 @@
+/**
+  \file host_flash.c
+
+  \brief FLASH/EEPROM programming model for STM8 register simulator
+
+  Simulates the unlock sequences via DUKR/PUKR, write protection of EEPROM
+  and program flash, and the IAPSR flags. A byte write to unlocked memory
+  sets EOP after the programming time, a write to locked memory is
+  discarded and sets WR_PG_DIS. Reading IAPSR clears EOP and WR_PG_DIS.
+  Memory content is kept until host_init().
+  Only byte programming is simulated, not word/block mode, option bytes,
+  UBC protection or the CPU stall during program flash writes.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "host.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// byte programming time incl. erase [ms]
+#if !defined(HOST_FLASH_PROG_MS)
+  #define HOST_FLASH_PROG_MS  6           ///< programming time [ms]
+#endif
+
+// unlock keys
+#define FLASH_KEY1          0x56
+#define FLASH_KEY2          0xAE
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// unlock sequence state: 0=idle, 1=first key ok, 0xFF=wrong key (locked until reset)
+static uint8_t      s_keyData;
+static uint8_t      s_keyProg;
+
+// cycles until end of programming (0=idle)
+static uint32_t     s_progTime;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void flash_set(uint8_t flags)
+
+  \brief set IAPSR flags and request interrupt if enabled
+
+  \param[in]  flags   IAPSR flags to set
+*/
+static void flash_set(uint8_t flags) {
+
+  host_poke(HOST_ADDR(_FLASH_IAPSR), host_peek(HOST_ADDR(_FLASH_IAPSR)) | flags);
+  if ((flags & (_FLASH_IAPSR_EOP | _FLASH_IAPSR_WR_PG_DIS)) && (host_peek(HOST_ADDR(_FLASH_CR1)) & _FLASH_CR1_IE))
+    host_irq(__FLASH_VECTOR__);
+
+} // flash_set
+
+
+
+/**
+  \fn uint8_t flash_key(uint8_t *state, uint8_t value, uint8_t first, uint8_t second)
+
+  \brief process unlock key
+
+  \param[in]  state    state of unlock sequence
+  \param[in]  value    written key
+  \param[in]  first    expected first key
+  \param[in]  second   expected second key
+
+  \return 1 if unlocked
+*/
+static uint8_t flash_key(uint8_t *state, uint8_t value, uint8_t first, uint8_t second) {
+
+  if (*state == 0xFF)
+    return(0);
+  if ((*state == 0) && (value == first)) {
+    *state = 1;
+    return(0);
+  }
+  if ((*state == 1) && (value == second)) {
+    *state = 0;
+    return(1);
+  }
+  *state = 0xFF;
+  return(0);
+
+} // flash_key
+
+
+
+/**
+  \fn void flash_reg_hook(uint16_t addr, uint8_t access, uint8_t old)
+
+  \brief FLASH register access hook
+
+  \param[in]  addr     register address
+  \param[in]  access   access type
+  \param[in]  old      value before access
+*/
+static void flash_reg_hook(uint16_t addr, uint8_t access, uint8_t old) {
+
+  uint8_t   value = host_peek(addr);
+
+  // reading status clears EOP and WR_PG_DIS
+  if (addr == HOST_ADDR(_FLASH_IAPSR)) {
+    if (access == HOST_POST_READ)
+      host_poke(addr, value & ~(_FLASH_IAPSR_EOP | _FLASH_IAPSR_WR_PG_DIS));
+    else if (access == HOST_WRITE)
+      host_poke(addr, (old & ~(_FLASH_IAPSR_PUL | _FLASH_IAPSR_DUL)) | (old & value & (_FLASH_IAPSR_PUL | _FLASH_IAPSR_DUL)));
+  }
+
+  // unlock keys. Registers read as 0
+  else if ((addr == HOST_ADDR(_FLASH_DUKR)) && (access == HOST_WRITE)) {
+    host_poke(addr, 0x00);
+    if (flash_key(&s_keyData, value, FLASH_KEY2, FLASH_KEY1))
+      flash_set(_FLASH_IAPSR_DUL);
+  }
+  else if ((addr == HOST_ADDR(_FLASH_PUKR)) && (access == HOST_WRITE)) {
+    host_poke(addr, 0x00);
+    if (flash_key(&s_keyProg, value, FLASH_KEY1, FLASH_KEY2))
+      flash_set(_FLASH_IAPSR_PUL);
+  }
+
+} // flash_reg_hook
+
+
+
+/**
+  \fn void flash_mem_hook(uint16_t addr, uint8_t access, uint8_t old)
+
+  \brief EEPROM and program flash access hook
+
+  \param[in]  addr     memory address
+  \param[in]  access   access type
+  \param[in]  old      value before access
+*/
+static void flash_mem_hook(uint16_t addr, uint8_t access, uint8_t old) {
+
+  uint8_t   iapsr = host_peek(HOST_ADDR(_FLASH_IAPSR));
+  uint8_t   unlock;
+
+  if (access != HOST_WRITE)
+    return;
+
+  // check write protection
+  if (addr >= STM8_PFLASH_START)
+    unlock = iapsr & _FLASH_IAPSR_PUL;
+  else
+    unlock = iapsr & _FLASH_IAPSR_DUL;
+
+  // locked -> discard. Else program
+  if (!unlock) {
+    host_poke(addr, old);
+    flash_set(_FLASH_IAPSR_WR_PG_DIS);
+  }
+  else {
+    host_poke(HOST_ADDR(_FLASH_IAPSR), iapsr & ~_FLASH_IAPSR_HVOFF);
+    s_progTime = (HOST_FHSI / 1000L) * HOST_FLASH_PROG_MS;
+  }
+
+} // flash_mem_hook
+
+
+
+/**
+  \fn uint32_t flash_tick(uint32_t cycles)
+
+  \brief advance programming
+
+  \param[in]  cycles   HSI cycles
+
+  \return HSI cycles until end of programming
+*/
+static uint32_t flash_tick(uint32_t cycles) {
+
+  if (s_progTime == 0)
+    return(HOST_IDLE);
+  if (cycles < s_progTime) {
+    s_progTime -= cycles;
+    return(s_progTime);
+  }
+  s_progTime = 0;
+  flash_set(_FLASH_IAPSR_EOP | _FLASH_IAPSR_HVOFF);
+
+  return(HOST_IDLE);
+
+} // flash_tick
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void host_flash_init(void)
+
+  \brief init FLASH model (memory locked, erased to 0x00)
+*/
+void host_flash_init(void) {
+
+  s_keyData  = 0;
+  s_keyProg  = 0;
+  s_progTime = 0;
+  host_poke(HOST_ADDR(_FLASH_IAPSR), _FLASH_IAPSR_HVOFF);
+  host_poke(HOST_ADDR(_FLASH_NCR2), 0xFF);
+  host_poke(HOST_ADDR(_FLASH_NFPR), 0xFF);
+  host_attach(HOST_ADDR(_FLASH_CR1), HOST_ADDR(_FLASH_DUKR), flash_reg_hook);
+  host_attach(STM8_EEPROM_START, STM8_EEPROM_END, flash_mem_hook);
+  host_attach(STM8_PFLASH_START, STM8_PFLASH_END, flash_mem_hook);
+  host_attach_tick(flash_tick);
+
+} // host_flash_init
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
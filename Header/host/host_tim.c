@@ -0,0 +1,423 @@
+/**
+  \file host_tim.c
+
+  \brief timer model for STM8 register simulator
+
+  Simulates the counters of TIM1..TIM6, clocked by fMASTER:
+    - TIM1: 16bit prescaler (PSCR+1), 16bit up- or down-counter, 4 channels
+    - TIM2/3/5: prescaler 2^PSCR, 16bit up-counter, 3/2/3 channels
+    - TIM4/6: prescaler 2^PSCR, 8bit up-counter
+  On overflow UIF is set, on a compare match CCxIF is set, and the update
+  or capture/compare interrupt is requested at the exact event time. EGR
+  generates software events.
+  Preload of PSCR/ARR/CCRx, center-aligned mode (counts up), one-pulse
+  mode, input capture, trigger/break and pin outputs are not simulated.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "host.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// number of timer slots (TIM1..TIM6)
+#define TIM_MAX             7
+
+// register bits (identical for all timers)
+#define TIM_CR1_CEN         0x01
+#define TIM_CR1_DIR         0x10
+#define TIM_SR1_UIF         0x01
+#define TIM_SR1_CCIF        0x1E
+#define TIM_EGR_UG          0x01
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL TYPES
+-----------------------------------------------------------------------------*/
+
+// state of one timer. Addresses of unused registers are 0
+typedef struct {
+  uint16_t  cr1, ier, sr1, egr;         // control and status registers
+  uint16_t  cntrh, cntrl;               // counter
+  uint16_t  pscrh, pscrl;               // prescaler
+  uint16_t  arrh, arrl;                 // auto-reload
+  uint16_t  ccr1h;                      // first compare register, others follow
+  uint16_t  last;                       // last register address
+  uint8_t   channels;                   // number of compare channels
+  uint8_t   linear;                     // 1=prescaler PSCR+1 (TIM1), 0=2^PSCR
+  uint8_t   pscMask;                    // mask for 2^PSCR
+  uint8_t   irqUpd, irqCC;              // interrupt vectors
+  uint32_t  sub;                        // HSI cycles since last counter tick
+} host_tim_t;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// timer states, index is timer number. Not initialized if cr1==0
+static host_tim_t   s_tim[TIM_MAX];
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn uint16_t tim_get(uint16_t high, uint16_t low)
+
+  \brief read 8bit or 16bit register value
+
+  \param[in]  high   address of high byte (0 for 8bit)
+  \param[in]  low    address of low byte
+
+  \return register value
+*/
+static uint16_t tim_get(uint16_t high, uint16_t low) {
+
+  if (high == 0)
+    return(host_peek(low));
+  return(((uint16_t) host_peek(high) << 8) | host_peek(low));
+
+} // tim_get
+
+
+
+/**
+  \fn void tim_flag(host_tim_t *t, uint8_t flags)
+
+  \brief set SR1 flags and request interrupts if enabled
+
+  \param[in]  t       timer state
+  \param[in]  flags   flags to set
+*/
+static void tim_flag(host_tim_t *t, uint8_t flags) {
+
+  uint8_t   sr  = host_peek(t->sr1) | flags;
+  uint8_t   ier = host_peek(t->ier);
+
+  host_poke(t->sr1, sr);
+  if (sr & ier & TIM_SR1_UIF)
+    host_irq(t->irqUpd);
+  if (sr & ier & TIM_SR1_CCIF)
+    host_irq(t->irqCC);
+
+} // tim_flag
+
+
+
+/**
+  \fn uint32_t tim_divider(host_tim_t *t)
+
+  \brief get duration of one counter tick
+
+  \param[in]  t   timer state
+
+  \return HSI cycles per counter tick
+*/
+static uint32_t tim_divider(host_tim_t *t) {
+
+  uint32_t  div;
+
+  if (t->linear)
+    div = (uint32_t) tim_get(t->pscrh, t->pscrl) + 1;
+  else
+    div = 1UL << (host_peek(t->pscrl) & t->pscMask);
+
+  return(div << host_clk_shift());
+
+} // tim_divider
+
+
+
+/**
+  \fn void tim_hook(uint16_t addr, uint8_t access, uint8_t old)
+
+  \brief register access hook for all timers
+
+  \param[in]  addr     register address
+  \param[in]  access   access type
+  \param[in]  old      value before access
+*/
+static void tim_hook(uint16_t addr, uint8_t access, uint8_t old) {
+
+  host_tim_t  *t = NULL;
+  uint8_t     i, value;
+
+  if (access != HOST_WRITE)
+    return;
+
+  // find timer
+  for (i=1; i<TIM_MAX; i++) {
+    if ((s_tim[i].cr1 != 0) && (addr >= s_tim[i].cr1) && (addr <= s_tim[i].last))
+      t = &(s_tim[i]);
+  }
+  if (t == NULL)
+    return;
+  value = host_peek(addr);
+
+  // software events. Update resets counter and prescaler
+  if (addr == t->egr) {
+    host_poke(addr, 0x00);
+    if (value & TIM_EGR_UG) {
+      if (t->linear && (host_peek(t->cr1) & TIM_CR1_DIR)) {
+        if (t->cntrh)
+          host_poke(t->cntrh, host_peek(t->arrh));
+        host_poke(t->cntrl, host_peek(t->arrl));
+      }
+      else {
+        if (t->cntrh)
+          host_poke(t->cntrh, 0x00);
+        host_poke(t->cntrl, 0x00);
+      }
+      t->sub = 0;
+    }
+    tim_flag(t, value & (TIM_SR1_UIF | TIM_SR1_CCIF));
+  }
+
+  // status flags are only cleared by writing 0
+  else if (addr == t->sr1)
+    host_poke(addr, old & value);
+
+  // timer start or counter write restarts prescaler
+  else if ((addr == t->cntrh) || (addr == t->cntrl) || ((addr == t->cr1) && (value & ~old & TIM_CR1_CEN)))
+    t->sub = 0;
+
+  // interrupt enabled with pending flag (level triggered)
+  else if (addr == t->ier)
+    tim_flag(t, 0x00);
+
+} // tim_hook
+
+
+
+/**
+  \fn uint32_t tim_advance(host_tim_t *t, uint32_t cycles)
+
+  \brief advance one timer
+
+  \param[in]  t        timer state
+  \param[in]  cycles   HSI cycles
+
+  \return HSI cycles until next overflow or compare match
+*/
+static uint32_t tim_advance(host_tim_t *t, uint32_t cycles) {
+
+  uint32_t  div, ticks, step, left, next, d;
+  uint16_t  mask, cnt, arr, ccr[4];
+  uint8_t   ch, down, flags;
+  uint64_t  time;
+
+  if (!(host_peek(t->cr1) & TIM_CR1_CEN))
+    return(HOST_IDLE);
+
+  // counter state
+  mask = (t->cntrh) ? 0xFFFF : 0xFF;
+  down = t->linear && (host_peek(t->cr1) & TIM_CR1_DIR);
+  cnt  = tim_get(t->cntrh, t->cntrl);
+  arr  = tim_get(t->arrh, t->arrl);
+  for (ch=0; ch<t->channels; ch++)
+    ccr[ch] = tim_get(t->ccr1h + 2*ch, t->ccr1h + 2*ch + 1);
+
+  // counter ticks in time step
+  div     = tim_divider(t);
+  t->sub += cycles;
+  ticks   = t->sub / div;
+  t->sub %= div;
+
+  // count in segments up to overflow/underflow and check compare matches
+  while (ticks) {
+    flags = 0x00;
+    left  = (down) ? (uint32_t) cnt + 1 : (uint32_t) ((arr - cnt) & mask) + 1;
+    step  = (ticks < left) ? ticks : left;
+    for (ch=0; ch<t->channels; ch++) {
+      d = (down) ? (uint32_t) ((cnt - ccr[ch]) & mask) : (uint32_t) ((ccr[ch] - cnt) & mask);
+      if ((d >= 1) && (d <= step) && (d < left))
+        flags |= (uint8_t) (0x02 << ch);
+      if ((step == left) && (ccr[ch] == ((down) ? arr : 0)))
+        flags |= (uint8_t) (0x02 << ch);
+    }
+    if (step == left) {
+      cnt = (down) ? arr : 0;
+      flags |= TIM_SR1_UIF;
+    }
+    else
+      cnt = (down) ? (uint16_t) (cnt - step) : (uint16_t) (cnt + step);
+    if (flags)
+      tim_flag(t, flags);
+    ticks -= step;
+  }
+  if (t->cntrh)
+    host_poke(t->cntrh, (uint8_t) (cnt >> 8));
+  host_poke(t->cntrl, (uint8_t) cnt);
+
+  // ticks until next event
+  next = (down) ? (uint32_t) cnt + 1 : (uint32_t) ((arr - cnt) & mask) + 1;
+  for (ch=0; ch<t->channels; ch++) {
+    d = (down) ? (uint32_t) ((cnt - ccr[ch]) & mask) : (uint32_t) ((ccr[ch] - cnt) & mask);
+    if ((d >= 1) && (d < next))
+      next = d;
+  }
+
+  // convert to HSI cycles
+  time = (uint64_t) next * div - t->sub;
+  return((time < HOST_IDLE) ? (uint32_t) time : HOST_IDLE - 1);
+
+} // tim_advance
+
+
+
+/**
+  \fn uint32_t tim_tick(uint32_t cycles)
+
+  \brief advance all timers
+
+  \param[in]  cycles   HSI cycles
+
+  \return HSI cycles until next event
+*/
+static uint32_t tim_tick(uint32_t cycles) {
+
+  uint32_t  next = HOST_IDLE, t;
+  uint8_t   i;
+
+  for (i=1; i<TIM_MAX; i++) {
+    if (s_tim[i].cr1 != 0) {
+      t = tim_advance(&(s_tim[i]), cycles);
+      if (t < next)
+        next = t;
+    }
+  }
+
+  return(next);
+
+} // tim_tick
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn uint8_t host_tim_init(uint8_t timer)
+
+  \brief init timer model (timer stopped)
+
+  \param[in]  timer   timer number 1..6
+
+  \return 1 on success, 0 if timer doesn't exist in device
+*/
+uint8_t host_tim_init(uint8_t timer) {
+
+  host_tim_t  *t;
+
+  if ((timer == 0) || (timer >= TIM_MAX))
+    return(0);
+  t = &(s_tim[timer]);
+  t->cr1 = 0;
+
+  // register addresses of timer
+  switch (timer) {
+
+    #if defined(_TIM1_CR1)
+      case 1:
+        t->cr1 = HOST_ADDR(_TIM1_CR1);    t->ier = HOST_ADDR(_TIM1_IER);
+        t->sr1 = HOST_ADDR(_TIM1_SR1);    t->egr = HOST_ADDR(_TIM1_EGR);
+        t->cntrh = HOST_ADDR(_TIM1_CNTRH); t->cntrl = HOST_ADDR(_TIM1_CNTRL);
+        t->pscrh = HOST_ADDR(_TIM1_PSCRH); t->pscrl = HOST_ADDR(_TIM1_PSCRL);
+        t->arrh = HOST_ADDR(_TIM1_ARRH);  t->arrl = HOST_ADDR(_TIM1_ARRL);
+        t->ccr1h = HOST_ADDR(_TIM1_CCR1H); t->last = HOST_ADDR(_TIM1_CCR4L);
+        t->channels = 4; t->linear = 1; t->pscMask = 0x00;
+        t->irqUpd = __TIM1_UPD_OVF_VECTOR__; t->irqCC = __TIM1_CAPCOM_VECTOR__;
+        break;
+    #endif
+
+    #if defined(_TIM2_CR1)
+      case 2:
+        t->cr1 = HOST_ADDR(_TIM2_CR1);    t->ier = HOST_ADDR(_TIM2_IER);
+        t->sr1 = HOST_ADDR(_TIM2_SR1);    t->egr = HOST_ADDR(_TIM2_EGR);
+        t->cntrh = HOST_ADDR(_TIM2_CNTRH); t->cntrl = HOST_ADDR(_TIM2_CNTRL);
+        t->pscrh = 0;                     t->pscrl = HOST_ADDR(_TIM2_PSCR);
+        t->arrh = HOST_ADDR(_TIM2_ARRH);  t->arrl = HOST_ADDR(_TIM2_ARRL);
+        t->ccr1h = HOST_ADDR(_TIM2_CCR1H); t->last = HOST_ADDR(_TIM2_CCR3L);
+        t->channels = 3; t->linear = 0; t->pscMask = 0x0F;
+        t->irqUpd = __TIM2_UPD_OVF_VECTOR__; t->irqCC = __TIM2_CAPCOM_VECTOR__;
+        break;
+    #endif
+
+    #if defined(_TIM3_CR1)
+      case 3:
+        t->cr1 = HOST_ADDR(_TIM3_CR1);    t->ier = HOST_ADDR(_TIM3_IER);
+        t->sr1 = HOST_ADDR(_TIM3_SR1);    t->egr = HOST_ADDR(_TIM3_EGR);
+        t->cntrh = HOST_ADDR(_TIM3_CNTRH); t->cntrl = HOST_ADDR(_TIM3_CNTRL);
+        t->pscrh = 0;                     t->pscrl = HOST_ADDR(_TIM3_PSCR);
+        t->arrh = HOST_ADDR(_TIM3_ARRH);  t->arrl = HOST_ADDR(_TIM3_ARRL);
+        t->ccr1h = HOST_ADDR(_TIM3_CCR1H); t->last = HOST_ADDR(_TIM3_CCR2L);
+        t->channels = 2; t->linear = 0; t->pscMask = 0x0F;
+        t->irqUpd = __TIM3_UPD_OVF_VECTOR__; t->irqCC = __TIM3_CAPCOM_VECTOR__;
+        break;
+    #endif
+
+    #if defined(_TIM4_CR)
+      case 4:
+        t->cr1 = HOST_ADDR(_TIM4_CR);     t->ier = HOST_ADDR(_TIM4_IER);
+        t->sr1 = HOST_ADDR(_TIM4_SR);     t->egr = HOST_ADDR(_TIM4_EGR);
+        t->cntrh = 0;                     t->cntrl = HOST_ADDR(_TIM4_CNTR);
+        t->pscrh = 0;                     t->pscrl = HOST_ADDR(_TIM4_PSCR);
+        t->arrh = 0;                      t->arrl = HOST_ADDR(_TIM4_ARR);
+        t->ccr1h = 0;                     t->last = HOST_ADDR(_TIM4_ARR);
+        t->channels = 0; t->linear = 0; t->pscMask = 0x07;
+        t->irqUpd = __TIM4_UPD_OVF_VECTOR__; t->irqCC = __TIM4_UPD_OVF_VECTOR__;
+        break;
+    #endif
+
+    #if defined(_TIM5_CR1)
+      case 5:
+        t->cr1 = HOST_ADDR(_TIM5_CR1);    t->ier = HOST_ADDR(_TIM5_IER);
+        t->sr1 = HOST_ADDR(_TIM5_SR1);    t->egr = HOST_ADDR(_TIM5_EGR);
+        t->cntrh = HOST_ADDR(_TIM5_CNTRH); t->cntrl = HOST_ADDR(_TIM5_CNTRL);
+        t->pscrh = 0;                     t->pscrl = HOST_ADDR(_TIM5_PSCR);
+        t->arrh = HOST_ADDR(_TIM5_ARRH);  t->arrl = HOST_ADDR(_TIM5_ARRL);
+        t->ccr1h = HOST_ADDR(_TIM5_CCR1H); t->last = HOST_ADDR(_TIM5_CCR3L);
+        t->channels = 3; t->linear = 0; t->pscMask = 0x0F;
+        t->irqUpd = __TIM5_UPD_OVF_VECTOR__; t->irqCC = __TIM5_CAPCOM_VECTOR__;
+        break;
+    #endif
+
+    #if defined(_TIM6_CR)
+      case 6:
+        t->cr1 = HOST_ADDR(_TIM6_CR);     t->ier = HOST_ADDR(_TIM6_IER);
+        t->sr1 = HOST_ADDR(_TIM6_SR);     t->egr = HOST_ADDR(_TIM6_EGR);
+        t->cntrh = 0;                     t->cntrl = HOST_ADDR(_TIM6_CNTR);
+        t->pscrh = 0;                     t->pscrl = HOST_ADDR(_TIM6_PSCR);
+        t->arrh = 0;                      t->arrl = HOST_ADDR(_TIM6_ARR);
+        t->ccr1h = 0;                     t->last = HOST_ADDR(_TIM6_ARR);
+        t->channels = 0; t->linear = 0; t->pscMask = 0x07;
+        t->irqUpd = __TIM6_UPD_OVF_VECTOR__; t->irqCC = __TIM6_UPD_OVF_VECTOR__;
+        break;
+    #endif
+
+    default:
+      return(0);
+
+  } // switch timer
+
+  // reset state: ARR = max
+  t->sub = 0;
+  if (t->arrh)
+    host_poke(t->arrh, 0xFF);
+  host_poke(t->arrl, 0xFF);
+  host_attach(t->cr1, t->last, tim_hook);
+  host_attach_tick(tim_tick);
+
+  return(1);
+
+} // host_tim_init
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,387 @@
+/**
+  \file host_uart.c
+
+  \brief UART model for STM8 register simulator
+
+  Simulates transmission and reception with baudrate timing from BRR1/BRR2,
+  the flags TXE, TC, RXNE and OR, and the TX/RX interrupts. Transmitted
+  bytes are collected in a buffer, received bytes are taken from a queue
+  filled by the test. The UART is clocked by fMASTER.
+
+  Register offsets are identical for UART1..4: SR, DR, BRR1, BRR2, CR1, CR2.
+  LIN, IrDA, smartcard and 9bit modes are not simulated.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "host.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// max. number of UARTs
+#if !defined(HOST_UART_MAX)
+  #define HOST_UART_MAX     2             ///< number of UART models
+#endif
+
+// size of TX buffer and RX queue
+#if !defined(HOST_UART_BUF)
+  #define HOST_UART_BUF     256           ///< buffer size [B]
+#endif
+
+// register offsets
+#define UART_SR             0x00
+#define UART_DR             0x01
+#define UART_BRR1           0x02
+#define UART_BRR2           0x03
+#define UART_CR2            0x05
+
+// register bits (identical for all UARTs)
+#define UART_SR_TXE         0x80
+#define UART_SR_TC          0x40
+#define UART_SR_RXNE        0x20
+#define UART_SR_OR          0x08
+#define UART_CR2_TIEN       0x80
+#define UART_CR2_TCIEN      0x40
+#define UART_CR2_RIEN       0x20
+#define UART_CR2_TEN        0x08
+#define UART_CR2_REN        0x04
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL TYPES
+-----------------------------------------------------------------------------*/
+
+// state of one UART
+typedef struct {
+  uint16_t  base;                       // register base address
+  uint8_t   irqTx, irqRx;               // interrupt vectors
+  uint32_t  txTime;                     // cycles until shift register empty (0=idle)
+  uint8_t   txShift;                    // byte in shift register
+  uint8_t   txFull;                     // DR contains byte
+  uint8_t   txData;                     // byte in DR
+  uint8_t   txBuf[HOST_UART_BUF];       // transmitted bytes
+  uint16_t  txLen;
+  uint32_t  rxTime;                     // cycles until next byte received (0=idle)
+  uint8_t   rxData;                     // last received byte
+  uint8_t   rxQueue[HOST_UART_BUF];     // bytes to receive
+  uint16_t  rxHead, rxTail;
+} host_uart_t;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+static host_uart_t  s_uart[HOST_UART_MAX];
+static uint8_t      s_numUart;
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF LOCAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn uint32_t uart_byte_time(host_uart_t *u)
+
+  \brief get duration of one frame (start + 8 data + stop bit)
+
+  \param[in]  u   UART state
+
+  \return frame time [HSI cycles]
+*/
+static uint32_t uart_byte_time(host_uart_t *u) {
+
+  uint8_t   brr2 = host_peek(u->base + UART_BRR2);
+  uint32_t  div;
+
+  div = ((uint32_t) (brr2 & 0xF0) << 8) | ((uint32_t) host_peek(u->base + UART_BRR1) << 4) | (brr2 & 0x0F);
+  if (div < 16)
+    div = 16;
+
+  return((10 * div) << host_clk_shift());
+
+} // uart_byte_time
+
+
+
+/**
+  \fn void uart_level(host_uart_t *u)
+
+  \brief request interrupts for enabled and set flags (level triggered)
+
+  \param[in]  u   UART state
+*/
+static void uart_level(host_uart_t *u) {
+
+  uint8_t   sr  = host_peek(u->base + UART_SR);
+  uint8_t   cr2 = host_peek(u->base + UART_CR2);
+
+  if (((sr & UART_SR_TXE) && (cr2 & UART_CR2_TIEN)) || ((sr & UART_SR_TC) && (cr2 & UART_CR2_TCIEN)))
+    host_irq(u->irqTx);
+  if ((sr & (UART_SR_RXNE | UART_SR_OR)) && (cr2 & UART_CR2_RIEN))
+    host_irq(u->irqRx);
+
+} // uart_level
+
+
+
+/**
+  \fn void uart_set(host_uart_t *u, uint8_t flags)
+
+  \brief set SR flags and request interrupt if enabled
+
+  \param[in]  u       UART state
+  \param[in]  flags   SR flags to set
+*/
+static void uart_set(host_uart_t *u, uint8_t flags) {
+
+  host_poke(u->base + UART_SR, host_peek(u->base + UART_SR) | flags);
+  uart_level(u);
+
+} // uart_set
+
+
+
+/**
+  \fn void uart_hook(uint16_t addr, uint8_t access, uint8_t old)
+
+  \brief register access hook for all UARTs
+
+  \param[in]  addr     register address
+  \param[in]  access   access type
+  \param[in]  old      value before access
+*/
+static void uart_hook(uint16_t addr, uint8_t access, uint8_t old) {
+
+  host_uart_t   *u = NULL;
+  uint8_t       i, value, sr;
+
+  // find UART
+  for (i=0; i<s_numUart; i++) {
+    if ((addr >= s_uart[i].base) && (addr <= s_uart[i].base + UART_CR2))
+      u = &(s_uart[i]);
+  }
+  if (u == NULL)
+    return;
+  value = host_peek(addr);
+  sr    = host_peek(u->base + UART_SR);
+
+  // DR read returns received byte and clears RXNE and OR
+  if (addr == u->base + UART_DR) {
+    if (access == HOST_PRE_READ)
+      host_poke(addr, u->rxData);
+    else if (access == HOST_POST_READ)
+      host_poke(u->base + UART_SR, sr & ~(UART_SR_RXNE | UART_SR_OR));
+    else if (host_peek(u->base + UART_CR2) & UART_CR2_TEN) {
+
+      // shift register empty -> transmit immediately, else keep in DR
+      if (u->txTime == 0) {
+        u->txShift = value;
+        u->txTime  = uart_byte_time(u);
+        host_poke(u->base + UART_SR, sr & ~UART_SR_TC);
+      }
+      else {
+        u->txData = value;
+        u->txFull = 1;
+        host_poke(u->base + UART_SR, sr & ~(UART_SR_TXE | UART_SR_TC));
+      }
+    }
+  } // DR
+
+  // SR write: only TC and RXNE can be cleared by writing 0
+  else if ((addr == u->base + UART_SR) && (access == HOST_WRITE)) {
+    host_poke(addr, (old & ~(UART_SR_TC | UART_SR_RXNE)) | (old & value & (UART_SR_TC | UART_SR_RXNE)));
+  }
+
+  // CR2 write: start reception
+  else if ((addr == u->base + UART_CR2) && (access == HOST_WRITE)) {
+    if ((value & UART_CR2_REN) && (u->rxTime == 0) && (u->rxHead != u->rxTail))
+      u->rxTime = uart_byte_time(u);
+  }
+
+  // interrupt request remains active while flag is set
+  uart_level(u);
+
+} // uart_hook
+
+
+
+/**
+  \fn uint32_t uart_tick(uint32_t cycles)
+
+  \brief advance all UARTs
+
+  \param[in]  cycles   HSI cycles
+
+  \return HSI cycles until next event
+*/
+static uint32_t uart_tick(uint32_t cycles) {
+
+  host_uart_t   *u;
+  uint32_t      next = HOST_IDLE;
+  uint8_t       i;
+
+  for (i=0; i<s_numUart; i++) {
+    u = &(s_uart[i]);
+
+    // transmission
+    if (u->txTime) {
+      if (cycles >= u->txTime) {
+        if (u->txLen < HOST_UART_BUF)
+          u->txBuf[u->txLen++] = u->txShift;
+        u->txTime = 0;
+        if (u->txFull) {
+          u->txShift = u->txData;
+          u->txFull  = 0;
+          u->txTime  = uart_byte_time(u);
+          uart_set(u, UART_SR_TXE);
+        }
+        else
+          uart_set(u, UART_SR_TC);
+      }
+      else
+        u->txTime -= cycles;
+    }
+
+    // reception
+    if (u->rxTime) {
+      if (cycles >= u->rxTime) {
+        u->rxTime = 0;
+        if (host_peek(u->base + UART_CR2) & UART_CR2_REN) {
+          if (host_peek(u->base + UART_SR) & UART_SR_RXNE)
+            uart_set(u, UART_SR_OR);
+          else {
+            u->rxData = u->rxQueue[u->rxTail];
+            uart_set(u, UART_SR_RXNE);
+          }
+          u->rxTail = (u->rxTail + 1) % HOST_UART_BUF;
+          if (u->rxHead != u->rxTail)
+            u->rxTime = uart_byte_time(u);
+        }
+      }
+      else
+        u->rxTime -= cycles;
+    }
+
+    // next event
+    if ((u->txTime) && (u->txTime < next))
+      next = u->txTime;
+    if ((u->rxTime) && (u->rxTime < next))
+      next = u->rxTime;
+
+  } // loop UARTs
+
+  return(next);
+
+} // uart_tick
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn uint8_t host_uart_init(uint16_t base, uint8_t irqTx, uint8_t irqRx)
+
+  \brief init UART model
+
+  \param[in]  base    register base address, e.g. UART2_AddressBase
+  \param[in]  irqTx   TX vector, e.g. __UART2_TXE_VECTOR__
+  \param[in]  irqRx   RX vector, e.g. __UART2_RXF_VECTOR__
+
+  \return ID for host_uart_send() and host_uart_receive(), 0xFF on error
+*/
+uint8_t host_uart_init(uint16_t base, uint8_t irqTx, uint8_t irqRx) {
+
+  host_uart_t   *u;
+  uint8_t       id;
+
+  // re-init of same UART (e.g. after host_init()) uses same ID
+  for (id=0; (id<s_numUart) && (s_uart[id].base != base); id++);
+  if (id >= HOST_UART_MAX)
+    return(0xFF);
+  if (id == s_numUart)
+    s_numUart++;
+  u = &(s_uart[id]);
+
+  u->base   = base;
+  u->irqTx  = irqTx;
+  u->irqRx  = irqRx;
+  u->txTime = 0;
+  u->txFull = 0;
+  u->txLen  = 0;
+  u->rxTime = 0;
+  u->rxData = 0;
+  u->rxHead = 0;
+  u->rxTail = 0;
+  host_poke(base + UART_SR, 0xC0);
+
+  host_attach(base, base + UART_CR2, uart_hook);
+  host_attach_tick(uart_tick);
+
+  return(id);
+
+} // host_uart_init
+
+
+
+/**
+  \fn void host_uart_send(uint8_t id, const uint8_t *data, uint16_t len)
+
+  \brief queue bytes for reception by firmware
+
+  \param[in]  id     UART ID
+  \param[in]  data   bytes to receive
+  \param[in]  len    number of bytes
+*/
+void host_uart_send(uint8_t id, const uint8_t *data, uint16_t len) {
+
+  host_uart_t   *u = &(s_uart[id]);
+
+  while (len--) {
+    if ((u->rxHead + 1) % HOST_UART_BUF == u->rxTail)
+      break;
+    u->rxQueue[u->rxHead] = *data++;
+    u->rxHead = (u->rxHead + 1) % HOST_UART_BUF;
+  }
+  if ((u->rxTime == 0) && (u->rxHead != u->rxTail) && (host_peek(u->base + UART_CR2) & UART_CR2_REN))
+    u->rxTime = uart_byte_time(u);
+
+} // host_uart_send
+
+
+
+/**
+  \fn uint16_t host_uart_receive(uint8_t id, uint8_t *data, uint16_t max)
+
+  \brief get and clear bytes transmitted by firmware
+
+  \param[in]  id     UART ID
+  \param[out] data   buffer for bytes
+  \param[in]  max    size of buffer
+
+  \return number of bytes
+*/
+uint16_t host_uart_receive(uint8_t id, uint8_t *data, uint16_t max) {
+
+  host_uart_t   *u = &(s_uart[id]);
+  uint16_t      i, len;
+
+  len = (u->txLen < max) ? u->txLen : max;
+  for (i=0; i<len; i++)
+    data[i] = u->txBuf[i];
+  for (i=len; i<u->txLen; i++)
+    u->txBuf[i-len] = u->txBuf[i];
+  u->txLen -= len;
+
+  return(len);
+
+} // host_uart_receive
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
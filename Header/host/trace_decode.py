@@ -0,0 +1,200 @@
+#!/usr/bin/python3
+# -*- coding: utf-8 -*-
+'''
+  Decode a register access trace into register and bit names. The trace is
+  recorded on target via SFR_READ()/SFR_WRITE() (example project Register_Trace)
+  or on a PC by the register simulator via host_trace_start(). Register addresses
+  and bit masks are taken from the device and family headers, which are parsed
+  with the C preprocessor, i.e. device specific register layouts are resolved.
+
+  Copyright (C) 2019 Georg Icking-Konert
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+  **notes**
+
+    - trace format (little endian):
+        header:  'STRC', time base [kHz] (2B), size of timestamp [B], reserved, number of records (2B, 0xFFFF=until end of file)
+        record:  timestamp, address (2B), value, type (0=read, 1=write)
+    - timestamps wrap around, i.e. the time between two records must be shorter than
+      one wrap period (65ms for 2B @ 1MHz on target, 268s for 4B @ 16MHz on host)
+    - requires a C preprocessor (default gcc) to read the headers
+
+'''
+
+# import required modules
+import os, sys, re
+import struct
+import argparse
+import subprocess
+
+
+# print disclaimer
+print('')
+print(sys.argv[0] + ', a small utility to decode STM8 register traces.')
+print('')
+print('Copyright (C) 2019  Georg Icking-Konert')
+print('')
+print('This program comes with ABSOLUTELY NO WARRANTY!')
+print('This is free software, and you are welcome to redistribute it')
+print('under certain conditions; see source code for details.')
+print('')
+
+
+#-------------------------------------------------------------------
+# global settings
+#-------------------------------------------------------------------
+
+# directories relative to this script
+BASEDIR     = os.path.dirname(os.path.abspath(__file__))
+INCLUDEDIR  = os.path.join(BASEDIR, '..', 'stm8', 'stm8af_stm8s')
+
+# trace file identifier and access types
+MAGIC       = b'STRC'
+TYPES       = ['R', 'W']
+
+
+
+#-------------------------------------------------------------------
+# get register and bit definitions from headers
+#-------------------------------------------------------------------
+def readHeaders(device, incdir, cpp):
+  """ Get registers and bit fields of a device via the C preprocessor.
+
+  :param device:   device header name without extension, e.g. 'STM8S105K6'
+  :param incdir:   folder with device and family headers
+  :param cpp:      C compiler used as preprocessor
+
+  :return: dict {address: (register name, [(field name, mask, shift)])}
+
+  """
+
+  # get all active macros of device header
+  cmd = [cpp, '-E', '-dM', '-DSTM8_HOST', '-I', incdir, '-x', 'c', os.path.join(incdir, device + '.h')]
+  try:
+    macros = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE, check=True, universal_newlines=True).stdout
+  except (OSError, subprocess.CalledProcessError) as err:
+    sys.exit('error: preprocessing ' + device + '.h failed: ' + str(err))
+  defines = {}
+  for line in macros.splitlines():
+    match = re.match(r'#define\s+(\w+)\s+(.*)$', line)
+    if match:
+      defines[match.group(1)] = match.group(2).strip()
+
+  # registers: _XXX _SFR(uint8_t, YYY_AddressBase+0xNN)
+  registers = {}
+  for name, value in defines.items():
+    match = re.match(r'_SFR\(\s*uint8_t\s*,\s*(\w+)\s*\+\s*(0x[0-9A-Fa-f]+|\d+)\s*\)$', value)
+    if match and (match.group(1) in defines):
+      addr = int(defines[match.group(1)], 0) + int(match.group(2), 0)
+      registers[name] = addr
+
+  # bit fields: _XXX_FIELD ((uint8_t) (0xMM << S)). Skip single bits of multi-bit fields, e.g. _ADC1_CSR_CH0
+  fields = {}
+  for name, value in defines.items():
+    match = re.match(r'\(\(uint8_t\)\s*\((0x[0-9A-Fa-f]+)\s*<<\s*(\d+)\)\)$', value)
+    if not match:
+      continue
+    for reg in registers:
+      if name.startswith(reg + '_'):
+        field = name[len(reg)+1:]
+        fields.setdefault(reg, []).append((field, int(match.group(1), 16) << int(match.group(2)), int(match.group(2))))
+  for reg, lst in fields.items():
+    multi = [f[0] for f in lst if bin(f[1]).count('1') > 1]
+    fields[reg] = [f for f in lst if not ((bin(f[1]).count('1') == 1) and (re.sub(r'\d+$', '', f[0]) in multi) and (f[0] not in multi))]
+
+  # lookup by address. Prefer shortest name, if several registers share an address
+  result = {}
+  for name, addr in sorted(registers.items(), key=lambda r: len(r[0])):
+    if addr not in result:
+      result[addr] = (name, fields.get(name, []))
+
+  return result
+
+
+
+#-------------------------------------------------------------------
+# decode fields of a register value
+#-------------------------------------------------------------------
+def decodeFields(fields, value):
+  """ Get non-zero bit fields of a register value.
+
+  :param fields:   list of (field name, mask, shift)
+  :param value:    register value
+
+  :return: string with set bits and field values, e.g. 'EOC CH=3'
+
+  """
+
+  result = []
+  for name, mask, shift in sorted(fields, key=lambda f: -f[1]):
+    if value & mask:
+      if (mask >> shift) == 1:
+        result.append(name)
+      else:
+        result.append(name + '=' + str((value & mask) >> shift))
+  return ' '.join(result)
+
+
+
+#-------------------------------------------------------------------
+# main program
+#-------------------------------------------------------------------
+if __name__ == '__main__':
+
+  # commandline parameters
+  parser = argparse.ArgumentParser(description='decode STM8 register access trace')
+  parser.add_argument('trace', help='trace file')
+  parser.add_argument('-d', '--device', default='STM8S105K6', help='device header without extension (default: STM8S105K6)')
+  parser.add_argument('-I', '--include', default=INCLUDEDIR, help='folder with device headers')
+  parser.add_argument('--cpp', default='gcc', help='C preprocessor (default: gcc)')
+  parser.add_argument('-r', '--raw', action='store_true', help='don\'t decode bit fields')
+  args = parser.parse_args()
+
+  # read register definitions
+  registers = readHeaders(args.device, args.include, args.cpp)
+
+  # read trace header
+  with open(args.trace, 'rb') as fp:
+    data = fp.read()
+  if (len(data) < 10) or (data[0:4] != MAGIC):
+    sys.exit('error: ' + args.trace + ' is no trace file')
+  freq, timeSize, _, count = struct.unpack('<HBBH', data[4:10])
+  if (freq == 0) or (timeSize < 1) or (timeSize > 4):
+    sys.exit('error: invalid trace header')
+  recSize = timeSize + 4
+  if count == 0xFFFF:
+    count = (len(data) - 10) // recSize
+  timeMask = (1 << (8*timeSize)) - 1
+
+  # print records with unwrapped time
+  print('  time [us]  type  register            value  fields')
+  time = None
+  for i in range(count):
+    rec = data[10 + i*recSize : 10 + (i+1)*recSize]
+    if len(rec) < recSize:
+      print('warning: trace truncated after ' + str(i) + ' records')
+      break
+    stamp = int.from_bytes(rec[0:timeSize], 'little')
+    addr, value, typ = struct.unpack('<HBB', rec[timeSize:])
+    if time is None:
+      time, last = 0, stamp
+    time += (stamp - last) & timeMask
+    last = stamp
+    name, fields = registers.get(addr, ('0x%04X' % addr, []))
+    line = '%11.3f  %-4s  %-18s  0x%02X' % (time * 1000.0 / freq, TYPES[typ & 0x01], name, value)
+    if not args.raw:
+      line += '   ' + decodeFields(fields, value)
+    print(line.rstrip())